@@ -0,0 +1,378 @@
+// Host Register Bank Module
+// BAR0 register file behind the PCIe interface. Turns host register
+// writes into parser beats and order entry commands, and exposes the
+// book manager outputs. Book levels pushed through the load FIFO are fed
+// to the parser back to back, without a host handshake per level, to
+// restore the book from a snapshot. The map is mirrored in
+// sw/api/register_map.hpp.
+`timescale 1ns / 1ps
+
+module host_register_bank #(
+    parameter int CLK_PERIOD_NS = 4,
+    parameter int THROUGHPUT_WINDOW_LOG2 = 20, // cycles per throughput sample
+    parameter int LOAD_FIFO_DEPTH = 16
+)(
+    input  logic        clk,
+    input  logic        rst_n,
+
+    // Register bus (32-bit word addressed), read data valid the next cycle
+    input  logic        reg_we,
+    input  logic        reg_re,
+    input  logic [9:0]  reg_addr,
+    input  logic [31:0] reg_wdata,
+    output logic [31:0] reg_rdata,
+
+    // Market data parser input
+    output logic        md_valid,
+    output logic [63:0] md_data,
+    output logic        md_first,   // md_data is a header beat
+    input  logic        md_ready,
+
+    // Order book manager outputs
+    input  logic [31:0] best_bid_price,
+    input  logic [31:0] best_ask_price,
+    input  logic [31:0] best_bid_qty,
+    input  logic [31:0] best_ask_qty,
+    input  logic        book_updated,
+
+    // Order entry encoder host port
+    output logic        host_cmd_valid,
+    input  logic        host_cmd_ready,
+    output logic        host_cmd_cancel,
+    output logic        host_cmd_buy,
+    output logic [63:0] host_cmd_symbol,
+    output logic [31:0] host_cmd_price,
+    output logic [31:0] host_cmd_quantity,
+    output logic [31:0] host_cmd_order_id,
+    output logic        seq_load,
+    output logic [31:0] seq_value,
+    input  logic [31:0] next_order_id,
+    input  logic [31:0] last_order_id
+);
+
+    // Register indices (see sw/api/register_map.hpp)
+    localparam logic [9:0] REG_SYMBOL         = 10'd0;
+    localparam logic [9:0] REG_PRICE_H        = 10'd1;
+    localparam logic [9:0] REG_PRICE_L        = 10'd2;
+    localparam logic [9:0] REG_QUANTITY       = 10'd3;
+    localparam logic [9:0] REG_CONTROL        = 10'd4;
+    localparam logic [9:0] REG_STATUS         = 10'd5;
+    localparam logic [9:0] REG_BEST_BID_H     = 10'd6;
+    localparam logic [9:0] REG_BEST_BID_L     = 10'd7;
+    localparam logic [9:0] REG_BEST_ASK_H     = 10'd8;
+    localparam logic [9:0] REG_BEST_ASK_L     = 10'd9;
+    localparam logic [9:0] REG_BEST_BID_QTY   = 10'd10;
+    localparam logic [9:0] REG_BEST_ASK_QTY   = 10'd11;
+    localparam logic [9:0] REG_LATENCY        = 10'd12;
+    localparam logic [9:0] REG_THROUGHPUT     = 10'd13;
+    localparam logic [9:0] REG_ORDER_SYMBOL_L = 10'd14;
+    localparam logic [9:0] REG_ORDER_SYMBOL_H = 10'd15;
+    localparam logic [9:0] REG_ORDER_PRICE    = 10'd16;
+    localparam logic [9:0] REG_ORDER_QTY      = 10'd17;
+    localparam logic [9:0] REG_ORDER_ID       = 10'd18;
+    localparam logic [9:0] REG_ORDER_CONTROL  = 10'd19;
+    localparam logic [9:0] REG_ORDER_STATUS   = 10'd20;
+    localparam logic [9:0] REG_ORDER_SEQ      = 10'd21;
+    localparam logic [9:0] REG_LOAD_PRICE     = 10'd24;
+    localparam logic [9:0] REG_LOAD_QTY       = 10'd25;
+    localparam logic [9:0] REG_LOAD_COUNT     = 10'd26;
+    localparam logic [9:0] REG_BOOK_SEQ_BEGIN = 10'd40;
+    localparam logic [9:0] REG_BOOK_BID_H     = 10'd41;
+    localparam logic [9:0] REG_BOOK_BID_L     = 10'd42;
+    localparam logic [9:0] REG_BOOK_ASK_H     = 10'd43;
+    localparam logic [9:0] REG_BOOK_ASK_L     = 10'd44;
+    localparam logic [9:0] REG_BOOK_BID_QTY   = 10'd45;
+    localparam logic [9:0] REG_BOOK_ASK_QTY   = 10'd46;
+    localparam logic [9:0] REG_BOOK_SEQ_END   = 10'd47;
+
+    localparam logic [1:0] MSG_QUOTE = 2'b10;
+
+    // Staged market data update
+    logic [31:0] symbol_reg;
+    logic [31:0] price_h_reg;  // read back only: the datapath is 32 bits, the host
+                               // rejects larger prices
+    logic [31:0] price_l_reg;
+    logic [31:0] quantity_reg;
+    logic        is_bid_reg;
+
+    // Parser beat sequencer
+    logic        md_active;
+    logic [1:0]  md_beat;
+    logic        waiting_book;
+    logic        md_from_load;  // current message came from the load FIFO
+
+    // Book load FIFO: {price}, {is_bid, quantity[30:0]}
+    localparam int LOAD_PTR_W = $clog2(LOAD_FIFO_DEPTH);
+    logic [31:0] load_price_fifo [LOAD_FIFO_DEPTH];
+    logic [31:0] load_qty_fifo [LOAD_FIFO_DEPTH];
+    logic [LOAD_PTR_W:0] load_wr;
+    logic [LOAD_PTR_W:0] load_rd;
+    logic        load_empty;
+    logic        load_full;
+    logic [31:0] load_price_reg;
+    logic [31:0] cur_load_price;
+    logic [31:0] cur_load_qty;
+    logic [31:0] load_count;    // loaded levels applied by the book
+
+    // Status and readback
+    logic [1:0]  status;
+    logic        book_request;
+    logic [31:0] best_bid_reg;
+    logic [31:0] best_ask_reg;
+    logic [31:0] best_bid_qty_reg;
+    logic [31:0] best_ask_qty_reg;
+    logic        order_accepted;
+
+    // Top of book copy taken on every book update, with its generation.
+    // Reading BOOK_SEQ_BEGIN latches copy and generation into the read
+    // snapshot that BOOK_* and BOOK_SEQ_END return.
+    logic [31:0] book_gen;
+    logic [31:0] live_bid;
+    logic [31:0] live_ask;
+    logic [31:0] live_bid_qty;
+    logic [31:0] live_ask_qty;
+    logic [31:0] snap_gen;
+    logic [31:0] snap_bid;
+    logic [31:0] snap_ask;
+    logic [31:0] snap_bid_qty;
+    logic [31:0] snap_ask_qty;
+
+    // Latency and throughput measurement
+    logic [63:0] cycle_count;
+    logic [63:0] update_start;
+    logic [31:0] latency_ns;
+    logic [31:0] window_messages;
+    logic [31:0] throughput;
+    logic        update_done;
+
+    assign update_done = book_updated && waiting_book;
+    assign load_empty = (load_wr == load_rd);
+    assign load_full = (load_wr[LOAD_PTR_W-1:0] == load_rd[LOAD_PTR_W-1:0]) &&
+                       (load_wr[LOAD_PTR_W] != load_rd[LOAD_PTR_W]);
+
+    always_comb begin
+        md_valid = md_active;
+        md_first = (md_beat == 2'd0);
+        case (md_beat)
+            2'd0: md_data = {61'd0, md_from_load ? cur_load_qty[31] : is_bid_reg, MSG_QUOTE};
+            2'd1: md_data = {32'd0, symbol_reg};
+            2'd2: md_data = {32'd0, md_from_load ? cur_load_price : price_l_reg};  // parser datapath is 32 bits
+            default: md_data = {32'd0, md_from_load ? {1'b0, cur_load_qty[30:0]} : quantity_reg};
+        endcase
+    end
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            symbol_reg <= '0;
+            price_h_reg <= '0;
+            price_l_reg <= '0;
+            quantity_reg <= '0;
+            is_bid_reg <= 1'b0;
+            md_active <= 1'b0;
+            md_beat <= '0;
+            waiting_book <= 1'b0;
+            md_from_load <= 1'b0;
+            load_wr <= '0;
+            load_rd <= '0;
+            load_price_reg <= '0;
+            cur_load_price <= '0;
+            cur_load_qty <= '0;
+            load_count <= '0;
+            status <= 2'b01;
+            book_request <= 1'b0;
+            best_bid_reg <= '0;
+            best_ask_reg <= '0;
+            best_bid_qty_reg <= '0;
+            best_ask_qty_reg <= '0;
+            order_accepted <= 1'b1;
+            book_gen <= '0;
+            live_bid <= '0;
+            live_ask <= '0;
+            live_bid_qty <= '0;
+            live_ask_qty <= '0;
+            snap_gen <= '0;
+            snap_bid <= '0;
+            snap_ask <= '0;
+            snap_bid_qty <= '0;
+            snap_ask_qty <= '0;
+            host_cmd_valid <= 1'b0;
+            host_cmd_cancel <= 1'b0;
+            host_cmd_buy <= 1'b0;
+            host_cmd_symbol <= '0;
+            host_cmd_price <= '0;
+            host_cmd_quantity <= '0;
+            host_cmd_order_id <= '0;
+            seq_load <= 1'b0;
+            seq_value <= '0;
+            cycle_count <= '0;
+            update_start <= '0;
+            latency_ns <= '0;
+            window_messages <= '0;
+            throughput <= '0;
+            reg_rdata <= '0;
+        end else begin
+            cycle_count <= cycle_count + 1;
+            seq_load <= 1'b0;
+
+            // Parser beats
+            if (md_active && md_ready) begin
+                md_beat <= md_beat + 1;
+                if (md_beat == 2'd3) begin
+                    md_active <= 1'b0;
+                    waiting_book <= 1'b1;
+                end
+            end
+
+            // Acknowledge once the update has reached the book
+            if (update_done) begin
+                waiting_book <= 1'b0;
+                if (md_from_load) begin
+                    load_count <= load_count + 1;
+                end else begin
+                    status[0] <= 1'b1;
+                    latency_ns <= 32'((cycle_count - update_start) * CLK_PERIOD_NS);
+                end
+            end
+
+            // Next loaded level once the previous message has been applied
+            if (!md_active && !waiting_book && !load_empty) begin
+                cur_load_price <= load_price_fifo[load_rd[LOAD_PTR_W-1:0]];
+                cur_load_qty <= load_qty_fifo[load_rd[LOAD_PTR_W-1:0]];
+                load_rd <= load_rd + 1;
+                md_from_load <= 1'b1;
+                md_active <= 1'b1;
+                md_beat <= '0;
+            end
+
+            if (cycle_count[THROUGHPUT_WINDOW_LOG2-1:0] == '1) begin
+                // messages/s = messages per window * clock Hz / window cycles
+                throughput <= 32'((64'(window_messages) * (64'd1000000000 / CLK_PERIOD_NS))
+                                  >> THROUGHPUT_WINDOW_LOG2);
+                window_messages <= {31'd0, update_done};
+            end else if (update_done) begin
+                window_messages <= window_messages + 1;
+            end
+
+            // Generation and copy change on the same edge
+            if (book_updated) begin
+                book_gen <= book_gen + 1;
+                live_bid <= best_bid_price;
+                live_ask <= best_ask_price;
+                live_bid_qty <= best_bid_qty;
+                live_ask_qty <= best_ask_qty;
+            end
+
+            // Book snapshot one cycle after the request
+            if (book_request) begin
+                best_bid_reg <= best_bid_price;
+                best_ask_reg <= best_ask_price;
+                best_bid_qty_reg <= best_bid_qty;
+                best_ask_qty_reg <= best_ask_qty;
+                status[1] <= 1'b1;
+                book_request <= 1'b0;
+            end
+
+            // Order entry handshake
+            if (host_cmd_valid && host_cmd_ready) begin
+                host_cmd_valid <= 1'b0;
+                order_accepted <= 1'b1;
+            end
+
+            // Register writes
+            if (reg_we) begin
+                case (reg_addr)
+                    REG_SYMBOL:   symbol_reg <= reg_wdata;
+                    REG_PRICE_H:  price_h_reg <= reg_wdata;
+                    REG_PRICE_L:  price_l_reg <= reg_wdata;
+                    REG_QUANTITY: quantity_reg <= reg_wdata;
+                    REG_CONTROL: begin
+                        if (reg_wdata[0]) begin
+                            is_bid_reg <= reg_wdata[1];
+                            md_from_load <= 1'b0;
+                            md_active <= 1'b1;
+                            md_beat <= '0;
+                            status[0] <= 1'b0;
+                            update_start <= cycle_count;
+                        end
+                        if (reg_wdata[2]) begin
+                            status[1] <= 1'b0;
+                            book_request <= 1'b1;
+                        end
+                    end
+                    REG_ORDER_SYMBOL_L: host_cmd_symbol[31:0] <= reg_wdata;
+                    REG_ORDER_SYMBOL_H: host_cmd_symbol[63:32] <= reg_wdata;
+                    REG_ORDER_PRICE:    host_cmd_price <= reg_wdata;
+                    REG_ORDER_QTY:      host_cmd_quantity <= reg_wdata;
+                    REG_ORDER_ID:       host_cmd_order_id <= reg_wdata;
+                    REG_ORDER_CONTROL: begin
+                        if (reg_wdata[0]) begin
+                            host_cmd_valid <= 1'b1;
+                            host_cmd_buy <= reg_wdata[1];
+                            host_cmd_cancel <= reg_wdata[2];
+                            order_accepted <= 1'b0;
+                        end
+                    end
+                    REG_ORDER_SEQ: begin
+                        seq_load <= 1'b1;
+                        seq_value <= reg_wdata;
+                    end
+                    REG_LOAD_PRICE: load_price_reg <= reg_wdata;
+                    REG_LOAD_QTY: begin
+                        // The host batches pushes to the FIFO depth, so a
+                        // push into a full FIFO is dropped
+                        if (!load_full) begin
+                            load_price_fifo[load_wr[LOAD_PTR_W-1:0]] <= load_price_reg;
+                            load_qty_fifo[load_wr[LOAD_PTR_W-1:0]] <= reg_wdata;
+                            load_wr <= load_wr + 1;
+                        end
+                    end
+                    default: ;
+                endcase
+            end
+
+            // Register reads
+            if (reg_re) begin
+                case (reg_addr)
+                    REG_SYMBOL:         reg_rdata <= symbol_reg;
+                    REG_PRICE_H:        reg_rdata <= price_h_reg;
+                    REG_PRICE_L:        reg_rdata <= price_l_reg;
+                    REG_QUANTITY:       reg_rdata <= quantity_reg;
+                    REG_STATUS:         reg_rdata <= {30'd0, status};
+                    REG_BEST_BID_H:     reg_rdata <= '0;  // book prices are 32 bits
+                    REG_BEST_BID_L:     reg_rdata <= best_bid_reg;
+                    REG_BEST_ASK_H:     reg_rdata <= '0;
+                    REG_BEST_ASK_L:     reg_rdata <= best_ask_reg;
+                    REG_BEST_BID_QTY:   reg_rdata <= best_bid_qty_reg;
+                    REG_BEST_ASK_QTY:   reg_rdata <= best_ask_qty_reg;
+                    REG_LATENCY:        reg_rdata <= latency_ns;
+                    REG_THROUGHPUT:     reg_rdata <= throughput;
+                    REG_ORDER_SYMBOL_L: reg_rdata <= host_cmd_symbol[31:0];
+                    REG_ORDER_SYMBOL_H: reg_rdata <= host_cmd_symbol[63:32];
+                    REG_ORDER_PRICE:    reg_rdata <= host_cmd_price;
+                    REG_ORDER_QTY:      reg_rdata <= host_cmd_quantity;
+                    REG_ORDER_ID:       reg_rdata <= last_order_id;
+                    REG_ORDER_STATUS:   reg_rdata <= {31'd0, order_accepted};
+                    REG_ORDER_SEQ:      reg_rdata <= next_order_id;
+                    REG_LOAD_COUNT:     reg_rdata <= load_count;
+                    REG_BOOK_SEQ_BEGIN: begin
+                        reg_rdata <= book_gen;
+                        snap_gen <= book_gen;
+                        snap_bid <= live_bid;
+                        snap_ask <= live_ask;
+                        snap_bid_qty <= live_bid_qty;
+                        snap_ask_qty <= live_ask_qty;
+                    end
+                    REG_BOOK_BID_H:     reg_rdata <= '0;  // book prices are 32 bits
+                    REG_BOOK_BID_L:     reg_rdata <= snap_bid;
+                    REG_BOOK_ASK_H:     reg_rdata <= '0;
+                    REG_BOOK_ASK_L:     reg_rdata <= snap_ask;
+                    REG_BOOK_BID_QTY:   reg_rdata <= snap_bid_qty;
+                    REG_BOOK_ASK_QTY:   reg_rdata <= snap_ask_qty;
+                    REG_BOOK_SEQ_END:   reg_rdata <= snap_gen;
+                    default:            reg_rdata <= '0;
+                endcase
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,165 @@
+// Latency Histogram Module
+// Log2-bucketed latency histogram held in a ping-pong pair of BRAM banks.
+// Samples accumulate in the active bank; a write to the control register
+// swaps the banks on one clock edge, freezing the samples taken so far for
+// host readout and starting a cleared bank. Clearing is O(1): each bank
+// carries a generation counter, and entries whose tag does not match it
+// read as zero. Generations run 1..2^GEN_W-1; when a bank's counter wraps
+// it is swept back to tag 0 as it becomes active, so a tag never repeats
+// between clears. Samples arriving during the NUM_BUCKETS-cycle sweep are
+// dropped, like those during the reset sweep, and a snapshot requested
+// during either sweep is ignored.
+`timescale 1ns / 1ps
+
+module latency_histogram #(
+    parameter int NUM_BUCKETS = 32,           // bucket 0: 0 cycles, bucket k: [2^(k-1), 2^k)
+    parameter int GEN_W = 8,                  // generation tag width
+    parameter logic [9:0] CONTROL_ADDR = 10'd33,
+    parameter logic [9:0] BASE_ADDR = 10'd128 // bucket i of the frozen bank at BASE + i
+)(
+    input  logic        clk,
+    input  logic        rst_n,
+
+    // Latency samples in clock cycles
+    input  logic        sample_valid,
+    input  logic [31:0] sample_cycles,
+
+    // Register bus slave
+    input  logic        reg_we,
+    input  logic        reg_re,
+    input  logic [9:0]  reg_addr,
+    input  logic [31:0] reg_wdata,
+    output logic [31:0] reg_rdata,
+    output logic        reg_hit     // reg_rdata belongs to this block
+);
+
+    localparam int IDX_W = $clog2(NUM_BUCKETS);
+
+    typedef struct packed {
+        logic [GEN_W-1:0] tag;
+        logic [31:0]      count;
+    } entry_t;
+
+    // {bank, bucket} addressed, true dual port: A = sample path, B = host
+    entry_t mem [2 * NUM_BUCKETS];
+
+    logic             active;
+    logic [GEN_W-1:0] gen [2];
+    logic [GEN_W-1:0] gen_next;   // generation of the bank about to become active
+    logic             clearing;
+    logic [IDX_W:0]   clear_addr;
+    logic [IDX_W:0]   clear_last;
+
+    // Stage 1: bucket index
+    logic             s1_valid;
+    logic             s1_bank;
+    logic [IDX_W-1:0] s1_bucket;
+
+    // Stage 2: BRAM read data, read-modify-write
+    logic             s2_valid;
+    logic             s2_bank;
+    logic [IDX_W-1:0] s2_bucket;
+    entry_t           s2_entry;
+    logic             fwd_valid;  // s2_entry is stale, use the entry written last cycle
+    entry_t           fwd_entry;
+    entry_t           s2_current;
+    entry_t           s2_next;
+
+    // Host readout
+    logic [9:0]       offset;
+    logic             rd_bank;
+    entry_t           rd_entry;
+
+    function automatic logic [IDX_W-1:0] bucket_of(input logic [31:0] cycles);
+        logic [IDX_W-1:0] idx;
+        idx = '0;
+        for (int b = 0; b < 32; b++) begin
+            if (cycles[b]) begin
+                idx = (b + 1 >= NUM_BUCKETS) ? IDX_W'(NUM_BUCKETS - 1) : IDX_W'(b + 1);
+            end
+        end
+        return idx;
+    endfunction
+
+    assign offset = reg_addr - BASE_ADDR;
+    assign gen_next = gen[!active] + 1'b1;
+    assign s2_current = fwd_valid ? fwd_entry : s2_entry;
+
+    always_comb begin
+        s2_next.tag = gen[s2_bank];
+        s2_next.count = (s2_current.tag == gen[s2_bank]) ? s2_current.count + 1 : 32'd1;
+    end
+
+    always_ff @(posedge clk) begin
+        // Port A: sample path, else the clear sweep, which waits for
+        // samples still in flight to the other bank
+        if (s2_valid) begin
+            mem[{s2_bank, s2_bucket}] <= s2_next;
+        end else if (clearing) begin
+            mem[clear_addr] <= '{tag: '0, count: '0};
+        end
+        s2_entry <= mem[{s1_bank, s1_bucket}];
+
+        // Port B: host readout
+        rd_entry <= mem[{rd_bank, offset[IDX_W-1:0]}];
+    end
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            active <= 1'b0;
+            gen[0] <= GEN_W'(1);
+            gen[1] <= GEN_W'(1);
+            clearing <= 1'b1;
+            clear_addr <= '0;
+            clear_last <= (IDX_W+1)'(2 * NUM_BUCKETS - 1);
+            s1_valid <= 1'b0;
+            s1_bank <= 1'b0;
+            s1_bucket <= '0;
+            s2_valid <= 1'b0;
+            s2_bank <= 1'b0;
+            s2_bucket <= '0;
+            fwd_valid <= 1'b0;
+            fwd_entry <= '0;
+            rd_bank <= 1'b1;
+            reg_hit <= 1'b0;
+        end else begin
+            if (clearing && !s2_valid) begin
+                clear_addr <= clear_addr + 1;
+                if (clear_addr == clear_last) begin
+                    clearing <= 1'b0;
+                end
+            end
+
+            // The bank is chosen on entry, so a sample belongs to the
+            // snapshot interval it was taken in
+            s1_valid <= sample_valid && !clearing;
+            s1_bank <= active;
+            s1_bucket <= bucket_of(sample_cycles);
+
+            s2_valid <= s1_valid;
+            s2_bank <= s1_bank;
+            s2_bucket <= s1_bucket;
+            fwd_valid <= s2_valid && s1_valid && {s2_bank, s2_bucket} == {s1_bank, s1_bucket};
+            fwd_entry <= s2_next;
+
+            // Bit 0: snapshot and clear
+            if (reg_we && reg_addr == CONTROL_ADDR && reg_wdata[0] && !clearing) begin
+                active <= !active;
+                rd_bank <= active;
+                if (gen_next == '0) begin
+                    gen[!active] <= GEN_W'(1);
+                    clearing <= 1'b1;
+                    clear_addr <= {!active, IDX_W'(0)};
+                    clear_last <= {!active, IDX_W'(NUM_BUCKETS - 1)};
+                end else begin
+                    gen[!active] <= gen_next;
+                end
+            end
+
+            reg_hit <= reg_re && reg_addr >= BASE_ADDR && offset < 10'(NUM_BUCKETS);
+        end
+    end
+
+    assign reg_rdata = (rd_entry.tag == gen[rd_bank]) ? rd_entry.count : 32'd0;
+
+endmodule
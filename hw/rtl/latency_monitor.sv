@@ -0,0 +1,137 @@
+// Latency Monitor Module
+// Timestamps each market data message as it enters the parser and
+// follows it through the book manager, feeding two latency histograms:
+// ingress to book update, and book update to the next order command
+// accepted by the order entry encoder.
+`timescale 1ns / 1ps
+
+module latency_monitor #(
+    parameter int NUM_BUCKETS = 32,
+    parameter logic [9:0] CONTROL_ADDR = 10'd33,
+    parameter logic [9:0] INGRESS_BASE_ADDR = 10'd128,
+    parameter logic [9:0] ORDER_BASE_ADDR = 10'd160
+)(
+    input  logic        clk,
+    input  logic        rst_n,
+
+    // Stage events
+    input  logic        ingress,        // header beat accepted by the parser
+    input  logic        parse_valid,    // parser output / book input
+    input  logic        book_updated,
+    input  logic        order_accepted, // order command accepted by the encoder
+
+    // Register bus slave
+    input  logic        reg_we,
+    input  logic        reg_re,
+    input  logic [9:0]  reg_addr,
+    input  logic [31:0] reg_wdata,
+    output logic [31:0] reg_rdata,
+    output logic        reg_hit
+);
+
+    localparam int FIFO_DEPTH = 4;  // messages in flight through the parser
+
+    logic [31:0] cycle_count;
+
+    // Parser stage timestamps, in order
+    logic [31:0] parser_ts [FIFO_DEPTH];
+    logic [1:0]  wr_ptr;
+    logic [1:0]  rd_ptr;
+
+    // Book stage: the book takes an update every other cycle at most and
+    // drops updates that arrive while it recomputes the best prices
+    logic        book_busy;
+    logic [31:0] book_ts;
+
+    // Last book update not yet followed by an order
+    logic        update_pending;
+    logic [31:0] update_ts;
+
+    logic        ingress_sample;
+    logic [31:0] ingress_cycles;
+    logic        order_sample;
+    logic [31:0] order_cycles;
+
+    logic [31:0] ingress_rdata;
+    logic        ingress_hit;
+    logic [31:0] order_rdata;
+    logic        order_hit;
+
+    assign ingress_sample = book_updated;
+    assign ingress_cycles = cycle_count - book_ts;
+    assign order_sample = order_accepted && update_pending;
+    assign order_cycles = cycle_count - update_ts;
+
+    assign reg_rdata = ingress_hit ? ingress_rdata : order_rdata;
+    assign reg_hit = ingress_hit || order_hit;
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            cycle_count <= '0;
+            wr_ptr <= '0;
+            rd_ptr <= '0;
+            book_busy <= 1'b0;
+            book_ts <= '0;
+            update_pending <= 1'b0;
+            update_ts <= '0;
+        end else begin
+            cycle_count <= cycle_count + 1;
+
+            if (ingress) begin
+                parser_ts[wr_ptr] <= cycle_count;
+                wr_ptr <= wr_ptr + 1;
+            end
+
+            book_busy <= 1'b0;
+            if (parse_valid) begin
+                rd_ptr <= rd_ptr + 1;
+                if (!book_busy) begin
+                    book_ts <= parser_ts[rd_ptr];
+                    book_busy <= 1'b1;
+                end
+            end
+
+            if (book_updated) begin
+                update_pending <= 1'b1;
+                update_ts <= cycle_count;
+            end else if (order_accepted) begin
+                update_pending <= 1'b0;
+            end
+        end
+    end
+
+    latency_histogram #(
+        .NUM_BUCKETS(NUM_BUCKETS),
+        .CONTROL_ADDR(CONTROL_ADDR),
+        .BASE_ADDR(INGRESS_BASE_ADDR)
+    ) u_ingress_hist (
+        .clk(clk),
+        .rst_n(rst_n),
+        .sample_valid(ingress_sample),
+        .sample_cycles(ingress_cycles),
+        .reg_we(reg_we),
+        .reg_re(reg_re),
+        .reg_addr(reg_addr),
+        .reg_wdata(reg_wdata),
+        .reg_rdata(ingress_rdata),
+        .reg_hit(ingress_hit)
+    );
+
+    latency_histogram #(
+        .NUM_BUCKETS(NUM_BUCKETS),
+        .CONTROL_ADDR(CONTROL_ADDR),
+        .BASE_ADDR(ORDER_BASE_ADDR)
+    ) u_order_hist (
+        .clk(clk),
+        .rst_n(rst_n),
+        .sample_valid(order_sample),
+        .sample_cycles(order_cycles),
+        .reg_we(reg_we),
+        .reg_re(reg_re),
+        .reg_addr(reg_addr),
+        .reg_wdata(reg_wdata),
+        .reg_rdata(order_rdata),
+        .reg_hit(order_hit)
+    );
+
+endmodule
@@ -19,9 +19,14 @@ module market_data_parser #(
     output logic [PRICE_WIDTH-1:0]  price,
     output logic [QUANTITY_WIDTH-1:0] quantity,
     output logic                    parse_valid,
-    output logic [1:0]             msg_type    // 00: undefined, 01: trade, 10: quote, 11: order
+    output logic [1:0]             msg_type,   // 00: undefined, 01: trade, 10: quote, 11: order
+    output logic                    is_bid
 );
 
+    // Messages arrive as four beats: header (bits [1:0] msg_type,
+    // bit 2 is_bid), symbol, price and quantity. One beat is accepted per
+    // clock, so a message occupies the parser for four cycles.
+
     // State machine states
     typedef enum logic [2:0] {
         IDLE,
@@ -47,20 +52,22 @@ module market_data_parser #(
             quantity <= '0;
             parse_valid <= 1'b0;
             msg_type <= 2'b00;
+            is_bid <= 1'b0;
+            header_type <= '0;
         end else begin
             current_state <= next_state;
+            parse_valid <= 1'b0;
+
+            // Latch the next beat whenever one is accepted
+            if (data_valid && data_ready) begin
+                data_buffer <= data_in;
+            end
             
             case (current_state)
-                IDLE: begin
-                    if (data_valid) begin
-                        data_buffer <= data_in;
-                        parse_valid <= 1'b0;
-                    end
-                end
-
                 HEADER_PARSE: begin
                     header_type <= data_buffer[2:0];
                     msg_type <= data_buffer[1:0];
+                    is_bid <= data_buffer[2];
                 end
 
                 SYMBOL_PARSE: begin
@@ -73,8 +80,10 @@ module market_data_parser #(
 
                 QUANTITY_PARSE: begin
                     quantity <= data_buffer[QUANTITY_WIDTH-1:0];
-                    parse_valid <= 1'b1;
+                    parse_valid <= ready_next;
                 end
+
+                default: ;
             endcase
         end
     end
@@ -93,21 +102,33 @@ module market_data_parser #(
             end
 
             HEADER_PARSE: begin
-                next_state = SYMBOL_PARSE;
+                if (data_valid) begin
+                    next_state = SYMBOL_PARSE;
+                end
+                data_ready = 1'b1;
             end
 
             SYMBOL_PARSE: begin
-                next_state = PRICE_PARSE;
+                if (data_valid) begin
+                    next_state = PRICE_PARSE;
+                end
+                data_ready = 1'b1;
             end
 
             PRICE_PARSE: begin
-                next_state = QUANTITY_PARSE;
+                if (data_valid) begin
+                    next_state = QUANTITY_PARSE;
+                end
+                data_ready = 1'b1;
             end
 
             QUANTITY_PARSE: begin
+                // Accept the next header in the same cycle the parsed
+                // message is handed downstream
                 if (ready_next) begin
-                    next_state = IDLE;
+                    next_state = data_valid ? HEADER_PARSE : IDLE;
                 end
+                data_ready = ready_next;
             end
 
             default: next_state = IDLE;
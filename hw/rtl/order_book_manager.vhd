@@ -27,9 +27,11 @@ entity order_book_manager is
         best_bid_qty    : out std_logic_vector(QUANTITY_WIDTH-1 downto 0);
         best_ask_qty    : out std_logic_vector(QUANTITY_WIDTH-1 downto 0);
         book_valid      : out std_logic;
+        book_updated    : out std_logic;  -- one-cycle pulse when the outputs refresh
         
         -- Status
-        book_full       : out std_logic
+        book_full       : out std_logic;
+        update_dropped  : out std_logic   -- update lost: book busy or full
     );
 end order_book_manager;
 
@@ -57,16 +59,30 @@ architecture rtl of order_book_manager is
     
 begin
     -- Main order book update process
+    -- Each update sets the quantity of one price level; a zero quantity
+    -- removes the level. The cycle after an update the best bid/ask are
+    -- recomputed from the new book contents.
     process(clk, rst_n)
         variable new_price : unsigned(PRICE_WIDTH-1 downto 0);
         variable new_qty   : unsigned(QUANTITY_WIDTH-1 downto 0);
+        variable match_idx : integer range -1 to MAX_ORDERS-1;
+        variable free_idx  : integer range -1 to MAX_ORDERS-1;
+        variable best_idx  : integer range -1 to MAX_ORDERS-1;
     begin
         if rst_n = '0' then
             -- Reset all signals
             order_count <= (others => '0');
             book_valid <= '0';
+            book_updated <= '0';
             book_full <= '0';
+            update_dropped <= '0';
             updating <= '0';
+            best_bid_idx <= 0;
+            best_ask_idx <= 0;
+            best_bid_price <= (others => '0');
+            best_ask_price <= (others => '0');
+            best_bid_qty <= (others => '0');
+            best_ask_qty <= (others => '0');
             
             -- Reset order books
             for i in 0 to MAX_ORDERS-1 loop
@@ -75,63 +91,117 @@ begin
             end loop;
             
         elsif rising_edge(clk) then
+            book_updated <= '0';
+            update_dropped <= '0';
+
             if update_valid = '1' and updating = '0' then
                 new_price := unsigned(price_in);
                 new_qty := unsigned(quantity_in);
+                match_idx := -1;
+                free_idx := -1;
                 
                 if is_bid = '1' then
                     -- Update bid book
                     for i in 0 to MAX_ORDERS-1 loop
-                        if bid_book(i).valid = '0' or bid_book(i).price = new_price then
-                            bid_book(i).price <= new_price;
-                            bid_book(i).quantity <= new_qty;
-                            bid_book(i).valid <= '1';
-                            exit;
+                        if bid_book(i).valid = '1' and bid_book(i).price = new_price then
+                            match_idx := i;
+                        elsif bid_book(i).valid = '0' and free_idx = -1 then
+                            free_idx := i;
                         end if;
                     end loop;
+
+                    if match_idx >= 0 then
+                        if new_qty = 0 then
+                            bid_book(match_idx).valid <= '0';
+                        else
+                            bid_book(match_idx).quantity <= new_qty;
+                        end if;
+                    elsif new_qty /= 0 and free_idx >= 0 then
+                        bid_book(free_idx).price <= new_price;
+                        bid_book(free_idx).quantity <= new_qty;
+                        bid_book(free_idx).valid <= '1';
+                    end if;
                 else
                     -- Update ask book
                     for i in 0 to MAX_ORDERS-1 loop
-                        if ask_book(i).valid = '0' or ask_book(i).price = new_price then
-                            ask_book(i).price <= new_price;
-                            ask_book(i).quantity <= new_qty;
-                            ask_book(i).valid <= '1';
-                            exit;
+                        if ask_book(i).valid = '1' and ask_book(i).price = new_price then
+                            match_idx := i;
+                        elsif ask_book(i).valid = '0' and free_idx = -1 then
+                            free_idx := i;
                         end if;
                     end loop;
+
+                    if match_idx >= 0 then
+                        if new_qty = 0 then
+                            ask_book(match_idx).valid <= '0';
+                        else
+                            ask_book(match_idx).quantity <= new_qty;
+                        end if;
+                    elsif new_qty /= 0 and free_idx >= 0 then
+                        ask_book(free_idx).price <= new_price;
+                        ask_book(free_idx).quantity <= new_qty;
+                        ask_book(free_idx).valid <= '1';
+                    end if;
+                end if;
+
+                -- A new level with no free slot is dropped
+                if match_idx = -1 and free_idx = -1 and new_qty /= 0 then
+                    book_full <= '1';
+                    update_dropped <= '1';
+                else
+                    book_full <= '0';
                 end if;
                 
+                order_count <= order_count + 1;
                 updating <= '1';
             else
+                -- Updates arriving while the best prices are recomputed are lost
+                update_dropped <= update_valid;
                 updating <= '0';
             end if;
             
             -- Update best bid/ask
             if updating = '1' then
                 -- Find best bid (highest price)
+                best_idx := -1;
                 for i in 0 to MAX_ORDERS-1 loop
                     if bid_book(i).valid = '1' then
-                        if i = 0 or bid_book(i).price > bid_book(best_bid_idx).price then
-                            best_bid_idx <= i;
+                        if best_idx = -1 or bid_book(i).price > bid_book(best_idx).price then
+                            best_idx := i;
                         end if;
                     end if;
                 end loop;
+
+                if best_idx >= 0 then
+                    best_bid_idx <= best_idx;
+                    best_bid_price <= std_logic_vector(bid_book(best_idx).price);
+                    best_bid_qty <= std_logic_vector(bid_book(best_idx).quantity);
+                else
+                    best_bid_price <= (others => '0');
+                    best_bid_qty <= (others => '0');
+                end if;
                 
                 -- Find best ask (lowest price)
+                best_idx := -1;
                 for i in 0 to MAX_ORDERS-1 loop
                     if ask_book(i).valid = '1' then
-                        if i = 0 or ask_book(i).price < ask_book(best_ask_idx).price then
-                            best_ask_idx <= i;
+                        if best_idx = -1 or ask_book(i).price < ask_book(best_idx).price then
+                            best_idx := i;
                         end if;
                     end if;
                 end loop;
+
+                if best_idx >= 0 then
+                    best_ask_idx <= best_idx;
+                    best_ask_price <= std_logic_vector(ask_book(best_idx).price);
+                    best_ask_qty <= std_logic_vector(ask_book(best_idx).quantity);
+                else
+                    best_ask_price <= (others => '0');
+                    best_ask_qty <= (others => '0');
+                end if;
                 
-                -- Update outputs
-                best_bid_price <= std_logic_vector(bid_book(best_bid_idx).price);
-                best_bid_qty <= std_logic_vector(bid_book(best_bid_idx).quantity);
-                best_ask_price <= std_logic_vector(ask_book(best_ask_idx).price);
-                best_ask_qty <= std_logic_vector(ask_book(best_ask_idx).quantity);
                 book_valid <= '1';
+                book_updated <= '1';
             end if;
         end if;
     end process;
@@ -0,0 +1,225 @@
+// Order Entry Encoder Module
+// Turns internal order commands into OUCH 4.2 messages framed as
+// SoupBinTCP unsequenced data packets for the exchange gateway
+`timescale 1ns / 1ps
+
+module order_entry_encoder #(
+    parameter logic [47:0] TOKEN_PREFIX  = "FPGA00",  // first 6 chars of every order token
+    parameter logic [31:0] FIRM          = "FPGA",
+    parameter logic [31:0] TIME_IN_FORCE = 32'd99998, // market hours
+    parameter logic [7:0]  DISPLAY       = "Y",
+    parameter logic [7:0]  CAPACITY      = "P",
+    parameter logic [7:0]  CROSS_TYPE    = "N",
+    parameter logic [7:0]  CUSTOMER_TYPE = "R"
+)(
+    input  logic        clk,
+    input  logic        rst_n,
+
+    // Host command port (PCIe register bank)
+    input  logic        host_cmd_valid,
+    output logic        host_cmd_ready,
+    input  logic        host_cmd_cancel,
+    input  logic        host_cmd_buy,
+    input  logic [63:0] host_cmd_symbol,    // ASCII, char 0 in bits [7:0]
+    input  logic [31:0] host_cmd_price,     // 4 implied decimals
+    input  logic [31:0] host_cmd_quantity,
+    input  logic [31:0] host_cmd_order_id,  // cancel target
+
+    // Trade engine command port (in-fabric strategies)
+    input  logic        eng_cmd_valid,
+    output logic        eng_cmd_ready,
+    input  logic        eng_cmd_cancel,
+    input  logic        eng_cmd_buy,
+    input  logic [63:0] eng_cmd_symbol,
+    input  logic [31:0] eng_cmd_price,
+    input  logic [31:0] eng_cmd_quantity,
+    input  logic [31:0] eng_cmd_order_id,
+
+    // Order token sequence
+    input  logic        seq_load,
+    input  logic [31:0] seq_value,
+    output logic [31:0] next_order_id,
+    output logic [31:0] last_order_id,      // id assigned to the last accepted command
+    output logic        last_order_host,    // last accepted command came from the host port
+
+    // Outbound byte stream (byte 0 in tx_data[7:0])
+    output logic [63:0] tx_data,
+    output logic [7:0]  tx_keep,
+    output logic        tx_valid,
+    output logic        tx_last,
+    input  logic        tx_ready,
+    output logic [63:0] tx_msg_count
+);
+
+    localparam int ENTER_LEN  = 49;             // OUCH 4.2 Enter Order
+    localparam int CANCEL_LEN = 19;             // OUCH 4.2 Cancel Order
+    localparam int FRAME_HDR  = 3;              // SoupBinTCP length (2) + 'U'
+    localparam int MAX_BEATS  = 7;
+
+    typedef enum logic [0:0] {
+        IDLE,
+        SEND
+    } encode_state_t;
+
+    encode_state_t state;
+
+    logic [8*8*MAX_BEATS-1:0] frame;
+    logic [2:0] beat;
+    logic [2:0] last_beat;
+    logic [7:0] last_keep;
+    logic       grant_eng;
+    logic       prefer_host;
+
+    // Selected command
+    logic        sel_cancel;
+    logic        sel_buy;
+    logic [63:0] sel_symbol;
+    logic [31:0] sel_price;
+    logic [31:0] sel_quantity;
+    logic [31:0] sel_order_id;
+
+    function automatic logic [7:0] hex_ascii(input logic [3:0] nibble);
+        return (nibble < 4'd10) ? (8'h30 + nibble) : (8'h37 + nibble);
+    endfunction
+
+    // Write a 14-byte order token starting at byte offset 'pos'
+    function automatic logic [8*8*MAX_BEATS-1:0] put_token(
+        input logic [8*8*MAX_BEATS-1:0] buf_in,
+        input int pos,
+        input logic [31:0] id
+    );
+        logic [8*8*MAX_BEATS-1:0] b;
+        b = buf_in;
+        for (int i = 0; i < 6; i++)
+            b[8*(pos+i) +: 8] = TOKEN_PREFIX[8*(5-i) +: 8];
+        for (int i = 0; i < 8; i++)
+            b[8*(pos+6+i) +: 8] = hex_ascii(id[4*(7-i) +: 4]);
+        return b;
+    endfunction
+
+    // Write a big-endian 32-bit field starting at byte offset 'pos'
+    function automatic logic [8*8*MAX_BEATS-1:0] put_u32(
+        input logic [8*8*MAX_BEATS-1:0] buf_in,
+        input int pos,
+        input logic [31:0] value
+    );
+        logic [8*8*MAX_BEATS-1:0] b;
+        b = buf_in;
+        for (int i = 0; i < 4; i++)
+            b[8*(pos+i) +: 8] = value[8*(3-i) +: 8];
+        return b;
+    endfunction
+
+    // Arbitration: round-robin between the host and trade engine ports
+    always_comb begin
+        grant_eng = eng_cmd_valid && (!host_cmd_valid || !prefer_host);
+        host_cmd_ready = (state == IDLE) && !grant_eng;
+        eng_cmd_ready = (state == IDLE) && grant_eng;
+
+        if (grant_eng) begin
+            sel_cancel   = eng_cmd_cancel;
+            sel_buy      = eng_cmd_buy;
+            sel_symbol   = eng_cmd_symbol;
+            sel_price    = eng_cmd_price;
+            sel_quantity = eng_cmd_quantity;
+            sel_order_id = eng_cmd_order_id;
+        end else begin
+            sel_cancel   = host_cmd_cancel;
+            sel_buy      = host_cmd_buy;
+            sel_symbol   = host_cmd_symbol;
+            sel_price    = host_cmd_price;
+            sel_quantity = host_cmd_quantity;
+            sel_order_id = host_cmd_order_id;
+        end
+    end
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state <= IDLE;
+            frame <= '0;
+            beat <= '0;
+            last_beat <= '0;
+            last_keep <= '0;
+            prefer_host <= 1'b1;
+            next_order_id <= 32'd1;
+            last_order_id <= '0;
+            last_order_host <= 1'b0;
+            tx_msg_count <= '0;
+        end else begin
+            if (seq_load) begin
+                next_order_id <= seq_value;
+            end
+
+            case (state)
+                IDLE: begin
+                    if (grant_eng || host_cmd_valid) begin
+                        logic [8*8*MAX_BEATS-1:0] f;
+                        logic [31:0] id;
+
+                        f = '0;
+                        id = sel_cancel ? sel_order_id : next_order_id;
+
+                        if (sel_cancel) begin
+                            f[7:0]   = 8'h00;
+                            f[15:8]  = 8'(CANCEL_LEN + 1);
+                            f[23:16] = "U";
+                            f[31:24] = "X";
+                            f = put_token(f, 4, id);
+                            f = put_u32(f, 18, 32'd0);      // cancel all remaining shares
+                            last_beat <= 3'd2;
+                            last_keep <= 8'h3F;             // 22 bytes
+                        end else begin
+                            f[7:0]   = 8'h00;
+                            f[15:8]  = 8'(ENTER_LEN + 1);
+                            f[23:16] = "U";
+                            f[31:24] = "O";
+                            f = put_token(f, 4, id);
+                            f[8*18 +: 8] = sel_buy ? "B" : "S";
+                            f = put_u32(f, 19, sel_quantity);
+                            for (int i = 0; i < 8; i++)
+                                f[8*(23+i) +: 8] = sel_symbol[8*i +: 8];
+                            f = put_u32(f, 31, sel_price);
+                            f = put_u32(f, 35, TIME_IN_FORCE);
+                            f = put_u32(f, 39, FIRM);
+                            f[8*43 +: 8] = DISPLAY;
+                            f[8*44 +: 8] = CAPACITY;
+                            f[8*45 +: 8] = "N";             // intermarket sweep
+                            f = put_u32(f, 46, 32'd0);      // minimum quantity
+                            f[8*50 +: 8] = CROSS_TYPE;
+                            f[8*51 +: 8] = CUSTOMER_TYPE;
+                            last_beat <= 3'd6;
+                            last_keep <= 8'h0F;             // 52 bytes
+                            next_order_id <= next_order_id + 1;
+                        end
+
+                        frame <= f;
+                        beat <= '0;
+                        last_order_id <= id;
+                        last_order_host <= !grant_eng;
+                        prefer_host <= grant_eng;
+                        state <= SEND;
+                    end
+                end
+
+                SEND: begin
+                    if (tx_ready) begin
+                        if (beat == last_beat) begin
+                            tx_msg_count <= tx_msg_count + 1;
+                            state <= IDLE;
+                        end
+                        beat <= beat + 1;
+                    end
+                end
+            endcase
+        end
+    end
+
+    // Output stream
+    always_comb begin
+        tx_valid = (state == SEND);
+        tx_data = frame[64*beat +: 64];
+        tx_last = (state == SEND) && (beat == last_beat);
+        tx_keep = tx_last ? last_keep : 8'hFF;
+    end
+
+endmodule
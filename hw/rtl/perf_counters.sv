@@ -0,0 +1,67 @@
+// Performance Counters Module
+// Free-running 64-bit event counters with a shadow copy. A write to the
+// control register latches every counter into the shadow bank in the
+// same cycle; the host then burst-reads the shadow words while the live
+// counters keep running.
+`timescale 1ns / 1ps
+
+module perf_counters #(
+    parameter int NUM_COUNTERS = 11,
+    parameter logic [9:0] CONTROL_ADDR = 10'd32,
+    parameter logic [9:0] BASE_ADDR = 10'd64  // counter i: BASE + 2i (low), BASE + 2i + 1 (high)
+)(
+    input  logic                    clk,
+    input  logic                    rst_n,
+
+    // Event strobes, one per counter
+    input  logic [NUM_COUNTERS-1:0] events,
+
+    // Register bus slave
+    input  logic                    reg_we,
+    input  logic                    reg_re,
+    input  logic [9:0]              reg_addr,
+    input  logic [31:0]             reg_wdata,
+    output logic [31:0]             reg_rdata,
+    output logic                    reg_hit     // reg_rdata belongs to this block
+);
+
+    logic [63:0] counters [NUM_COUNTERS];
+    logic [63:0] shadow [NUM_COUNTERS];
+    logic [9:0]  offset;
+
+    assign offset = reg_addr - BASE_ADDR;
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            for (int i = 0; i < NUM_COUNTERS; i++) begin
+                counters[i] <= '0;
+                shadow[i] <= '0;
+            end
+            reg_rdata <= '0;
+            reg_hit <= 1'b0;
+        end else begin
+            for (int i = 0; i < NUM_COUNTERS; i++) begin
+                counters[i] <= counters[i] + 64'(events[i]);
+            end
+
+            // Bit 0: snapshot
+            if (reg_we && reg_addr == CONTROL_ADDR && reg_wdata[0]) begin
+                for (int i = 0; i < NUM_COUNTERS; i++) begin
+                    shadow[i] <= counters[i];
+                end
+            end
+
+            reg_hit <= 1'b0;
+            if (reg_re) begin
+                if (reg_addr >= BASE_ADDR && offset < 10'(2 * NUM_COUNTERS)) begin
+                    reg_rdata <= offset[0] ? shadow[offset[9:1]][63:32] : shadow[offset[9:1]][31:0];
+                    reg_hit <= 1'b1;
+                end else if (reg_addr == CONTROL_ADDR) begin
+                    reg_rdata <= 32'(NUM_COUNTERS);
+                    reg_hit <= 1'b1;
+                end
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,234 @@
+// Trading Accelerator Top Level
+// Host register bank -> market data parser -> order book manager, plus
+// the order entry encoder driven from the host and trade engine ports
+// and per-stage performance counters and latency histograms
+`timescale 1ns / 1ps
+
+module trading_top #(
+    parameter int CLK_PERIOD_NS = 4,
+    parameter int MAX_ORDERS = 1024
+)(
+    input  logic        clk,
+    input  logic        rst_n,
+
+    // PCIe BAR0 register bus
+    input  logic        reg_we,
+    input  logic        reg_re,
+    input  logic [9:0]  reg_addr,
+    input  logic [31:0] reg_wdata,
+    output logic [31:0] reg_rdata,
+
+    // Trade engine order commands
+    input  logic        eng_cmd_valid,
+    output logic        eng_cmd_ready,
+    input  logic        eng_cmd_cancel,
+    input  logic        eng_cmd_buy,
+    input  logic [63:0] eng_cmd_symbol,
+    input  logic [31:0] eng_cmd_price,
+    input  logic [31:0] eng_cmd_quantity,
+    input  logic [31:0] eng_cmd_order_id,
+
+    // Exchange gateway stream
+    output logic [63:0] tx_data,
+    output logic [7:0]  tx_keep,
+    output logic        tx_valid,
+    output logic        tx_last,
+    input  logic        tx_ready
+);
+
+    // Parser interface
+    logic        md_valid;
+    logic [63:0] md_data;
+    logic        md_first;
+    logic        md_ready;
+    logic [31:0] parsed_symbol;
+    logic [31:0] parsed_price;
+    logic [31:0] parsed_quantity;
+    logic        parse_valid;
+    logic [1:0]  parsed_msg_type;
+    logic        parsed_is_bid;
+
+    // Book outputs
+    logic [31:0] best_bid_price;
+    logic [31:0] best_ask_price;
+    logic [31:0] best_bid_qty;
+    logic [31:0] best_ask_qty;
+    logic        book_valid;
+    logic        book_updated;
+    logic        book_full;
+    logic        update_dropped;
+
+    // Encoder host port
+    logic        host_cmd_valid;
+    logic        host_cmd_ready;
+    logic        host_cmd_cancel;
+    logic        host_cmd_buy;
+    logic [63:0] host_cmd_symbol;
+    logic [31:0] host_cmd_price;
+    logic [31:0] host_cmd_quantity;
+    logic [31:0] host_cmd_order_id;
+    logic        seq_load;
+    logic [31:0] seq_value;
+    logic [31:0] next_order_id;
+    logic [31:0] last_order_id;
+    logic        last_order_host;
+    logic [63:0] tx_msg_count;
+
+    // Register read data
+    logic [31:0] bank_rdata;
+    logic [31:0] perf_rdata;
+    logic        perf_hit;
+    logic [31:0] lat_rdata;
+    logic        lat_hit;
+
+    // Performance counter events (see sw/api/register_map.hpp PERF_*)
+    localparam int NUM_PERF_COUNTERS = 11;
+    logic [NUM_PERF_COUNTERS-1:0] perf_events;
+
+    assign perf_events[0]  = md_valid && md_ready && md_first;             // parser in
+    assign perf_events[1]  = parse_valid;                                  // parser out
+    assign perf_events[2]  = parse_valid;                                  // book in
+    assign perf_events[3]  = book_updated;                                 // book out
+    assign perf_events[4]  = (host_cmd_valid && host_cmd_ready) ||
+                             (eng_cmd_valid && eng_cmd_ready);             // trade engine in
+    assign perf_events[5]  = tx_valid && tx_ready && tx_last;              // trade engine out
+    assign perf_events[6]  = md_valid && !md_ready;                        // parser stall
+    assign perf_events[7]  = (host_cmd_valid && !host_cmd_ready) ||
+                             (eng_cmd_valid && !eng_cmd_ready);            // order command stall
+    assign perf_events[8]  = tx_valid && !tx_ready;                        // gateway backpressure
+    assign perf_events[9]  = update_dropped;                               // dropped updates
+    assign perf_events[10] = 1'b1;                                         // cycles
+
+    assign reg_rdata = perf_hit ? perf_rdata :
+                       lat_hit  ? lat_rdata  : bank_rdata;
+
+    host_register_bank #(
+        .CLK_PERIOD_NS(CLK_PERIOD_NS)
+    ) u_regs (
+        .clk(clk),
+        .rst_n(rst_n),
+        .reg_we(reg_we),
+        .reg_re(reg_re),
+        .reg_addr(reg_addr),
+        .reg_wdata(reg_wdata),
+        .reg_rdata(bank_rdata),
+        .md_valid(md_valid),
+        .md_data(md_data),
+        .md_first(md_first),
+        .md_ready(md_ready),
+        .best_bid_price(best_bid_price),
+        .best_ask_price(best_ask_price),
+        .best_bid_qty(best_bid_qty),
+        .best_ask_qty(best_ask_qty),
+        .book_updated(book_updated),
+        .host_cmd_valid(host_cmd_valid),
+        .host_cmd_ready(host_cmd_ready),
+        .host_cmd_cancel(host_cmd_cancel),
+        .host_cmd_buy(host_cmd_buy),
+        .host_cmd_symbol(host_cmd_symbol),
+        .host_cmd_price(host_cmd_price),
+        .host_cmd_quantity(host_cmd_quantity),
+        .host_cmd_order_id(host_cmd_order_id),
+        .seq_load(seq_load),
+        .seq_value(seq_value),
+        .next_order_id(next_order_id),
+        .last_order_id(last_order_id)
+    );
+
+    market_data_parser u_parser (
+        .clk(clk),
+        .rst_n(rst_n),
+        .data_valid(md_valid),
+        .data_in(md_data),
+        .ready_next(1'b1),
+        .data_ready(md_ready),
+        .symbol(parsed_symbol),
+        .price(parsed_price),
+        .quantity(parsed_quantity),
+        .parse_valid(parse_valid),
+        .msg_type(parsed_msg_type),
+        .is_bid(parsed_is_bid)
+    );
+
+    order_book_manager #(
+        .MAX_ORDERS(MAX_ORDERS)
+    ) u_book (
+        .clk(clk),
+        .rst_n(rst_n),
+        .symbol_in(parsed_symbol),
+        .price_in(parsed_price),
+        .quantity_in(parsed_quantity),
+        .is_bid(parsed_is_bid),
+        .update_valid(parse_valid),
+        .best_bid_price(best_bid_price),
+        .best_ask_price(best_ask_price),
+        .best_bid_qty(best_bid_qty),
+        .best_ask_qty(best_ask_qty),
+        .book_valid(book_valid),
+        .book_updated(book_updated),
+        .book_full(book_full),
+        .update_dropped(update_dropped)
+    );
+
+    order_entry_encoder u_encoder (
+        .clk(clk),
+        .rst_n(rst_n),
+        .host_cmd_valid(host_cmd_valid),
+        .host_cmd_ready(host_cmd_ready),
+        .host_cmd_cancel(host_cmd_cancel),
+        .host_cmd_buy(host_cmd_buy),
+        .host_cmd_symbol(host_cmd_symbol),
+        .host_cmd_price(host_cmd_price),
+        .host_cmd_quantity(host_cmd_quantity),
+        .host_cmd_order_id(host_cmd_order_id),
+        .eng_cmd_valid(eng_cmd_valid),
+        .eng_cmd_ready(eng_cmd_ready),
+        .eng_cmd_cancel(eng_cmd_cancel),
+        .eng_cmd_buy(eng_cmd_buy),
+        .eng_cmd_symbol(eng_cmd_symbol),
+        .eng_cmd_price(eng_cmd_price),
+        .eng_cmd_quantity(eng_cmd_quantity),
+        .eng_cmd_order_id(eng_cmd_order_id),
+        .seq_load(seq_load),
+        .seq_value(seq_value),
+        .next_order_id(next_order_id),
+        .last_order_id(last_order_id),
+        .last_order_host(last_order_host),
+        .tx_data(tx_data),
+        .tx_keep(tx_keep),
+        .tx_valid(tx_valid),
+        .tx_last(tx_last),
+        .tx_ready(tx_ready),
+        .tx_msg_count(tx_msg_count)
+    );
+
+    perf_counters #(
+        .NUM_COUNTERS(NUM_PERF_COUNTERS)
+    ) u_perf (
+        .clk(clk),
+        .rst_n(rst_n),
+        .events(perf_events),
+        .reg_we(reg_we),
+        .reg_re(reg_re),
+        .reg_addr(reg_addr),
+        .reg_wdata(reg_wdata),
+        .reg_rdata(perf_rdata),
+        .reg_hit(perf_hit)
+    );
+
+    latency_monitor u_latency (
+        .clk(clk),
+        .rst_n(rst_n),
+        .ingress(perf_events[0]),
+        .parse_valid(parse_valid),
+        .book_updated(book_updated),
+        .order_accepted(perf_events[4]),
+        .reg_we(reg_we),
+        .reg_re(reg_re),
+        .reg_addr(reg_addr),
+        .reg_wdata(reg_wdata),
+        .reg_rdata(lat_rdata),
+        .reg_hit(lat_hit)
+    );
+
+endmodule
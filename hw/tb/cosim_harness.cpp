@@ -0,0 +1,549 @@
+// Co-simulation harness for the RTL modules
+//
+// Drives market_data_parser -> order_book_manager and order_entry_encoder
+// with randomized or pcap-derived stimulus, checks every transaction
+// against the C++ reference models and reports messages per clock and
+// latency in cycles.
+//
+// The SystemVerilog modules run through Verilator when the harness is
+// built with -DENABLE_VERILATOR=ON (select with --verilator); otherwise,
+// and always for the VHDL book manager, the cycle-accurate C++
+// translations in sw/sim are used.
+
+#include "itch_decoder.hpp"
+#include "market_data_parser_model.hpp"
+#include "order_book_manager_model.hpp"
+#include "order_entry_encoder_model.hpp"
+#include "ouch_encoder.hpp"
+#include "pcap_reader.hpp"
+#include "reference_models.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_VERILATOR
+#include "Vmarket_data_parser.h"
+#include "Vorder_entry_encoder.h"
+#include "verilated.h"
+#endif
+
+using trading::sim::BookReference;
+using trading::sim::ParsedMessage;
+using trading::sim::ParserBeats;
+using trading::sim::TopOfBook;
+
+namespace {
+
+struct Options {
+    size_t messages = 100000;
+    size_t orders = 20000;
+    uint64_t seed = 1;
+    std::string pcap_path;
+    std::string write_pcap_path;
+    int valid_pct = 100;
+    int stall_pct = 0;
+    int tx_ready_pct = 100;
+    double clock_mhz = 250.0;
+    bool verilator = false;
+};
+
+constexpr int MAX_REPORTED_MISMATCHES = 5;
+constexpr uint64_t CYCLE_LIMIT_FACTOR = 64;
+
+#ifdef HAVE_VERILATOR
+// Give Verilator models the same eval()/tick() interface as the C++ models
+template <typename Model>
+struct VerilatedDut : Model {
+    VerilatedDut() {
+        this->clk = 0;
+        this->eval();
+    }
+
+    void tick() {
+        this->clk = 1;
+        this->eval();
+        this->clk = 0;
+        this->eval();
+    }
+};
+#endif
+
+template <typename Dut>
+void reset(Dut& dut) {
+    dut.rst_n = 0;
+    dut.eval();
+    dut.tick();
+    dut.tick();
+    dut.rst_n = 1;
+    dut.eval();
+}
+
+uint32_t pack_symbol4(const char* s) {
+    uint32_t v = 0;
+    std::memcpy(&v, s, 4);
+    return v;
+}
+
+std::vector<ParsedMessage> random_stimulus(const Options& opt) {
+    static const char* symbols[] = {"AAPL", "MSFT", "GOOG", "AMZN", "NVDA", "META", "TSLA", "INTC"};
+    std::mt19937_64 rng(opt.seed);
+    std::vector<ParsedMessage> out;
+    out.reserve(opt.messages);
+
+    // Random walk around 100.000000 in one-cent steps, 6-decimal fixed point
+    int64_t bid = 100000000 - 10000;
+    int64_t ask = 100000000 + 10000;
+    for (size_t i = 0; i < opt.messages; ++i) {
+        bool is_bid = rng() & 1;
+        int64_t& ref = is_bid ? bid : ask;
+        ref += (static_cast<int64_t>(rng() % 5) - 2) * 10000;
+        ref = std::max<int64_t>(ref, 10000);
+        int64_t offset = static_cast<int64_t>(rng() % 8) * 10000;
+        uint32_t price = static_cast<uint32_t>(is_bid ? std::max<int64_t>(ref - offset, 10000) : ref + offset);
+        uint32_t quantity = (rng() % 10) == 0 ? 0 : 1 + static_cast<uint32_t>(rng() % 1000);
+        out.push_back(ParsedMessage{2, is_bid, pack_symbol4(symbols[rng() % 8]), price, quantity});
+    }
+    return out;
+}
+
+bool pcap_stimulus(const Options& opt, std::vector<ParsedMessage>& out) {
+    trading::feed::PcapReader reader;
+    if (!reader.open(opt.pcap_path)) {
+        return false;
+    }
+
+    trading::feed::UdpDatagram datagram;
+    while (reader.next(datagram) && out.size() < opt.messages) {
+        trading::feed::moldudp64::for_each_message(
+            datagram.payload, datagram.length,
+            [&](uint64_t, const uint8_t* msg, size_t len) {
+                trading::feed::itch::AddOrder add;
+                if (!trading::feed::itch::parse_add_order(msg, len, add)) {
+                    return;
+                }
+                // ITCH prices carry 4 decimals, the parser datapath 6
+                uint64_t price = static_cast<uint64_t>(add.price) * 100;
+                if (price > UINT32_MAX) {
+                    return;
+                }
+                out.push_back(ParsedMessage{3, add.is_buy, static_cast<uint32_t>(add.stock),
+                                            static_cast<uint32_t>(price), add.shares});
+            });
+    }
+    return true;
+}
+
+bool write_pcap(const std::string& path, const std::vector<ParsedMessage>& messages) {
+    trading::feed::PcapWriter writer;
+    if (!writer.open(path)) {
+        return false;
+    }
+
+    const uint8_t session[trading::feed::moldudp64::SESSION_LEN] = {'C', 'O', 'S', 'I', 'M', ' ', ' ', ' ', ' ', ' '};
+    uint8_t packet[1400];
+    trading::feed::moldudp64::PacketBuilder builder(packet, sizeof(packet));
+    uint64_t sequence = 1;
+    uint64_t timestamp = 0;
+
+    for (size_t i = 0; i < messages.size(); ++i) {
+        if (builder.count() == 0) {
+            builder.begin(session, sequence);
+        }
+
+        trading::feed::itch::AddOrder add{};
+        add.timestamp_ns = timestamp;
+        add.order_ref = i + 1;
+        add.is_buy = messages[i].is_bid;
+        add.shares = messages[i].quantity;
+        add.stock = 0x2020202000000000ull | messages[i].symbol;
+        add.price = messages[i].price / 100;
+
+        uint8_t msg[trading::feed::itch::ADD_ORDER_LEN];
+        trading::feed::itch::encode_add_order(add, msg);
+        builder.append(msg, sizeof(msg));
+        timestamp += 100;
+
+        if (builder.count() == 32 || i + 1 == messages.size()) {
+            if (!writer.write_udp(timestamp, 0xe9363701, 26477, builder.data(), builder.length())) {
+                return false;
+            }
+            sequence += builder.count();
+            builder.begin(session, sequence);
+        }
+    }
+    return true;
+}
+
+struct PipelineResult {
+    uint64_t messages = 0;
+    uint64_t cycles = 0;
+    uint64_t parser_mismatches = 0;
+    uint64_t book_mismatches = 0;
+    uint64_t latency_min = UINT64_MAX;
+    uint64_t latency_max = 0;
+    uint64_t latency_sum = 0;
+    bool timed_out = false;
+};
+
+template <typename ParserDut>
+PipelineResult run_pipeline(ParserDut& parser, const std::vector<ParsedMessage>& stimulus,
+                            const Options& opt) {
+    trading::sim::OrderBookManagerModel book;
+    BookReference reference;
+    std::mt19937 rng(static_cast<uint32_t>(opt.seed) ^ 0x5eed);
+    PipelineResult result;
+
+    std::vector<ParserBeats> beats;
+    beats.reserve(stimulus.size());
+    for (const ParsedMessage& msg : stimulus) {
+        beats.push_back(trading::sim::make_parser_beats(msg));
+    }
+
+    reset(parser);
+    reset(book);
+
+    struct InFlight {
+        size_t index;
+        uint64_t start_cycle;
+        TopOfBook expected;
+    };
+    std::deque<InFlight> parsing;
+    std::deque<InFlight> updating;
+
+    size_t next_msg = 0;
+    size_t beat = 0;
+    uint64_t cycle = 0;
+    uint64_t first_cycle = 0;
+    const uint64_t cycle_limit = CYCLE_LIMIT_FACTOR * (stimulus.size() + 16);
+
+    while (next_msg < stimulus.size() || !parsing.empty() || !updating.empty()) {
+        if (cycle > cycle_limit) {
+            result.timed_out = true;
+            break;
+        }
+
+        parser.data_valid = next_msg < stimulus.size() &&
+                            static_cast<int>(rng() % 100) < opt.valid_pct;
+        parser.data_in = next_msg < stimulus.size() ? beats[next_msg].beat[beat] : 0;
+        parser.ready_next = static_cast<int>(rng() % 100) >= opt.stall_pct;
+        parser.eval();
+        const bool accepted = parser.data_valid && parser.data_ready;
+
+        // Parser outputs are registered and wired straight into the book
+        book.update_valid = parser.parse_valid;
+        book.symbol_in = parser.symbol;
+        book.price_in = parser.price;
+        book.quantity_in = parser.quantity;
+        book.is_bid = parser.is_bid;
+        book.eval();
+
+        parser.tick();
+        book.tick();
+
+        if (accepted) {
+            if (beat == 0) {
+                if (parsing.empty() && updating.empty() && result.messages == 0) {
+                    first_cycle = cycle;
+                }
+                parsing.push_back(InFlight{next_msg, cycle, TopOfBook{}});
+            }
+            if (++beat == 4) {
+                beat = 0;
+                ++next_msg;
+            }
+        }
+        ++cycle;
+
+        if (parser.parse_valid && !parsing.empty()) {
+            InFlight msg = parsing.front();
+            parsing.pop_front();
+            const ParsedMessage& expected = stimulus[msg.index];
+            ParsedMessage actual{static_cast<uint8_t>(parser.msg_type), static_cast<bool>(parser.is_bid),
+                                 static_cast<uint32_t>(parser.symbol), static_cast<uint32_t>(parser.price),
+                                 static_cast<uint32_t>(parser.quantity)};
+            if (actual != expected) {
+                if (result.parser_mismatches++ < MAX_REPORTED_MISMATCHES) {
+                    std::cerr << "parser mismatch at message " << msg.index << ": price "
+                              << actual.price << " vs " << expected.price << ", qty "
+                              << actual.quantity << " vs " << expected.quantity << std::endl;
+                }
+            }
+            reference.apply(expected.price, expected.quantity, expected.is_bid);
+            msg.expected = reference.top();
+            updating.push_back(msg);
+        }
+
+        if (book.book_updated && !updating.empty()) {
+            InFlight msg = updating.front();
+            updating.pop_front();
+
+            TopOfBook actual{book.best_bid_price, book.best_bid_qty,
+                             book.best_ask_price, book.best_ask_qty};
+            if (actual != msg.expected) {
+                if (result.book_mismatches++ < MAX_REPORTED_MISMATCHES) {
+                    const TopOfBook& expected = msg.expected;
+                    std::cerr << "book mismatch at message " << msg.index << ": bid "
+                                  << actual.best_bid_price << "x" << actual.best_bid_qty << " vs "
+                                  << expected.best_bid_price << "x" << expected.best_bid_qty
+                                  << ", ask " << actual.best_ask_price << "x" << actual.best_ask_qty
+                                  << " vs " << expected.best_ask_price << "x" << expected.best_ask_qty
+                              << std::endl;
+                }
+            }
+
+            uint64_t latency = cycle - msg.start_cycle;
+            result.latency_min = std::min(result.latency_min, latency);
+            result.latency_max = std::max(result.latency_max, latency);
+            result.latency_sum += latency;
+            ++result.messages;
+        }
+    }
+
+    result.cycles = cycle - first_cycle;
+    return result;
+}
+
+struct EncoderResult {
+    uint64_t orders = 0;
+    uint64_t cycles = 0;
+    uint64_t byte_mismatches = 0;
+    bool timed_out = false;
+};
+
+template <typename EncoderDut>
+EncoderResult run_encoder(EncoderDut& encoder, const Options& opt) {
+    std::mt19937_64 rng(opt.seed * 31 + 7);
+    trading::OuchEncoder reference;
+    EncoderResult result;
+
+    std::vector<trading::OrderCommand> commands(opt.orders);
+    for (trading::OrderCommand& cmd : commands) {
+        cmd.cancel = (rng() % 4) == 0;
+        cmd.is_buy = rng() & 1;
+        cmd.symbol = trading::ouch::pack_stock((rng() & 1) ? "AAPL" : "MSFT");
+        cmd.price = 1000000 + static_cast<uint32_t>(rng() % 10000);
+        cmd.quantity = 1 + static_cast<uint32_t>(rng() % 1000);
+        cmd.order_id = 1 + static_cast<uint32_t>(rng() % 1000);
+    }
+
+    reset(encoder);
+
+    // Alternate the command stream between the host and trade engine ports
+    size_t next_host = 0;
+    size_t next_eng = 1;
+    std::deque<std::vector<uint8_t>> expected;
+    std::vector<uint8_t> frame;
+    uint64_t cycle = 0;
+    const uint64_t cycle_limit = CYCLE_LIMIT_FACTOR * (commands.size() + 16);
+
+    auto drive = [&](bool& valid, bool& cancel, bool& buy, auto& symbol, auto& price,
+                     auto& quantity, auto& order_id, size_t index) {
+        valid = index < commands.size();
+        if (valid) {
+            const trading::OrderCommand& cmd = commands[index];
+            cancel = cmd.cancel;
+            buy = cmd.is_buy;
+            symbol = cmd.symbol;
+            price = cmd.price;
+            quantity = cmd.quantity;
+            order_id = cmd.order_id;
+        }
+    };
+
+    while (result.orders < commands.size()) {
+        if (cycle > cycle_limit) {
+            result.timed_out = true;
+            break;
+        }
+
+        bool host_valid = false, host_cancel = false, host_buy = false;
+        bool eng_valid = false, eng_cancel = false, eng_buy = false;
+        uint64_t host_symbol = 0, eng_symbol = 0;
+        uint32_t host_price = 0, host_qty = 0, host_id = 0;
+        uint32_t eng_price = 0, eng_qty = 0, eng_id = 0;
+        drive(host_valid, host_cancel, host_buy, host_symbol, host_price, host_qty, host_id, next_host);
+        drive(eng_valid, eng_cancel, eng_buy, eng_symbol, eng_price, eng_qty, eng_id, next_eng);
+
+        encoder.host_cmd_valid = host_valid;
+        encoder.host_cmd_cancel = host_cancel;
+        encoder.host_cmd_buy = host_buy;
+        encoder.host_cmd_symbol = host_symbol;
+        encoder.host_cmd_price = host_price;
+        encoder.host_cmd_quantity = host_qty;
+        encoder.host_cmd_order_id = host_id;
+        encoder.eng_cmd_valid = eng_valid;
+        encoder.eng_cmd_cancel = eng_cancel;
+        encoder.eng_cmd_buy = eng_buy;
+        encoder.eng_cmd_symbol = eng_symbol;
+        encoder.eng_cmd_price = eng_price;
+        encoder.eng_cmd_quantity = eng_qty;
+        encoder.eng_cmd_order_id = eng_id;
+        encoder.seq_load = 0;
+        encoder.tx_ready = static_cast<int>(rng() % 100) < opt.tx_ready_pct;
+        encoder.eval();
+
+        size_t accepted = commands.size();
+        if (encoder.host_cmd_valid && encoder.host_cmd_ready) {
+            accepted = next_host;
+            next_host += 2;
+        } else if (encoder.eng_cmd_valid && encoder.eng_cmd_ready) {
+            accepted = next_eng;
+            next_eng += 2;
+        }
+        if (accepted < commands.size()) {
+            uint8_t bytes[trading::ouch::MAX_FRAME_LEN];
+            size_t len = reference.encode(commands[accepted], bytes);
+            expected.emplace_back(bytes, bytes + len);
+        }
+
+        if (encoder.tx_valid && encoder.tx_ready) {
+            uint64_t data = encoder.tx_data;
+            for (int i = 0; i < 8; ++i) {
+                if ((encoder.tx_keep >> i) & 1) {
+                    frame.push_back(static_cast<uint8_t>(data >> (8 * i)));
+                }
+            }
+            if (encoder.tx_last) {
+                if (expected.empty() || frame != expected.front()) {
+                    if (result.byte_mismatches++ < MAX_REPORTED_MISMATCHES) {
+                        std::cerr << "encoder mismatch at order " << result.orders << std::endl;
+                    }
+                }
+                if (!expected.empty()) {
+                    expected.pop_front();
+                }
+                frame.clear();
+                ++result.orders;
+            }
+        }
+
+        encoder.tick();
+        ++cycle;
+    }
+
+    result.cycles = cycle;
+    return result;
+}
+
+bool parse_options(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            return i + 1 < argc ? argv[++i] : "";
+        };
+        if (arg == "--messages") {
+            opt.messages = std::strtoull(value(), nullptr, 10);
+        } else if (arg == "--orders") {
+            opt.orders = std::strtoull(value(), nullptr, 10);
+        } else if (arg == "--seed") {
+            opt.seed = std::strtoull(value(), nullptr, 10);
+        } else if (arg == "--pcap") {
+            opt.pcap_path = value();
+        } else if (arg == "--write-pcap") {
+            opt.write_pcap_path = value();
+        } else if (arg == "--valid-pct") {
+            opt.valid_pct = std::atoi(value());
+        } else if (arg == "--stall-pct") {
+            opt.stall_pct = std::atoi(value());
+        } else if (arg == "--tx-ready-pct") {
+            opt.tx_ready_pct = std::atoi(value());
+        } else if (arg == "--clock-mhz") {
+            opt.clock_mhz = std::atof(value());
+        } else if (arg == "--verilator") {
+            opt.verilator = true;
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--messages N] [--orders N] [--seed S] [--pcap FILE]"
+                         " [--write-pcap FILE] [--valid-pct P] [--stall-pct P]"
+                         " [--tx-ready-pct P] [--clock-mhz F] [--verilator]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        return 2;
+    }
+
+#ifndef HAVE_VERILATOR
+    if (opt.verilator) {
+        std::cerr << "Built without Verilator; reconfigure with -DENABLE_VERILATOR=ON" << std::endl;
+        return 2;
+    }
+#else
+    Verilated::commandArgs(argc, argv);
+#endif
+
+    std::vector<ParsedMessage> stimulus;
+    if (!opt.pcap_path.empty()) {
+        if (!pcap_stimulus(opt, stimulus)) {
+            return 1;
+        }
+    } else {
+        stimulus = random_stimulus(opt);
+    }
+
+    if (!opt.write_pcap_path.empty() && !write_pcap(opt.write_pcap_path, stimulus)) {
+        return 1;
+    }
+
+    PipelineResult pipeline;
+    EncoderResult encoder_result;
+#ifdef HAVE_VERILATOR
+    if (opt.verilator) {
+        VerilatedDut<Vmarket_data_parser> parser;
+        VerilatedDut<Vorder_entry_encoder> encoder;
+        pipeline = run_pipeline(parser, stimulus, opt);
+        encoder_result = run_encoder(encoder, opt);
+    } else
+#endif
+    {
+        trading::sim::MarketDataParserModel parser;
+        trading::sim::OrderEntryEncoderModel encoder;
+        pipeline = run_pipeline(parser, stimulus, opt);
+        encoder_result = run_encoder(encoder, opt);
+    }
+
+    const char* backend = opt.verilator ? "verilator" : "c++ model";
+    double msgs_per_clock = pipeline.cycles ? static_cast<double>(pipeline.messages) / pipeline.cycles : 0.0;
+
+    std::cout << "Parser -> book (" << backend << ", "
+              << (opt.pcap_path.empty() ? "random" : opt.pcap_path) << " stimulus)" << std::endl;
+    std::cout << "  Messages:        " << pipeline.messages << " in " << pipeline.cycles << " cycles" << std::endl;
+    std::cout << "  Messages/clock:  " << msgs_per_clock << " ("
+              << msgs_per_clock * opt.clock_mhz << " M msgs/s at " << opt.clock_mhz << " MHz)" << std::endl;
+    if (pipeline.messages > 0) {
+        std::cout << "  Latency cycles:  min " << pipeline.latency_min << ", avg "
+                  << static_cast<double>(pipeline.latency_sum) / pipeline.messages
+                  << ", max " << pipeline.latency_max << std::endl;
+    }
+    std::cout << "  Mismatches:      parser " << pipeline.parser_mismatches
+              << ", book " << pipeline.book_mismatches << std::endl;
+
+    double cycles_per_order = encoder_result.orders
+        ? static_cast<double>(encoder_result.cycles) / encoder_result.orders : 0.0;
+    std::cout << "Order entry encoder (" << backend << ")" << std::endl;
+    std::cout << "  Orders:          " << encoder_result.orders << " in " << encoder_result.cycles
+              << " cycles (" << cycles_per_order << " cycles/order)" << std::endl;
+    std::cout << "  Mismatches:      " << encoder_result.byte_mismatches << std::endl;
+
+    if (pipeline.timed_out || encoder_result.timed_out) {
+        std::cerr << "Simulation stalled before all stimulus drained" << std::endl;
+        return 1;
+    }
+
+    bool passed = pipeline.parser_mismatches == 0 && pipeline.book_mismatches == 0 &&
+                  encoder_result.byte_mismatches == 0;
+    return passed ? 0 : 1;
+}
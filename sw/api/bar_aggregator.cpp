@@ -0,0 +1,173 @@
+#include "bar_aggregator.hpp"
+#include "pow2.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace trading {
+
+BarAggregator::BarAggregator(const BarConfig& config)
+    : intervals_(config.intervals_ns),
+      history_(std::max<uint32_t>(config.history, 1)),
+      max_symbols_(config.max_symbols), symbol_count_(0),
+      queue_(round_up_pow2(config.close_queue)),
+      queue_tail_(0), queue_head_(0), dropped_(0) {
+    intervals_.erase(std::remove(intervals_.begin(), intervals_.end(), 0), intervals_.end());
+    size_t series = max_symbols_ * intervals_.size();
+    symbols_.reserve(max_symbols_);
+    open_.reserve(series);
+    series_.reset(new Series[std::max<size_t>(series, 1)]());
+    slots_.reset(new SeqlockSlot<Bar>[std::max<size_t>(series * history_, 1)]());
+}
+
+BarAggregator::~BarAggregator() = default;
+
+int32_t BarAggregator::add_symbol(const std::string& symbol) {
+    auto it = index_.find(symbol);
+    if (it != index_.end()) {
+        return static_cast<int32_t>(it->second);
+    }
+    if (symbols_.size() == max_symbols_) {
+        std::cerr << "Bar aggregator is full (" << max_symbols_ << " symbols), dropping "
+                  << symbol << std::endl;
+        return -1;
+    }
+
+    uint32_t id = static_cast<uint32_t>(symbols_.size());
+    symbols_.push_back(symbol);
+    index_.emplace(symbol, id);
+    open_.resize(open_.size() + intervals_.size(), Open{Bar{}, 0, 0, 0, 0});
+    symbol_count_.store(symbols_.size(), std::memory_order_release);
+    return static_cast<int32_t>(id);
+}
+
+int32_t BarAggregator::symbol_id(const std::string& symbol) const {
+    auto it = index_.find(symbol);
+    return it == index_.end() ? -1 : static_cast<int32_t>(it->second);
+}
+
+BarAggregator::Open& BarAggregator::open_bar(uint32_t symbol_id, uint32_t interval,
+                                             uint64_t timestamp_ns) {
+    // One compare against the end of the open bar; late events land in it
+    Open& open = open_[symbol_id * intervals_.size() + interval];
+    if (timestamp_ns >= open.end_ns) {
+        if (open.end_ns != 0) {
+            close_bar(symbol_id, interval, open);
+        }
+        uint64_t length = intervals_[interval];
+        uint64_t start = timestamp_ns - timestamp_ns % length;
+        int64_t last = open.last_close;
+        open.bar = Bar{start, last, last, last, last, 0, 0, 0, open.bar.bid, open.bar.ask, 0};
+        open.end_ns = start + length;
+        open.notional = 0;
+    }
+    return open;
+}
+
+void BarAggregator::close_bar(uint32_t symbol_id, uint32_t interval, Open& open) {
+    Bar& bar = open.bar;
+    bar.vwap = bar.volume ? open.notional / static_cast<int64_t>(bar.volume) : 0;
+    open.end_ns = 0;
+
+    size_t series = symbol_id * intervals_.size() + interval;
+    uint64_t n = open.closed++;
+    slots_[series * history_ + n % history_].store(n, bar);
+    series_[series].closed.store(n + 1, std::memory_order_release);
+
+    uint64_t tail = queue_tail_.load(std::memory_order_relaxed);
+    if (tail - queue_head_.load(std::memory_order_acquire) == queue_.size()) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    queue_[tail & (queue_.size() - 1)] = BarClose{symbol_id, interval, n, bar};
+    queue_tail_.store(tail + 1, std::memory_order_release);
+}
+
+void BarAggregator::on_trade(uint32_t symbol_id, uint64_t price, uint32_t quantity,
+                             uint64_t timestamp_ns) {
+    int64_t p = static_cast<int64_t>(price);
+    for (uint32_t i = 0; i < intervals_.size(); ++i) {
+        Open& open = open_bar(symbol_id, i, timestamp_ns);
+        Bar& bar = open.bar;
+        if (bar.trades == 0) {
+            bar.open = bar.high = bar.low = p;
+        } else {
+            bar.high = std::max(bar.high, p);
+            bar.low = std::min(bar.low, p);
+        }
+        bar.close = p;
+        bar.volume += quantity;
+        bar.trades += 1;
+        open.notional += p * quantity;
+        open.last_close = p;
+    }
+}
+
+void BarAggregator::on_book(uint32_t symbol_id, uint64_t bid_price, uint32_t bid_qty,
+                            uint64_t ask_price, uint32_t ask_qty, uint64_t timestamp_ns) {
+    int64_t bid = bid_qty ? static_cast<int64_t>(bid_price) : 0;
+    int64_t ask = ask_qty ? static_cast<int64_t>(ask_price) : 0;
+    for (uint32_t i = 0; i < intervals_.size(); ++i) {
+        Bar& bar = open_bar(symbol_id, i, timestamp_ns).bar;
+        bar.bid = bid;
+        bar.ask = ask;
+        bar.quotes += 1;
+    }
+}
+
+void BarAggregator::on_book(uint32_t symbol_id, const OrderBook& book, uint64_t timestamp_ns) {
+    on_book(symbol_id, static_cast<uint64_t>(book.best_bid_price * 1000000.0 + 0.5), book.best_bid_qty,
+            static_cast<uint64_t>(book.best_ask_price * 1000000.0 + 0.5), book.best_ask_qty,
+            timestamp_ns);
+}
+
+void BarAggregator::flush(uint64_t now_ns) {
+    for (uint32_t s = 0; s < symbols_.size(); ++s) {
+        for (uint32_t i = 0; i < intervals_.size(); ++i) {
+            Open& open = open_[s * intervals_.size() + i];
+            if (open.end_ns != 0 && open.end_ns <= now_ns) {
+                close_bar(s, i, open);
+            }
+        }
+    }
+}
+
+uint64_t BarAggregator::closed_bars(uint32_t symbol_id, uint32_t interval) const {
+    if (symbol_id >= symbol_count() || interval >= intervals_.size()) {
+        return 0;
+    }
+    return series_[symbol_id * intervals_.size() + interval].closed.load(std::memory_order_acquire);
+}
+
+bool BarAggregator::read_bar(uint32_t symbol_id, uint32_t interval, uint64_t index, Bar& bar) const {
+    uint64_t closed = closed_bars(symbol_id, interval);
+    if (index >= closed || closed - index > history_) {
+        return false;
+    }
+    size_t series = symbol_id * intervals_.size() + interval;
+    return slots_[series * history_ + index % history_].load(index, bar);
+}
+
+bool BarAggregator::latest_bar(uint32_t symbol_id, uint32_t interval, Bar& bar) const {
+    uint64_t closed = closed_bars(symbol_id, interval);
+    return closed != 0 && read_bar(symbol_id, interval, closed - 1, bar);
+}
+
+void BarAggregator::subscribe(BarHandler handler) {
+    handlers_.push_back(std::move(handler));
+}
+
+size_t BarAggregator::dispatch() {
+    uint64_t head = queue_head_.load(std::memory_order_relaxed);
+    uint64_t tail = queue_tail_.load(std::memory_order_acquire);
+    for (uint64_t i = head; i != tail; ++i) {
+        const BarClose& close = queue_[i & (queue_.size() - 1)];
+        for (const BarHandler& handler : handlers_) {
+            handler(symbols_[close.symbol_id], close);
+        }
+    }
+    queue_head_.store(tail, std::memory_order_release);
+    return static_cast<size_t>(tail - head);
+}
+
+} // namespace trading
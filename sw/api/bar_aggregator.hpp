@@ -0,0 +1,128 @@
+#pragma once
+
+#include "seqlock_slot.hpp"
+#include "trading_interface.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trading {
+
+// One OHLCV bar. Prices have 6 implied decimals; every field is 64 bits,
+// see SeqlockSlot. A bar without trades is flat at the previous close (0 before the first
+// trade).
+struct Bar {
+    uint64_t start_ns;
+    int64_t open;
+    int64_t high;
+    int64_t low;
+    int64_t close;
+    int64_t vwap;      // 0 without trades
+    uint64_t volume;
+    uint64_t trades;
+    int64_t bid;       // quote in force at the close, 0 for an empty side
+    int64_t ask;
+    uint64_t quotes;   // book events in the bar
+};
+
+struct BarClose {
+    uint32_t symbol_id;
+    uint32_t interval;  // index into BarConfig::intervals_ns
+    uint64_t index;     // bar number in its series, from 0
+    Bar bar;
+};
+
+struct BarConfig {
+    std::vector<uint64_t> intervals_ns = {1000000000ull, 60000000000ull};
+    uint32_t history = 64;        // completed bars kept per series
+    size_t max_symbols = 1024;
+    size_t close_queue = 4096;    // closes awaiting dispatch()
+};
+
+// Maintains bars for several intervals per symbol from trade and book
+// events on a single writer thread. Intervals with no events produce no
+// bar. Completed bars go into preallocated per-symbol rings that any
+// thread can read without locks, and onto a queue that dispatch() drains
+// to subscribers off the update path.
+class BarAggregator {
+public:
+    using BarHandler = std::function<void(const std::string& symbol, const BarClose& close)>;
+
+    explicit BarAggregator(const BarConfig& config = BarConfig());
+    ~BarAggregator();
+
+    BarAggregator(const BarAggregator&) = delete;
+    BarAggregator& operator=(const BarAggregator&) = delete;
+
+    // Writer side. Returns -1 once max_symbols are in use. Symbols may be
+    // added while readers run: names sit in storage reserved up front and
+    // the count is published after each one is in place.
+    int32_t add_symbol(const std::string& symbol);
+    int32_t symbol_id(const std::string& symbol) const;
+    const std::string& symbol(uint32_t symbol_id) const { return symbols_[symbol_id]; }
+    size_t symbol_count() const { return symbol_count_.load(std::memory_order_acquire); }
+    size_t interval_count() const { return intervals_.size(); }
+
+    // Prices with 6 implied decimals; a zero size is an empty side
+    void on_trade(uint32_t symbol_id, uint64_t price, uint32_t quantity, uint64_t timestamp_ns);
+    void on_book(uint32_t symbol_id, uint64_t bid_price, uint32_t bid_qty,
+                 uint64_t ask_price, uint32_t ask_qty, uint64_t timestamp_ns);
+    void on_book(uint32_t symbol_id, const OrderBook& book, uint64_t timestamp_ns);
+    // Closes bars that ended by now_ns on symbols that have gone quiet
+    void flush(uint64_t now_ns);
+
+    // Reader side, any thread
+    uint64_t closed_bars(uint32_t symbol_id, uint32_t interval) const;
+    // Fails if the bar is not closed yet or has left the ring
+    bool read_bar(uint32_t symbol_id, uint32_t interval, uint64_t index, Bar& bar) const;
+    bool latest_bar(uint32_t symbol_id, uint32_t interval, Bar& bar) const;
+
+    // Subscribers are called from dispatch() on the calling thread, which
+    // must be the only one draining the queue
+    void subscribe(BarHandler handler);
+    size_t dispatch();
+    // Closes that found the queue full; the bars are still in the rings
+    uint64_t dropped_closes() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    // Writer-private bar in progress
+    struct Open {
+        Bar bar;
+        uint64_t end_ns;    // 0 while no bar is open
+        int64_t notional;
+        int64_t last_close;
+        uint64_t closed;
+    };
+
+    struct alignas(64) Series {
+        std::atomic<uint64_t> closed;
+    };
+
+    Open& open_bar(uint32_t symbol_id, uint32_t interval, uint64_t timestamp_ns);
+    void close_bar(uint32_t symbol_id, uint32_t interval, Open& open);
+
+    std::vector<uint64_t> intervals_;
+    uint32_t history_;
+    size_t max_symbols_;
+    std::vector<std::string> symbols_;       // max_symbols_ reserved, never reallocated
+    std::atomic<size_t> symbol_count_;       // readers' view of symbols_.size()
+    std::unordered_map<std::string, uint32_t> index_;
+    std::vector<Open> open_;                 // symbol * intervals + interval
+    std::unique_ptr<Series[]> series_;
+    std::unique_ptr<SeqlockSlot<Bar>[]> slots_;  // history per series, version n is bar n
+
+    // Single-producer, single-consumer queue of closes
+    std::vector<BarClose> queue_;
+    alignas(64) std::atomic<uint64_t> queue_tail_;
+    alignas(64) std::atomic<uint64_t> queue_head_;
+    std::atomic<uint64_t> dropped_;
+    std::vector<BarHandler> handlers_;
+};
+
+} // namespace trading
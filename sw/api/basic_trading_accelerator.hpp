@@ -0,0 +1,350 @@
+#pragma once
+
+#include "book_snapshot.hpp"
+#include "ouch_encoder.hpp"
+#include "register_map.hpp"
+#include "trace.hpp"
+#include "trading_interface.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace trading {
+
+// BAR0 of the card through /dev/xdma0. Register accesses are volatile
+// loads and stores at constant offsets from one base pointer.
+class MmioBackend {
+public:
+    MmioBackend() : fd_(-1), base_(nullptr) {}
+    ~MmioBackend() {
+        if (base_) {
+            munmap(const_cast<uint32_t*>(base_), regs::MAP_SIZE);
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    MmioBackend(const MmioBackend&) = delete;
+    MmioBackend& operator=(const MmioBackend&) = delete;
+
+    bool open() {
+        // Open PCIe device
+        fd_ = ::open("/dev/xdma0", O_RDWR);
+        if (fd_ < 0) {
+            std::cerr << "Failed to open PCIe device" << std::endl;
+            return false;
+        }
+
+        // Map BAR0 memory region
+        void* base = mmap(nullptr, regs::MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (base == MAP_FAILED) {
+            std::cerr << "Failed to map BAR0 memory" << std::endl;
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        base_ = static_cast<volatile uint32_t*>(base);
+        return true;
+    }
+
+    uint32_t read(uint32_t reg) { return base_[reg]; }
+    void write(uint32_t reg, uint32_t value) { base_[reg] = value; }
+
+    // Read consecutive registers as 64-bit loads so the bridge can
+    // coalesce them into one burst
+    void read_burst(uint32_t first, size_t count, uint32_t* out) {
+        const volatile uint64_t* src = reinterpret_cast<const volatile uint64_t*>(base_ + first);
+        for (size_t i = 0; i < count / 2; ++i) {
+            uint64_t pair = src[i];
+            out[2 * i] = static_cast<uint32_t>(pair);
+            out[2 * i + 1] = static_cast<uint32_t>(pair >> 32);
+        }
+        if (count & 1) {
+            out[count - 1] = base_[first + count - 1];
+        }
+    }
+
+    double cycle_ns() const { return regs::CLOCK_PERIOD_NS; }
+
+private:
+    int fd_;
+    volatile uint32_t* base_;
+};
+
+// The register protocol of TradingAccelerator with the backend fixed at
+// compile time. Every call is defined here so it can inline into the
+// caller, and the overloads taking packed symbols and fixed-point prices
+// skip the string and double conversions. A Backend provides open(),
+// read(), write(), read_burst() and cycle_ns().
+//
+// TradingAccelerator wraps one of these for the backend chosen by
+// SIMULATION_MODE and adds tracing, host counters and warm state.
+template <typename Backend>
+class BasicTradingAccelerator {
+public:
+    static constexpr int MAX_BOOK_READ_ATTEMPTS = 16;
+
+    template <typename... Args>
+    explicit BasicTradingAccelerator(Args&&... args)
+        : backend_(std::forward<Args>(args)...), book_read_stats_() {}
+
+    BasicTradingAccelerator(const BasicTradingAccelerator&) = delete;
+    BasicTradingAccelerator& operator=(const BasicTradingAccelerator&) = delete;
+
+    bool initialize() { return backend_.open(); }
+    Backend& backend() { return backend_; }
+
+    // Market data interface
+    bool send_market_data(const MarketData& data) {
+        return send_market_data(pack_symbol(data.symbol), double_to_fixed(data.price),
+                                data.quantity, data.is_bid);
+    }
+
+    // symbol from pack_symbol(), price with 6 implied decimals, at most
+    // regs::MAX_PRICE
+    bool send_market_data(uint32_t symbol, uint64_t price, uint32_t quantity, bool is_bid) {
+        if (price > regs::MAX_PRICE) {
+            std::cerr << "Price " << price << " exceeds the device's 32-bit datapath" << std::endl;
+            return false;
+        }
+        backend_.write(regs::SYMBOL, symbol);
+        backend_.write(regs::PRICE_H, static_cast<uint32_t>(price >> 32));
+        backend_.write(regs::PRICE_L, static_cast<uint32_t>(price));
+        backend_.write(regs::QUANTITY, quantity);
+        backend_.write(regs::CONTROL, (is_bid ? regs::CTRL_BID : 0) | regs::CTRL_VALID);
+
+        // Wait for acknowledgment
+        while ((backend_.read(regs::STATUS) & regs::STATUS_ACK) == 0) {
+            // Add timeout if needed
+        }
+        TRACE_INSTANT(trace::DEVICE_ACK, 0);
+        return true;
+    }
+
+    // The book manager holds a single instrument
+    bool get_order_book(OrderBook& book) {
+        for (int attempt = 0; attempt < MAX_BOOK_READ_ATTEMPTS; ++attempt) {
+            if (try_read_order_book(book)) {
+                return true;
+            }
+        }
+
+        std::cerr << "Order book snapshot torn " << MAX_BOOK_READ_ATTEMPTS
+                  << " times in a row" << std::endl;
+        return false;
+    }
+
+    // One attempt; false if the snapshot was torn
+    bool try_read_order_book(OrderBook& book) {
+        // Seqlock read: one burst over the generation-bracketed block,
+        // retried by the caller if another reader re-latched it mid-burst
+        uint32_t block[regs::BOOK_BLOCK_LEN];
+        backend_.read_burst(regs::BOOK_SEQ_BEGIN, regs::BOOK_BLOCK_LEN, block);
+        auto word = [&block](uint32_t reg) { return block[reg - regs::BOOK_SEQ_BEGIN]; };
+        if (word(regs::BOOK_SEQ_BEGIN) != word(regs::BOOK_SEQ_END)) {
+            ++book_read_stats_.retries;
+            return false;
+        }
+
+        // send_market_data() and load_book() keep prices within
+        // regs::MAX_PRICE, so the high words are always 0
+        book.best_bid_price = fixed_to_double(word(regs::BOOK_BID_L));
+        book.best_ask_price = fixed_to_double(word(regs::BOOK_ASK_L));
+        book.best_bid_qty = word(regs::BOOK_BID_QTY);
+        book.best_ask_qty = word(regs::BOOK_ASK_QTY);
+        book.generation = word(regs::BOOK_SEQ_BEGIN);
+        ++book_read_stats_.reads;
+        return true;
+    }
+
+    const BookReadStats& book_read_stats() const { return book_read_stats_; }
+
+    // Trading interface
+    bool place_order(const std::string& symbol, double price, uint32_t quantity, bool is_buy,
+                     uint64_t& order_id) {
+        uint32_t encoded;
+        if (!ouch::to_price(price, encoded)) {
+            std::cerr << "Price " << price << " of " << symbol << " does not fit an OUCH order"
+                      << std::endl;
+            return false;
+        }
+        return place_order(ouch::pack_stock(symbol), encoded, quantity, is_buy, order_id);
+    }
+
+    // stock from ouch::pack_stock(), price from ouch::to_price()
+    bool place_order(uint64_t stock, uint32_t price, uint32_t quantity, bool is_buy,
+                     uint64_t& order_id) {
+        submit_order(stock, price, quantity, is_buy);
+
+        // Wait for the encoder to accept the command
+        while (!order_accepted()) {
+            // Add timeout if needed
+        }
+
+        order_id = accepted_order_id();
+        TRACE_INSTANT(trace::DEVICE_ACK, static_cast<uint32_t>(order_id));
+        return true;
+    }
+
+    bool cancel_order(uint64_t order_id) {
+        submit_cancel(order_id);
+        while (!order_accepted()) {
+            // Add timeout if needed
+        }
+        return true;
+    }
+
+    // Split-phase order entry for callers that wait for acceptance
+    // themselves. The command port takes one command at a time: submit,
+    // then poll order_accepted() before submitting the next.
+    void submit_order(uint64_t stock, uint32_t price, uint32_t quantity, bool is_buy) {
+        backend_.write(regs::ORDER_SYMBOL_L, static_cast<uint32_t>(stock));
+        backend_.write(regs::ORDER_SYMBOL_H, static_cast<uint32_t>(stock >> 32));
+        backend_.write(regs::ORDER_PRICE, price);
+        backend_.write(regs::ORDER_QTY, quantity);
+        backend_.write(regs::ORDER_CONTROL,
+                       (is_buy ? regs::ORDER_CTRL_BUY : 0) | regs::ORDER_CTRL_VALID);
+    }
+
+    void submit_cancel(uint64_t order_id) {
+        backend_.write(regs::ORDER_ID, static_cast<uint32_t>(order_id));
+        backend_.write(regs::ORDER_CONTROL, regs::ORDER_CTRL_CANCEL | regs::ORDER_CTRL_VALID);
+    }
+
+    bool order_accepted() {
+        return (backend_.read(regs::ORDER_STATUS) & regs::ORDER_STATUS_ACCEPTED) != 0;
+    }
+
+    // Id the encoder assigned to the last accepted order
+    uint64_t accepted_order_id() {
+        return backend_.read(regs::ORDER_ID);
+    }
+
+    // Order tokens continue from next_order_id
+    void set_next_order_id(uint64_t next_order_id) {
+        backend_.write(regs::ORDER_SEQ, static_cast<uint32_t>(next_order_id));
+    }
+
+    // Streams levels through the load FIFO. LOAD_COUNT is only polled when
+    // the FIFO may be full, so a batch costs one round trip, not one per level.
+    // Fails without loading anything if a price exceeds regs::MAX_PRICE or
+    // a quantity regs::MAX_LOAD_QTY.
+    bool load_book(const SymbolDepth& depth) {
+        for (const std::vector<BookLevel>* side : {&depth.bids, &depth.asks}) {
+            for (const BookLevel& level : *side) {
+                if (level.price > regs::MAX_PRICE) {
+                    std::cerr << "Price " << level.price << " of " << depth.symbol
+                              << " exceeds the device's 32-bit datapath" << std::endl;
+                    return false;
+                }
+                if (level.quantity > regs::MAX_LOAD_QTY) {
+                    std::cerr << "Quantity " << level.quantity << " of " << depth.symbol
+                              << " does not fit the book load register" << std::endl;
+                    return false;
+                }
+            }
+        }
+        backend_.write(regs::SYMBOL, pack_symbol(depth.symbol));
+        uint32_t applied = backend_.read(regs::LOAD_COUNT);
+        uint32_t pushed = applied;
+
+        auto push = [&](const BookLevel& level, bool is_bid) {
+            while (pushed - applied >= regs::LOAD_FIFO_DEPTH) {
+                applied = backend_.read(regs::LOAD_COUNT);
+            }
+            backend_.write(regs::LOAD_PRICE, static_cast<uint32_t>(level.price));
+            backend_.write(regs::LOAD_QTY, level.quantity | (is_bid ? regs::LOAD_QTY_BID : 0));
+            ++pushed;
+        };
+        for (const BookLevel& level : depth.bids) {
+            push(level, true);
+        }
+        for (const BookLevel& level : depth.asks) {
+            push(level, false);
+        }
+
+        while (applied != pushed) {
+            applied = backend_.read(regs::LOAD_COUNT);
+        }
+        return true;
+    }
+
+    // Performance monitoring
+    double get_latency_ns() {
+        return static_cast<double>(backend_.read(regs::LATENCY));
+    }
+
+    uint64_t get_throughput_orders_per_sec() {
+        return static_cast<uint64_t>(backend_.read(regs::THROUGHPUT));
+    }
+
+    bool read_perf_counters(PerfCounters& counters) {
+        // Latch every counter in one device cycle, then fetch the shadow
+        // copies in a single burst; the live counters keep running
+        uint32_t words[2 * regs::PERF_NUM_COUNTERS];
+        backend_.write(regs::PERF_CONTROL, regs::PERF_CTRL_SNAPSHOT);
+        backend_.read_burst(regs::PERF_BASE, 2 * regs::PERF_NUM_COUNTERS, words);
+
+        auto counter = [&words](uint32_t index) {
+            return (static_cast<uint64_t>(words[2 * index + 1]) << 32) | words[2 * index];
+        };
+        counters.parser_in = counter(regs::PERF_PARSER_IN);
+        counters.parser_out = counter(regs::PERF_PARSER_OUT);
+        counters.book_in = counter(regs::PERF_BOOK_IN);
+        counters.book_out = counter(regs::PERF_BOOK_OUT);
+        counters.engine_in = counter(regs::PERF_ENGINE_IN);
+        counters.engine_out = counter(regs::PERF_ENGINE_OUT);
+        counters.parser_stall_cycles = counter(regs::PERF_PARSER_STALL);
+        counters.order_stall_cycles = counter(regs::PERF_ORDER_STALL);
+        counters.tx_backpressure_cycles = counter(regs::PERF_TX_BACKPRESSURE);
+        counters.dropped_updates = counter(regs::PERF_DROPPED_UPDATES);
+        counters.cycles = counter(regs::PERF_CYCLES);
+        return true;
+    }
+
+    // Snapshots and clears both histograms in one device cycle
+    bool read_latency_histograms(LatencyHistograms& histograms) {
+        // Swap the ping-pong banks, then read the frozen ones
+        backend_.write(regs::HIST_CONTROL, regs::HIST_CTRL_SNAPSHOT);
+        read_histogram(regs::HIST_INGRESS_BASE, histograms.ingress_to_book);
+        read_histogram(regs::HIST_ORDER_BASE, histograms.book_to_order);
+        return true;
+    }
+
+    static uint32_t pack_symbol(const std::string& symbol) {
+        uint32_t packed = 0;
+        std::memcpy(&packed, symbol.c_str(), std::min<size_t>(symbol.size(), sizeof(packed)));
+        return packed;
+    }
+
+    // Convert between double and fixed-point representation
+    static uint64_t double_to_fixed(double value) {
+        return static_cast<uint64_t>(value * 1000000.0); // 6 decimal places
+    }
+
+    static double fixed_to_double(uint64_t value) {
+        return static_cast<double>(value) / 1000000.0;
+    }
+
+private:
+    void read_histogram(uint32_t base, LatencyHistogram& histogram) {
+        static_assert(LatencyHistogram::NUM_BUCKETS == regs::HIST_NUM_BUCKETS,
+                      "histogram layout must match latency_histogram.sv");
+        backend_.read_burst(base, regs::HIST_NUM_BUCKETS, histogram.buckets);
+        histogram.cycle_ns = backend_.cycle_ns();
+    }
+
+    Backend backend_;
+    BookReadStats book_read_stats_;
+};
+
+} // namespace trading
@@ -0,0 +1,208 @@
+#include "book_snapshot.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+
+template <typename T>
+void put_le(std::vector<uint8_t>& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+template <typename T>
+T get_le(const uint8_t* p) {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(p[i]) << (8 * i);
+    }
+    return value;
+}
+
+uint32_t fnv1a(const uint8_t* data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void put_levels(std::vector<uint8_t>& out, const std::vector<BookLevel>& levels) {
+    for (const BookLevel& level : levels) {
+        put_le<uint64_t>(out, level.price);
+        put_le<uint32_t>(out, level.quantity);
+    }
+}
+
+void get_levels(const uint8_t*& p, uint32_t count, std::vector<BookLevel>& levels) {
+    levels.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        levels[i].price = get_le<uint64_t>(p);
+        levels[i].quantity = get_le<uint32_t>(p + 8);
+        p += snapshot::LEVEL_LEN;
+    }
+}
+
+bool write_all(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+size_t BookSnapshot::level_count() const {
+    size_t count = 0;
+    for (const SymbolDepth& depth : symbols) {
+        count += depth.bids.size() + depth.asks.size();
+    }
+    return count;
+}
+
+void encode_book_snapshot(const BookSnapshot& snapshot, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(snapshot::HEADER_LEN + snapshot.symbols.size() * snapshot::SYMBOL_HEADER_LEN +
+                snapshot.level_count() * snapshot::LEVEL_LEN + snapshot::TRAILER_LEN);
+
+    put_le<uint32_t>(out, snapshot::MAGIC);
+    put_le<uint16_t>(out, snapshot::VERSION);
+    put_le<uint16_t>(out, static_cast<uint16_t>(snapshot::HEADER_LEN));
+    put_le<uint32_t>(out, static_cast<uint32_t>(snapshot.symbols.size()));
+    put_le<uint32_t>(out, 0);
+    put_le<uint64_t>(out, snapshot.timestamp_ns);
+    put_le<uint64_t>(out, snapshot.sequence);
+
+    for (const SymbolDepth& depth : snapshot.symbols) {
+        char symbol[snapshot::SYMBOL_LEN];
+        std::memset(symbol, ' ', sizeof(symbol));
+        std::memcpy(symbol, depth.symbol.data(), std::min(depth.symbol.size(), sizeof(symbol)));
+        out.insert(out.end(), symbol, symbol + sizeof(symbol));
+        put_le<uint32_t>(out, static_cast<uint32_t>(depth.bids.size()));
+        put_le<uint32_t>(out, static_cast<uint32_t>(depth.asks.size()));
+        put_levels(out, depth.bids);
+        put_levels(out, depth.asks);
+    }
+    put_le<uint32_t>(out, fnv1a(out.data(), out.size()));
+}
+
+bool save_book_snapshot(const std::string& path, const BookSnapshot& snapshot) {
+    std::vector<uint8_t> out;
+    encode_book_snapshot(snapshot, out);
+
+    std::string tmp_path = path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to create snapshot " << tmp_path << std::endl;
+        return false;
+    }
+    bool ok = write_all(fd, out.data(), out.size()) && fsync(fd) == 0;
+    close(fd);
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to write snapshot " << path << std::endl;
+        unlink(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool decode_book_snapshot(const uint8_t* data, size_t length, BookSnapshot& snapshot,
+                          const std::string& source) {
+    if (length < snapshot::HEADER_LEN + snapshot::TRAILER_LEN ||
+        get_le<uint32_t>(data) != snapshot::MAGIC) {
+        std::cerr << "Not a book snapshot: " << source << std::endl;
+        return false;
+    }
+    if (get_le<uint16_t>(data + 4) != snapshot::VERSION) {
+        std::cerr << "Unsupported snapshot version in " << source << std::endl;
+        return false;
+    }
+    size_t body_len = length - snapshot::TRAILER_LEN;
+    if (fnv1a(data, body_len) != get_le<uint32_t>(data + body_len)) {
+        std::cerr << "Snapshot checksum mismatch in " << source << std::endl;
+        return false;
+    }
+
+    // Counts are checked against the bytes present before anything is
+    // sized from them; snapshots also arrive from the network
+    uint16_t header_len = get_le<uint16_t>(data + 6);
+    uint32_t symbol_count = get_le<uint32_t>(data + 8);
+    if (header_len < snapshot::HEADER_LEN || header_len > body_len ||
+        symbol_count > (body_len - header_len) / snapshot::SYMBOL_HEADER_LEN) {
+        std::cerr << "Corrupt snapshot header in " << source << std::endl;
+        return false;
+    }
+    snapshot.timestamp_ns = get_le<uint64_t>(data + 16);
+    snapshot.sequence = get_le<uint64_t>(data + 24);
+    snapshot.symbols.clear();
+    snapshot.symbols.reserve(symbol_count);
+
+    const uint8_t* p = data + header_len;
+    const uint8_t* end = data + body_len;
+    for (uint32_t i = 0; i < symbol_count; ++i) {
+        if (end - p < static_cast<ptrdiff_t>(snapshot::SYMBOL_HEADER_LEN)) {
+            std::cerr << "Truncated snapshot " << source << std::endl;
+            return false;
+        }
+        SymbolDepth depth;
+        depth.symbol.assign(reinterpret_cast<const char*>(p), snapshot::SYMBOL_LEN);
+        depth.symbol.erase(depth.symbol.find_last_not_of(' ') + 1);
+        uint32_t bid_count = get_le<uint32_t>(p + snapshot::SYMBOL_LEN);
+        uint32_t ask_count = get_le<uint32_t>(p + snapshot::SYMBOL_LEN + 4);
+        p += snapshot::SYMBOL_HEADER_LEN;
+
+        if (static_cast<uint64_t>(end - p) <
+            (static_cast<uint64_t>(bid_count) + ask_count) * snapshot::LEVEL_LEN) {
+            std::cerr << "Truncated snapshot " << source << std::endl;
+            return false;
+        }
+        get_levels(p, bid_count, depth.bids);
+        get_levels(p, ask_count, depth.asks);
+        snapshot.symbols.push_back(std::move(depth));
+    }
+    return true;
+}
+
+bool load_book_snapshot(const std::string& path, BookSnapshot& snapshot) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open snapshot " << path << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    std::vector<uint8_t> data;
+    bool ok = fstat(fd, &st) == 0;
+    if (ok) {
+        data.resize(static_cast<size_t>(st.st_size));
+        size_t done = 0;
+        while (ok && done < data.size()) {
+            ssize_t n = read(fd, data.data() + done, data.size() - done);
+            ok = n > 0;
+            done += ok ? static_cast<size_t>(n) : 0;
+        }
+    }
+    close(fd);
+    if (!ok) {
+        std::cerr << "Failed to read snapshot " << path << std::endl;
+        return false;
+    }
+
+    return decode_book_snapshot(data.data(), data.size(), snapshot, path);
+}
+
+} // namespace trading
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// Persisted per-symbol depth, used to restore books after a restart.
+//
+// File layout (little-endian):
+//   header   magic "FTBS", u16 version, u16 header length, u32 symbol count,
+//            u32 reserved, u64 capture time (ns), u64 feed sequence
+//   symbol   char[8] symbol (space padded), u32 bid levels, u32 ask levels,
+//            then bids best first and asks best first as
+//            { u64 price (6 implied decimals), u32 quantity }
+//   trailer  u32 FNV-1a of everything before it
+namespace snapshot {
+
+constexpr uint32_t MAGIC = 0x53425446;  // "FTBS"
+constexpr uint16_t VERSION = 1;
+constexpr size_t HEADER_LEN = 32;
+constexpr size_t SYMBOL_LEN = 8;
+constexpr size_t SYMBOL_HEADER_LEN = SYMBOL_LEN + 8;
+constexpr size_t LEVEL_LEN = 12;
+constexpr size_t TRAILER_LEN = 4;
+
+} // namespace snapshot
+
+struct BookLevel {
+    uint64_t price;  // 6 implied decimals, as on the device
+    uint32_t quantity;
+};
+
+struct SymbolDepth {
+    std::string symbol;
+    std::vector<BookLevel> bids;  // best first
+    std::vector<BookLevel> asks;  // best first
+};
+
+struct BookSnapshot {
+    uint64_t timestamp_ns = 0;  // capture time
+    uint64_t sequence = 0;      // last feed sequence applied to the books
+    std::vector<SymbolDepth> symbols;
+
+    size_t level_count() const;
+};
+
+// Written to a temporary file, synced and renamed over path, so a crash
+// never leaves a partial snapshot behind
+bool save_book_snapshot(const std::string& path, const BookSnapshot& snapshot);
+bool load_book_snapshot(const std::string& path, BookSnapshot& snapshot);
+
+// The same layout in memory, e.g. to send a snapshot over a socket;
+// source names the data in error messages
+void encode_book_snapshot(const BookSnapshot& snapshot, std::vector<uint8_t>& out);
+bool decode_book_snapshot(const uint8_t* data, size_t length, BookSnapshot& snapshot,
+                          const std::string& source);
+
+} // namespace trading
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "pow2.hpp"
+#include "seqlock_slot.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+namespace trading {
+
+// One market data update as fanned out to strategy threads. Prices have
+// 6 implied decimals.
+struct BookUpdate {
+    uint64_t timestamp_ns;
+    uint64_t price;
+    uint32_t quantity;
+    bool is_bid;
+    char symbol[8];  // NUL padded
+};
+
+// What the producer does about a consumer a full ring behind
+enum class SlowConsumerPolicy {
+    GATE,  // wait for it
+    DROP,  // disconnect it; it may rejoin() at the head
+};
+
+struct BroadcastStats {
+    uint64_t published;
+    uint64_t gated;    // publishes that had to wait for a consumer
+    uint64_t dropped;  // consumers disconnected
+};
+
+// Single-producer, multi-consumer broadcast ring in the style of the LMAX
+// Disruptor: every consumer sees every entry, reading in place from a
+// shared ring with its own cursor instead of a queue of its own. Slots are
+// a cache line or more each and stamped with their sequence (SeqlockSlot),
+// so a consumer that is lapped finds out instead of reading a torn entry. The producer
+// only scans consumer cursors when it is about to wrap past the slowest
+// one it last saw.
+template <typename T>
+class BroadcastRing {
+    static_assert(std::is_trivially_copyable<T>::value, "entries are copied word by word");
+
+public:
+    // capacity is rounded up to a power of two
+    BroadcastRing(size_t capacity, size_t max_consumers,
+                  SlowConsumerPolicy policy = SlowConsumerPolicy::GATE)
+        : capacity_(round_up_pow2(capacity)), max_consumers_(max_consumers), policy_(policy),
+          slots_(new Slot[capacity_]()), consumers_(new Consumer[max_consumers]()),
+          head_(0), next_(0), gate_(0), gated_(0), dropped_(0) {}
+
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+    size_t capacity() const { return capacity_; }
+    SlowConsumerPolicy policy() const { return policy_; }
+
+    // Joins at the head; returns -1 when every consumer slot is taken
+    int32_t add_consumer() {
+        for (size_t i = 0; i < max_consumers_; ++i) {
+            uint32_t state = FREE;
+            if (consumers_[i].state.compare_exchange_strong(state, JOINING)) {
+                join(consumers_[i]);
+                return static_cast<int32_t>(i);
+            }
+        }
+        return -1;
+    }
+
+    void remove_consumer(int32_t id) {
+        consumers_[id].state.store(FREE, std::memory_order_release);
+    }
+
+    // After being dropped, continue from the head
+    void rejoin(int32_t id) {
+        consumers_[id].state.store(JOINING, std::memory_order_relaxed);
+        join(consumers_[id]);
+    }
+
+    bool dropped(int32_t id) const {
+        return consumers_[id].state.load(std::memory_order_acquire) == DROPPED;
+    }
+
+    // Entries published but not yet read by this consumer
+    uint64_t lag(int32_t id) const {
+        return head_.load(std::memory_order_acquire) -
+               consumers_[id].cursor.load(std::memory_order_relaxed);
+    }
+
+    // Producer side, one thread
+    void publish(const T& value) {
+        uint64_t sequence = next_;
+        if (sequence - gate_ >= capacity_) {
+            wait_for_room(sequence);
+        }
+
+        slots_[sequence & (capacity_ - 1)].store(sequence, value);
+        next_ = sequence + 1;
+        head_.store(next_, std::memory_order_release);
+    }
+
+    // Consumer side: copies up to max entries and advances the cursor once
+    // for the batch. Returns 0 when nothing is new or the consumer has been
+    // dropped; check dropped() to tell them apart.
+    size_t poll(int32_t id, T* out, size_t max) {
+        Consumer& consumer = consumers_[id];
+        if (consumer.state.load(std::memory_order_acquire) != ACTIVE) {
+            return 0;
+        }
+        uint64_t cursor = consumer.cursor.load(std::memory_order_relaxed);
+        uint64_t available = head_.load(std::memory_order_acquire) - cursor;
+        size_t count = static_cast<size_t>(available < max ? available : max);
+
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t sequence = cursor + i;
+            if (!slots_[sequence & (capacity_ - 1)].load(sequence, out[i])) {
+                // Lapped: only possible once the producer stopped gating on us
+                uint32_t state = ACTIVE;
+                if (consumer.state.compare_exchange_strong(state, DROPPED)) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+                return 0;
+            }
+        }
+        consumer.cursor.store(cursor + count, std::memory_order_release);
+        return count;
+    }
+
+    BroadcastStats stats() const {
+        return BroadcastStats{head_.load(std::memory_order_relaxed),
+                              gated_.load(std::memory_order_relaxed),
+                              dropped_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    enum : uint32_t { FREE, JOINING, ACTIVE, DROPPED };
+
+    // Entry n is version n of its slot
+    struct alignas(64) Slot : SeqlockSlot<T> {};
+
+    struct alignas(64) Consumer {
+        std::atomic<uint64_t> cursor;  // next sequence to read
+        std::atomic<uint32_t> state;
+    };
+
+    void join(Consumer& consumer) {
+        consumer.cursor.store(head_.load(std::memory_order_acquire), std::memory_order_relaxed);
+        consumer.state.store(ACTIVE, std::memory_order_release);
+    }
+
+    // Slowest active consumer, dropping the ones a full ring behind under
+    // DROP; the head when there are none
+    uint64_t scan(uint64_t sequence) {
+        uint64_t slowest = sequence;
+        for (size_t i = 0; i < max_consumers_; ++i) {
+            Consumer& consumer = consumers_[i];
+            uint32_t state = consumer.state.load(std::memory_order_acquire);
+            if (state == JOINING) {
+                // Its cursor is about to be set from a head at or before ours
+                return sequence - capacity_;
+            }
+            if (state != ACTIVE) {
+                continue;
+            }
+            uint64_t cursor = consumer.cursor.load(std::memory_order_acquire);
+            if (policy_ == SlowConsumerPolicy::DROP && sequence - cursor >= capacity_) {
+                if (consumer.state.compare_exchange_strong(state, DROPPED)) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+                continue;
+            }
+            slowest = cursor < slowest ? cursor : slowest;
+        }
+        return slowest;
+    }
+
+    void wait_for_room(uint64_t sequence) {
+        gate_ = scan(sequence);
+        if (sequence - gate_ < capacity_) {
+            return;
+        }
+        gated_.fetch_add(1, std::memory_order_relaxed);
+        do {
+            std::this_thread::yield();
+            gate_ = scan(sequence);
+        } while (sequence - gate_ >= capacity_);
+    }
+
+    const size_t capacity_;
+    const size_t max_consumers_;
+    const SlowConsumerPolicy policy_;
+    std::unique_ptr<Slot[]> slots_;
+    std::unique_ptr<Consumer[]> consumers_;
+
+    alignas(64) std::atomic<uint64_t> head_;  // entries published
+    // Producer-private
+    alignas(64) uint64_t next_;
+    uint64_t gate_;  // slowest cursor at the last scan
+    std::atomic<uint64_t> gated_;
+    std::atomic<uint64_t> dropped_;
+};
+
+using BookUpdateRing = BroadcastRing<BookUpdate>;
+
+} // namespace trading
@@ -0,0 +1,227 @@
+#include "feature_engine.hpp"
+#include "pow2.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace trading {
+
+namespace {
+
+// An empty ask compares above every real price, an empty bid below
+constexpr int64_t NO_ASK = std::numeric_limits<int64_t>::max();
+
+} // namespace
+
+FeatureEngine::FeatureEngine(const FeatureConfig& config)
+    : config_(config), published_capacity_(0) {
+    config_.window_buckets = static_cast<uint32_t>(round_up_pow2(config_.window_buckets));
+    bucket_ns_ = std::max<uint64_t>(config_.window_ns / config_.window_buckets, 1);
+    symbols_.reserve(config_.expected_symbols);
+    states_.reserve(config_.expected_symbols);
+    buckets_.reserve(config_.expected_symbols * config_.window_buckets);
+    published_.reset(new Published[std::max<size_t>(config_.expected_symbols, 1)]());
+    published_capacity_ = std::max<size_t>(config_.expected_symbols, 1);
+}
+
+FeatureEngine::~FeatureEngine() = default;
+
+uint32_t FeatureEngine::add_symbol(const std::string& symbol) {
+    auto it = index_.find(symbol);
+    if (it != index_.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(symbols_.size());
+    if (id == published_capacity_) {
+        // Only before readers start: the slots move
+        std::unique_ptr<Published[]> grown(new Published[published_capacity_ * 2]());
+        for (size_t i = 0; i < published_capacity_; ++i) {
+            grown[i].latest.store(published_[i].latest.load());
+            for (uint32_t s = 0; s < SLOTS; ++s) {
+                grown[i].slots[s].sequence.store(published_[i].slots[s].sequence.load());
+                for (size_t w = 0; w < SeqlockSlot<Features>::WORDS; ++w) {
+                    grown[i].slots[s].words[w].store(published_[i].slots[s].words[w].load());
+                }
+            }
+        }
+        published_ = std::move(grown);
+        published_capacity_ *= 2;
+    }
+
+    symbols_.push_back(symbol);
+    index_.emplace(symbol, id);
+    State state;
+    std::memset(&state, 0, sizeof(state));
+    state.ask_price = NO_ASK;
+    states_.push_back(state);
+    buckets_.resize(buckets_.size() + config_.window_buckets, Bucket{0, 0, 0, 0, 0});
+    return id;
+}
+
+int32_t FeatureEngine::symbol_id(const std::string& symbol) const {
+    auto it = index_.find(symbol);
+    return it == index_.end() ? -1 : static_cast<int32_t>(it->second);
+}
+
+FeatureEngine::Bucket& FeatureEngine::bucket(uint32_t symbol_id, uint64_t index) {
+    return buckets_[static_cast<size_t>(symbol_id) * config_.window_buckets +
+                    (index & (config_.window_buckets - 1))];
+}
+
+void FeatureEngine::advance(uint32_t symbol_id, State& state, uint64_t timestamp_ns) {
+    // Buckets leaving the window are subtracted from the running sums as
+    // their ring positions are reused; late events land in the newest one
+    uint64_t now = timestamp_ns / bucket_ns_;
+    if (now <= state.bucket) {
+        return;
+    }
+    uint64_t expired = std::min<uint64_t>(now - state.bucket, config_.window_buckets);
+    for (uint64_t i = now - expired + 1; i <= now; ++i) {
+        Bucket& b = bucket(symbol_id, i);
+        state.window.ofi -= b.ofi;
+        state.window.notional -= b.notional;
+        state.window.volume -= b.volume;
+        state.window.realized_sum -= b.realized_sum;
+        state.window.realized_count -= b.realized_count;
+        b = Bucket{0, 0, 0, 0, 0};
+    }
+    state.bucket = now;
+}
+
+void FeatureEngine::settle_trades(uint32_t symbol_id, State& state, uint64_t timestamp_ns) {
+    // A trade is scored against the mid in force at its horizon, which is
+    // the mid before the event that crosses it
+    if (state.features.mid == 0) {
+        return;
+    }
+    Bucket& current = bucket(symbol_id, state.bucket);
+    while (state.pending_count != 0) {
+        const PendingTrade& trade = state.pending[state.pending_head];
+        if (trade.due_ns > timestamp_ns) {
+            break;
+        }
+        int64_t realized = 2 * trade.sign * (trade.price - state.features.mid);
+        current.realized_sum += realized;
+        current.realized_count += 1;
+        state.window.realized_sum += realized;
+        state.window.realized_count += 1;
+        state.pending_head = (state.pending_head + 1) % PENDING_TRADES;
+        --state.pending_count;
+    }
+}
+
+void FeatureEngine::on_book(uint32_t symbol_id, uint64_t bid_price, uint32_t bid_qty,
+                            uint64_t ask_price, uint32_t ask_qty, uint64_t timestamp_ns) {
+    State& state = states_[symbol_id];
+    advance(symbol_id, state, timestamp_ns);
+    settle_trades(symbol_id, state, timestamp_ns);
+
+    int64_t bid = bid_qty ? static_cast<int64_t>(bid_price) : 0;
+    int64_t ask = ask_qty ? static_cast<int64_t>(ask_price) : NO_ASK;
+    int64_t bq = bid_qty;
+    int64_t aq = ask_qty;
+
+    // Order-flow imbalance (Cont, Kukanov and Stoikov): size added at or
+    // above the old best bid minus size removed from it, less the same on
+    // the ask side
+    int64_t ofi = (bid >= state.bid_price ? bq : 0) - (bid <= state.bid_price ? state.bid_qty : 0) -
+                  (ask <= state.ask_price ? aq : 0) + (ask >= state.ask_price ? state.ask_qty : 0);
+    bucket(symbol_id, state.bucket).ofi += ofi;
+    state.window.ofi += ofi;
+    state.features.ofi_total += ofi;
+
+    state.bid_price = bid;
+    state.ask_price = ask;
+    state.bid_qty = bq;
+    state.ask_qty = aq;
+
+    // Microprice and imbalance share one reciprocal instead of two integer
+    // divisions; the results are rounded back to fixed point
+    Features& f = state.features;
+    double inv_depth = bq + aq != 0 ? 1.0 / static_cast<double>(bq + aq) : 0.0;
+    if (bq != 0 && aq != 0) {
+        f.mid = (bid + ask) / 2;
+        // In double: a micro-dollar price times a deep queue overflows int64
+        double weighted = static_cast<double>(bid) * static_cast<double>(aq) +
+                          static_cast<double>(ask) * static_cast<double>(bq);
+        f.microprice = static_cast<int64_t>(weighted * inv_depth + 0.5);
+    } else {
+        f.mid = 0;
+        f.microprice = 0;
+    }
+    f.imbalance_ppm = static_cast<int64_t>(static_cast<double>(bq - aq) * 1e6 * inv_depth);
+    finish(symbol_id, state, timestamp_ns);
+}
+
+void FeatureEngine::on_book(uint32_t symbol_id, const OrderBook& book, uint64_t timestamp_ns) {
+    on_book(symbol_id, static_cast<uint64_t>(book.best_bid_price * 1000000.0 + 0.5), book.best_bid_qty,
+            static_cast<uint64_t>(book.best_ask_price * 1000000.0 + 0.5), book.best_ask_qty,
+            timestamp_ns);
+}
+
+void FeatureEngine::on_trade(uint32_t symbol_id, uint64_t price, uint32_t quantity,
+                             bool buyer_initiated, uint64_t timestamp_ns) {
+    State& state = states_[symbol_id];
+    advance(symbol_id, state, timestamp_ns);
+    settle_trades(symbol_id, state, timestamp_ns);
+
+    int64_t p = static_cast<int64_t>(price);
+    Bucket& current = bucket(symbol_id, state.bucket);
+    current.notional += p * quantity;
+    current.volume += quantity;
+    state.window.notional += p * quantity;
+    state.window.volume += quantity;
+
+    // A full queue scores its oldest trade early rather than dropping it
+    if (state.pending_count == PENDING_TRADES) {
+        state.pending[state.pending_head].due_ns = 0;
+        settle_trades(symbol_id, state, 0);
+        if (state.pending_count == PENDING_TRADES) {
+            state.pending_head = (state.pending_head + 1) % PENDING_TRADES;
+            --state.pending_count;
+        }
+    }
+    uint32_t tail = (state.pending_head + state.pending_count) % PENDING_TRADES;
+    state.pending[tail] = PendingTrade{timestamp_ns + config_.realized_horizon_ns, p,
+                                       buyer_initiated ? 1 : -1};
+    ++state.pending_count;
+    finish(symbol_id, state, timestamp_ns);
+}
+
+void FeatureEngine::finish(uint32_t symbol_id, State& state, uint64_t timestamp_ns) {
+    Features& f = state.features;
+    f.timestamp_ns = timestamp_ns;
+    ++f.updates;
+    f.ofi = state.window.ofi;
+    f.window_volume = state.window.volume;
+    f.vwap = state.window.volume ? state.window.notional / state.window.volume : 0;
+    f.realized_count = static_cast<uint64_t>(state.window.realized_count);
+    f.realized_spread = state.window.realized_count
+                            ? state.window.realized_sum / state.window.realized_count : 0;
+    publish(symbol_id, f);
+}
+
+void FeatureEngine::publish(uint32_t symbol_id, const Features& features) {
+    Published& p = published_[symbol_id];
+    uint64_t n = p.latest.load(std::memory_order_relaxed) + 1;
+    p.slots[n % SLOTS].store(n - 1, features);
+    p.latest.store(n, std::memory_order_release);
+}
+
+bool FeatureEngine::read(uint32_t symbol_id, Features& features) const {
+    if (symbol_id >= symbols_.size()) {
+        return false;
+    }
+    const Published& p = published_[symbol_id];
+    uint64_t n = p.latest.load(std::memory_order_acquire);
+    if (n == 0) {
+        return false;
+    }
+
+    // The newest slot is only rewritten SLOTS publications later
+    return p.slots[n % SLOTS].load(n - 1, features);
+}
+
+} // namespace trading
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "seqlock_slot.hpp"
+#include "trading_interface.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trading {
+
+// Microstructure features of one symbol. Prices have 6 implied decimals
+// like the rest of the host API; every field is 64 bits, see SeqlockSlot.
+struct Features {
+    uint64_t timestamp_ns;    // of the last event applied
+    uint64_t updates;         // events applied
+    int64_t mid;              // 0 until both sides are present
+    int64_t microprice;       // size-weighted: leans toward the thinner side
+    int64_t imbalance_ppm;    // (bid size - ask size) / (bid size + ask size)
+    int64_t ofi;              // order-flow imbalance over the window, shares
+    int64_t ofi_total;        // since the first event
+    int64_t vwap;             // traded over the window, 0 without trades
+    int64_t window_volume;
+    int64_t realized_spread;  // mean 2 * side * (trade price - later mid) over the window
+    uint64_t realized_count;
+};
+
+struct FeatureConfig {
+    uint64_t window_ns = 1000000000;   // rolling window of OFI, VWAP and realized spread
+    uint32_t window_buckets = 64;      // resolution of the window
+    uint64_t realized_horizon_ns = 100000000;  // mid this long after a trade
+    size_t expected_symbols = 1024;
+};
+
+// Updates features incrementally from book and trade events, with a single
+// writer thread. Each symbol publishes into a small ring of slots, and
+// read() copies the newest one in a bounded number of steps with no locks
+// or retries; it fails only if the writer laps the ring during the copy.
+class FeatureEngine {
+public:
+    explicit FeatureEngine(const FeatureConfig& config = FeatureConfig());
+    ~FeatureEngine();
+
+    FeatureEngine(const FeatureEngine&) = delete;
+    FeatureEngine& operator=(const FeatureEngine&) = delete;
+
+    // Writer side. Symbols must all be added before readers start.
+    uint32_t add_symbol(const std::string& symbol);
+    int32_t symbol_id(const std::string& symbol) const;
+    size_t symbol_count() const { return symbols_.size(); }
+
+    // Prices with 6 implied decimals; a zero size is an empty side
+    void on_book(uint32_t symbol_id, uint64_t bid_price, uint32_t bid_qty,
+                 uint64_t ask_price, uint32_t ask_qty, uint64_t timestamp_ns);
+    void on_book(uint32_t symbol_id, const OrderBook& book, uint64_t timestamp_ns);
+    void on_trade(uint32_t symbol_id, uint64_t price, uint32_t quantity,
+                  bool buyer_initiated, uint64_t timestamp_ns);
+
+    // Reader side, any thread
+    bool read(uint32_t symbol_id, Features& features) const;
+
+private:
+    static constexpr uint32_t SLOTS = 4;
+    static constexpr uint32_t PENDING_TRADES = 32;
+
+    struct Bucket {
+        int64_t ofi;
+        int64_t notional;  // price * quantity, 6 implied decimals
+        int64_t volume;
+        int64_t realized_sum;
+        int64_t realized_count;
+    };
+
+    struct PendingTrade {
+        uint64_t due_ns;
+        int64_t price;
+        int64_t sign;
+    };
+
+    // Writer-private running state
+    struct State {
+        int64_t bid_price;
+        int64_t ask_price;
+        int64_t bid_qty;
+        int64_t ask_qty;
+        uint64_t bucket;   // index of the newest bucket
+        Bucket window;     // sum over the live buckets
+        uint32_t pending_head;
+        uint32_t pending_count;
+        PendingTrade pending[PENDING_TRADES];
+        Features features;
+    };
+
+    // Reader-visible copies
+    struct alignas(64) Published {
+        std::atomic<uint64_t> latest;  // publications so far
+        SeqlockSlot<Features> slots[SLOTS];  // publication n is version n - 1
+    };
+
+    void advance(uint32_t symbol_id, State& state, uint64_t timestamp_ns);
+    void settle_trades(uint32_t symbol_id, State& state, uint64_t timestamp_ns);
+    Bucket& bucket(uint32_t symbol_id, uint64_t index);
+    void finish(uint32_t symbol_id, State& state, uint64_t timestamp_ns);
+    void publish(uint32_t symbol_id, const Features& features);
+
+    FeatureConfig config_;
+    uint64_t bucket_ns_;
+    std::vector<std::string> symbols_;
+    std::unordered_map<std::string, uint32_t> index_;
+    std::vector<State> states_;
+    std::vector<Bucket> buckets_;  // window_buckets per symbol
+    std::unique_ptr<Published[]> published_;
+    size_t published_capacity_;
+};
+
+} // namespace trading
@@ -0,0 +1,132 @@
+#include "host_counters.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+
+struct EventSpec {
+    uint32_t type;
+    uint64_t config;
+};
+
+constexpr uint64_t cache_miss(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+// Indexed by HostEvent
+const EventSpec EVENTS[HOST_NUM_EVENTS] = {
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int open_event(const EventSpec& spec, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // A pinned group stays on the PMU or fails its reads, so deltas are
+    // never taken across multiplexing
+    attr.pinned = group_fd < 0;
+    attr.disabled = group_fd < 0;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+} // namespace
+
+HostCounters::HostCounters() : available_(0), members_(0) {
+    for (int i = 0; i < HOST_NUM_EVENTS; ++i) {
+        fds_[i] = -1;
+        slots_[i] = -1;
+    }
+}
+
+HostCounters::~HostCounters() {
+    close();
+}
+
+bool HostCounters::open() {
+    close();
+
+    int leader = open_event(EVENTS[HOST_TASK_CLOCK], -1);
+    if (leader < 0) {
+        std::cerr << "perf_event_open failed; check /proc/sys/kernel/perf_event_paranoid"
+                  << " (needs 2 or lower)" << std::endl;
+        return false;
+    }
+    fds_[HOST_TASK_CLOCK] = leader;
+    slots_[HOST_TASK_CLOCK] = 0;
+    available_ = 1u << HOST_TASK_CLOCK;
+    members_ = 1;
+
+    for (int i = HOST_TASK_CLOCK + 1; i < HOST_NUM_EVENTS; ++i) {
+        int fd = open_event(EVENTS[i], leader);
+        if (fd < 0) {
+            continue;
+        }
+        fds_[i] = fd;
+        slots_[i] = static_cast<int>(members_++);
+        available_ |= 1u << i;
+    }
+
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void HostCounters::close() {
+    for (int i = HOST_NUM_EVENTS - 1; i >= 0; --i) {
+        if (fds_[i] >= 0) {
+            ::close(fds_[i]);
+            fds_[i] = -1;
+        }
+        slots_[i] = -1;
+    }
+    available_ = 0;
+    members_ = 0;
+}
+
+bool HostCounters::read(uint64_t values[HOST_NUM_EVENTS]) {
+    // Group layout: nr, then one value per member in open order
+    uint64_t buffer[1 + HOST_NUM_EVENTS];
+    ssize_t expected = static_cast<ssize_t>((1 + members_) * sizeof(uint64_t));
+    if (!is_open() || ::read(fds_[HOST_TASK_CLOCK], buffer, sizeof(buffer)) != expected) {
+        return false;
+    }
+    for (int i = 0; i < HOST_NUM_EVENTS; ++i) {
+        values[i] = slots_[i] >= 0 ? buffer[1 + slots_[i]] : 0;
+    }
+    return true;
+}
+
+HostCounters* HostCounters::for_this_thread() {
+    // Opened once per thread; a failed open is not retried on every call
+    thread_local std::unique_ptr<HostCounters> counters;
+    thread_local bool attempted = false;
+    if (!attempted) {
+        attempted = true;
+        counters.reset(new HostCounters());
+        if (!counters->open()) {
+            counters.reset();
+        }
+    }
+    return counters.get();
+}
+
+} // namespace trading
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace trading {
+
+// Host CPU events read around instrumented API calls
+enum HostEvent {
+    HOST_TASK_CLOCK = 0,     // ns on CPU, software event, always present
+    HOST_CYCLES,
+    HOST_INSTRUCTIONS,
+    HOST_L1D_MISSES,         // L1D read misses
+    HOST_LLC_MISSES,
+    HOST_DTLB_MISSES,        // dTLB read misses
+    HOST_BRANCH_MISSES,
+    HOST_NUM_EVENTS
+};
+
+// One perf_event_open group counting the calling thread in user mode only
+// (exclude_kernel), so it opens without privileges whenever
+// perf_event_paranoid is 2 or lower. Hardware events the PMU or the
+// hypervisor does not expose are left out of the group.
+class HostCounters {
+public:
+    HostCounters();
+    ~HostCounters();
+
+    HostCounters(const HostCounters&) = delete;
+    HostCounters& operator=(const HostCounters&) = delete;
+
+    bool open();
+    void close();
+    bool is_open() const { return fds_[HOST_TASK_CLOCK] >= 0; }
+    // Bit per HostEvent that is being counted
+    uint32_t available() const { return available_; }
+
+    // Current counts of every event, 0 for missing ones. Fails while the
+    // group is multiplexed off the PMU, when the counts are not comparable.
+    bool read(uint64_t values[HOST_NUM_EVENTS]);
+
+    // The group of the calling thread, opened on first use; null if
+    // perf_event_open is not permitted here
+    static HostCounters* for_this_thread();
+
+private:
+    int fds_[HOST_NUM_EVENTS];
+    int slots_[HOST_NUM_EVENTS];  // position in the group read, -1 if missing
+    uint32_t available_;
+    uint32_t members_;
+};
+
+} // namespace trading
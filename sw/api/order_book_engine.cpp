@@ -0,0 +1,121 @@
+#include "order_book_engine.hpp"
+#include "top_of_book_table.hpp"
+
+namespace trading {
+
+namespace {
+
+template <typename Levels>
+void set_level(Levels& levels, uint64_t price, uint32_t quantity) {
+    if (quantity == 0) {
+        levels.erase(price);
+    } else {
+        levels[price] = quantity;
+    }
+}
+
+template <typename Levels>
+void save_levels(const Levels& levels, std::vector<BookLevel>& out) {
+    out.clear();
+    out.reserve(levels.size());
+    for (const auto& level : levels) {
+        out.push_back(BookLevel{level.first, level.second});
+    }
+}
+
+template <typename Levels>
+void load_levels(const std::vector<BookLevel>& levels, Levels& out) {
+    out.clear();
+    for (const BookLevel& level : levels) {
+        if (level.quantity != 0) {
+            out.emplace_hint(out.end(), level.price, level.quantity);
+        }
+    }
+}
+
+} // namespace
+
+void OrderBookEngine::apply(const std::string& symbol, uint64_t price,
+                            uint32_t quantity, bool is_bid) {
+    Book& book = books_[symbol];
+    if (is_bid) {
+        set_level(book.bids, price, quantity);
+    } else {
+        set_level(book.asks, price, quantity);
+    }
+    if (table_) {
+        refresh_table(symbol, book);
+    }
+}
+
+void OrderBookEngine::apply(const MarketData& data) {
+    apply(data.symbol, static_cast<uint64_t>(data.price * 1000000.0), data.quantity, data.is_bid);
+}
+
+bool OrderBookEngine::top_of_book(const std::string& symbol, OrderBook& book) const {
+    auto it = books_.find(symbol);
+    if (it == books_.end()) {
+        return false;
+    }
+
+    const Book& levels = it->second;
+    book.best_bid_price = levels.bids.empty() ? 0.0 : levels.bids.begin()->first / 1000000.0;
+    book.best_bid_qty = levels.bids.empty() ? 0 : levels.bids.begin()->second;
+    book.best_ask_price = levels.asks.empty() ? 0.0 : levels.asks.begin()->first / 1000000.0;
+    book.best_ask_qty = levels.asks.empty() ? 0 : levels.asks.begin()->second;
+    return true;
+}
+
+size_t OrderBookEngine::level_count() const {
+    size_t count = 0;
+    for (const auto& entry : books_) {
+        count += entry.second.bids.size() + entry.second.asks.size();
+    }
+    return count;
+}
+
+void OrderBookEngine::save(BookSnapshot& snapshot) const {
+    snapshot.symbols.clear();
+    snapshot.symbols.reserve(books_.size());
+    for (const auto& entry : books_) {
+        SymbolDepth depth;
+        depth.symbol = entry.first;
+        save_levels(entry.second.bids, depth.bids);
+        save_levels(entry.second.asks, depth.asks);
+        snapshot.symbols.push_back(std::move(depth));
+    }
+}
+
+void OrderBookEngine::load(const BookSnapshot& snapshot) {
+    for (const SymbolDepth& depth : snapshot.symbols) {
+        Book& book = books_[depth.symbol];
+        load_levels(depth.bids, book.bids);
+        load_levels(depth.asks, book.asks);
+        if (table_) {
+            refresh_table(depth.symbol, book);
+        }
+    }
+}
+
+void OrderBookEngine::attach_table(TopOfBookTable* table) {
+    table_ = table;
+    for (auto& entry : books_) {
+        entry.second.table_id = -1;
+        if (table_) {
+            refresh_table(entry.first, entry.second);
+        }
+    }
+}
+
+void OrderBookEngine::refresh_table(const std::string& symbol, Book& book) {
+    if (book.table_id < 0) {
+        book.table_id = static_cast<int32_t>(table_->add_symbol(symbol));
+    }
+    table_->update(static_cast<uint32_t>(book.table_id),
+                   book.bids.empty() ? 0.0 : book.bids.begin()->first / 1000000.0,
+                   book.bids.empty() ? 0 : book.bids.begin()->second,
+                   book.asks.empty() ? 0.0 : book.asks.begin()->first / 1000000.0,
+                   book.asks.empty() ? 0 : book.asks.begin()->second);
+}
+
+} // namespace trading
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "book_snapshot.hpp"
+#include "trading_interface.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace trading {
+
+class TopOfBookTable;
+
+// Host-side price-level books for any number of symbols, with the same
+// update rule as order_book_manager.vhd: a level takes the latest
+// quantity and is removed at zero.
+class OrderBookEngine {
+public:
+    // price has 6 implied decimals
+    void apply(const std::string& symbol, uint64_t price, uint32_t quantity, bool is_bid);
+    void apply(const MarketData& data);
+
+    bool top_of_book(const std::string& symbol, OrderBook& book) const;
+    size_t symbol_count() const { return books_.size(); }
+    size_t level_count() const;
+    void clear() { books_.clear(); }
+
+    void save(BookSnapshot& snapshot) const;
+    // Replaces the books of every symbol in the snapshot
+    void load(const BookSnapshot& snapshot);
+
+    // Keeps every symbol's top of book in table as updates are applied;
+    // null detaches
+    void attach_table(TopOfBookTable* table);
+
+private:
+    struct Book {
+        std::map<uint64_t, uint32_t, std::greater<uint64_t>> bids;
+        std::map<uint64_t, uint32_t> asks;
+        int32_t table_id = -1;
+    };
+
+    void refresh_table(const std::string& symbol, Book& book);
+
+    std::unordered_map<std::string, Book> books_;
+    TopOfBookTable* table_ = nullptr;
+};
+
+} // namespace trading
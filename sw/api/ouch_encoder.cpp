@@ -0,0 +1,126 @@
+#include "ouch_encoder.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace trading {
+
+namespace ouch {
+
+uint32_t to_price(double price) {
+    return static_cast<uint32_t>(std::llround(price * 10000.0));
+}
+
+bool to_price(double price, uint32_t& encoded) {
+    double scaled = std::round(price * 10000.0);
+    // Also false for NaN
+    if (!(scaled >= 0.0 && scaled <= static_cast<double>(UINT32_MAX))) {
+        return false;
+    }
+    encoded = static_cast<uint32_t>(scaled);
+    return true;
+}
+
+uint64_t pack_stock(const std::string& symbol) {
+    uint64_t packed = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        uint8_t c = i < symbol.size() ? static_cast<uint8_t>(symbol[i]) : ' ';
+        packed |= static_cast<uint64_t>(c) << (8 * i);
+    }
+    return packed;
+}
+
+std::string unpack_stock(uint64_t stock) {
+    char chars[sizeof(stock)];
+    for (size_t i = 0; i < sizeof(chars); ++i) {
+        chars[i] = static_cast<char>(stock >> (8 * i));
+    }
+    size_t length = sizeof(chars);
+    while (length > 0 && (chars[length - 1] == ' ' || chars[length - 1] == '\0')) {
+        --length;
+    }
+    return std::string(chars, length);
+}
+
+} // namespace ouch
+
+namespace {
+
+// Must match the parameter defaults of order_entry_encoder.sv
+constexpr uint32_t TIME_IN_FORCE = 99998;
+constexpr uint8_t DISPLAY = 'Y';
+constexpr uint8_t CAPACITY = 'P';
+constexpr uint8_t CROSS_TYPE = 'N';
+constexpr uint8_t CUSTOMER_TYPE = 'R';
+
+inline void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+inline void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+void copy_padded(uint8_t* dst, const std::string& src, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        dst[i] = i < src.size() ? static_cast<uint8_t>(src[i]) : ' ';
+    }
+}
+
+} // namespace
+
+OuchEncoder::OuchEncoder(const std::string& token_prefix, const std::string& firm)
+    : next_order_id_(1), last_order_id_(0), messages_sent_(0) {
+    copy_padded(token_prefix_, token_prefix, sizeof(token_prefix_));
+    copy_padded(firm_, firm, sizeof(firm_));
+}
+
+void OuchEncoder::format_token(uint32_t order_id, uint8_t* out) const {
+    static const char hex[] = "0123456789ABCDEF";
+    std::memcpy(out, token_prefix_, sizeof(token_prefix_));
+    for (int i = 0; i < 8; ++i) {
+        out[6 + i] = hex[(order_id >> (4 * (7 - i))) & 0xF];
+    }
+}
+
+size_t OuchEncoder::encode(const OrderCommand& cmd, uint8_t* out) {
+    uint8_t* msg = out + ouch::FRAME_HEADER_LEN;
+    out[2] = 'U';
+
+    if (cmd.cancel) {
+        put_u16(out, static_cast<uint16_t>(ouch::CANCEL_ORDER_LEN + 1));
+        msg[0] = 'X';
+        format_token(cmd.order_id, msg + 1);
+        put_u32(msg + 15, 0);  // cancel all remaining shares
+        last_order_id_ = cmd.order_id;
+        ++messages_sent_;
+        return ouch::FRAME_HEADER_LEN + ouch::CANCEL_ORDER_LEN;
+    }
+
+    put_u16(out, static_cast<uint16_t>(ouch::ENTER_ORDER_LEN + 1));
+    msg[0] = 'O';
+    format_token(next_order_id_, msg + 1);
+    msg[15] = cmd.is_buy ? 'B' : 'S';
+    put_u32(msg + 16, cmd.quantity);
+    for (size_t i = 0; i < 8; ++i) {
+        msg[20 + i] = static_cast<uint8_t>(cmd.symbol >> (8 * i));
+    }
+    put_u32(msg + 28, cmd.price);
+    put_u32(msg + 32, TIME_IN_FORCE);
+    std::memcpy(msg + 36, firm_, sizeof(firm_));
+    msg[40] = DISPLAY;
+    msg[41] = CAPACITY;
+    msg[42] = 'N';  // intermarket sweep
+    put_u32(msg + 43, 0);  // minimum quantity
+    msg[47] = CROSS_TYPE;
+    msg[48] = CUSTOMER_TYPE;
+
+    last_order_id_ = next_order_id_++;
+    ++messages_sent_;
+    return ouch::FRAME_HEADER_LEN + ouch::ENTER_ORDER_LEN;
+}
+
+} // namespace trading
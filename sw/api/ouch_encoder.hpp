@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trading {
+
+namespace ouch {
+
+// OUCH 4.2 message lengths (without SoupBinTCP framing)
+constexpr size_t ENTER_ORDER_LEN = 49;
+constexpr size_t CANCEL_ORDER_LEN = 19;
+constexpr size_t TOKEN_LEN = 14;
+
+// SoupBinTCP unsequenced data packet: length (2) + 'U'
+constexpr size_t FRAME_HEADER_LEN = 3;
+constexpr size_t MAX_FRAME_LEN = FRAME_HEADER_LEN + ENTER_ORDER_LEN;
+
+// OUCH prices carry 4 implied decimal places; price must be encodable
+uint32_t to_price(double price);
+// False for a price the 32-bit field cannot carry: negative, not a
+// number, or above $429,496.7295
+bool to_price(double price, uint32_t& encoded);
+
+// Pack up to 8 symbol characters, char 0 in the low byte, space padded
+uint64_t pack_stock(const std::string& symbol);
+// The symbol back, without space or NUL padding
+std::string unpack_stock(uint64_t stock);
+
+} // namespace ouch
+
+struct OrderCommand {
+    bool cancel;
+    bool is_buy;
+    uint64_t symbol;      // see ouch::pack_stock
+    uint32_t price;       // see ouch::to_price
+    uint32_t quantity;
+    uint32_t order_id;    // cancel target
+};
+
+// Bit-exact software model of hw/rtl/order_entry_encoder.sv
+class OuchEncoder {
+public:
+    explicit OuchEncoder(const std::string& token_prefix = "FPGA00",
+                         const std::string& firm = "FPGA");
+
+    // Encode one framed message into out (at least MAX_FRAME_LEN bytes).
+    // Returns the frame length; the assigned order id is left in last_order_id().
+    size_t encode(const OrderCommand& cmd, uint8_t* out);
+
+    void set_next_order_id(uint32_t id) { next_order_id_ = id; }
+    uint32_t next_order_id() const { return next_order_id_; }
+    uint32_t last_order_id() const { return last_order_id_; }
+    uint64_t messages_sent() const { return messages_sent_; }
+
+    // Write the 14-character token for an order id
+    void format_token(uint32_t order_id, uint8_t* out) const;
+
+private:
+    uint8_t token_prefix_[6];
+    uint8_t firm_[4];
+    uint32_t next_order_id_;
+    uint32_t last_order_id_;
+    uint64_t messages_sent_;
+};
+
+} // namespace trading
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+namespace trading {
+
+// Smallest power of two that is at least value and at least minimum, a
+// power of two itself: 64 for sizes tracked by bitmaps of 64-bit words
+inline uint64_t round_up_pow2(uint64_t value, uint64_t minimum = 1) {
+    uint64_t rounded = minimum;
+    while (rounded < value) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+} // namespace trading
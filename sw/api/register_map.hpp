@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace trading {
+
+// BAR0 register map of hw/rtl/host_register_bank.sv (32-bit word indices)
+namespace regs {
+
+constexpr size_t MAP_SIZE = 4096;
+constexpr uint32_t CLOCK_PERIOD_NS = 4;  // trading_top CLK_PERIOD_NS
+
+// The parser and book datapaths carry 32-bit prices: PRICE_H is stored
+// but not used, so market data and book loads above MAX_PRICE (6 implied
+// decimals, about $4294.97) must be rejected by the host
+constexpr uint64_t MAX_PRICE = 0xFFFFFFFFull;
+
+constexpr uint32_t SYMBOL = 0;
+constexpr uint32_t PRICE_H = 1;
+constexpr uint32_t PRICE_L = 2;
+constexpr uint32_t QUANTITY = 3;
+constexpr uint32_t CONTROL = 4;
+constexpr uint32_t STATUS = 5;
+constexpr uint32_t BEST_BID_H = 6;  // reads 0, see MAX_PRICE
+constexpr uint32_t BEST_BID_L = 7;
+constexpr uint32_t BEST_ASK_H = 8;
+constexpr uint32_t BEST_ASK_L = 9;
+constexpr uint32_t BEST_BID_QTY = 10;
+constexpr uint32_t BEST_ASK_QTY = 11;
+constexpr uint32_t LATENCY = 12;
+constexpr uint32_t THROUGHPUT = 13;
+
+// Order entry encoder command port
+constexpr uint32_t ORDER_SYMBOL_L = 14;
+constexpr uint32_t ORDER_SYMBOL_H = 15;
+constexpr uint32_t ORDER_PRICE = 16;
+constexpr uint32_t ORDER_QTY = 17;
+constexpr uint32_t ORDER_ID = 18;       // cancel target / assigned id
+constexpr uint32_t ORDER_CONTROL = 19;
+constexpr uint32_t ORDER_STATUS = 20;
+constexpr uint32_t ORDER_SEQ = 21;      // next order token sequence
+
+// Book load FIFO. Write LOAD_PRICE, then LOAD_QTY (bit 31: bid) to push a
+// level; the bank feeds queued levels to the parser on its own and counts
+// the ones applied in LOAD_COUNT. Push at most LOAD_FIFO_DEPTH levels
+// ahead of LOAD_COUNT, and do not send market data while a load runs.
+constexpr uint32_t LOAD_PRICE = 24;
+constexpr uint32_t LOAD_QTY = 25;
+constexpr uint32_t LOAD_COUNT = 26;
+constexpr uint32_t LOAD_QTY_BID = 1u << 31;
+constexpr uint32_t MAX_LOAD_QTY = LOAD_QTY_BID - 1;  // quantities above it do not fit
+constexpr uint32_t LOAD_FIFO_DEPTH = 16;
+
+// Consistent top of book. Reading BOOK_SEQ_BEGIN returns the book
+// generation and latches the top of book it belongs to; BOOK_SEQ_END
+// returns the generation of the latched copy. Read the block in one
+// burst and retry when the two differ (another reader re-latched it).
+// Book prices are at most MAX_PRICE: BOOK_*_H, like BEST_*_H, read 0.
+constexpr uint32_t BOOK_SEQ_BEGIN = 40;
+constexpr uint32_t BOOK_BID_H = 41;
+constexpr uint32_t BOOK_BID_L = 42;
+constexpr uint32_t BOOK_ASK_H = 43;
+constexpr uint32_t BOOK_ASK_L = 44;
+constexpr uint32_t BOOK_BID_QTY = 45;
+constexpr uint32_t BOOK_ASK_QTY = 46;
+constexpr uint32_t BOOK_SEQ_END = 47;
+constexpr uint32_t BOOK_BLOCK_LEN = 8;
+
+// Performance counters (perf_counters.sv). Writing PERF_CTRL_SNAPSHOT to
+// PERF_CONTROL copies every counter into shadow registers in one cycle;
+// counter i is then read from PERF_BASE + 2i (low) and PERF_BASE + 2i + 1 (high).
+constexpr uint32_t PERF_CONTROL = 32;
+constexpr uint32_t PERF_BASE = 64;
+constexpr uint32_t PERF_CTRL_SNAPSHOT = 1;
+
+constexpr uint32_t PERF_PARSER_IN = 0;
+constexpr uint32_t PERF_PARSER_OUT = 1;
+constexpr uint32_t PERF_BOOK_IN = 2;
+constexpr uint32_t PERF_BOOK_OUT = 3;
+constexpr uint32_t PERF_ENGINE_IN = 4;
+constexpr uint32_t PERF_ENGINE_OUT = 5;
+constexpr uint32_t PERF_PARSER_STALL = 6;
+constexpr uint32_t PERF_ORDER_STALL = 7;
+constexpr uint32_t PERF_TX_BACKPRESSURE = 8;
+constexpr uint32_t PERF_DROPPED_UPDATES = 9;
+constexpr uint32_t PERF_CYCLES = 10;
+constexpr uint32_t PERF_NUM_COUNTERS = 11;
+
+// Latency histograms (latency_monitor.sv), 32-bit counts of log2 cycle
+// buckets. Writing HIST_CTRL_SNAPSHOT to HIST_CONTROL swaps the ping-pong
+// banks: samples since the previous snapshot are frozen for readout and
+// counting restarts from zero.
+constexpr uint32_t HIST_CONTROL = 33;
+constexpr uint32_t HIST_CTRL_SNAPSHOT = 1;
+constexpr uint32_t HIST_INGRESS_BASE = 128;  // parser ingress -> book update
+constexpr uint32_t HIST_ORDER_BASE = 160;    // book update -> order command
+constexpr uint32_t HIST_NUM_BUCKETS = 32;
+
+// CONTROL bits
+constexpr uint32_t CTRL_VALID = 1;
+constexpr uint32_t CTRL_BID = 2;
+constexpr uint32_t CTRL_BOOK_REQUEST = 4;
+
+// STATUS bits
+constexpr uint32_t STATUS_ACK = 1;        // last market data update reached the book
+constexpr uint32_t STATUS_BOOK_VALID = 2; // best bid/ask registers hold the requested book
+
+// ORDER_CONTROL bits
+constexpr uint32_t ORDER_CTRL_VALID = 1;
+constexpr uint32_t ORDER_CTRL_BUY = 2;
+constexpr uint32_t ORDER_CTRL_CANCEL = 4;
+
+// ORDER_STATUS bits
+constexpr uint32_t ORDER_STATUS_ACCEPTED = 1;
+
+} // namespace regs
+
+} // namespace trading
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace trading {
+
+// One value written by a single thread and copied out by any number of
+// readers without locks. The writer stamps the sequence odd, stores the
+// value as 64-bit words and stamps it even again; a reader copies the
+// words between two reads of the sequence and keeps the copy only if
+// both show the version it asked for. The words are relaxed atomics, so a
+// read racing the writer is a discarded copy rather than a data race, and
+// a value made of 64-bit fields (Bar, Features) is never seen with half of
+// a field updated.
+template <typename T>
+struct SeqlockSlot {
+    static_assert(std::is_trivially_copyable<T>::value, "values are copied word by word");
+
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence;  // 2n + 1 while version n is written, 2n + 2 after
+    std::atomic<uint64_t> words[WORDS];
+
+    // Writer only
+    void store(uint64_t version, const T& value) {
+        uint64_t copy[WORDS] = {};
+        std::memcpy(copy, static_cast<const void*>(&value), sizeof(T));
+        sequence.store(2 * version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            words[i].store(copy[i], std::memory_order_relaxed);
+        }
+        sequence.store(2 * version + 2, std::memory_order_release);
+    }
+
+    // False unless the slot held version for the whole copy
+    bool load(uint64_t version, T& value) const {
+        if (sequence.load(std::memory_order_acquire) != 2 * version + 2) {
+            return false;
+        }
+        uint64_t copy[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) {
+            copy[i] = words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != 2 * version + 2) {
+            return false;
+        }
+        std::memcpy(static_cast<void*>(&value), copy, sizeof(T));
+        return true;
+    }
+};
+
+} // namespace trading
@@ -0,0 +1,470 @@
+#include "top_of_book_table.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+
+namespace trading {
+
+namespace {
+
+const float NOT_A_PRICE = std::numeric_limits<float>::quiet_NaN();
+const float NEG_INF = -std::numeric_limits<float>::infinity();
+
+// Spread in bps is (ask - bid) * 2e4 / (ask + bid)
+constexpr float BPS_SCALE = 20000.0f;
+
+struct Columns {
+    const float* bid_price;
+    const float* ask_price;
+    const uint32_t* bid_qty;
+    const uint32_t* ask_qty;
+    size_t size;
+    size_t padded;  // multiple of 16, the tail holds empty sides
+};
+
+// One set of kernels per instruction set. metric() and argmax() run over
+// the padded length; screen() masks off the tail itself. above() returns a
+// bit per value of a 16-value block that is greater than threshold.
+struct Kernels {
+    size_t (*screen)(const Columns& c, const ScreenQuery& q, uint32_t* out);
+    void (*metric)(const Columns& c, TopMetric metric, bool negate, float* out);
+    int32_t (*argmax)(const float* values, size_t count);
+    uint32_t (*above)(const float* values, float threshold);
+};
+
+float metric_value(const Columns& c, TopMetric metric, size_t i) {
+    switch (metric) {
+    case TopMetric::SPREAD_BPS:
+        return (c.ask_price[i] - c.bid_price[i]) * BPS_SCALE / (c.ask_price[i] + c.bid_price[i]);
+    case TopMetric::BID_QTY:
+        return c.bid_qty[i] ? static_cast<float>(c.bid_qty[i]) : NOT_A_PRICE;
+    case TopMetric::ASK_QTY:
+        return c.ask_qty[i] ? static_cast<float>(c.ask_qty[i]) : NOT_A_PRICE;
+    case TopMetric::BID_PRICE:
+        return c.bid_price[i];
+    case TopMetric::ASK_PRICE:
+        return c.ask_price[i];
+    }
+    return NOT_A_PRICE;
+}
+
+size_t screen_scalar(const Columns& c, const ScreenQuery& q, uint32_t* out) {
+    const bool spread = std::isfinite(q.max_spread_bps);
+    size_t count = 0;
+    for (size_t i = 0; i < c.size; ++i) {
+        bool pass = c.bid_qty[i] >= q.min_bid_qty && c.ask_qty[i] >= q.min_ask_qty;
+        if (spread) {
+            pass = pass && (c.ask_price[i] - c.bid_price[i]) * BPS_SCALE <=
+                               q.max_spread_bps * (c.ask_price[i] + c.bid_price[i]);
+        }
+        out[count] = static_cast<uint32_t>(i);
+        count += pass;
+    }
+    return count;
+}
+
+void metric_scalar(const Columns& c, TopMetric metric, bool negate, float* out) {
+    for (size_t i = 0; i < c.padded; ++i) {
+        float value = metric_value(c, metric, i);
+        out[i] = negate ? -value : value;
+    }
+}
+
+int32_t argmax_scalar(const float* values, size_t count) {
+    int32_t best_index = -1;
+    float best = NEG_INF;
+    for (size_t i = 0; i < count; ++i) {
+        if (values[i] > best) {
+            best = values[i];
+            best_index = static_cast<int32_t>(i);
+        }
+    }
+    return best_index;
+}
+
+uint32_t above_scalar(const float* values, float threshold) {
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+        mask |= static_cast<uint32_t>(values[i] > threshold) << i;
+    }
+    return mask;
+}
+
+__attribute__((target("avx2")))
+size_t screen_avx2(const Columns& c, const ScreenQuery& q, uint32_t* out) {
+    const bool spread = std::isfinite(q.max_spread_bps);
+    const __m256 scale = _mm256_set1_ps(BPS_SCALE);
+    const __m256 bound = _mm256_set1_ps(q.max_spread_bps);
+    const __m256i min_bid = _mm256_set1_epi32(static_cast<int>(q.min_bid_qty));
+    const __m256i min_ask = _mm256_set1_epi32(static_cast<int>(q.min_ask_qty));
+    size_t count = 0;
+    for (size_t i = 0; i < c.size; i += 8) {
+        // Unsigned q >= min as max(q, min) == q
+        __m256i bid_qty = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.bid_qty + i));
+        __m256i ask_qty = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.ask_qty + i));
+        __m256i pass = _mm256_and_si256(
+            _mm256_cmpeq_epi32(_mm256_max_epu32(bid_qty, min_bid), bid_qty),
+            _mm256_cmpeq_epi32(_mm256_max_epu32(ask_qty, min_ask), ask_qty));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(pass)));
+        if (spread) {
+            __m256 bid = _mm256_loadu_ps(c.bid_price + i);
+            __m256 ask = _mm256_loadu_ps(c.ask_price + i);
+            __m256 lhs = _mm256_mul_ps(_mm256_sub_ps(ask, bid), scale);
+            __m256 rhs = _mm256_mul_ps(_mm256_add_ps(ask, bid), bound);
+            mask &= static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(lhs, rhs, _CMP_LE_OQ)));
+        }
+        if (c.size - i < 8) {
+            mask &= (1u << (c.size - i)) - 1;
+        }
+        while (mask) {
+            out[count++] = static_cast<uint32_t>(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    return count;
+}
+
+__attribute__((target("avx2")))
+__m256 metric_avx2(const Columns& c, TopMetric metric, size_t i) {
+    const __m256 nan = _mm256_set1_ps(NOT_A_PRICE);
+    switch (metric) {
+    case TopMetric::SPREAD_BPS: {
+        __m256 bid = _mm256_loadu_ps(c.bid_price + i);
+        __m256 ask = _mm256_loadu_ps(c.ask_price + i);
+        return _mm256_div_ps(_mm256_mul_ps(_mm256_sub_ps(ask, bid), _mm256_set1_ps(BPS_SCALE)),
+                             _mm256_add_ps(ask, bid));
+    }
+    case TopMetric::BID_QTY:
+    case TopMetric::ASK_QTY: {
+        // AVX2 has no unsigned conversion: hi * 2^16 and lo are exact, so
+        // their sum rounds once, like the scalar and AVX-512 conversions
+        const uint32_t* qty = metric == TopMetric::BID_QTY ? c.bid_qty : c.ask_qty;
+        __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(qty + i));
+        __m256 empty = _mm256_castsi256_ps(_mm256_cmpeq_epi32(q, _mm256_setzero_si256()));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_srli_epi32(q, 16));
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_and_si256(q, _mm256_set1_epi32(0xFFFF)));
+        __m256 value = _mm256_add_ps(_mm256_mul_ps(hi, _mm256_set1_ps(65536.0f)), lo);
+        return _mm256_blendv_ps(value, nan, empty);
+    }
+    case TopMetric::BID_PRICE:
+        return _mm256_loadu_ps(c.bid_price + i);
+    case TopMetric::ASK_PRICE:
+        return _mm256_loadu_ps(c.ask_price + i);
+    }
+    return nan;
+}
+
+__attribute__((target("avx2")))
+void metric_avx2(const Columns& c, TopMetric metric, bool negate, float* out) {
+    const __m256 sign = _mm256_set1_ps(negate ? -0.0f : 0.0f);
+    for (size_t i = 0; i < c.padded; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_xor_ps(metric_avx2(c, metric, i), sign));
+    }
+}
+
+__attribute__((target("avx2")))
+int32_t argmax_avx2(const float* values, size_t count) {
+    __m256 best = _mm256_set1_ps(NEG_INF);
+    __m256i best_index = _mm256_setzero_si256();
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i step = _mm256_set1_epi32(8);
+    for (size_t i = 0; i < count; i += 8) {
+        __m256 v = _mm256_loadu_ps(values + i);
+        __m256 greater = _mm256_cmp_ps(v, best, _CMP_GT_OQ);
+        best = _mm256_blendv_ps(best, v, greater);
+        best_index = _mm256_blendv_epi8(best_index, index, _mm256_castps_si256(greater));
+        index = _mm256_add_epi32(index, step);
+    }
+
+    // Lowest index among the lanes holding the maximum
+    float lane_best[8];
+    int32_t lane_index[8];
+    _mm256_storeu_ps(lane_best, best);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lane_index), best_index);
+    int32_t result = -1;
+    float result_value = NEG_INF;
+    for (int lane = 0; lane < 8; ++lane) {
+        if (lane_best[lane] > result_value ||
+            (lane_best[lane] == result_value && result >= 0 && lane_index[lane] < result)) {
+            result_value = lane_best[lane];
+            result = lane_index[lane];
+        }
+    }
+    return result;
+}
+
+__attribute__((target("avx2")))
+uint32_t above_avx2(const float* values, float threshold) {
+    const __m256 t = _mm256_set1_ps(threshold);
+    uint32_t low = static_cast<uint32_t>(
+        _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(values), t, _CMP_GT_OQ)));
+    uint32_t high = static_cast<uint32_t>(
+        _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(values + 8), t, _CMP_GT_OQ)));
+    return low | (high << 8);
+}
+
+// GCC 12 flags the deliberately undefined vectors inside some AVX-512
+// intrinsics as uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f")))
+size_t screen_avx512(const Columns& c, const ScreenQuery& q, uint32_t* out) {
+    const bool spread = std::isfinite(q.max_spread_bps);
+    const __m512 scale = _mm512_set1_ps(BPS_SCALE);
+    const __m512 bound = _mm512_set1_ps(q.max_spread_bps);
+    const __m512i min_bid = _mm512_set1_epi32(static_cast<int>(q.min_bid_qty));
+    const __m512i min_ask = _mm512_set1_epi32(static_cast<int>(q.min_ask_qty));
+    const __m512i step = _mm512_set1_epi32(16);
+    __m512i index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    size_t count = 0;
+    for (size_t i = 0; i < c.size; i += 16) {
+        __mmask16 mask =
+            _mm512_cmpge_epu32_mask(_mm512_loadu_si512(c.bid_qty + i), min_bid) &
+            _mm512_cmpge_epu32_mask(_mm512_loadu_si512(c.ask_qty + i), min_ask);
+        if (spread) {
+            __m512 bid = _mm512_loadu_ps(c.bid_price + i);
+            __m512 ask = _mm512_loadu_ps(c.ask_price + i);
+            __m512 lhs = _mm512_mul_ps(_mm512_sub_ps(ask, bid), scale);
+            __m512 rhs = _mm512_mul_ps(_mm512_add_ps(ask, bid), bound);
+            mask &= _mm512_cmp_ps_mask(lhs, rhs, _CMP_LE_OQ);
+        }
+        if (c.size - i < 16) {
+            mask &= static_cast<__mmask16>((1u << (c.size - i)) - 1);
+        }
+        _mm512_mask_compressstoreu_epi32(out + count, mask, index);
+        count += static_cast<size_t>(__builtin_popcount(mask));
+        index = _mm512_add_epi32(index, step);
+    }
+    return count;
+}
+
+__attribute__((target("avx512f")))
+__m512 metric_avx512(const Columns& c, TopMetric metric, size_t i) {
+    const __m512 nan = _mm512_set1_ps(NOT_A_PRICE);
+    switch (metric) {
+    case TopMetric::SPREAD_BPS: {
+        __m512 bid = _mm512_loadu_ps(c.bid_price + i);
+        __m512 ask = _mm512_loadu_ps(c.ask_price + i);
+        return _mm512_div_ps(_mm512_mul_ps(_mm512_sub_ps(ask, bid), _mm512_set1_ps(BPS_SCALE)),
+                             _mm512_add_ps(ask, bid));
+    }
+    case TopMetric::BID_QTY:
+    case TopMetric::ASK_QTY: {
+        const uint32_t* qty = metric == TopMetric::BID_QTY ? c.bid_qty : c.ask_qty;
+        __m512i q = _mm512_loadu_si512(qty + i);
+        __mmask16 empty = _mm512_cmpeq_epi32_mask(q, _mm512_setzero_si512());
+        return _mm512_mask_mov_ps(_mm512_cvtepu32_ps(q), empty, nan);
+    }
+    case TopMetric::BID_PRICE:
+        return _mm512_loadu_ps(c.bid_price + i);
+    case TopMetric::ASK_PRICE:
+        return _mm512_loadu_ps(c.ask_price + i);
+    }
+    return nan;
+}
+
+__attribute__((target("avx512f")))
+void metric_avx512(const Columns& c, TopMetric metric, bool negate, float* out) {
+    const __m512i sign = _mm512_set1_epi32(negate ? static_cast<int>(0x80000000u) : 0);
+    for (size_t i = 0; i < c.padded; i += 16) {
+        __m512i v = _mm512_castps_si512(metric_avx512(c, metric, i));
+        _mm512_storeu_ps(out + i, _mm512_castsi512_ps(_mm512_xor_si512(v, sign)));
+    }
+}
+
+__attribute__((target("avx512f")))
+int32_t argmax_avx512(const float* values, size_t count) {
+    __m512 best = _mm512_set1_ps(NEG_INF);
+    __m512i best_index = _mm512_setzero_si512();
+    __m512i index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i step = _mm512_set1_epi32(16);
+    for (size_t i = 0; i < count; i += 16) {
+        __m512 v = _mm512_loadu_ps(values + i);
+        __mmask16 greater = _mm512_cmp_ps_mask(v, best, _CMP_GT_OQ);
+        best = _mm512_mask_mov_ps(best, greater, v);
+        best_index = _mm512_mask_mov_epi32(best_index, greater, index);
+        index = _mm512_add_epi32(index, step);
+    }
+
+    float max = _mm512_reduce_max_ps(best);
+    if (!(max > NEG_INF)) {
+        return -1;
+    }
+    __mmask16 at_max = _mm512_cmp_ps_mask(best, _mm512_set1_ps(max), _CMP_EQ_OQ);
+    return static_cast<int32_t>(_mm512_mask_reduce_min_epu32(at_max, best_index));
+}
+
+__attribute__((target("avx512f")))
+uint32_t above_avx512(const float* values, float threshold) {
+    return _mm512_cmp_ps_mask(_mm512_loadu_ps(values), _mm512_set1_ps(threshold), _CMP_GT_OQ);
+}
+
+#pragma GCC diagnostic pop
+
+const Kernels& kernels(TopOfBookTable::Isa isa) {
+    static const Kernels SCALAR = {screen_scalar, metric_scalar, argmax_scalar, above_scalar};
+    static const Kernels AVX2 = {screen_avx2, metric_avx2, argmax_avx2, above_avx2};
+    static const Kernels AVX512 = {screen_avx512, metric_avx512, argmax_avx512, above_avx512};
+    switch (isa) {
+    case TopOfBookTable::Isa::AVX512:
+        return AVX512;
+    case TopOfBookTable::Isa::AVX2:
+        return AVX2;
+    default:
+        return SCALAR;
+    }
+}
+
+} // namespace
+
+TopOfBookTable::TopOfBookTable(size_t expected_symbols) : isa_(best_isa()) {
+    size_t padded = (expected_symbols + BLOCK - 1) / BLOCK * BLOCK;
+    symbols_.reserve(expected_symbols);
+    bid_price_.reserve(padded);
+    ask_price_.reserve(padded);
+    bid_qty_.reserve(padded);
+    ask_qty_.reserve(padded);
+    scratch_.reserve(padded);
+}
+
+TopOfBookTable::Isa TopOfBookTable::best_isa() {
+    if (__builtin_cpu_supports("avx512f")) {
+        return Isa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::AVX2;
+    }
+    return Isa::SCALAR;
+}
+
+void TopOfBookTable::set_isa(Isa isa) {
+    isa_ = std::min(isa, best_isa());
+}
+
+void TopOfBookTable::grow(size_t symbols) {
+    // Pad to whole blocks of empty sides so kernels never need a scalar tail
+    size_t padded = (symbols + BLOCK - 1) / BLOCK * BLOCK;
+    bid_price_.resize(padded, NOT_A_PRICE);
+    ask_price_.resize(padded, NOT_A_PRICE);
+    bid_qty_.resize(padded, 0);
+    ask_qty_.resize(padded, 0);
+}
+
+uint32_t TopOfBookTable::add_symbol(const std::string& symbol) {
+    auto it = index_.find(symbol);
+    if (it != index_.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(symbols_.size());
+    symbols_.push_back(symbol);
+    index_.emplace(symbol, id);
+    if (symbols_.size() > bid_price_.size()) {
+        grow(symbols_.size());
+    }
+    return id;
+}
+
+int32_t TopOfBookTable::symbol_id(const std::string& symbol) const {
+    auto it = index_.find(symbol);
+    return it == index_.end() ? -1 : static_cast<int32_t>(it->second);
+}
+
+void TopOfBookTable::update(uint32_t symbol_id, double bid_price, uint32_t bid_qty,
+                            double ask_price, uint32_t ask_qty) {
+    bid_price_[symbol_id] = bid_qty ? static_cast<float>(bid_price) : NOT_A_PRICE;
+    ask_price_[symbol_id] = ask_qty ? static_cast<float>(ask_price) : NOT_A_PRICE;
+    bid_qty_[symbol_id] = bid_qty;
+    ask_qty_[symbol_id] = ask_qty;
+}
+
+void TopOfBookTable::update(uint32_t symbol_id, const OrderBook& book) {
+    update(symbol_id, book.best_bid_price, book.best_bid_qty, book.best_ask_price, book.best_ask_qty);
+}
+
+bool TopOfBookTable::top_of_book(uint32_t symbol_id, OrderBook& book) const {
+    if (symbol_id >= symbols_.size()) {
+        return false;
+    }
+    book.best_bid_price = bid_qty_[symbol_id] ? bid_price_[symbol_id] : 0.0;
+    book.best_ask_price = ask_qty_[symbol_id] ? ask_price_[symbol_id] : 0.0;
+    book.best_bid_qty = bid_qty_[symbol_id];
+    book.best_ask_qty = ask_qty_[symbol_id];
+    return true;
+}
+
+size_t TopOfBookTable::screen(const ScreenQuery& query, std::vector<uint32_t>& ids) const {
+    Columns columns{bid_price_.data(), ask_price_.data(), bid_qty_.data(), ask_qty_.data(),
+                    symbols_.size(), bid_price_.size()};
+    // Kernels write whole blocks, so leave room for one past the end
+    ids.resize(columns.padded + BLOCK);
+    size_t count = kernels(isa_).screen(columns, query, ids.data());
+    ids.resize(count);
+    return count;
+}
+
+const float* TopOfBookTable::metric_column(TopMetric metric, bool negate) const {
+    Columns columns{bid_price_.data(), ask_price_.data(), bid_qty_.data(), ask_qty_.data(),
+                    symbols_.size(), bid_price_.size()};
+    scratch_.resize(columns.padded);
+    kernels(isa_).metric(columns, metric, negate, scratch_.data());
+    return scratch_.data();
+}
+
+int32_t TopOfBookTable::min_index(TopMetric metric) const {
+    // The smallest value is the largest negated one
+    return kernels(isa_).argmax(metric_column(metric, true), bid_price_.size());
+}
+
+int32_t TopOfBookTable::max_index(TopMetric metric) const {
+    return kernels(isa_).argmax(metric_column(metric, false), bid_price_.size());
+}
+
+size_t TopOfBookTable::top_k(TopMetric metric, size_t k, bool largest,
+                             std::vector<uint32_t>& ids) const {
+    ids.clear();
+    if (k == 0) {
+        return 0;
+    }
+    const float* values = metric_column(metric, !largest);
+    const size_t count = bid_price_.size();
+    const Kernels& kernel = kernels(isa_);
+
+    // Heap of the best k so far with the weakest on top; a block only costs
+    // a compare unless something in it beats the weakest
+    auto better = [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
+    heap_.clear();
+    float floor = NEG_INF;
+    for (size_t i = 0; i < count; i += BLOCK) {
+        uint32_t mask = kernel.above(values + i, floor);
+        while (mask) {
+            uint32_t index = static_cast<uint32_t>(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+            if (!(values[index] > floor)) {
+                continue;
+            }
+            heap_.emplace_back(values[index], index);
+            std::push_heap(heap_.begin(), heap_.end(), better);
+            if (heap_.size() > k) {
+                std::pop_heap(heap_.begin(), heap_.end(), better);
+                heap_.pop_back();
+            }
+            if (heap_.size() == k) {
+                floor = heap_.front().first;
+            }
+        }
+    }
+
+    std::sort_heap(heap_.begin(), heap_.end(), better);
+    ids.reserve(heap_.size());
+    for (const auto& entry : heap_) {
+        ids.push_back(entry.second);
+    }
+    return ids.size();
+}
+
+} // namespace trading
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "trading_interface.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trading {
+
+// Bounds a symbol must meet to pass TopOfBookTable::screen(). Unset bounds
+// accept everything; a spread bound also requires both sides.
+struct ScreenQuery {
+    float max_spread_bps = std::numeric_limits<float>::infinity();
+    uint32_t min_bid_qty = 0;
+    uint32_t min_ask_qty = 0;
+};
+
+// Per-symbol quantities that can be ranked. Symbols missing the metric
+// (an empty side, or either side for the spread) are skipped.
+enum class TopMetric {
+    SPREAD_BPS,
+    BID_QTY,
+    ASK_QTY,
+    BID_PRICE,
+    ASK_PRICE,
+};
+
+// Top of book for a whole universe of symbols in structure-of-arrays form,
+// so cross-sectional queries scan contiguous columns with AVX-512 or AVX2
+// (chosen at runtime) instead of asking one symbol at a time. Prices are
+// kept as float, which is ample for screening; exact prices stay in the
+// books that feed the table. Queries reuse internal scratch space, so one
+// table must not be queried from two threads at once.
+class TopOfBookTable {
+public:
+    enum class Isa {
+        SCALAR,
+        AVX2,
+        AVX512,
+    };
+
+    explicit TopOfBookTable(size_t expected_symbols = 8192);
+
+    // Dense ids in order of first appearance
+    uint32_t add_symbol(const std::string& symbol);
+    int32_t symbol_id(const std::string& symbol) const;
+    const std::string& symbol(uint32_t symbol_id) const { return symbols_[symbol_id]; }
+    size_t size() const { return symbols_.size(); }
+
+    // A side with zero quantity is empty
+    void update(uint32_t symbol_id, double bid_price, uint32_t bid_qty,
+                double ask_price, uint32_t ask_qty);
+    void update(uint32_t symbol_id, const OrderBook& book);
+    bool top_of_book(uint32_t symbol_id, OrderBook& book) const;
+
+    // Ids of the symbols passing every bound, ascending
+    size_t screen(const ScreenQuery& query, std::vector<uint32_t>& ids) const;
+    // Id with the smallest/largest metric, or -1 if no symbol has it
+    int32_t min_index(TopMetric metric) const;
+    int32_t max_index(TopMetric metric) const;
+    // Up to k ids, best first
+    size_t top_k(TopMetric metric, size_t k, bool largest, std::vector<uint32_t>& ids) const;
+
+    Isa isa() const { return isa_; }
+    // Forces a narrower kernel set, e.g. to compare them; wider than the
+    // CPU supports is clamped
+    void set_isa(Isa isa);
+    static Isa best_isa();
+
+private:
+    static constexpr size_t BLOCK = 16;  // columns are padded to whole AVX-512 vectors
+
+    void grow(size_t symbols);
+    const float* metric_column(TopMetric metric, bool negate) const;
+
+    std::vector<std::string> symbols_;
+    std::unordered_map<std::string, uint32_t> index_;
+
+    // Empty sides hold a NaN price and zero quantity
+    std::vector<float> bid_price_;
+    std::vector<float> ask_price_;
+    std::vector<uint32_t> bid_qty_;
+    std::vector<uint32_t> ask_qty_;
+
+    Isa isa_;
+    mutable std::vector<float> scratch_;
+    mutable std::vector<std::pair<float, uint32_t>> heap_;
+};
+
+} // namespace trading
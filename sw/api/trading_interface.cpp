@@ -1,157 +1,345 @@
 #include "trading_interface.hpp"
+#include "basic_trading_accelerator.hpp"
+#include "book_snapshot.hpp"
+#include "broadcast_ring.hpp"
+#include "host_counters.hpp"
+#include "order_book_engine.hpp"
+#include "trace.hpp"
+#include "warm_state.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <unistd.h>
+#include <utility>
+
+#ifdef SIMULATION_MODE
+#include "sim_backend.hpp"
+#endif
 
 namespace trading {
 
-// Implementation class
+#ifdef SIMULATION_MODE
+// Register accesses go to a cycle-accurate model of the RTL
+using DeviceBackend = sim::SimBackend;
+#else
+using DeviceBackend = MmioBackend;
+#endif
+
+// Implementation class: the register protocol lives in
+// BasicTradingAccelerator; this adds the bookkeeping around it
 class TradingAccelerator::Impl {
 public:
-    Impl() : fd_(-1), base_addr_(nullptr) {}
-    ~Impl() {
-        if (base_addr_) {
-            #ifdef SIMULATION_MODE
-            free(base_addr_);
-            #else
-            munmap(base_addr_, MAP_SIZE);
-            #endif
-        }
-        if (fd_ >= 0) {
-            close(fd_);
-        }
-    }
+    Impl()
+        : startup_report_(), sim_report_(), host_report_(), host_sample_every_(0),
+          broadcast_(nullptr) {}
 
     bool initialize(const std::string& bitstream_path) {
         #ifdef SIMULATION_MODE
         std::cout << "Running in simulation mode" << std::endl;
-        base_addr_ = malloc(MAP_SIZE);
-        if (!base_addr_) {
-            std::cerr << "Failed to allocate simulation memory" << std::endl;
+        #endif
+        if (!device_.initialize()) {
             return false;
         }
-        // Initialize simulation memory with some test data
-        volatile uint32_t* regs = static_cast<volatile uint32_t*>(base_addr_);
-        regs[REG_STATUS] = 1;  // Ready
-        regs[REG_LATENCY] = 100;  // 100ns latency
-        regs[REG_THROUGHPUT] = 1000000;  // 1M orders/sec
+        #ifdef SIMULATION_MODE
+        sim_report_.clock_mhz = 1000.0 / device_.backend().cycle_ns();
+        device_.backend().device().set_egress_handler(egress_);
+        #endif
         return true;
-        #else
-        // Open PCIe device
-        fd_ = open("/dev/xdma0", O_RDWR);
-        if (fd_ < 0) {
-            std::cerr << "Failed to open PCIe device" << std::endl;
+    }
+
+    bool initialize(const std::string& bitstream_path, const StartupOptions& options) {
+        const auto start = std::chrono::steady_clock::now();
+        auto elapsed_ns = [&start]() {
+            return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        };
+
+        startup_report_ = StartupReport();
+        if (!initialize(bitstream_path)) {
             return false;
         }
+        if (!options.warm_state_path.empty() && !attach_warm_state(options.warm_state_path)) {
+            return false;
+        }
+        startup_report_.warm_attach_ns = elapsed_ns();
+        if (options.snapshot_path.empty()) {
+            return true;
+        }
 
-        // Map BAR0 memory region
-        base_addr_ = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, 
-                         MAP_SHARED, fd_, 0);
-        if (base_addr_ == MAP_FAILED) {
-            std::cerr << "Failed to map BAR0 memory" << std::endl;
-            close(fd_);
-            fd_ = -1;
+        BookSnapshot snapshot;
+        if (!load_book_snapshot(options.snapshot_path, snapshot)) {
             return false;
         }
+        startup_report_.snapshot_load_ns = elapsed_ns();
 
-        return true;
+        if (options.software_book) {
+            options.software_book->load(snapshot);
+            startup_report_.software_levels = snapshot.level_count();
+        }
+
+        const SymbolDepth* depth = nullptr;
+        for (const SymbolDepth& candidate : snapshot.symbols) {
+            if (options.device_symbol.empty() || candidate.symbol == options.device_symbol) {
+                depth = &candidate;
+                break;
+            }
+        }
+        if (!depth) {
+            std::cerr << "Snapshot has no depth for " << options.device_symbol << std::endl;
+            return false;
+        }
+        if (!device_.load_book(*depth)) {
+            return false;
+        }
+        startup_report_.device_levels = depth->bids.size() + depth->asks.size();
+
+        // Every loaded level has been applied, so the next read is valid
+        OrderBook book;
+        if (!get_order_book(depth->symbol, book)) {
+            return false;
+        }
+        startup_report_.time_to_first_book_ns = elapsed_ns();
+        #ifdef SIMULATION_MODE
+        startup_report_.device_cycles = device_.backend().cycles();
         #endif
+        return true;
+    }
+
+    // Reattaches to (or creates) the warm-restart state and resumes the
+    // order token sequence where the previous process left off
+    bool attach_warm_state(const std::string& path) {
+        std::unique_ptr<WarmState> state(new WarmState());
+        if (!state->open(path)) {
+            return false;
+        }
+        if (state->next_order_id() != 0) {
+            device_.set_next_order_id(state->next_order_id());
+        }
+        startup_report_.warm_reattached = state->reattached();
+        startup_report_.warm_orders = state->order_count();
+        warm_state_ = std::move(state);
+        return true;
+    }
+
+    WarmState* warm_state() {
+        return warm_state_.get();
+    }
+
+    bool get_startup_report(StartupReport& report) {
+        report = startup_report_;
+        return true;
     }
 
     bool send_market_data(const MarketData& data) {
-        // Convert price to fixed-point representation
-        uint64_t fixed_price = double_to_fixed(data.price);
-        
-        // Write to FPGA registers
-        volatile uint32_t* regs = static_cast<volatile uint32_t*>(base_addr_);
-        
-        // Write symbol (assumed to be 4 characters max)
-        regs[REG_SYMBOL] = *reinterpret_cast<const uint32_t*>(data.symbol.c_str());
-        
-        // Write price (high and low 32-bits)
-        regs[REG_PRICE_H] = static_cast<uint32_t>(fixed_price >> 32);
-        regs[REG_PRICE_L] = static_cast<uint32_t>(fixed_price);
-        
-        // Write quantity
-        regs[REG_QUANTITY] = data.quantity;
-        
-        // Write control (is_bid and valid)
-        uint32_t control = (data.is_bid ? 2 : 0) | 1;
-        regs[REG_CONTROL] = control;
-        
-        // Wait for acknowledgment
-        while ((regs[REG_STATUS] & 1) == 0) {
-            // Add timeout if needed
-        }
-        
+        CallScope scope(this, sim_report_.send_market_data, host_report_.send_market_data);
+        TRACE_SCOPE(trace::SEND_MARKET_DATA, data.quantity);
+        if (!device_.send_market_data(data)) {
+            return false;
+        }
+
+        if (broadcast_) {
+            BookUpdate update{};
+            update.timestamp_ns = static_cast<uint64_t>(data.timestamp.count());
+            update.price = device_.double_to_fixed(data.price);
+            update.quantity = data.quantity;
+            update.is_bid = data.is_bid;
+            std::memcpy(update.symbol, data.symbol.data(),
+                        std::min(data.symbol.size(), sizeof(update.symbol)));
+            broadcast_->publish(update);
+        }
         return true;
     }
 
+    size_t send_market_data(const BookUpdate* updates, size_t count) {
+        CallScope scope(this, sim_report_.send_market_data, host_report_.send_market_data);
+        TRACE_SCOPE(trace::SEND_MARKET_DATA, static_cast<uint32_t>(count));
+        for (size_t i = 0; i < count; ++i) {
+            const BookUpdate& update = updates[i];
+            // NUL padding makes the leading bytes what pack_symbol() would give
+            uint32_t symbol = 0;
+            std::memcpy(&symbol, update.symbol, sizeof(symbol));
+            if (!device_.send_market_data(symbol, update.price, update.quantity, update.is_bid)) {
+                return i;
+            }
+            if (broadcast_) {
+                broadcast_->publish(update);
+            }
+        }
+        return count;
+    }
+
     bool get_order_book(const std::string& symbol, OrderBook& book) {
-        volatile uint32_t* regs = static_cast<volatile uint32_t*>(base_addr_);
-        
-        // Request order book for symbol
-        regs[REG_SYMBOL] = *reinterpret_cast<const uint32_t*>(symbol.c_str());
-        regs[REG_CONTROL] = 4; // Request order book command
-        
-        // Wait for valid data
-        while ((regs[REG_STATUS] & 2) == 0) {
-            // Add timeout if needed
-        }
-        
-        // Read best bid/ask prices and quantities
-        uint64_t best_bid = (static_cast<uint64_t>(regs[REG_BEST_BID_H]) << 32) |
-                            regs[REG_BEST_BID_L];
-        uint64_t best_ask = (static_cast<uint64_t>(regs[REG_BEST_ASK_H]) << 32) |
-                            regs[REG_BEST_ASK_L];
-        
-        book.best_bid_price = fixed_to_double(best_bid);
-        book.best_ask_price = fixed_to_double(best_ask);
-        book.best_bid_qty = regs[REG_BEST_BID_QTY];
-        book.best_ask_qty = regs[REG_BEST_ASK_QTY];
-        
+        CallScope scope(this, sim_report_.get_order_book, host_report_.get_order_book);
+        TRACE_SCOPE(trace::GET_ORDER_BOOK, 0);
+        (void)symbol;  // the book manager holds a single instrument
+        return device_.get_order_book(book);
+    }
+
+    bool get_book_read_stats(BookReadStats& stats) {
+        stats = device_.book_read_stats();
+        return true;
+    }
+
+    void attach_broadcast(BookUpdateRing* ring) {
+        broadcast_ = ring;
+    }
+
+    bool set_order_egress(OrderEgressHandler handler) {
+        #ifdef SIMULATION_MODE
+        egress_ = std::move(handler);
+        if (device_.backend().is_open()) {
+            device_.backend().device().set_egress_handler(egress_);
+        }
+        return true;
+        #else
+        (void)handler;
+        return false;
+        #endif
+    }
+
+    bool place_order(const std::string& symbol, double price,
+                     uint32_t quantity, bool is_buy, uint64_t& order_id) {
+        CallScope scope(this, sim_report_.place_order, host_report_.place_order);
+        TRACE_SCOPE(trace::PLACE_ORDER, quantity);
+        if (!device_.place_order(symbol, price, quantity, is_buy, order_id)) {
+            return false;
+        }
+
+        if (warm_state_) {
+            int32_t symbol_id = warm_state_->add_symbol(symbol);
+            if (symbol_id >= 0) {
+                WarmOrder order{};
+                order.order_id = order_id;
+                order.price = device_.double_to_fixed(price);
+                order.symbol_id = static_cast<uint32_t>(symbol_id);
+                order.quantity = quantity;
+                order.is_buy = is_buy;
+                warm_state_->add_order(order);
+            }
+            warm_state_->set_next_order_id(order_id + 1);
+            warm_state_->commit();
+        }
+        return true;
+    }
+
+    bool cancel_order(uint64_t order_id) {
+        CallScope scope(this, sim_report_.cancel_order, host_report_.cancel_order);
+        TRACE_SCOPE(trace::CANCEL_ORDER, static_cast<uint32_t>(order_id));
+        if (!device_.cancel_order(order_id)) {
+            return false;
+        }
+
+        // No exchange acknowledgements come back through this interface,
+        // so the order is closed once the cancel has been sent
+        if (warm_state_ && warm_state_->remove_order(order_id)) {
+            warm_state_->commit();
+        }
         return true;
     }
 
     double get_latency_ns() {
-        volatile uint32_t* regs = static_cast<volatile uint32_t*>(base_addr_);
-        return static_cast<double>(regs[REG_LATENCY]);
+        return device_.get_latency_ns();
     }
 
     uint64_t get_throughput_orders_per_sec() {
-        volatile uint32_t* regs = static_cast<volatile uint32_t*>(base_addr_);
-        return static_cast<uint64_t>(regs[REG_THROUGHPUT]);
+        return device_.get_throughput_orders_per_sec();
     }
 
-private:
-    static constexpr size_t MAP_SIZE = 4096;
-    static constexpr uint32_t REG_SYMBOL = 0;
-    static constexpr uint32_t REG_PRICE_H = 1;
-    static constexpr uint32_t REG_PRICE_L = 2;
-    static constexpr uint32_t REG_QUANTITY = 3;
-    static constexpr uint32_t REG_CONTROL = 4;
-    static constexpr uint32_t REG_STATUS = 5;
-    static constexpr uint32_t REG_BEST_BID_H = 6;
-    static constexpr uint32_t REG_BEST_BID_L = 7;
-    static constexpr uint32_t REG_BEST_ASK_H = 8;
-    static constexpr uint32_t REG_BEST_ASK_L = 9;
-    static constexpr uint32_t REG_BEST_BID_QTY = 10;
-    static constexpr uint32_t REG_BEST_ASK_QTY = 11;
-    static constexpr uint32_t REG_LATENCY = 12;
-    static constexpr uint32_t REG_THROUGHPUT = 13;
-
-    int fd_;
-    void* base_addr_;
-
-    // Convert between double and fixed-point representation
-    static uint64_t double_to_fixed(double value) {
-        return static_cast<uint64_t>(value * 1000000.0); // 6 decimal places
-    }
-
-    static double fixed_to_double(uint64_t value) {
-        return static_cast<double>(value) / 1000000.0;
+    bool read_perf_counters(PerfCounters& counters) {
+        return device_.read_perf_counters(counters);
+    }
+
+    bool read_latency_histograms(LatencyHistograms& histograms) {
+        return device_.read_latency_histograms(histograms);
+    }
+
+    bool get_sim_cycle_report(SimCycleReport& report) {
+        #ifdef SIMULATION_MODE
+        report = sim_report_;
+        return true;
+        #else
+        (void)report;
+        return false;
+        #endif
+    }
+
+    bool enable_host_counters(uint32_t sample_every) {
+        HostCounters* counters = HostCounters::for_this_thread();
+        if (!counters) {
+            return false;
+        }
+        host_report_ = HostCounterReport();
+        host_report_.sample_every = std::max<uint32_t>(sample_every, 1);
+        host_report_.available = counters->available();
+        host_sample_every_ = host_report_.sample_every;
+        return true;
+    }
+
+    void disable_host_counters() {
+        host_sample_every_ = 0;
     }
+
+    bool get_host_counter_report(HostCounterReport& report) {
+        report = host_report_;
+        return host_report_.sample_every != 0;
+    }
+
+private:
+    BasicTradingAccelerator<DeviceBackend> device_;
+    StartupReport startup_report_;
+    SimCycleReport sim_report_;
+    HostCounterReport host_report_;
+    uint32_t host_sample_every_;  // 0 while host counters are off
+    std::unique_ptr<WarmState> warm_state_;
+    BookUpdateRing* broadcast_;
+    OrderEgressHandler egress_;
+
+    // Counts simulated device cycles spent in one API call and, on sampled
+    // calls, host CPU events. The host counters are read innermost so the
+    // bookkeeping stays out of the deltas.
+    class CallScope {
+    public:
+        CallScope(Impl* impl, SimCycleStats& sim_stats, HostCounterStats& host_stats)
+            : impl_(impl), sim_stats_(sim_stats), host_stats_(host_stats), host_counters_(nullptr) {
+            #ifdef SIMULATION_MODE
+            sim_start_ = impl->device_.backend().cycles();
+            #endif
+            uint32_t every = impl->host_sample_every_;
+            if (every != 0 && ++host_stats.calls % every == 0) {
+                host_counters_ = HostCounters::for_this_thread();
+                if (host_counters_ && !host_counters_->read(host_start_)) {
+                    host_counters_ = nullptr;
+                }
+            }
+        }
+        ~CallScope() {
+            uint64_t host_end[HOST_NUM_EVENTS];
+            if (host_counters_ && host_counters_->read(host_end)) {
+                ++host_stats_.sampled;
+                host_stats_.task_clock_ns += host_end[HOST_TASK_CLOCK] - host_start_[HOST_TASK_CLOCK];
+                host_stats_.cycles += host_end[HOST_CYCLES] - host_start_[HOST_CYCLES];
+                host_stats_.instructions += host_end[HOST_INSTRUCTIONS] - host_start_[HOST_INSTRUCTIONS];
+                host_stats_.l1d_misses += host_end[HOST_L1D_MISSES] - host_start_[HOST_L1D_MISSES];
+                host_stats_.llc_misses += host_end[HOST_LLC_MISSES] - host_start_[HOST_LLC_MISSES];
+                host_stats_.dtlb_misses += host_end[HOST_DTLB_MISSES] - host_start_[HOST_DTLB_MISSES];
+                host_stats_.branch_misses += host_end[HOST_BRANCH_MISSES] - host_start_[HOST_BRANCH_MISSES];
+            }
+            #ifdef SIMULATION_MODE
+            ++sim_stats_.calls;
+            sim_stats_.cycles += impl_->device_.backend().cycles() - sim_start_;
+            #endif
+        }
+
+    private:
+        Impl* impl_;
+        SimCycleStats& sim_stats_;
+        HostCounterStats& host_stats_;
+        HostCounters* host_counters_;
+        uint64_t host_start_[HOST_NUM_EVENTS];
+        #ifdef SIMULATION_MODE
+        uint64_t sim_start_;
+        #endif
+    };
 };
 
 // Public interface implementation
@@ -162,24 +350,57 @@ bool TradingAccelerator::initialize(const std::string& bitstream_path) {
     return impl_->initialize(bitstream_path);
 }
 
+bool TradingAccelerator::initialize(const std::string& bitstream_path,
+                                    const StartupOptions& options) {
+    return impl_->initialize(bitstream_path, options);
+}
+
+bool TradingAccelerator::get_startup_report(StartupReport& report) {
+    return impl_->get_startup_report(report);
+}
+
+WarmState* TradingAccelerator::warm_state() {
+    return impl_->warm_state();
+}
+
 bool TradingAccelerator::send_market_data(const MarketData& data) {
     return impl_->send_market_data(data);
 }
 
+size_t TradingAccelerator::send_market_data(const BookUpdate* updates, size_t count) {
+    return impl_->send_market_data(updates, count);
+}
+
 bool TradingAccelerator::get_order_book(const std::string& symbol, OrderBook& book) {
     return impl_->get_order_book(symbol, book);
 }
 
+bool TradingAccelerator::get_book_read_stats(BookReadStats& stats) {
+    return impl_->get_book_read_stats(stats);
+}
+
+void TradingAccelerator::attach_broadcast(BroadcastRing<BookUpdate>* ring) {
+    impl_->attach_broadcast(ring);
+}
+
 bool TradingAccelerator::place_order(const std::string& symbol, double price,
                                    uint32_t quantity, bool is_buy) {
-    MarketData data{symbol, price, quantity, is_buy,
-                   std::chrono::nanoseconds(0)};
-    return send_market_data(data);
+    uint64_t order_id;
+    return impl_->place_order(symbol, price, quantity, is_buy, order_id);
+}
+
+bool TradingAccelerator::place_order(const std::string& symbol, double price,
+                                   uint32_t quantity, bool is_buy,
+                                   uint64_t& order_id) {
+    return impl_->place_order(symbol, price, quantity, is_buy, order_id);
 }
 
 bool TradingAccelerator::cancel_order(uint64_t order_id) {
-    // Not implemented in this version
-    return false;
+    return impl_->cancel_order(order_id);
+}
+
+bool TradingAccelerator::set_order_egress(OrderEgressHandler handler) {
+    return impl_->set_order_egress(std::move(handler));
 }
 
 double TradingAccelerator::get_latency_ns() {
@@ -190,4 +411,54 @@ uint64_t TradingAccelerator::get_throughput_orders_per_sec() {
     return impl_->get_throughput_orders_per_sec();
 }
 
+bool TradingAccelerator::read_perf_counters(PerfCounters& counters) {
+    return impl_->read_perf_counters(counters);
+}
+
+bool TradingAccelerator::read_latency_histograms(LatencyHistograms& histograms) {
+    return impl_->read_latency_histograms(histograms);
+}
+
+uint64_t LatencyHistogram::samples() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        total += buckets[i];
+    }
+    return total;
+}
+
+double LatencyHistogram::quantile_ns(double q) const {
+    uint64_t total = samples();
+    if (total == 0) {
+        return 0.0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    size_t bucket = 0;
+    for (; bucket < NUM_BUCKETS; ++bucket) {
+        seen += buckets[bucket];
+        if (seen >= rank) {
+            break;
+        }
+    }
+    return bucket == 0 ? 0.0 : static_cast<double>(1ull << bucket) * cycle_ns;
+}
+
+bool TradingAccelerator::get_sim_cycle_report(SimCycleReport& report) {
+    return impl_->get_sim_cycle_report(report);
+}
+
+bool TradingAccelerator::enable_host_counters(uint32_t sample_every) {
+    return impl_->enable_host_counters(sample_every);
+}
+
+void TradingAccelerator::disable_host_counters() {
+    impl_->disable_host_counters();
+}
+
+bool TradingAccelerator::get_host_counter_report(HostCounterReport& report) {
+    return impl_->get_host_counter_report(report);
+}
+
 } // namespace trading
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -8,6 +10,12 @@
 
 namespace trading {
 
+class OrderBookEngine;
+class WarmState;
+struct BookUpdate;
+template <typename T>
+class BroadcastRing;
+
 struct MarketData {
     std::string symbol;
     double price;
@@ -22,8 +30,108 @@ struct OrderBook {
     uint32_t best_bid_qty;
     uint32_t best_ask_qty;
     std::chrono::nanoseconds timestamp;
+    uint32_t generation;  // book updates applied when the snapshot was taken
+};
+
+// get_order_book() snapshot reads; a retry is a torn snapshot read again
+struct BookReadStats {
+    uint64_t reads;
+    uint64_t retries;
 };
 
+// Free-running device counters, sampled atomically by read_perf_counters()
+struct PerfCounters {
+    uint64_t parser_in;               // messages accepted by the parser
+    uint64_t parser_out;              // messages parsed
+    uint64_t book_in;                 // updates offered to the book manager
+    uint64_t book_out;                // book refreshes
+    uint64_t engine_in;               // order commands accepted by the trade engine
+    uint64_t engine_out;              // order messages sent to the exchange gateway
+    uint64_t parser_stall_cycles;     // beats offered but not accepted
+    uint64_t order_stall_cycles;      // order commands waiting on the encoder
+    uint64_t tx_backpressure_cycles;  // encoder waiting on the gateway
+    uint64_t dropped_updates;         // book updates lost (busy or full)
+    uint64_t cycles;
+};
+
+// Log2-bucketed device latency distribution: bucket 0 counts samples of
+// zero cycles, bucket k samples of [2^(k-1), 2^k) cycles
+struct LatencyHistogram {
+    static constexpr size_t NUM_BUCKETS = 32;
+    uint32_t buckets[NUM_BUCKETS];
+    double cycle_ns;
+
+    uint64_t samples() const;
+    // Upper bound of the bucket holding quantile q (0..1), in ns
+    double quantile_ns(double q) const;
+};
+
+// In-fabric latency distributions since the previous read
+struct LatencyHistograms {
+    LatencyHistogram ingress_to_book;  // parser ingress to book update
+    LatencyHistogram book_to_order;    // book update to next order command
+};
+
+// Optional work done by initialize() before it returns
+struct StartupOptions {
+    std::string snapshot_path;                 // book snapshot to restore, empty for none
+    std::string device_symbol;                 // symbol for the device book, default first
+    OrderBookEngine* software_book = nullptr;  // also restored from the snapshot when set
+    std::string warm_state_path;               // symbols, open orders and positions to reattach
+};
+
+struct StartupReport {
+    size_t device_levels;
+    size_t software_levels;
+    double snapshot_load_ns;       // reading and validating the snapshot file
+    double time_to_first_book_ns;  // initialize() entry to the first valid top of book
+    uint64_t device_cycles;        // simulation backend: device cycles to the same point
+    bool warm_reattached;          // warm state came from a previous process
+    uint32_t warm_orders;          // open orders found in it
+    double warm_attach_ns;         // initialize() entry to the warm state being usable
+};
+
+// Simulated device cycles spent in one API entry point
+struct SimCycleStats {
+    uint64_t calls;
+    uint64_t cycles;
+};
+
+struct SimCycleReport {
+    SimCycleStats send_market_data;
+    SimCycleStats get_order_book;
+    SimCycleStats place_order;
+    SimCycleStats cancel_order;
+    double clock_mhz;
+};
+
+// Host CPU events spent in one API entry point, summed over the sampled
+// calls. Events the host does not expose stay zero; see
+// HostCounterReport::available.
+struct HostCounterStats {
+    uint64_t calls;          // calls while counting was enabled
+    uint64_t sampled;        // calls the counters were read around
+    uint64_t task_clock_ns;
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t l1d_misses;
+    uint64_t llc_misses;
+    uint64_t dtlb_misses;
+    uint64_t branch_misses;
+};
+
+struct HostCounterReport {
+    HostCounterStats send_market_data;
+    HostCounterStats get_order_book;
+    HostCounterStats place_order;
+    HostCounterStats cancel_order;
+    uint32_t sample_every;
+    uint32_t available;  // bit per HostEvent (host_counters.hpp) counted
+};
+
+// Receives each SoupBinTCP-framed OUCH message the device sends
+using OrderEgressHandler = std::function<void(const uint8_t* frame, size_t length)>;
+
 class TradingAccelerator {
 public:
     TradingAccelerator();
@@ -31,19 +139,49 @@ public:
 
     // Initialize the FPGA and PCIe connection
     bool initialize(const std::string& bitstream_path);
+    // Also restores books from a snapshot, see StartupOptions
+    bool initialize(const std::string& bitstream_path, const StartupOptions& options);
+    bool get_startup_report(StartupReport& report);
+    // Warm-restart state when initialized with a warm_state_path, else null.
+    // place_order and cancel_order keep it current and commit after each call.
+    WarmState* warm_state();
 
     // Market data interface
     bool send_market_data(const MarketData& data);
+    // Delivers a batch of already-packed updates under one accounting scope;
+    // returns how many were delivered before the first failure
+    size_t send_market_data(const BookUpdate* updates, size_t count);
     bool get_order_book(const std::string& symbol, OrderBook& book);
+    bool get_book_read_stats(BookReadStats& stats);
+    // Publishes every update send_market_data() delivers to consumers of
+    // the ring (broadcast_ring.hpp); null detaches
+    void attach_broadcast(BroadcastRing<BookUpdate>* ring);
 
     // Trading interface
     bool place_order(const std::string& symbol, double price, 
                     uint32_t quantity, bool is_buy);
+    bool place_order(const std::string& symbol, double price,
+                    uint32_t quantity, bool is_buy, uint64_t& order_id);
     bool cancel_order(uint64_t order_id);
+    // Simulation backend only: where the simulated order entry encoder's
+    // frames go, e.g. to an exchange simulator. The card sends its own.
+    bool set_order_egress(OrderEgressHandler handler);
 
     // Performance monitoring
     double get_latency_ns();
     uint64_t get_throughput_orders_per_sec();
+    bool read_perf_counters(PerfCounters& counters);
+    // Snapshots and clears both histograms in one device cycle
+    bool read_latency_histograms(LatencyHistograms& histograms);
+
+    // Simulation backend only: device cycles per API call
+    bool get_sim_cycle_report(SimCycleReport& report);
+
+    // Reads host CPU counters (perf_event_open) around every sample_every-th
+    // call of each entry point. Fails if the kernel does not allow it.
+    bool enable_host_counters(uint32_t sample_every = 1);
+    void disable_host_counters();
+    bool get_host_counter_report(HostCounterReport& report);
 
 private:
     class Impl;
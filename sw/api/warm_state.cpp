@@ -0,0 +1,361 @@
+#include "warm_state.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+
+constexpr size_t PAGE_SIZE = 4096;
+
+constexpr size_t page_round(size_t len) {
+    return (len + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+}
+
+} // namespace
+
+struct WarmState::Header {
+    uint32_t magic;  // written last on creation
+    uint16_t version;
+    uint16_t header_len;
+    uint32_t max_symbols;
+    uint32_t max_orders;
+    uint64_t slot_size;
+    uint64_t commit;  // generation << 1 | committed slot
+};
+
+struct WarmState::Slot {
+    uint32_t symbol_count;
+    uint32_t order_count;
+    uint64_t next_order_id;
+    WarmSymbol symbols[warm::MAX_SYMBOLS];
+    WarmPosition positions[warm::MAX_SYMBOLS];
+    WarmOrder orders[warm::MAX_ORDERS];
+};
+
+const size_t WarmState::SLOT_SIZE = page_round(sizeof(WarmState::Slot));
+const size_t WarmState::FILE_SIZE = PAGE_SIZE + 2 * WarmState::SLOT_SIZE;
+
+bool WarmState::interrupted_creation(const Header& hdr) {
+    // open() fills in the header, then writes the magic: a file it was
+    // creating holds either zeros or this layout behind a zero magic
+    if (hdr.magic != 0) {
+        return false;
+    }
+    Header zero;
+    std::memset(&zero, 0, sizeof(zero));
+    if (std::memcmp(&hdr, &zero, sizeof(zero)) == 0) {
+        return true;
+    }
+    return hdr.version == warm::VERSION && hdr.header_len == sizeof(Header) &&
+           hdr.max_symbols == warm::MAX_SYMBOLS && hdr.max_orders == warm::MAX_ORDERS &&
+           hdr.slot_size == SLOT_SIZE && hdr.commit == 1ull << 1;
+}
+
+WarmState::WarmState()
+    : fd_(-1), base_(nullptr), file_size_(0), working_(1), reattached_(false) {}
+
+WarmState::~WarmState() {
+    close();
+}
+
+bool WarmState::open(const std::string& path) {
+    static_assert(sizeof(Header) <= PAGE_SIZE, "header must fit its page");
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open warm state " << path << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        std::cerr << "Failed to stat warm state " << path << std::endl;
+        close();
+        return false;
+    }
+    // Only an empty file is new: open() just created it, or a crash came
+    // before it was sized. A short file with anything in it is someone's
+    // data, so it is reported below rather than overwritten.
+    bool fresh = st.st_size == 0;
+    if (fresh && ftruncate(fd_, FILE_SIZE) != 0) {
+        std::cerr << "Failed to size warm state " << path << std::endl;
+        close();
+        return false;
+    }
+    if (!fresh && static_cast<size_t>(st.st_size) < FILE_SIZE) {
+        std::cerr << "Warm state " << path << " is truncated" << std::endl;
+        close();
+        return false;
+    }
+
+    void* base = mmap(nullptr, FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (base == MAP_FAILED) {
+        std::cerr << "Failed to map warm state " << path << std::endl;
+        close();
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(base);
+    file_size_ = FILE_SIZE;
+    dirty_pages_.assign(SLOT_SIZE / PAGE_SIZE, 0);
+
+    Header* hdr = header();
+    if (!fresh && hdr->magic != warm::MAGIC && !interrupted_creation(*hdr)) {
+        // Someone else's file, or the wrong path: leave it alone
+        std::cerr << "Warm state " << path << " is not a warm state file (magic 0x" << std::hex
+                  << hdr->magic << std::dec << ")" << std::endl;
+        close();
+        return false;
+    }
+    if (hdr->magic != warm::MAGIC) {
+        // A new file, or creation crashed before the magic was written:
+        // both slots are zero, i.e. an empty committed state
+        std::memset(base_, 0, FILE_SIZE);
+        hdr->version = warm::VERSION;
+        hdr->header_len = sizeof(Header);
+        hdr->max_symbols = warm::MAX_SYMBOLS;
+        hdr->max_orders = warm::MAX_ORDERS;
+        hdr->slot_size = SLOT_SIZE;
+        hdr->commit = 1ull << 1;
+        msync(base_, PAGE_SIZE, MS_SYNC);
+        hdr->magic = warm::MAGIC;
+        msync(base_, PAGE_SIZE, MS_SYNC);
+        reattached_ = false;
+    } else {
+        if (hdr->version != warm::VERSION || hdr->max_symbols != warm::MAX_SYMBOLS ||
+            hdr->max_orders != warm::MAX_ORDERS || hdr->slot_size != SLOT_SIZE) {
+            std::cerr << "Warm state " << path << " has an incompatible layout (version "
+                      << hdr->version << ")" << std::endl;
+            close();
+            return false;
+        }
+        reattached_ = true;
+    }
+
+    // Work on a copy of the committed slot
+    uint32_t committed = static_cast<uint32_t>(hdr->commit & 1);
+    working_ = committed ^ 1;
+    std::memcpy(working(), slot(committed), SLOT_SIZE);
+    rebuild_indexes();
+    return true;
+}
+
+void WarmState::close() {
+    if (base_) {
+        munmap(base_, file_size_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    symbol_index_.clear();
+    order_index_.clear();
+    reattached_ = false;
+}
+
+WarmState::Header* WarmState::header() const {
+    return reinterpret_cast<Header*>(base_);
+}
+
+WarmState::Slot* WarmState::slot(uint32_t index) const {
+    return reinterpret_cast<Slot*>(base_ + PAGE_SIZE + index * SLOT_SIZE);
+}
+
+void WarmState::mark_dirty(const void* p, size_t len) {
+    size_t offset = static_cast<const uint8_t*>(p) - reinterpret_cast<const uint8_t*>(working());
+    for (size_t page = offset / PAGE_SIZE; page <= (offset + len - 1) / PAGE_SIZE; ++page) {
+        dirty_pages_[page] = 1;
+    }
+}
+
+void WarmState::rebuild_indexes() {
+    const Slot* s = working();
+    symbol_index_.clear();
+    for (uint32_t i = 0; i < s->symbol_count; ++i) {
+        symbol_index_[symbol_name(i)] = i;
+    }
+    order_index_.clear();
+    for (uint32_t i = 0; i < s->order_count; ++i) {
+        order_index_[s->orders[i].order_id] = i;
+    }
+}
+
+int32_t WarmState::symbol_id(const std::string& symbol) const {
+    auto it = symbol_index_.find(symbol);
+    return it == symbol_index_.end() ? -1 : static_cast<int32_t>(it->second);
+}
+
+int32_t WarmState::add_symbol(const std::string& symbol) {
+    int32_t id = symbol_id(symbol);
+    if (id >= 0) {
+        return id;
+    }
+
+    Slot* s = working();
+    if (s->symbol_count >= warm::MAX_SYMBOLS || symbol.size() > warm::SYMBOL_LEN) {
+        std::cerr << "Cannot add symbol " << symbol << " to warm state" << std::endl;
+        return -1;
+    }
+    uint32_t index = s->symbol_count;
+    WarmSymbol& entry = s->symbols[index];
+    std::memset(entry.symbol, 0, sizeof(entry.symbol));
+    std::memcpy(entry.symbol, symbol.data(), symbol.size());
+    s->positions[index] = WarmPosition{0, 0};
+    s->symbol_count = index + 1;
+    mark_dirty(&entry, sizeof(entry));
+    mark_dirty(&s->positions[index], sizeof(WarmPosition));
+    mark_dirty(s, sizeof(s->symbol_count));
+    symbol_index_[symbol] = index;
+    return static_cast<int32_t>(index);
+}
+
+uint32_t WarmState::symbol_count() const {
+    return working()->symbol_count;
+}
+
+std::string WarmState::symbol_name(uint32_t symbol_id) const {
+    const WarmSymbol& entry = working()->symbols[symbol_id];
+    return std::string(entry.symbol, strnlen(entry.symbol, sizeof(entry.symbol)));
+}
+
+bool WarmState::add_order(const WarmOrder& order) {
+    Slot* s = working();
+    if (s->order_count >= warm::MAX_ORDERS || order.symbol_id >= s->symbol_count ||
+        order_index_.count(order.order_id)) {
+        std::cerr << "Cannot add order " << order.order_id << " to warm state" << std::endl;
+        return false;
+    }
+    uint32_t index = s->order_count;
+    s->orders[index] = order;
+    s->order_count = index + 1;
+    mark_dirty(&s->orders[index], sizeof(WarmOrder));
+    mark_dirty(s, sizeof(s->symbol_count) + sizeof(s->order_count));
+    order_index_[order.order_id] = index;
+    return true;
+}
+
+bool WarmState::remove_order(uint64_t order_id) {
+    auto it = order_index_.find(order_id);
+    if (it == order_index_.end()) {
+        return false;
+    }
+
+    // Keep the table dense: move the last order into the hole
+    Slot* s = working();
+    uint32_t index = it->second;
+    uint32_t last = s->order_count - 1;
+    order_index_.erase(it);
+    if (index != last) {
+        s->orders[index] = s->orders[last];
+        order_index_[s->orders[index].order_id] = index;
+        mark_dirty(&s->orders[index], sizeof(WarmOrder));
+    }
+    s->order_count = last;
+    mark_dirty(s, sizeof(s->symbol_count) + sizeof(s->order_count));
+    return true;
+}
+
+const WarmOrder* WarmState::find_order(uint64_t order_id) const {
+    auto it = order_index_.find(order_id);
+    return it == order_index_.end() ? nullptr : &working()->orders[it->second];
+}
+
+uint32_t WarmState::order_count() const {
+    return working()->order_count;
+}
+
+const WarmOrder* WarmState::orders() const {
+    return working()->orders;
+}
+
+bool WarmState::apply_fill(uint64_t order_id, uint32_t quantity, uint64_t price) {
+    auto it = order_index_.find(order_id);
+    if (it == order_index_.end()) {
+        return false;
+    }
+
+    Slot* s = working();
+    WarmOrder& order = s->orders[it->second];
+    quantity = std::min(quantity, order.quantity);
+    WarmPosition& position = s->positions[order.symbol_id];
+    int64_t signed_qty = order.is_buy ? quantity : -static_cast<int64_t>(quantity);
+    position.quantity += signed_qty;
+    position.cost += signed_qty * static_cast<int64_t>(price);
+    mark_dirty(&position, sizeof(position));
+
+    order.quantity -= quantity;
+    order.filled += quantity;
+    mark_dirty(&order, sizeof(order));
+    if (order.quantity == 0) {
+        remove_order(order_id);
+    }
+    return true;
+}
+
+WarmPosition WarmState::position(uint32_t symbol_id) const {
+    return working()->positions[symbol_id];
+}
+
+uint64_t WarmState::next_order_id() const {
+    return working()->next_order_id;
+}
+
+void WarmState::set_next_order_id(uint64_t order_id) {
+    Slot* s = working();
+    s->next_order_id = order_id;
+    mark_dirty(&s->next_order_id, sizeof(s->next_order_id));
+}
+
+bool WarmState::commit(bool durable) {
+    if (!base_) {
+        return false;
+    }
+
+    Header* hdr = header();
+    uint8_t* work = reinterpret_cast<uint8_t*>(working());
+    if (durable) {
+        for (size_t page = 0; page < dirty_pages_.size(); ++page) {
+            if (dirty_pages_[page] && msync(work + page * PAGE_SIZE, PAGE_SIZE, MS_SYNC) != 0) {
+                std::cerr << "Failed to sync warm state" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // The slot contents must be visible before the commit word names it
+    uint64_t generation = (hdr->commit >> 1) + 1;
+    std::atomic_thread_fence(std::memory_order_release);
+    reinterpret_cast<std::atomic<uint64_t>*>(&hdr->commit)->store(
+        (generation << 1) | working_, std::memory_order_relaxed);
+    if (durable) {
+        msync(base_, PAGE_SIZE, MS_SYNC);
+    }
+
+    // Bring the other slot up to date and continue there
+    uint32_t committed = working_;
+    working_ ^= 1;
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(slot(committed));
+    uint8_t* dst = reinterpret_cast<uint8_t*>(working());
+    for (size_t page = 0; page < dirty_pages_.size(); ++page) {
+        if (dirty_pages_[page]) {
+            std::memcpy(dst + page * PAGE_SIZE, src + page * PAGE_SIZE, PAGE_SIZE);
+            dirty_pages_[page] = 0;
+        }
+    }
+    return true;
+}
+
+uint64_t WarmState::generation() const {
+    return base_ ? header()->commit >> 1 : 0;
+}
+
+} // namespace trading
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trading {
+
+// File layout of the warm-restart state. The file holds a header page and
+// two copies (slots) of the state. The header's commit word names the slot
+// holding the last committed state. Mutations only touch the other
+// (working) slot, and commit() publishes it with a single aligned 8-byte
+// store, so a crash at any point leaves a complete committed slot behind.
+namespace warm {
+
+constexpr uint32_t MAGIC = 0x53575446;  // "FTWS"
+constexpr uint16_t VERSION = 1;
+constexpr uint32_t MAX_SYMBOLS = 1024;
+constexpr uint32_t MAX_ORDERS = 16384;
+constexpr size_t SYMBOL_LEN = 8;
+
+} // namespace warm
+
+struct WarmSymbol {
+    char symbol[warm::SYMBOL_LEN];  // NUL padded
+};
+
+struct WarmOrder {
+    uint64_t order_id;
+    uint64_t price;      // 6 implied decimals
+    uint32_t symbol_id;
+    uint32_t quantity;   // still open
+    uint32_t filled;
+    uint8_t is_buy;
+    uint8_t reserved[3];
+};
+
+struct WarmPosition {
+    int64_t quantity;  // signed, long positive
+    int64_t cost;      // signed notional paid, 6 implied decimals
+};
+
+// Symbol directory, open orders and positions kept in a file-backed
+// shared mapping. A restarted process reattaches to the last commit point
+// instead of replaying journals; uncommitted changes are discarded.
+class WarmState {
+public:
+    WarmState();
+    ~WarmState();
+
+    WarmState(const WarmState&) = delete;
+    WarmState& operator=(const WarmState&) = delete;
+
+    // Creates the file, or reattaches to an existing one with this layout
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return base_ != nullptr; }
+    bool reattached() const { return reattached_; }
+
+    // Symbol directory; ids are dense and stable across restarts
+    int32_t symbol_id(const std::string& symbol) const;
+    int32_t add_symbol(const std::string& symbol);
+    uint32_t symbol_count() const;
+    std::string symbol_name(uint32_t symbol_id) const;
+
+    // Open orders
+    bool add_order(const WarmOrder& order);
+    bool remove_order(uint64_t order_id);
+    const WarmOrder* find_order(uint64_t order_id) const;
+    uint32_t order_count() const;
+    const WarmOrder* orders() const;
+
+    // Applies an execution to an open order and its symbol's position;
+    // the order is removed once fully filled
+    bool apply_fill(uint64_t order_id, uint32_t quantity, uint64_t price);
+    WarmPosition position(uint32_t symbol_id) const;
+
+    // Next order token sequence, restored into the encoder on reattach
+    uint64_t next_order_id() const;
+    void set_next_order_id(uint64_t order_id);
+
+    // Publishes the working slot. durable additionally syncs it to the
+    // file, which only matters for power loss; a process crash keeps
+    // everything already in the page cache.
+    bool commit(bool durable = false);
+    uint64_t generation() const;
+
+private:
+    struct Header;
+    struct Slot;
+
+    static const size_t SLOT_SIZE;
+    static const size_t FILE_SIZE;
+
+    static bool interrupted_creation(const Header& hdr);
+    Header* header() const;
+    Slot* slot(uint32_t index) const;
+    Slot* working() const { return slot(working_); }
+    void mark_dirty(const void* p, size_t len);
+    void rebuild_indexes();
+
+    int fd_;
+    uint8_t* base_;
+    size_t file_size_;
+    uint32_t working_;
+    bool reattached_;
+    std::vector<uint8_t> dirty_pages_;
+    std::unordered_map<std::string, uint32_t> symbol_index_;
+    std::unordered_map<uint64_t, uint32_t> order_index_;
+};
+
+} // namespace trading
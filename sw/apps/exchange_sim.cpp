@@ -0,0 +1,64 @@
+#include "exchange_server.hpp"
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+std::atomic<bool> stop(false);
+
+void on_signal(int) {
+    stop.store(true);
+}
+
+} // namespace
+
+// Local exchange for order round-trip tests: price-time matching over
+// OUCH on loopback TCP and/or a shared-memory link, with MoldUDP64/ITCH
+// level updates. Runs until interrupted.
+//
+//   exchange_sim --tcp 9000 --md-port 9001
+//   exchange_sim --shm /exchange_sim
+int main(int argc, char** argv) {
+    trading::exchange::ExchangeConfig config;
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--tcp") == 0 && has_value) {
+            config.tcp_port = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--md-port") == 0 && has_value) {
+            config.md_port = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--shm") == 0 && has_value) {
+            config.shm_name = argv[++i];
+        } else if (std::strcmp(argv[i], "--busy-poll") == 0) {
+            config.busy_poll = true;
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--tcp <port>] [--md-port <port>] [--shm <name>] [--busy-poll]"
+                      << std::endl;
+            return 1;
+        }
+    }
+    if (config.tcp_port == 0 && config.shm_name.empty()) {
+        config.tcp_port = 9000;
+    }
+
+    trading::exchange::ExchangeServer server(config);
+    if (!server.open()) {
+        return 1;
+    }
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::cout << "Exchange simulator ready" << std::endl;
+    server.run(stop);
+
+    trading::exchange::ExchangeStats stats = server.stats();
+    std::cout << "Sessions " << stats.sessions << ", messages in " << stats.messages_in
+              << ", out " << stats.messages_out << ", orders " << stats.matching.orders
+              << ", executions " << stats.matching.executions << ", cancels "
+              << stats.matching.cancels << ", rejects " << stats.matching.rejects
+              << ", market data packets " << stats.md_packets << ", slow sessions dropped "
+              << stats.slow_dropped << std::endl;
+    return 0;
+}
@@ -35,17 +35,71 @@ int main() {
     }
 
     // Print order book
-    std::cout << "Order Book for AAPL:" << std::endl;
+    std::cout << "Order Book for AAPL (generation " << book.generation << "):" << std::endl;
     std::cout << "Best Bid: " << book.best_bid_price << " (" 
               << book.best_bid_qty << " shares)" << std::endl;
     std::cout << "Best Ask: " << book.best_ask_price << " (" 
               << book.best_ask_qty << " shares)" << std::endl;
 
+    // Place an order inside the spread
+    uint64_t order_id;
+    if (!accelerator.place_order("AAPL", 150.30, 50, false, order_id)) {
+        std::cerr << "Failed to place order" << std::endl;
+        return 1;
+    }
+    std::cout << "Placed order " << order_id << std::endl;
+
     // Print performance metrics
     std::cout << "\nPerformance Metrics:" << std::endl;
     std::cout << "Latency: " << accelerator.get_latency_ns() << " ns" << std::endl;
     std::cout << "Throughput: " << accelerator.get_throughput_orders_per_sec() 
               << " orders/sec" << std::endl;
 
+    trading::BookReadStats book_reads;
+    if (accelerator.get_book_read_stats(book_reads)) {
+        std::cout << "Book reads: " << book_reads.reads << " (" << book_reads.retries
+                  << " torn and retried)" << std::endl;
+    }
+
+    trading::PerfCounters perf;
+    if (accelerator.read_perf_counters(perf)) {
+        std::cout << "\nPipeline counters (" << perf.cycles << " cycles):" << std::endl;
+        std::cout << "  Parser in/out: " << perf.parser_in << "/" << perf.parser_out
+                  << ", stalled " << perf.parser_stall_cycles << " cycles" << std::endl;
+        std::cout << "  Book in/out: " << perf.book_in << "/" << perf.book_out
+                  << ", dropped " << perf.dropped_updates << std::endl;
+        std::cout << "  Trade engine in/out: " << perf.engine_in << "/" << perf.engine_out
+                  << ", stalled " << perf.order_stall_cycles << " cycles, backpressure "
+                  << perf.tx_backpressure_cycles << " cycles" << std::endl;
+    }
+
+    trading::LatencyHistograms histograms;
+    if (accelerator.read_latency_histograms(histograms)) {
+        auto print = [](const char* name, const trading::LatencyHistogram& histogram) {
+            std::cout << "  " << name << ": " << histogram.samples() << " samples, p50 <= "
+                      << histogram.quantile_ns(0.5) << " ns, p99 <= "
+                      << histogram.quantile_ns(0.99) << " ns" << std::endl;
+        };
+        std::cout << "\nIn-fabric latency:" << std::endl;
+        print("Ingress to book update", histograms.ingress_to_book);
+        print("Book update to order", histograms.book_to_order);
+    }
+
+    trading::SimCycleReport cycles;
+    if (accelerator.get_sim_cycle_report(cycles)) {
+        auto print = [&](const char* name, const trading::SimCycleStats& stats) {
+            if (stats.calls > 0) {
+                double per_call = static_cast<double>(stats.cycles) / stats.calls;
+                std::cout << "  " << name << ": " << per_call << " cycles/call ("
+                          << per_call * 1000.0 / cycles.clock_mhz << " ns)" << std::endl;
+            }
+        };
+        std::cout << "\nSimulated device cycles at " << cycles.clock_mhz << " MHz:" << std::endl;
+        print("send_market_data", cycles.send_market_data);
+        print("get_order_book", cycles.get_order_book);
+        print("place_order", cycles.place_order);
+        print("cancel_order", cycles.cancel_order);
+    }
+
     return 0;
 }
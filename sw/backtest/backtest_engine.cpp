@@ -0,0 +1,317 @@
+#include "backtest_engine.hpp"
+#include "itch_decoder.hpp"
+#include "ouch_encoder.hpp"
+#include "pcap_reader.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+namespace trading {
+namespace backtest {
+
+namespace {
+
+int64_t to_fixed(double price) {
+    return static_cast<int64_t>(price * 1000000.0 + 0.5);
+}
+
+// Symbols spread evenly over groups whatever their names
+uint32_t symbol_group(uint64_t stock, uint32_t groups) {
+    return static_cast<uint32_t>(((stock * 0x9E3779B97F4A7C15ull) >> 32) % groups);
+}
+
+// Messages skipped by type, indexed by the type byte
+using SkipCounts = std::vector<uint64_t>;
+
+// Calls fn for each add order in a capture and counts everything else
+template <typename Fn>
+bool for_each_add_order(const std::string& file, SkipCounts& skipped, Fn&& fn) {
+    skipped.assign(256, 0);
+    feed::PcapReader reader;
+    if (!reader.open(file)) {
+        std::cerr << "Failed to open " << file << std::endl;
+        return false;
+    }
+    feed::UdpDatagram datagram;
+    while (reader.next(datagram)) {
+        feed::moldudp64::for_each_message(datagram.payload, datagram.length,
+            [&](uint64_t, const uint8_t* message, size_t length) {
+                feed::itch::AddOrder order;
+                if (feed::itch::parse_add_order(message, length, order)) {
+                    fn(order);
+                } else if (length != 0) {
+                    ++skipped[message[0]];
+                }
+            });
+    }
+    return true;
+}
+
+// One partition's session, fed add orders in capture order
+class Replay {
+public:
+    explicit Replay(Strategy& strategy)
+        : session_(strategy), messages_(0), start_(std::chrono::steady_clock::now()) {}
+
+    void apply(const feed::itch::AddOrder& order) {
+        auto name = names_.find(order.stock);
+        if (name == names_.end()) {
+            name = names_.emplace(order.stock, ouch::unpack_stock(order.stock)).first;
+        }
+        // ITCH prices have 4 implied decimals
+        session_.on_update(name->second, static_cast<uint64_t>(order.price) * 100, order.shares,
+                           order.is_buy, order.timestamp_ns);
+        ++messages_;
+    }
+
+    void finish(const std::string& file, uint32_t group, PartitionResult& result) const {
+        result.file = file;
+        result.group = group;
+        result.messages = messages_;
+        result.orders = session_.orders();
+        result.fills = session_.fills();
+        result.filled_shares = session_.filled_shares();
+        result.pnl = session_.pnl();
+        result.seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    BacktestSession session_;
+    std::unordered_map<uint64_t, std::string> names_;
+    uint64_t messages_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace
+
+BacktestSession::BacktestSession(Strategy& strategy)
+    : strategy_(strategy), next_order_id_(1), cash_(0), orders_(0), fills_(0), filled_shares_(0) {}
+
+bool BacktestSession::get_order_book(const std::string& symbol, OrderBook& book) {
+    return books_.top_of_book(symbol, book);
+}
+
+bool BacktestSession::place_order(const std::string& symbol, double price, uint32_t quantity,
+                                  bool is_buy) {
+    uint64_t order_id;
+    return place_order(symbol, price, quantity, is_buy, order_id);
+}
+
+bool BacktestSession::place_order(const std::string& symbol, double price, uint32_t quantity,
+                                  bool is_buy, uint64_t& order_id) {
+    if (quantity == 0 || price <= 0.0) {
+        std::cerr << "Rejected backtest order for " << symbol << ": " << quantity << " @ "
+                  << price << std::endl;
+        return false;
+    }
+    order_id = next_order_id_++;
+    symbols_[symbol].orders.push_back(
+        RestingOrder{order_id, static_cast<uint64_t>(to_fixed(price)), quantity, is_buy});
+    order_symbols_.emplace(order_id, symbol);
+    ++orders_;
+    return true;
+}
+
+bool BacktestSession::cancel_order(uint64_t order_id) {
+    auto it = order_symbols_.find(order_id);
+    if (it == order_symbols_.end()) {
+        return false;
+    }
+    std::vector<RestingOrder>& orders = symbols_[it->second].orders;
+    orders.erase(std::remove_if(orders.begin(), orders.end(),
+                                [order_id](const RestingOrder& order) {
+                                    return order.order_id == order_id;
+                                }),
+                 orders.end());
+    order_symbols_.erase(it);
+    return true;
+}
+
+int64_t BacktestSession::position(const std::string& symbol) const {
+    auto it = symbols_.find(symbol);
+    return it == symbols_.end() ? 0 : it->second.position;
+}
+
+int64_t BacktestSession::pnl() const {
+    int64_t total = cash_;
+    for (const auto& entry : symbols_) {
+        total += entry.second.position * entry.second.mid;
+    }
+    return total;
+}
+
+void BacktestSession::on_update(const std::string& symbol, uint64_t price, uint32_t quantity,
+                                bool is_buy, uint64_t timestamp_ns) {
+    books_.apply(symbol, price, quantity, is_buy);
+    strategy_.on_market_data(MarketData{symbol, price / 1000000.0, quantity, is_buy,
+                                        std::chrono::nanoseconds(timestamp_ns)},
+                             *this);
+
+    // Symbols the strategy never touched cost one lookup
+    auto it = symbols_.find(symbol);
+    if (it == symbols_.end() || (it->second.orders.empty() && it->second.position == 0)) {
+        return;
+    }
+    match(symbol, it->second, timestamp_ns);
+
+    // Callbacks may place and cancel orders, so they run after matching
+    std::vector<Fill> fills;
+    fills.swap(pending_fills_);
+    for (const Fill& fill : fills) {
+        strategy_.on_fill(fill, *this);
+    }
+}
+
+void BacktestSession::match(const std::string& symbol, SymbolState& state, uint64_t timestamp_ns) {
+    OrderBook book;
+    if (!books_.top_of_book(symbol, book)) {
+        return;
+    }
+    int64_t bid = to_fixed(book.best_bid_price);
+    int64_t ask = to_fixed(book.best_ask_price);
+    if (book.best_bid_qty != 0 && book.best_ask_qty != 0) {
+        state.mid = (bid + ask) / 2;
+    }
+    uint32_t bid_left = state.bid_taken.available(bid, book.best_bid_qty);
+    uint32_t ask_left = state.ask_taken.available(ask, book.best_ask_qty);
+
+    for (RestingOrder& order : state.orders) {
+        uint32_t quantity = 0;
+        int64_t fill_price = 0;
+        if (order.is_buy && ask_left != 0 && ask <= static_cast<int64_t>(order.price)) {
+            quantity = std::min(order.remaining, ask_left);
+            ask_left -= quantity;
+            state.ask_taken.quantity += quantity;
+            fill_price = ask;
+            cash_ -= fill_price * quantity;
+            state.position += quantity;
+        } else if (!order.is_buy && bid_left != 0 && bid >= static_cast<int64_t>(order.price)) {
+            quantity = std::min(order.remaining, bid_left);
+            bid_left -= quantity;
+            state.bid_taken.quantity += quantity;
+            fill_price = bid;
+            cash_ += fill_price * quantity;
+            state.position -= quantity;
+        }
+        if (quantity == 0) {
+            continue;
+        }
+        order.remaining -= quantity;
+        ++fills_;
+        filled_shares_ += quantity;
+        pending_fills_.push_back(Fill{order.order_id, symbol, fill_price / 1000000.0, quantity,
+                                      order.is_buy, timestamp_ns});
+        if (order.remaining == 0) {
+            order_symbols_.erase(order.order_id);
+        }
+    }
+    state.orders.erase(std::remove_if(state.orders.begin(), state.orders.end(),
+                                      [](const RestingOrder& order) { return order.remaining == 0; }),
+                       state.orders.end());
+}
+
+BacktestEngine::BacktestEngine(const BacktestConfig& config) : config_(config) {}
+
+bool BacktestEngine::run(const StrategyFactory& factory, BacktestReport& report) {
+    WorkStealingPool pool(config_.threads);
+    uint32_t groups = 1;
+    if (config_.mode == PartitionMode::BY_SYMBOL) {
+        groups = config_.symbol_groups != 0 ? config_.symbol_groups
+                                            : static_cast<uint32_t>(4 * pool.thread_count());
+    }
+
+    report = BacktestReport();
+    report.partitions.resize(config_.files.size() * groups);
+    report.threads = pool.thread_count();
+    std::atomic<bool> failed(false);
+    std::vector<SkipCounts> skipped(config_.files.size());
+
+    // Under BY_SYMBOL each file is decoded once and split into its groups'
+    // add orders, then the groups replay from memory
+    std::vector<std::vector<std::vector<feed::itch::AddOrder>>> split;
+
+    const auto start = std::chrono::steady_clock::now();
+    if (config_.mode == PartitionMode::BY_DAY) {
+        for (size_t f = 0; f < config_.files.size(); ++f) {
+            PartitionResult* result = &report.partitions[f];
+            const std::string* file = &config_.files[f];
+            SkipCounts* counts = &skipped[f];
+            pool.submit([&factory, &failed, result, file, counts]() {
+                std::unique_ptr<Strategy> strategy = factory();
+                Replay replay(*strategy);
+                if (!for_each_add_order(*file, *counts, [&](const feed::itch::AddOrder& order) {
+                        replay.apply(order);
+                    })) {
+                    failed.store(true);
+                }
+                replay.finish(*file, 0, *result);
+            });
+        }
+    } else {
+        split.resize(config_.files.size());
+        for (size_t f = 0; f < config_.files.size(); ++f) {
+            std::vector<std::vector<feed::itch::AddOrder>>* out = &split[f];
+            const std::string* file = &config_.files[f];
+            SkipCounts* counts = &skipped[f];
+            pool.submit([&failed, out, file, counts, groups]() {
+                out->resize(groups);
+                if (!for_each_add_order(*file, *counts, [&](const feed::itch::AddOrder& order) {
+                        (*out)[symbol_group(order.stock, groups)].push_back(order);
+                    })) {
+                    failed.store(true);
+                }
+            });
+        }
+        pool.wait();
+
+        for (size_t f = 0; f < config_.files.size(); ++f) {
+            for (uint32_t g = 0; g < groups; ++g) {
+                PartitionResult* result = &report.partitions[f * groups + g];
+                const std::string* file = &config_.files[f];
+                std::vector<feed::itch::AddOrder>* orders = &split[f][g];
+                pool.submit([&factory, result, file, orders, g]() {
+                    std::unique_ptr<Strategy> strategy = factory();
+                    Replay replay(*strategy);
+                    for (const feed::itch::AddOrder& order : *orders) {
+                        replay.apply(order);
+                    }
+                    replay.finish(*file, g, *result);
+                    std::vector<feed::itch::AddOrder>().swap(*orders);
+                });
+            }
+        }
+    }
+    pool.wait();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report.steals = pool.steals();
+
+    for (const PartitionResult& result : report.partitions) {
+        report.messages += result.messages;
+        report.orders += result.orders;
+        report.fills += result.fills;
+        report.pnl += result.pnl;
+    }
+    report.messages_per_sec = report.seconds > 0.0 ? report.messages / report.seconds : 0.0;
+
+    uint64_t skipped_total = 0;
+    for (const SkipCounts& counts : skipped) {
+        for (size_t type = 0; type < counts.size(); ++type) {
+            if (counts[type] != 0) {
+                report.skipped[static_cast<char>(type)] += counts[type];
+                skipped_total += counts[type];
+            }
+        }
+    }
+    if (skipped_total != 0) {
+        std::cerr << "Skipped " << skipped_total << " ITCH messages other than add orders;"
+                  << " captures must carry level totals, see BacktestEngine" << std::endl;
+    }
+    return !failed.load();
+}
+
+} // namespace backtest
+} // namespace trading
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "order_book_engine.hpp"
+#include "trading_interface.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trading {
+namespace backtest {
+
+struct Fill {
+    uint64_t order_id;
+    std::string symbol;
+    double price;
+    uint32_t quantity;
+    bool is_buy;
+    uint64_t timestamp_ns;
+};
+
+class BacktestSession;
+
+// Strategy callbacks. One instance runs per partition, on one thread.
+class Strategy {
+public:
+    virtual ~Strategy() = default;
+    virtual void on_market_data(const MarketData& data, BacktestSession& session) = 0;
+    virtual void on_fill(const Fill& fill, BacktestSession& session) {
+        (void)fill;
+        (void)session;
+    }
+};
+
+using StrategyFactory = std::function<std::unique_ptr<Strategy>()>;
+
+// What a strategy trades against in a backtest: books rebuilt by
+// OrderBookEngine and a simulated matcher. The book and order methods
+// have TradingAccelerator's signatures, so a strategy written against
+// either (a template on the API type) runs unchanged on both.
+//
+// Orders rest until the book trades through them: a buy fills at the
+// best ask once it is at or below the limit, and sells mirror that.
+// Fills only take size the session has not already taken at that touch
+// price: the feed cannot show the session's own fills, so the displayed
+// size less what was consumed is what is left. Consumption is forgotten
+// once the touch moves to another price. Matching runs after every
+// update, so a marketable order fills against the book the strategy saw
+// when it placed it.
+class BacktestSession {
+public:
+    explicit BacktestSession(Strategy& strategy);
+
+    bool get_order_book(const std::string& symbol, OrderBook& book);
+    bool place_order(const std::string& symbol, double price, uint32_t quantity, bool is_buy);
+    bool place_order(const std::string& symbol, double price, uint32_t quantity, bool is_buy,
+                     uint64_t& order_id);
+    bool cancel_order(uint64_t order_id);
+
+    int64_t position(const std::string& symbol) const;
+    // Cash plus positions at their last mid, 6 implied decimals
+    int64_t pnl() const;
+
+    // Driven by the engine
+    void on_update(const std::string& symbol, uint64_t price, uint32_t quantity, bool is_buy,
+                   uint64_t timestamp_ns);
+
+    uint64_t orders() const { return orders_; }
+    uint64_t fills() const { return fills_; }
+    uint64_t filled_shares() const { return filled_shares_; }
+
+private:
+    struct RestingOrder {
+        uint64_t order_id;
+        uint64_t price;  // 6 implied decimals
+        uint32_t remaining;
+        bool is_buy;
+    };
+
+    // Size the session has taken at one side's touch price
+    struct Consumed {
+        int64_t price = 0;
+        uint32_t quantity = 0;
+
+        // Displayed size still on offer at price
+        uint32_t available(int64_t touch, uint32_t displayed) {
+            if (touch != price) {
+                price = touch;
+                quantity = 0;
+            }
+            return displayed > quantity ? displayed - quantity : 0;
+        }
+    };
+
+    struct SymbolState {
+        std::vector<RestingOrder> orders;
+        int64_t position = 0;
+        int64_t mid = 0;
+        Consumed bid_taken;
+        Consumed ask_taken;
+    };
+
+    void match(const std::string& symbol, SymbolState& state, uint64_t timestamp_ns);
+
+    Strategy& strategy_;
+    OrderBookEngine books_;
+    std::unordered_map<std::string, SymbolState> symbols_;
+    std::unordered_map<uint64_t, std::string> order_symbols_;
+    std::vector<Fill> pending_fills_;
+    uint64_t next_order_id_;
+    int64_t cash_;
+    uint64_t orders_;
+    uint64_t fills_;
+    uint64_t filled_shares_;
+};
+
+enum class PartitionMode {
+    BY_DAY,     // one partition per file
+    BY_SYMBOL,  // each file decoded once and split into symbol groups held in memory
+};
+
+struct BacktestConfig {
+    std::vector<std::string> files;  // MoldUDP64/ITCH captures, one per day, see BacktestEngine
+    PartitionMode mode = PartitionMode::BY_DAY;
+    uint32_t symbol_groups = 0;      // per file under BY_SYMBOL, 0 for 4 per thread
+    size_t threads = 0;              // 0 for one per hardware thread
+};
+
+struct PartitionResult {
+    std::string file;
+    uint32_t group;        // symbol group, 0 under BY_DAY
+    uint64_t messages;
+    uint64_t orders;
+    uint64_t fills;
+    uint64_t filled_shares;
+    int64_t pnl;           // 6 implied decimals
+    double seconds;
+};
+
+struct BacktestReport {
+    std::vector<PartitionResult> partitions;
+    uint64_t messages;
+    uint64_t orders;
+    uint64_t fills;
+    int64_t pnl;
+    double seconds;
+    double messages_per_sec;
+    size_t threads;
+    uint64_t steals;
+    // ITCH messages not replayed, by message type; add orders that did
+    // not parse count under 'A'
+    std::map<char, uint64_t> skipped;
+};
+
+// Replays captures through per-partition books and strategies on a
+// work-stealing pool. Partitions share nothing, so throughput scales
+// with cores until the files stop fitting in the page cache.
+//
+// Captures must follow this repo's level-total convention, the one
+// ExchangeServer publishes and OrderBookEngine applies: each ITCH add
+// order carries a price level's new total shares, and 0 empties it. Only
+// add orders are replayed. A real order-level ITCH feed, with its
+// executes, cancels, deletes and replaces, is not rebuilt; those
+// messages are counted in BacktestReport::skipped and a warning is
+// printed.
+class BacktestEngine {
+public:
+    explicit BacktestEngine(const BacktestConfig& config);
+
+    bool run(const StrategyFactory& factory, BacktestReport& report);
+
+private:
+    BacktestConfig config_;
+};
+
+} // namespace backtest
+} // namespace trading
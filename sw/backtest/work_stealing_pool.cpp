@@ -0,0 +1,101 @@
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+
+namespace trading {
+namespace backtest {
+
+WorkStealingPool::WorkStealingPool(size_t threads)
+    : next_worker_(0), queued_(0), outstanding_(0), stop_(false), steals_(0) {
+    if (threads == 0) {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(new Worker());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this, i]() { run(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        stop_ = true;
+    }
+    work_available_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    Worker& worker = *workers_[next_worker_];
+    next_worker_ = (next_worker_ + 1) % workers_.size();
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        ++queued_;
+        ++outstanding_;
+    }
+    work_available_.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    all_done_.wait(lock, [this]() { return outstanding_ == 0; });
+}
+
+bool WorkStealingPool::take(size_t index, std::function<void()>& task) {
+    {
+        Worker& own = *workers_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < workers_.size(); ++i) {
+        Worker& victim = *workers_[(index + i) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(size_t index) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(state_mutex_);
+            work_available_.wait(lock, [this]() { return queued_ != 0 || stop_; });
+            if (queued_ == 0) {
+                return;
+            }
+            // Claim one queued task; some deque is guaranteed to hold it
+            --queued_;
+        }
+
+        std::function<void()> task;
+        while (!take(index, task)) {
+            std::this_thread::yield();
+        }
+        task();
+
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (--outstanding_ == 0) {
+            all_done_.notify_all();
+        }
+    }
+}
+
+} // namespace backtest
+} // namespace trading
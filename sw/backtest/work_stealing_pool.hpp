@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace trading {
+namespace backtest {
+
+// Fixed set of worker threads, each with its own task deque. A worker
+// takes from the back of its own deque and, when that is empty, steals
+// from the front of the others, so uneven tasks even out without a
+// shared queue on the fast path.
+class WorkStealingPool {
+public:
+    // 0 threads means one per hardware thread
+    explicit WorkStealingPool(size_t threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Tasks are dealt round-robin onto the workers' deques
+    void submit(std::function<void()> task);
+    // Blocks until every submitted task has finished
+    void wait();
+
+    size_t thread_count() const { return threads_.size(); }
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void run(size_t index);
+    bool take(size_t index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    size_t next_worker_;
+
+    std::mutex state_mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable all_done_;
+    size_t queued_;       // in deques, under state_mutex_
+    size_t outstanding_;  // queued or running, under state_mutex_
+    bool stop_;
+    std::atomic<uint64_t> steals_;
+};
+
+} // namespace backtest
+} // namespace trading
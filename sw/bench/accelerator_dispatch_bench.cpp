@@ -0,0 +1,171 @@
+#include "basic_trading_accelerator.hpp"
+#include "ouch_encoder.hpp"
+#include "sim_backend.hpp"
+#include "trading_interface.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+
+// Registers in memory that acknowledge every command at once, so only the
+// host side of a call is timed. Volatile like BAR0, so accesses stay.
+class LoopbackBackend {
+public:
+    bool open() {
+        regs_[trading::regs::STATUS] = trading::regs::STATUS_ACK;
+        regs_[trading::regs::ORDER_STATUS] = trading::regs::ORDER_STATUS_ACCEPTED;
+        return true;
+    }
+    uint32_t read(uint32_t reg) { return regs_[reg]; }
+    void write(uint32_t reg, uint32_t value) { regs_[reg] = value; }
+    void read_burst(uint32_t first, size_t count, uint32_t* out) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = regs_[first + i];
+        }
+    }
+    double cycle_ns() const { return trading::regs::CLOCK_PERIOD_NS; }
+
+private:
+    volatile uint32_t regs_[trading::regs::MAP_SIZE / sizeof(uint32_t)] = {};
+};
+
+struct CallTimes {
+    double market_data_ns;
+    double book_ns;
+    double order_ns;
+};
+
+template <typename Fn>
+double time_ns(size_t calls, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < calls; ++i) {
+        fn(i);
+    }
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / calls;
+}
+
+// The string and double API, as an application calls it
+template <typename Accelerator>
+CallTimes time_api(Accelerator& accelerator, size_t calls) {
+    trading::MarketData data{"AAPL", 150.25, 100, true, std::chrono::nanoseconds(0)};
+    trading::OrderBook book;
+    uint64_t order_id = 0;
+    CallTimes times;
+    times.market_data_ns = time_ns(calls, [&](size_t i) {
+        data.quantity = 100 + static_cast<uint32_t>(i & 63);
+        accelerator.send_market_data(data);
+    });
+    times.book_ns = time_ns(calls, [&](size_t) { accelerator.get_order_book(book); });
+    times.order_ns = time_ns(calls, [&](size_t i) {
+        accelerator.place_order("AAPL", 150.25, 100 + static_cast<uint32_t>(i & 63), true, order_id);
+    });
+    return times;
+}
+
+// Symbol and prices converted once, outside the loop
+template <typename Accelerator>
+CallTimes time_packed(Accelerator& accelerator, size_t calls) {
+    const uint32_t symbol = Accelerator::pack_symbol("AAPL");
+    const uint64_t price = Accelerator::double_to_fixed(150.25);
+    const uint64_t stock = trading::ouch::pack_stock("AAPL");
+    const uint32_t order_price = trading::ouch::to_price(150.25);
+    trading::OrderBook book;
+    uint64_t order_id = 0;
+    CallTimes times;
+    times.market_data_ns = time_ns(calls, [&](size_t i) {
+        accelerator.send_market_data(symbol, price, 100 + static_cast<uint32_t>(i & 63), true);
+    });
+    times.book_ns = time_ns(calls, [&](size_t) { accelerator.get_order_book(book); });
+    times.order_ns = time_ns(calls, [&](size_t i) {
+        accelerator.place_order(stock, order_price, 100 + static_cast<uint32_t>(i & 63), true, order_id);
+    });
+    return times;
+}
+
+// The loopback behind a pointer and out-of-line calls, the way
+// TradingAccelerator wraps its backend
+class OutOfLineLoopback {
+public:
+    OutOfLineLoopback() : impl_(new trading::BasicTradingAccelerator<LoopbackBackend>()) {
+        impl_->initialize();
+    }
+    __attribute__((noinline)) bool send_market_data(const trading::MarketData& data) {
+        return impl_->send_market_data(data);
+    }
+    __attribute__((noinline)) bool get_order_book(trading::OrderBook& book) {
+        return impl_->get_order_book(book);
+    }
+    __attribute__((noinline)) bool place_order(const std::string& symbol, double price,
+                                               uint32_t quantity, bool is_buy, uint64_t& order_id) {
+        return impl_->place_order(symbol, price, quantity, is_buy, order_id);
+    }
+
+private:
+    std::unique_ptr<trading::BasicTradingAccelerator<LoopbackBackend>> impl_;
+};
+
+// TradingAccelerator takes a symbol for the book read
+struct PimplAdapter {
+    trading::TradingAccelerator& accelerator;
+    bool send_market_data(const trading::MarketData& data) {
+        return accelerator.send_market_data(data);
+    }
+    bool get_order_book(trading::OrderBook& book) {
+        return accelerator.get_order_book("AAPL", book);
+    }
+    bool place_order(const std::string& symbol, double price, uint32_t quantity, bool is_buy,
+                     uint64_t& order_id) {
+        return accelerator.place_order(symbol, price, quantity, is_buy, order_id);
+    }
+};
+
+void print(const char* name, const CallTimes& times) {
+    std::cout << "  " << name << ": send_market_data " << times.market_data_ns
+              << " ns, get_order_book " << times.book_ns << " ns, place_order "
+              << times.order_ns << " ns" << std::endl;
+}
+
+} // namespace
+
+// Host time per call through the pimpl TradingAccelerator against the
+// header-only BasicTradingAccelerator, on the simulated device and on
+// registers in memory where the call itself is all that is timed.
+int main(int argc, char** argv) {
+    const size_t calls = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const size_t loopback_calls = calls * 100;
+
+    // A fresh device per run: the simulated book grows as updates land
+    std::cout << "Simulated device (" << calls << " calls each):" << std::endl;
+    {
+        trading::TradingAccelerator pimpl;
+        if (pimpl.initialize("bitstream.bit")) {
+            PimplAdapter adapter{pimpl};
+            print("TradingAccelerator", time_api(adapter, calls));
+        } else {
+            std::cout << "  TradingAccelerator: not built for the simulator, skipped" << std::endl;
+        }
+    }
+    {
+        trading::BasicTradingAccelerator<trading::sim::SimBackend> simulated;
+        simulated.initialize();
+        print("BasicTradingAccelerator", time_api(simulated, calls));
+    }
+    {
+        trading::BasicTradingAccelerator<trading::sim::SimBackend> simulated;
+        simulated.initialize();
+        print("BasicTradingAccelerator, packed", time_packed(simulated, calls));
+    }
+
+    std::cout << "Loopback registers (" << loopback_calls << " calls each):" << std::endl;
+    OutOfLineLoopback out_of_line;
+    print("Out of line, behind a pointer", time_api(out_of_line, loopback_calls));
+    trading::BasicTradingAccelerator<LoopbackBackend> loopback;
+    loopback.initialize();
+    print("BasicTradingAccelerator", time_api(loopback, loopback_calls));
+    print("BasicTradingAccelerator, packed", time_packed(loopback, loopback_calls));
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "backtest_engine.hpp"
+#include "itch_decoder.hpp"
+#include "market_generator.hpp"
+#include "ouch_encoder.hpp"
+#include "pcap_reader.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Writes one day of synthetic order flow as MoldUDP64/ITCH adds. Levels
+// follow the loadgen convention: an add sets its level, a cancel or
+// execute clears it.
+bool write_day(const std::string& path, uint64_t seed, size_t messages) {
+    trading::loadgen::GeneratorConfig config;
+    config.seed = seed;
+    trading::loadgen::MarketGenerator generator(config);
+    std::vector<trading::loadgen::MarketUpdate> updates(messages);
+    generator.generate(updates.data(), messages);
+
+    std::vector<uint64_t> stocks(config.symbols);
+    for (uint32_t i = 0; i < config.symbols; ++i) {
+        stocks[i] = trading::ouch::pack_stock(generator.symbol(i));
+    }
+
+    trading::feed::PcapWriter writer;
+    if (!writer.open(path)) {
+        return false;
+    }
+    const uint8_t session[trading::feed::moldudp64::SESSION_LEN] = {'B', 'A', 'C', 'K', 'T',
+                                                                     'E', 'S', 'T', '0', '1'};
+    uint8_t packet[1400];
+    uint8_t message[trading::feed::itch::ADD_ORDER_LEN];
+    trading::feed::moldudp64::PacketBuilder builder(packet, sizeof(packet));
+    uint64_t sequence = 1;
+    builder.begin(session, sequence);
+    for (const trading::loadgen::MarketUpdate& update : updates) {
+        trading::feed::itch::AddOrder order{};
+        order.timestamp_ns = update.timestamp_ns;
+        order.order_ref = update.order_id;
+        order.is_buy = update.is_bid != 0;
+        order.shares = update.type == trading::loadgen::UpdateType::ADD ? update.quantity : 0;
+        order.stock = stocks[update.symbol_id];
+        order.price = update.price / 100;
+        trading::feed::itch::encode_add_order(order, message);
+        if (!builder.append(message, sizeof(message))) {
+            writer.write_udp(update.timestamp_ns, 0xe9000001, 26477, builder.data(), builder.length());
+            sequence += builder.count();
+            builder.begin(session, sequence);
+            builder.append(message, sizeof(message));
+        }
+    }
+    writer.write_udp(updates.back().timestamp_ns, 0xe9000001, 26477, builder.data(),
+                     builder.length());
+    return true;
+}
+
+// Quotes one lot at the touch while flat and works out of a position at
+// the opposite touch, checking the book every few updates per symbol
+class TouchStrategy : public trading::backtest::Strategy {
+public:
+    void on_market_data(const trading::MarketData& data,
+                        trading::backtest::BacktestSession& session) override {
+        State& state = states_[data.symbol];
+        if (++state.updates % 8 != 0 || state.working) {
+            return;
+        }
+        trading::OrderBook book;
+        if (!session.get_order_book(data.symbol, book) || book.best_bid_qty == 0 ||
+            book.best_ask_qty == 0 || book.best_bid_price >= book.best_ask_price) {
+            return;
+        }
+        int64_t position = session.position(data.symbol);
+        bool is_buy = position <= 0;
+        double price = is_buy ? book.best_bid_price : book.best_ask_price;
+        state.working = session.place_order(data.symbol, price, 100, is_buy, state.order_id);
+    }
+
+    void on_fill(const trading::backtest::Fill& fill,
+                 trading::backtest::BacktestSession& session) override {
+        State& state = states_[fill.symbol];
+        if (state.working && state.order_id == fill.order_id) {
+            state.working = false;
+            session.cancel_order(fill.order_id);
+        }
+    }
+
+private:
+    struct State {
+        uint64_t updates = 0;
+        uint64_t order_id = 0;
+        bool working = false;
+    };
+    std::unordered_map<std::string, State> states_;
+};
+
+uint64_t skipped(const trading::backtest::BacktestReport& report) {
+    uint64_t total = 0;
+    for (const auto& type : report.skipped) {
+        total += type.second;
+    }
+    return total;
+}
+
+} // namespace
+
+// Backtest throughput over a set of synthetic day files, partitioned by
+// day and by symbol, across increasing thread counts.
+int main(int argc, char** argv) {
+    const size_t days = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4;
+    const size_t per_day = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 500000;
+    const std::string directory = argc > 3 ? argv[3] : "/tmp";
+
+    trading::backtest::BacktestConfig config;
+    for (size_t d = 0; d < days; ++d) {
+        std::string path = directory + "/backtest_day" + std::to_string(d) + ".pcap";
+        if (!write_day(path, d + 1, per_day)) {
+            std::cerr << "Failed to write " << path << std::endl;
+            return 1;
+        }
+        config.files.push_back(path);
+    }
+    std::cout << days << " days of " << per_day << " messages, " << std::thread::hardware_concurrency()
+              << " hardware threads" << std::endl;
+
+    std::vector<size_t> thread_counts = {1, 2, 4};
+    if (std::thread::hardware_concurrency() > 4) {
+        thread_counts.push_back(std::thread::hardware_concurrency());
+    }
+    for (trading::backtest::PartitionMode mode : {trading::backtest::PartitionMode::BY_DAY,
+                                                  trading::backtest::PartitionMode::BY_SYMBOL}) {
+        for (size_t threads : thread_counts) {
+            config.mode = mode;
+            config.threads = threads;
+            trading::backtest::BacktestEngine engine(config);
+            trading::backtest::BacktestReport report;
+            if (!engine.run([]() { return std::unique_ptr<trading::backtest::Strategy>(new TouchStrategy()); },
+                            report)) {
+                return 1;
+            }
+            std::cout << (mode == trading::backtest::PartitionMode::BY_DAY ? "By day" : "By symbol")
+                      << ", " << threads << " threads, " << report.partitions.size()
+                      << " partitions: " << report.messages_per_sec / 1e6 << " M msgs/s ("
+                      << report.messages << " msgs, " << report.orders << " orders, "
+                      << report.fills << " fills, PnL " << report.pnl / 1e6 << ", "
+                      << report.steals << " steals, " << skipped(report) << " skipped)"
+                      << std::endl;
+        }
+    }
+    return 0;
+}
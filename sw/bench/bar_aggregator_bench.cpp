@@ -0,0 +1,103 @@
+#include "bar_aggregator.hpp"
+#include "order_book_engine.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Cost the aggregator adds to the update path, next to the order book
+// apply it would sit behind, with a subscriber draining bar closes on
+// another thread.
+int main(int argc, char** argv) {
+    const size_t symbols = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+    const size_t events = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000;
+
+    trading::BarConfig config;
+    config.max_symbols = symbols;
+    trading::BarAggregator bars(config);
+    std::vector<std::string> names(symbols);
+    for (size_t i = 0; i < symbols; ++i) {
+        names[i] = "S" + std::to_string(i);
+        bars.add_symbol(names[i]);
+    }
+
+    // One simulated microsecond per event, so 1s bars close every
+    // million events
+    struct Event {
+        uint32_t symbol;
+        uint32_t quantity;
+        uint32_t trade;
+        uint64_t price;
+    };
+    const size_t ring = 1 << 20;
+    std::vector<Event> stream(ring);
+    std::mt19937_64 rng(5);
+    for (size_t i = 0; i < ring; ++i) {
+        uint64_t r = rng();
+        Event& e = stream[i];
+        e.symbol = static_cast<uint32_t>(r % symbols);
+        e.quantity = 100 * (1 + static_cast<uint32_t>((r >> 24) % 50));
+        e.trade = (r >> 40) % 10 == 0;
+        e.price = 100000000 + 10000 * ((r >> 44) % 100);
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> delivered(0);
+    bars.subscribe([&](const std::string&, const trading::BarClose&) {
+        delivered.fetch_add(1, std::memory_order_relaxed);
+    });
+    std::thread subscriber([&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+            bars.dispatch();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        bars.dispatch();
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < events; ++i) {
+        const Event& e = stream[i & (ring - 1)];
+        uint64_t ts = i * 1000;
+        if (e.trade) {
+            bars.on_trade(e.symbol, e.price, e.quantity, ts);
+        } else {
+            bars.on_book(e.symbol, e.price - 10000, e.quantity, e.price + 10000, e.quantity, ts);
+        }
+    }
+    double bar_ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / events;
+    bars.flush(events * 1000);
+    stop.store(true);
+    subscriber.join();
+
+    // The book update the aggregator would follow
+    trading::OrderBookEngine engine;
+    const size_t book_events = std::min<size_t>(events, 2000000);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < book_events; ++i) {
+        const Event& e = stream[i & (ring - 1)];
+        engine.apply(names[e.symbol], e.price - 10000, e.quantity, true);
+    }
+    double book_ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / book_events;
+
+    std::cout << "Aggregated " << events << " events over " << symbols << " symbols into "
+              << bars.interval_count() << " intervals: " << bar_ns << " ns/event (order book apply: "
+              << book_ns << " ns/update)" << std::endl;
+    std::cout << "Bar closes delivered to the subscriber: " << delivered.load() << ", dropped: "
+              << bars.dropped_closes() << std::endl;
+
+    trading::Bar bar;
+    if (bars.latest_bar(0, 0, bar)) {
+        std::cout << names[0] << " last 1s bar: O " << bar.open / 1e6 << " H " << bar.high / 1e6
+                  << " L " << bar.low / 1e6 << " C " << bar.close / 1e6 << " V " << bar.volume
+                  << " VWAP " << bar.vwap / 1e6 << " (" << bars.closed_bars(0, 0) << " closed)"
+                  << std::endl;
+    }
+    return 0;
+}
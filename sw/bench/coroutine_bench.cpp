@@ -0,0 +1,186 @@
+#include "async_accelerator.hpp"
+#include "basic_trading_accelerator.hpp"
+#include "executor.hpp"
+#include "frame_pool.hpp"
+#include "ouch_encoder.hpp"
+#include "sim_backend.hpp"
+#include "task.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+using trading::coro::AsyncAccelerator;
+using trading::coro::Executor;
+using trading::coro::FramePool;
+using trading::coro::Task;
+
+// Registers in memory that accept every command at once, so only the
+// host side of a call is timed
+class LoopbackBackend {
+public:
+    bool open() {
+        regs_[trading::regs::STATUS] = trading::regs::STATUS_ACK;
+        regs_[trading::regs::ORDER_STATUS] = trading::regs::ORDER_STATUS_ACCEPTED;
+        return true;
+    }
+    uint32_t read(uint32_t reg) { return regs_[reg]; }
+    void write(uint32_t reg, uint32_t value) { regs_[reg] = value; }
+    void read_burst(uint32_t first, size_t count, uint32_t* out) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = regs_[first + i];
+        }
+    }
+    double cycle_ns() const { return trading::regs::CLOCK_PERIOD_NS; }
+
+private:
+    volatile uint32_t regs_[trading::regs::MAP_SIZE / sizeof(uint32_t)] = {};
+};
+
+const double LIMIT = 150.25;
+const uint64_t STOCK = trading::ouch::pack_stock("AAPL");
+const uint32_t PRICE = trading::ouch::to_price(LIMIT);
+
+double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Backend>
+double blocking_order_ns(trading::BasicTradingAccelerator<Backend>& device, size_t orders) {
+    uint64_t order_id = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < orders; ++i) {
+        device.place_order(STOCK, PRICE, 100 + static_cast<uint32_t>(i & 63), true, order_id);
+    }
+    return elapsed_ns(start) / orders;
+}
+
+template <typename Backend>
+Task<void> place_orders(AsyncAccelerator<Backend>& device, size_t orders) {
+    uint64_t order_id = 0;
+    for (size_t i = 0; i < orders; ++i) {
+        co_await device.place_order(STOCK, PRICE, 100 + static_cast<uint32_t>(i & 63), true,
+                                    order_id);
+    }
+}
+
+// One coroutine awaiting each order in turn: the blocking loop plus the
+// cost of suspending, polling and resuming
+template <typename Backend>
+double awaited_order_ns(trading::BasicTradingAccelerator<Backend>& device, size_t orders) {
+    Executor executor;
+    AsyncAccelerator<Backend> async(device, executor);
+    auto start = std::chrono::steady_clock::now();
+    executor.spawn(place_orders(async, orders));
+    executor.run();
+    return elapsed_ns(start) / orders;
+}
+
+// Place, check the book, cancel if the order is not at the touch
+template <typename Backend>
+Task<bool> order_lifecycle(AsyncAccelerator<Backend>& device, double price, uint32_t quantity,
+                           uint64_t& cancels) {
+    uint64_t order_id = 0;
+    if (!co_await device.place_order(STOCK, trading::ouch::to_price(price), quantity, true,
+                                     order_id)) {
+        co_return false;
+    }
+    trading::OrderBook book;
+    if (!co_await device.get_order_book(book)) {
+        co_return false;
+    }
+    if (book.best_bid_price > price) {
+        co_await device.cancel_order(order_id);
+        ++cancels;
+    }
+    co_return true;
+}
+
+template <typename Backend>
+Task<void> strategy(AsyncAccelerator<Backend>& device, size_t lifecycles, uint64_t& completed,
+                    uint64_t& cancels) {
+    for (size_t i = 0; i < lifecycles; ++i) {
+        // Every fourth order joins the best bid, the rest sit behind it
+        double price = LIMIT - 0.01 * (i & 3);
+        if (co_await order_lifecycle(device, price, 100 + static_cast<uint32_t>(i & 63), cancels)) {
+            ++completed;
+        }
+    }
+}
+
+template <typename Backend>
+void run_lifecycles(trading::BasicTradingAccelerator<Backend>& device, size_t strategies,
+                    size_t lifecycles) {
+    // A resting bid at the limit to check orders against
+    device.send_market_data(trading::MarketData{"AAPL", LIMIT, 500, true,
+                                                std::chrono::nanoseconds(0)});
+
+    Executor executor(strategies);
+    AsyncAccelerator<Backend> async(device, executor);
+    uint64_t completed = 0;
+    uint64_t cancels = 0;
+
+    const trading::coro::FramePoolStats before = FramePool::stats();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t s = 0; s < strategies; ++s) {
+        executor.spawn(strategy(async, lifecycles, completed, cancels));
+    }
+    executor.run();
+    double ns = elapsed_ns(start);
+    const trading::coro::FramePoolStats after = FramePool::stats();
+
+    std::cout << "  " << strategies << " strategies x " << lifecycles << " lifecycles: "
+              << completed << " completed, " << cancels << " cancelled, "
+              << ns / completed << " ns per lifecycle" << std::endl;
+    std::cout << "  frames " << after.allocations - before.allocations << ", pool refills "
+              << after.chunk_allocations - before.chunk_allocations << ", oversized "
+              << after.oversized - before.oversized << std::endl;
+}
+
+} // namespace
+
+// Order latency through the blocking API against co_await on the same
+// device, then many concurrent place/check/cancel coroutines on one
+// executor with frames from the pool.
+int main(int argc, char** argv) {
+    const size_t orders = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const size_t loopback_orders = orders * 50;
+    const size_t strategies = 64;
+
+    // Frames for every strategy (about 100 bytes) and the lifecycle each
+    // one awaits (about 300), so the timed runs never refill the pool
+    FramePool::reserve(128, strategies);
+    FramePool::reserve(512, strategies);
+
+    std::cout << "Loopback registers (" << loopback_orders << " orders):" << std::endl;
+    {
+        trading::BasicTradingAccelerator<LoopbackBackend> device;
+        device.initialize();
+        std::cout << "  blocking place_order " << blocking_order_ns(device, loopback_orders)
+                  << " ns, co_await place_order " << awaited_order_ns(device, loopback_orders)
+                  << " ns" << std::endl;
+    }
+
+    // A fresh device per run: the simulated book grows as orders land
+    std::cout << "Simulated device (" << orders << " orders):" << std::endl;
+    {
+        trading::BasicTradingAccelerator<trading::sim::SimBackend> device;
+        device.initialize();
+        std::cout << "  blocking place_order " << blocking_order_ns(device, orders) << " ns";
+    }
+    {
+        trading::BasicTradingAccelerator<trading::sim::SimBackend> device;
+        device.initialize();
+        std::cout << ", co_await place_order " << awaited_order_ns(device, orders) << " ns"
+                  << std::endl;
+    }
+
+    std::cout << "Order lifecycles on the simulated device:" << std::endl;
+    {
+        trading::BasicTradingAccelerator<trading::sim::SimBackend> device;
+        device.initialize();
+        run_lifecycles(device, strategies, orders / strategies / 4);
+    }
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include "exchange_client.hpp"
+#include "exchange_server.hpp"
+#include "load_driver.hpp"
+#include "matching_engine.hpp"
+#include "ouch_encoder.hpp"
+#include "trading_interface.hpp"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using trading::exchange::ExchangeClient;
+using trading::exchange::ExchangeConfig;
+using trading::exchange::ExchangeServer;
+
+const uint64_t STOCK = trading::ouch::pack_stock("AAPL");
+const uint16_t TCP_PORT = 19000;
+const char* SHM_NAME = "/exchange_bench";
+
+class CountingListener : public trading::exchange::MatchListener {
+public:
+    uint64_t messages = 0;
+    void on_accepted(uint32_t, const trading::ouch::OrderAccepted&) override { ++messages; }
+    void on_executed(uint32_t, const trading::ouch::OrderExecuted&) override { ++messages; }
+    void on_canceled(uint32_t, const trading::ouch::OrderCanceled&) override { ++messages; }
+    void on_rejected(uint32_t, const trading::ouch::OrderRejected&) override { ++messages; }
+    void on_level(uint64_t, uint32_t, uint32_t, bool, uint64_t) override { ++messages; }
+};
+
+// Orders around a drifting mid, a quarter of them marketable, with a
+// cancel for every third order
+struct FlowGenerator {
+    std::mt19937_64 rng{42};
+    trading::OuchEncoder encoder{"BENCH0"};  // tokens apart from the device's
+    std::vector<uint32_t> live;
+    uint32_t mid = 1000000;  // 100.0000
+
+    size_t next(uint8_t* out) {
+        if (!live.empty() && rng() % 3 == 0) {
+            size_t pick = rng() % live.size();
+            trading::OrderCommand cancel{true, false, STOCK, 0, 0, live[pick]};
+            live[pick] = live.back();
+            live.pop_back();
+            return encoder.encode(cancel, out);
+        }
+        uint64_t r = rng();
+        bool is_buy = r & 1;
+        bool marketable = ((r >> 1) & 3) == 0;
+        uint32_t offset = static_cast<uint32_t>((r >> 3) % 20) * 100;
+        mid += static_cast<uint32_t>((r >> 8) % 3) * 100 - 100;
+        uint32_t price = marketable ? (is_buy ? mid + 500 : mid - 500)
+                                    : (is_buy ? mid - 100 - offset : mid + 100 + offset);
+        trading::OrderCommand order{false, is_buy, STOCK, price,
+                                    100 + static_cast<uint32_t>((r >> 16) % 900), 0};
+        size_t length = encoder.encode(order, out);
+        if (live.size() < 100000) {
+            live.push_back(encoder.last_order_id());
+        }
+        return length;
+    }
+};
+
+// The engine on its own, with the framing parsed as the server does
+void bench_engine(size_t messages) {
+    FlowGenerator flow;
+    std::vector<uint8_t> stream(messages * trading::ouch::MAX_FRAME_LEN);
+    size_t length = 0;
+    for (size_t i = 0; i < messages; ++i) {
+        length += flow.next(stream.data() + length);
+    }
+
+    CountingListener listener;
+    trading::exchange::MatchingEngine engine(listener);
+    auto start = std::chrono::steady_clock::now();
+    trading::ouch::for_each_frame(stream.data(), length,
+        [&](uint8_t, const uint8_t* msg, size_t msg_length) {
+            if (msg[0] == trading::ouch::ENTER_ORDER) {
+                trading::ouch::EnterOrder order;
+                trading::ouch::parse_enter_order(msg, msg_length, order);
+                engine.enter(0, order, 0);
+            } else {
+                trading::ouch::CancelOrder cancel;
+                trading::ouch::parse_cancel_order(msg, msg_length, cancel);
+                engine.cancel(0, cancel, 0);
+            }
+        });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const trading::exchange::MatchingStats& stats = engine.stats();
+    std::cout << "Matching engine: " << messages / seconds / 1e6 << " M messages/s ("
+              << stats.orders << " orders, " << stats.executions << " executions, "
+              << stats.cancels << " cancels, " << engine.resting_orders() << " resting, "
+              << listener.messages << " events)" << std::endl;
+}
+
+std::atomic<bool> server_stop(false);
+
+void on_term(int) {
+    server_stop.store(true);
+}
+
+// The exchange in its own process, as exchange_sim runs it
+pid_t start_server(const ExchangeConfig& config) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        std::signal(SIGTERM, on_term);
+        ExchangeServer server(config);
+        if (!server.open()) {
+            _exit(1);
+        }
+        server.run(server_stop);
+        server.close();
+        _exit(0);
+    }
+    return pid;
+}
+
+void stop_server(pid_t pid) {
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+}
+
+bool connect(ExchangeClient& client, bool shm) {
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        if (shm ? client.connect_shm(SHM_NAME) : client.connect_tcp(TCP_PORT)) {
+            return true;
+        }
+        usleep(10000);
+    }
+    return false;
+}
+
+struct AckCounter : trading::exchange::ExchangeHandler {
+    uint64_t accepted = 0;
+    uint64_t replies = 0;
+    void on_accepted(const trading::ouch::OrderAccepted&) override { ++accepted; ++replies; }
+    void on_executed(const trading::ouch::OrderExecuted&) override { ++replies; }
+    void on_canceled(const trading::ouch::OrderCanceled&) override { ++replies; }
+};
+
+// Orders streamed in batches while replies are drained
+void bench_throughput(ExchangeClient& client, const char* name, size_t orders) {
+    const size_t batch = 256;
+    FlowGenerator flow;
+    std::vector<uint8_t> buffer(batch * trading::ouch::MAX_FRAME_LEN);
+    AckCounter counter;
+    size_t sent = 0;
+    uint64_t expected = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    while (sent < orders) {
+        size_t length = 0;
+        for (size_t i = 0; i < batch && sent < orders; ++i, ++sent) {
+            size_t frame = flow.next(buffer.data() + length);
+            expected += buffer[length + trading::ouch::FRAME_HEADER_LEN] == trading::ouch::ENTER_ORDER;
+            length += frame;
+        }
+        client.send(buffer.data(), length);
+        client.poll(counter);
+    }
+    while (counter.accepted < expected) {
+        if (client.poll(counter) == 0) {
+            client.wait();
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << name << ": " << orders / seconds / 1e6 << " M messages/s, "
+              << counter.replies / seconds / 1e6 << " M replies/s" << std::endl;
+}
+
+struct FirstAccept : trading::exchange::ExchangeHandler {
+    bool accepted = false;
+    void on_accepted(const trading::ouch::OrderAccepted&) override { accepted = true; }
+};
+
+// place_order on the simulated device to the exchange's accept, one at a time
+void bench_round_trip(ExchangeClient& client, const char* name, size_t orders) {
+    trading::TradingAccelerator accelerator;
+    if (!accelerator.set_order_egress([&client](const uint8_t* frame, size_t length) {
+            client.send(frame, length);
+        }) || !accelerator.initialize("bitstream.bit")) {
+        std::cout << "  " << name << ": needs the simulated device, skipped" << std::endl;
+        return;
+    }
+
+    trading::loadgen::LatencyRecorder latency;
+    FirstAccept handler;
+    for (size_t i = 0; i < orders; ++i) {
+        // Alternate sides at one price so every sell fills the buy before it
+        auto start = std::chrono::steady_clock::now();
+        handler.accepted = false;
+        accelerator.place_order("AAPL", 100.0, 100, (i & 1) == 0);
+        while (!handler.accepted) {
+            if (client.poll(handler) == 0) {
+                client.wait();
+            }
+        }
+        latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+    }
+    std::cout << "  " << name << " round trip: p50 " << latency.percentile_ns(0.5) / 1000.0
+              << " us, p99 " << latency.percentile_ns(0.99) / 1000.0 << " us, max "
+              << latency.max_ns() / 1000.0 << " us" << std::endl;
+}
+
+} // namespace
+
+// Messages per second through the matching engine alone and through an
+// exchange process over each transport, then order round trips from
+// TradingAccelerator on the simulated device to the exchange's accept.
+int main(int argc, char** argv) {
+    const size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    const size_t round_trips = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000;
+
+    bench_engine(messages);
+
+    std::cout << "Exchange process:" << std::endl;
+    for (bool shm : {true, false}) {
+        ExchangeConfig config;
+        if (shm) {
+            config.shm_name = SHM_NAME;
+        } else {
+            config.tcp_port = TCP_PORT;
+        }
+        const char* name = shm ? "shared memory" : "loopback TCP";
+
+        pid_t pid = start_server(config);
+        ExchangeClient client;
+        if (!connect(client, shm)) {
+            std::cout << "  " << name << ": exchange did not start" << std::endl;
+            stop_server(pid);
+            continue;
+        }
+        bench_throughput(client, name, messages / 4);
+        bench_round_trip(client, name, round_trips);
+        client.close();
+        stop_server(pid);
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "feature_engine.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Feature update rate on one core for a stream of top-of-book changes and
+// trades, then the cost of wait-free reads while the writer runs.
+int main(int argc, char** argv) {
+    const size_t symbols = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+    const size_t events = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000000;
+
+    trading::FeatureConfig config;
+    config.expected_symbols = symbols;
+    trading::FeatureEngine engine(config);
+    for (size_t i = 0; i < symbols; ++i) {
+        engine.add_symbol("S" + std::to_string(i));
+    }
+
+    // Pregenerated so the timed loop is the engine alone
+    struct Event {
+        uint32_t symbol;
+        uint32_t bid_qty;
+        uint32_t ask_qty;
+        uint32_t trade;  // 0 for a book event, else the traded size
+        uint64_t bid_price;
+        uint64_t timestamp_ns;
+    };
+    const size_t ring = 1 << 20;
+    std::vector<Event> stream(ring);
+    std::mt19937_64 rng(3);
+    std::vector<uint64_t> bids(symbols, 100000000);
+    for (size_t i = 0; i < ring; ++i) {
+        uint64_t r = rng();
+        Event& e = stream[i];
+        e.symbol = static_cast<uint32_t>(r % symbols);
+        uint64_t& bid = bids[e.symbol];
+        if ((r >> 20) % 4 == 0) {
+            bid = (r >> 22) & 1 ? bid + 10000 : bid - 10000;
+        }
+        e.bid_price = bid;
+        e.bid_qty = 100 * (1 + static_cast<uint32_t>((r >> 24) % 50));
+        e.ask_qty = 100 * (1 + static_cast<uint32_t>((r >> 32) % 50));
+        e.trade = (r >> 40) % 10 == 0 ? 100 : 0;
+        e.timestamp_ns = i * 1000;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t time_base = 0;
+    for (size_t i = 0; i < events; ++i) {
+        const Event& e = stream[i & (ring - 1)];
+        if ((i & (ring - 1)) == 0 && i != 0) {
+            time_base += ring * 1000;
+        }
+        uint64_t ts = time_base + e.timestamp_ns;
+        if (e.trade) {
+            engine.on_trade(e.symbol, e.bid_price + 10000, e.trade, true, ts);
+        } else {
+            engine.on_book(e.symbol, e.bid_price, e.bid_qty, e.bid_price + 20000, e.ask_qty, ts);
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "Updated " << events << " events over " << symbols << " symbols: "
+              << ns / events << " ns/event, " << events / ns * 1000.0 << " M events/s"
+              << std::endl;
+
+    trading::Features features;
+    engine.read(0, features);
+    std::cout << "S0: mid " << features.mid / 1e6 << ", microprice " << features.microprice / 1e6
+              << ", imbalance " << features.imbalance_ppm / 1e4 << "%, OFI " << features.ofi
+              << ", VWAP " << features.vwap / 1e6 << ", realized spread "
+              << features.realized_spread / 1e6 << " (" << features.realized_count << " trades)"
+              << std::endl;
+
+    // Readers against a live writer
+    std::atomic<bool> stop(false);
+    std::thread writer([&]() {
+        uint64_t ts = 1ull << 40;
+        for (size_t i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+            const Event& e = stream[i & (ring - 1)];
+            engine.on_book(e.symbol, e.bid_price, e.bid_qty, e.bid_price + 20000, e.ask_qty, ts += 1000);
+        }
+    });
+    const size_t reads = 10000000;
+    size_t failed = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < reads; ++i) {
+        failed += !engine.read(static_cast<uint32_t>(i % symbols), features);
+    }
+    ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    stop.store(true);
+    writer.join();
+    std::cout << "Read " << reads << " snapshots during updates: " << ns / reads
+              << " ns/read, " << failed << " lapped by the writer" << std::endl;
+    return 0;
+}
@@ -0,0 +1,285 @@
+#include "gap_recovery.hpp"
+#include "itch_decoder.hpp"
+#include "load_driver.hpp"
+#include "order_book_engine.hpp"
+#include "ouch_encoder.hpp"
+#include "recovery_server.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* GROUP = "239.1.1.6";
+const uint16_t FEED_PORT = 19502;
+const uint64_t SEED = 7;
+const size_t SYMBOLS = 8;
+const uint64_t RATE = 50000;  // packets per second
+const size_t BURST = 3000;    // packets lost in a row by a burst
+const int IDLE_MS = 300;
+const uint8_t SESSION[trading::feed::moldudp64::SESSION_LEN] = {'R', 'E', 'C', 'O', 'V',
+                                                                'E', 'R', '0', '0', '1'};
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count());
+}
+
+// Deterministic MoldUDP64/ITCH add orders over a few symbols and price
+// levels; zero shares clear a level. The sender and the reference book
+// both draw from it.
+class FeedSource {
+public:
+    FeedSource() : rng_(SEED), sequence_(1) {
+        static const char* names[SYMBOLS] = {"AAPL", "MSFT", "AMZN", "GOOG",
+                                             "META", "NVDA", "TSLA", "NFLX"};
+        for (size_t i = 0; i < SYMBOLS; ++i) {
+            stocks_[i] = trading::ouch::pack_stock(names[i]);
+        }
+    }
+
+    // Builds the next packet into buffer; returns its length
+    size_t next(uint8_t* buffer, size_t capacity) {
+        trading::feed::moldudp64::PacketBuilder builder(buffer, capacity);
+        builder.begin(SESSION, sequence_);
+        size_t count = 1 + rng_() % 8;
+        uint8_t message[trading::feed::itch::ADD_ORDER_LEN];
+        for (size_t m = 0; m < count; ++m) {
+            trading::feed::itch::AddOrder order{};
+            order.order_ref = sequence_++;
+            order.stock = stocks_[rng_() % SYMBOLS];
+            order.is_buy = (rng_() & 1) != 0;
+            uint32_t offset = static_cast<uint32_t>(rng_() % 16) * 100;
+            order.price = order.is_buy ? 1000000 - offset : 1010000 + offset;
+            order.shares = rng_() % 4 == 0 ? 0 : 100 * static_cast<uint32_t>(1 + rng_() % 10);
+            trading::feed::itch::encode_add_order(order, message);
+            builder.append(message, sizeof(message));
+        }
+        return builder.length();
+    }
+
+    uint64_t sequence() const { return sequence_; }
+
+private:
+    std::mt19937_64 rng_;
+    uint64_t sequence_;
+    uint64_t stocks_[SYMBOLS];
+};
+
+// Publishes packets at RATE, recording every one with the recovery
+// server but leaving some off the wire: each independently with
+// probability loss, and a burst of BURST every burst_every packets. Then
+// heartbeats until killed, still serving recovery.
+pid_t start_feed(size_t packets, double loss, size_t burst_every) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    trading::ingest::RecoveryServer server;
+    if (!server.start()) {
+        _exit(1);
+    }
+    usleep(100000);  // let the receiver join
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    in_addr local;
+    inet_pton(AF_INET, "127.0.0.1", &local);
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &local, sizeof(local));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(FEED_PORT);
+    inet_pton(AF_INET, GROUP, &addr.sin_addr);
+
+    FeedSource source;
+    std::mt19937_64 rng(SEED + 1);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    uint8_t packet[1400];
+    const auto start = Clock::now();
+    for (size_t i = 0; i < packets; ++i) {
+        auto due = start + std::chrono::nanoseconds(i * 1000000000ull / RATE);
+        while (Clock::now() < due) {
+            server.poll(0);
+            usleep(10);
+        }
+        size_t length = source.next(packet, sizeof(packet));
+        server.record(packet, length);
+        bool in_burst = burst_every != 0 && i % burst_every >= burst_every - BURST;
+        if (!in_burst && coin(rng) >= loss) {
+            sendto(fd, packet, length, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        }
+    }
+
+    trading::feed::moldudp64::PacketBuilder heartbeat(packet, sizeof(packet));
+    for (;;) {
+        heartbeat.begin(SESSION, source.sequence());
+        sendto(fd, packet, heartbeat.length(), 0, reinterpret_cast<sockaddr*>(&addr),
+               sizeof(addr));
+        server.poll(1);
+    }
+}
+
+int join_feed() {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    int buffer = 16 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &buffer, sizeof(buffer));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(FEED_PORT);
+    inet_pton(AF_INET, GROUP, &addr.sin_addr);
+    ip_mreq membership;
+    membership.imr_multiaddr = addr.sin_addr;
+    inet_pton(AF_INET, "127.0.0.1", &membership.imr_interface);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool same_books(const trading::OrderBookEngine& a, const trading::OrderBookEngine& b) {
+    trading::BookSnapshot left;
+    trading::BookSnapshot right;
+    a.save(left);
+    b.save(right);
+    auto by_symbol = [](const trading::SymbolDepth& x, const trading::SymbolDepth& y) {
+        return x.symbol < y.symbol;
+    };
+    std::sort(left.symbols.begin(), left.symbols.end(), by_symbol);
+    std::sort(right.symbols.begin(), right.symbols.end(), by_symbol);
+    if (left.symbols.size() != right.symbols.size()) {
+        return false;
+    }
+    auto same_levels = [](const std::vector<trading::BookLevel>& x,
+                          const std::vector<trading::BookLevel>& y) {
+        return x.size() == y.size() &&
+               std::equal(x.begin(), x.end(), y.begin(),
+                          [](const trading::BookLevel& p, const trading::BookLevel& q) {
+                              return p.price == q.price && p.quantity == q.quantity;
+                          });
+    };
+    for (size_t i = 0; i < left.symbols.size(); ++i) {
+        if (left.symbols[i].symbol != right.symbols[i].symbol ||
+            !same_levels(left.symbols[i].bids, right.symbols[i].bids) ||
+            !same_levels(left.symbols[i].asks, right.symbols[i].asks)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void print_latency(const char* name, const trading::loadgen::LatencyRecorder& recorder) {
+    if (recorder.count() == 0) {
+        std::cout << "    " << name << ": none" << std::endl;
+        return;
+    }
+    std::cout << "    " << name << ": " << recorder.count() << ", p50 "
+              << recorder.percentile_ns(0.5) / 1e3 << " us, p99 "
+              << recorder.percentile_ns(0.99) / 1e3 << " us, max " << recorder.max_ns() / 1e3
+              << " us" << std::endl;
+}
+
+void run(const char* name, size_t packets, double loss, size_t burst_every) {
+    int fd = join_feed();
+    if (fd < 0) {
+        std::cout << "  " << name << ": could not join " << GROUP << ", skipped" << std::endl;
+        return;
+    }
+    trading::OrderBookEngine book;
+    trading::ingest::GapRecovery recovery(book);
+    if (!recovery.open()) {
+        close(fd);
+        return;
+    }
+    trading::loadgen::LatencyRecorder retransmitted;
+    trading::loadgen::LatencyRecorder snapshotted;
+    recovery.set_recovered_handler([&](uint64_t, uint64_t, uint64_t ns, bool snapshot) {
+        (snapshot ? snapshotted : retransmitted).record(ns);
+    });
+
+    pid_t feed = start_feed(packets, loss, burst_every);
+    std::vector<uint8_t> packet(65536);
+    pollfd fds[2] = {{fd, POLLIN, 0}, {recovery.fd(), POLLIN, 0}};
+    size_t received = 0;
+    auto idle_since = Clock::now();
+    for (;;) {
+        ::poll(fds, 2, 1);
+        ssize_t n;
+        bool got = false;
+        while ((n = recv(fd, packet.data(), packet.size(), 0)) > 0) {
+            recovery.process(packet.data(), static_cast<size_t>(n), now_ns());
+            got = got || n > static_cast<ssize_t>(trading::feed::moldudp64::HEADER_LEN);
+            ++received;
+        }
+        recovery.poll(now_ns());
+        if (got) {
+            idle_since = Clock::now();
+        } else if (received != 0 && !recovery.recovering() &&
+                   Clock::now() - idle_since > std::chrono::milliseconds(IDLE_MS)) {
+            break;
+        }
+    }
+    kill(feed, SIGTERM);
+    waitpid(feed, nullptr, 0);
+    close(fd);
+
+    // The same stream applied without loss
+    trading::OrderBookEngine reference;
+    FeedSource source;
+    uint8_t buffer[1400];
+    for (size_t i = 0; i < packets; ++i) {
+        size_t length = source.next(buffer, sizeof(buffer));
+        trading::feed::moldudp64::for_each_message(buffer, length,
+            [&](uint64_t, const uint8_t* msg, size_t msg_length) {
+                trading::feed::itch::AddOrder order;
+                if (trading::feed::itch::parse_add_order(msg, msg_length, order)) {
+                    std::string symbol(reinterpret_cast<const char*>(&order.stock), 4);
+                    reference.apply(symbol, static_cast<uint64_t>(order.price) * 100,
+                                    order.shares, order.is_buy);
+                }
+            });
+    }
+
+    const trading::ingest::RecoveryStats& stats = recovery.stats();
+    std::cout << "  " << name << ": " << stats.released << " messages released of "
+              << source.sequence() - 1 << ", " << stats.holes << " holes, " << stats.requests
+              << " re-requests, " << stats.retransmitted << " retransmitted, " << stats.snapshots
+              << " snapshots, " << stats.buffered_peak << " held at most, books "
+              << (same_books(book, reference) ? "match" : "DIFFER") << std::endl;
+    print_latency("recovered by retransmission", retransmitted);
+    print_latency("recovered by snapshot", snapshotted);
+}
+
+} // namespace
+
+// Publishes a MoldUDP64/ITCH feed to a loopback multicast group from a
+// child that also runs the stand-in recovery server, leaving packets off
+// the wire, and keeps a book in step with GapRecovery. Reports how long
+// holes took to close by retransmission and by snapshot, and checks the
+// final book against the same stream applied without loss.
+int main(int argc, char** argv) {
+    const size_t packets = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000;
+    const double loss = argc > 2 ? std::atof(argv[2]) : 0.001;
+    const size_t burst_every = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 20000;
+
+    std::cout << packets << " packets at " << RATE / 1000 << "k/s:" << std::endl;
+    run("random loss", packets, loss, 0);
+    run("random loss and bursts", packets, loss, burst_every);
+    return 0;
+}
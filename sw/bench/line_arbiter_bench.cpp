@@ -0,0 +1,333 @@
+#include "itch_decoder.hpp"
+#include "line_arbiter.hpp"
+#include "ouch_encoder.hpp"
+#include "pcap_reader.hpp"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const uint16_t PORTS[trading::feed::NUM_LINES] = {19400, 19401};
+const char* GROUPS[trading::feed::NUM_LINES] = {"239.1.1.4", "239.1.1.5"};
+const char* LINE_NAMES[trading::feed::NUM_LINES] = {"A", "B"};
+const uint64_t PACKET_SPACING_NS = 4000;
+const int IDLE_MS = 300;
+
+uint64_t realtime_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Writes the same MoldUDP64/ITCH stream as an A and a B capture. Each line
+// drops packets independently with probability loss; B trails A by 1 us
+// on average and both jitter by up to 2 us, so either can win.
+bool write_lines(const std::string& path_a, const std::string& path_b, size_t messages,
+                 double loss) {
+    trading::feed::PcapWriter writers[trading::feed::NUM_LINES];
+    if (!writers[0].open(path_a) || !writers[1].open(path_b)) {
+        return false;
+    }
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::uniform_int_distribution<uint64_t> jitter(0, 2000);
+    std::uniform_int_distribution<size_t> per_packet(1, 8);
+
+    const uint8_t session[trading::feed::moldudp64::SESSION_LEN] = {'A', 'R', 'B', 'I', 'T',
+                                                                    'E', 'R', '0', '0', '1'};
+    uint8_t packet[1400];
+    uint8_t message[trading::feed::itch::ADD_ORDER_LEN];
+    trading::feed::itch::AddOrder order{1, 0, 0, true, 100,
+                                        trading::ouch::pack_stock("AAPL"), 1500000};
+    uint64_t sequence = 1;
+    uint64_t time_ns = 34200ull * 1000000000ull;  // 09:30
+    while (sequence <= messages) {
+        trading::feed::moldudp64::PacketBuilder builder(packet, sizeof(packet));
+        builder.begin(session, sequence);
+        size_t count = per_packet(rng);
+        for (size_t m = 0; m < count && sequence <= messages; ++m) {
+            order.timestamp_ns = time_ns;
+            order.order_ref = sequence++;
+            order.is_buy = (order.order_ref & 1) != 0;
+            order.price = 1500000 + static_cast<uint32_t>(order.order_ref % 16) * 100;
+            trading::feed::itch::encode_add_order(order, message);
+            builder.append(message, sizeof(message));
+        }
+        for (size_t line = 0; line < trading::feed::NUM_LINES; ++line) {
+            if (coin(rng) < loss) {
+                continue;
+            }
+            uint64_t at = time_ns + line * 1000 + jitter(rng);
+            writers[line].write_udp(at, 0xef010104 + static_cast<uint32_t>(line), PORTS[line],
+                                    builder.data(), builder.length());
+        }
+        time_ns += PACKET_SPACING_NS;
+    }
+    return true;
+}
+
+struct Capture {
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<uint64_t> timestamps;
+};
+
+bool load(const std::string& path, Capture& capture) {
+    trading::feed::PcapReader reader;
+    if (!reader.open(path)) {
+        return false;
+    }
+    trading::feed::UdpDatagram datagram;
+    while (reader.next(datagram)) {
+        capture.payloads.emplace_back(datagram.payload, datagram.payload + datagram.length);
+        capture.timestamps.push_back(datagram.timestamp_ns);
+    }
+    return true;
+}
+
+size_t decode(const uint8_t* msg, size_t length) {
+    trading::feed::itch::AddOrder order;
+    return trading::feed::itch::parse_add_order(msg, length, order) ? 1 : 0;
+}
+
+void report(const trading::feed::LineArbiter& arbiter) {
+    for (size_t line = 0; line < trading::feed::NUM_LINES; ++line) {
+        const trading::feed::LineStats& stats = arbiter.line_stats(line);
+        std::cout << "    line " << LINE_NAMES[line] << ": " << stats.packets << " packets, won "
+                  << arbiter.win_rate(line) * 100 << "%, led by "
+                  << (stats.lead_samples ? stats.lead_ns / stats.lead_samples : 0)
+                  << " ns on average, " << stats.gaps << " gaps (" << stats.gap_messages
+                  << " messages)" << std::endl;
+    }
+    const trading::feed::ArbiterStats& stats = arbiter.stats();
+    std::cout << "    merged: " << stats.emitted << " emitted, " << stats.gaps << " gaps, "
+              << stats.filled << " filled by the other line, " << stats.lost
+              << " lost in " << stats.lost_ranges << " ranges" << std::endl;
+}
+
+// Both captures' packets in timestamp order, as (line, index) pairs
+struct Schedule {
+    std::vector<size_t> lines;
+    std::vector<size_t> indices;
+};
+
+Schedule merge(const Capture* captures) {
+    Schedule schedule;
+    size_t positions[trading::feed::NUM_LINES] = {0, 0};
+    const size_t sizes[trading::feed::NUM_LINES] = {captures[0].payloads.size(),
+                                                    captures[1].payloads.size()};
+    while (positions[0] < sizes[0] || positions[1] < sizes[1]) {
+        size_t line = positions[1] >= sizes[1] ? 0
+            : positions[0] >= sizes[0] ? 1
+            : captures[1].timestamps[positions[1]] < captures[0].timestamps[positions[0]] ? 1 : 0;
+        schedule.lines.push_back(line);
+        schedule.indices.push_back(positions[line]++);
+    }
+    return schedule;
+}
+
+// The merged captures arbitrated on one core: the arbiter's own cost
+void bench_merged(const Capture* captures, const Schedule& schedule) {
+    // One line decoded alone, for comparison
+    size_t single_decoded = 0;
+    auto start = Clock::now();
+    for (const std::vector<uint8_t>& payload : captures[0].payloads) {
+        trading::feed::moldudp64::for_each_message(payload.data(), payload.size(),
+            [&](uint64_t, const uint8_t* msg, size_t length) {
+                single_decoded += decode(msg, length);
+            });
+    }
+    double single = std::chrono::duration<double>(Clock::now() - start).count();
+
+    trading::feed::LineArbiter arbiter;
+    size_t decoded = 0;
+    const size_t packets = schedule.lines.size();
+    start = Clock::now();
+    for (size_t i = 0; i < packets; ++i) {
+        const Capture& capture = captures[schedule.lines[i]];
+        const std::vector<uint8_t>& payload = capture.payloads[schedule.indices[i]];
+        arbiter.process(schedule.lines[i], payload.data(), payload.size(),
+                        capture.timestamps[schedule.indices[i]],
+            [&](uint32_t, uint64_t, const uint8_t* msg, size_t length) {
+                decoded += decode(msg, length);
+            });
+    }
+    double merged = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << "  merged on one core: " << packets / merged / 1e6 << " M packets/s, "
+              << arbiter.stats().emitted / merged / 1e6 << " M msgs/s emitted, "
+              << merged / packets * 1e9 << " ns/packet, " << decoded << " add orders"
+              << std::endl;
+    std::cout << "    line A decoded alone: " << single / captures[0].payloads.size() * 1e9
+              << " ns/packet, " << single_decoded << " add orders" << std::endl;
+    report(arbiter);
+}
+
+int open_line(size_t line) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    int buffer = 16 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &buffer, sizeof(buffer));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORTS[line]);
+    inet_pton(AF_INET, GROUPS[line], &addr.sin_addr);
+    ip_mreq membership;
+    membership.imr_multiaddr = addr.sin_addr;
+    inet_pton(AF_INET, "127.0.0.1", &membership.imr_interface);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Sends both captures, each to its line's group, keeping the captures'
+// timing. One process interleaves the two: with two replayers on a small
+// machine, scheduling alone would skew the lines by milliseconds.
+pid_t replay(const Capture* captures, const Schedule& schedule) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    usleep(100000);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    in_addr local;
+    inet_pton(AF_INET, "127.0.0.1", &local);
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &local, sizeof(local));
+    sockaddr_in addrs[trading::feed::NUM_LINES];
+    for (size_t line = 0; line < trading::feed::NUM_LINES; ++line) {
+        std::memset(&addrs[line], 0, sizeof(addrs[line]));
+        addrs[line].sin_family = AF_INET;
+        addrs[line].sin_port = htons(PORTS[line]);
+        inet_pton(AF_INET, GROUPS[line], &addrs[line].sin_addr);
+    }
+
+    const auto start = Clock::now();
+    uint64_t first = ~0ull;
+    for (size_t line = 0; line < trading::feed::NUM_LINES; ++line) {
+        if (!captures[line].timestamps.empty() && captures[line].timestamps[0] < first) {
+            first = captures[line].timestamps[0];
+        }
+    }
+    for (size_t i = 0; i < schedule.lines.size(); ++i) {
+        size_t line = schedule.lines[i];
+        const Capture& capture = captures[line];
+        auto due = start + std::chrono::nanoseconds(capture.timestamps[schedule.indices[i]] - first);
+        auto wait = due - Clock::now();
+        if (wait > std::chrono::microseconds(50)) {
+            usleep(static_cast<useconds_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(wait).count()));
+        }
+        const std::vector<uint8_t>& payload = capture.payloads[schedule.indices[i]];
+        sendto(fd, payload.data(), payload.size(), 0,
+               reinterpret_cast<sockaddr*>(&addrs[line]), sizeof(addrs[line]));
+    }
+    close(fd);
+    _exit(0);
+}
+
+// Both captures replayed concurrently over loopback multicast, a group per line
+void bench_live(const Capture* captures, const Schedule& schedule) {
+    int fds[trading::feed::NUM_LINES] = {open_line(0), open_line(1)};
+    if (fds[0] < 0 || fds[1] < 0) {
+        std::cout << "  live replay: could not join the line groups, skipped" << std::endl;
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        return;
+    }
+
+    trading::feed::LineArbiter arbiter;
+    pid_t sender = replay(captures, schedule);
+    pollfd polls[trading::feed::NUM_LINES] = {{fds[0], POLLIN, 0}, {fds[1], POLLIN, 0}};
+    std::vector<uint8_t> packet(65536);
+    size_t decoded = 0;
+    size_t received = 0;
+    auto idle_since = Clock::now();
+    for (;;) {
+        int ready = ::poll(polls, trading::feed::NUM_LINES, 1);
+        if (ready <= 0) {
+            arbiter.expire(realtime_ns());
+            if (received != 0 && Clock::now() - idle_since > std::chrono::milliseconds(IDLE_MS)) {
+                break;
+            }
+            continue;
+        }
+        idle_since = Clock::now();
+        // A packet from each line in turn, so neither waits behind the other's backlog
+        for (bool any = true; any;) {
+            any = false;
+            for (size_t line = 0; line < trading::feed::NUM_LINES; ++line) {
+                ssize_t n = recv(fds[line], packet.data(), packet.size(), MSG_DONTWAIT);
+                if (n <= 0) {
+                    continue;
+                }
+                any = true;
+                ++received;
+                arbiter.process(line, packet.data(), static_cast<size_t>(n), realtime_ns(),
+                    [&](uint32_t, uint64_t, const uint8_t* msg, size_t length) {
+                        decoded += decode(msg, length);
+                    });
+            }
+        }
+    }
+    waitpid(sender, nullptr, 0);
+    for (int fd : fds) {
+        close(fd);
+    }
+    std::cout << "  live replay: " << received << " packets received, " << decoded
+              << " add orders decoded" << std::endl;
+    report(arbiter);
+}
+
+} // namespace
+
+// Arbitrates two captures of one MoldUDP64 feed, given as a.pcap b.pcap
+// or generated with independent per-line packet loss. The captures are
+// first merged by timestamp and arbitrated on one core, then replayed
+// concurrently to two loopback multicast groups and arbitrated live.
+int main(int argc, char** argv) {
+    std::string paths[trading::feed::NUM_LINES] = {"/tmp/line_a.pcap", "/tmp/line_b.pcap"};
+    if (argc > 2 && std::strstr(argv[1], ".pcap")) {
+        paths[0] = argv[1];
+        paths[1] = argv[2];
+    } else {
+        const size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+        const double loss = argc > 2 ? std::atof(argv[2]) : 0.01;
+        std::cout << "Writing " << messages << " messages per line, " << loss * 100
+                  << "% packet loss per line" << std::endl;
+        if (!write_lines(paths[0], paths[1], messages, loss)) {
+            std::cerr << "Failed to write the captures" << std::endl;
+            return 1;
+        }
+    }
+
+    Capture captures[trading::feed::NUM_LINES];
+    for (size_t line = 0; line < trading::feed::NUM_LINES; ++line) {
+        if (!load(paths[line], captures[line])) {
+            std::cerr << "Failed to read " << paths[line] << std::endl;
+            return 1;
+        }
+    }
+    Schedule schedule = merge(captures);
+    bench_merged(captures, schedule);
+    bench_live(captures, schedule);
+    return 0;
+}
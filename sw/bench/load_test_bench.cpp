@@ -0,0 +1,143 @@
+#include "host_counters.hpp"
+#include "load_driver.hpp"
+#include "order_book_engine.hpp"
+#include "ouch_encoder.hpp"
+#include "trading_interface.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+void print_host_counters(const char* name, const trading::HostCounterStats& stats) {
+    if (stats.sampled == 0) {
+        return;
+    }
+    double n = static_cast<double>(stats.sampled);
+    std::cout << "  " << std::left << std::setw(17) << name << std::right
+              << std::setw(9) << stats.sampled
+              << std::setw(10) << static_cast<uint64_t>(stats.task_clock_ns / n)
+              << std::setw(10) << static_cast<uint64_t>(stats.cycles / n)
+              << std::setw(10) << static_cast<uint64_t>(stats.instructions / n)
+              << std::setw(9) << std::fixed << std::setprecision(1) << stats.l1d_misses / n
+              << std::setw(9) << stats.llc_misses / n
+              << std::setw(9) << stats.dtlb_misses / n
+              << std::setw(9) << stats.branch_misses / n << std::defaultfloat
+              << std::endl;
+}
+
+} // namespace
+
+// Open-loop latency-vs-throughput curves for each backend. Every point
+// issues operations on a fixed schedule from several threads and measures
+// latency from the scheduled send time; the sweep stops past the knee.
+//
+//   load_test_bench [threads] [seconds] [--host-counters[=N]]
+//
+// --host-counters reads host CPU counters around every N-th device call
+// and prints the per-call averages for each entry point.
+int main(int argc, char** argv) {
+    trading::loadgen::LoadTestConfig config;
+    config.threads = 2;
+    config.duration_s = 0.25;
+    config.generator.symbols = 100;
+    trading::loadgen::SweepConfig sweep;
+
+    uint32_t host_sample_every = 0;
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--host-counters", 15) == 0) {
+            host_sample_every = argv[i][15] == '=' ? std::strtoul(argv[i] + 16, nullptr, 10) : 1;
+        } else if (positional++ == 0) {
+            config.threads = static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10));
+        } else {
+            config.duration_s = std::strtod(argv[i], nullptr);
+        }
+    }
+
+    // Device: one accelerator shared by every thread, as the PCIe BAR is
+    trading::TradingAccelerator accelerator;
+    if (!accelerator.initialize("bitstream.bit")) {
+        std::cerr << "Failed to initialize FPGA" << std::endl;
+        return 1;
+    }
+    if (host_sample_every && !accelerator.enable_host_counters(host_sample_every)) {
+        std::cerr << "Host counters unavailable, continuing without them" << std::endl;
+    }
+    std::mutex device_mutex;
+    trading::loadgen::LoadBackend device;
+    device.name = "device";
+    device.send_market_data = [&](const trading::MarketData& data) {
+        std::lock_guard<std::mutex> lock(device_mutex);
+        return accelerator.send_market_data(data);
+    };
+    device.place_order = [&](const std::string& symbol, double price, uint32_t quantity,
+                             bool is_buy) {
+        std::lock_guard<std::mutex> lock(device_mutex);
+        return accelerator.place_order(symbol, price, quantity, is_buy);
+    };
+
+    // Software: host book plus the reference OUCH encoder
+    trading::OrderBookEngine engine;
+    trading::OuchEncoder encoder;
+    std::mutex software_mutex;
+    trading::loadgen::LoadBackend software;
+    software.name = "software";
+    software.send_market_data = [&](const trading::MarketData& data) {
+        std::lock_guard<std::mutex> lock(software_mutex);
+        engine.apply(data);
+        return true;
+    };
+    software.place_order = [&](const std::string& symbol, double price, uint32_t quantity,
+                               bool is_buy) {
+        trading::OrderCommand cmd{};
+        cmd.is_buy = is_buy;
+        cmd.symbol = trading::ouch::pack_stock(symbol);
+        cmd.price = trading::ouch::to_price(price);
+        cmd.quantity = quantity;
+        uint8_t frame[trading::ouch::MAX_FRAME_LEN];
+        std::lock_guard<std::mutex> lock(software_mutex);
+        return encoder.encode(cmd, frame) > 0;
+    };
+
+    for (const trading::loadgen::LoadBackend* backend : {&device, &software}) {
+        trading::loadgen::LoadDriver driver(*backend);
+        trading::loadgen::SweepResult result = driver.sweep(config, sweep);
+
+        std::cout << "\nBackend " << result.backend << " (" << config.threads
+                  << " threads, " << config.duration_s << " s per point)" << std::endl;
+        std::cout << "  offered/s  achieved/s    p50 ns    p99 ns  p99.9 ns    max ns"
+                  << "  service p99  late  unsent" << std::endl;
+        for (const trading::loadgen::LoadResult& point : result.points) {
+            std::cout << std::setw(11) << static_cast<uint64_t>(point.offered_rate)
+                      << std::setw(12) << static_cast<uint64_t>(point.achieved_rate)
+                      << std::setw(10) << point.latency.percentile_ns(0.5)
+                      << std::setw(10) << point.latency.percentile_ns(0.99)
+                      << std::setw(10) << point.latency.percentile_ns(0.999)
+                      << std::setw(10) << point.latency.max_ns()
+                      << std::setw(13) << point.service.percentile_ns(0.99)
+                      << std::setw(6) << point.late_sends
+                      << std::setw(8) << point.unsent << std::endl;
+        }
+        std::cout << "  Saturation: " << static_cast<uint64_t>(result.saturation_rate)
+                  << " ops/s" << std::endl;
+    }
+
+    trading::HostCounterReport host;
+    if (accelerator.get_host_counter_report(host)) {
+        std::cout << "\nDevice calls, host counters per sampled call (1 in "
+                  << host.sample_every << ")" << std::endl;
+        std::cout << "  entry point        sampled   task ns    cycles     instr"
+                  << "   L1D mis  LLC mis dTLB mis  br mis" << std::endl;
+        print_host_counters("send_market_data", host.send_market_data);
+        print_host_counters("get_order_book", host.get_order_book);
+        print_host_counters("place_order", host.place_order);
+        print_host_counters("cancel_order", host.cancel_order);
+        if ((host.available >> trading::HOST_CYCLES) == 0) {
+            std::cout << "  (no hardware PMU events on this host, task clock only)" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "market_generator.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Generation rate of the synthetic order-flow generator into a
+// preallocated buffer, plus a summary of the stream it produces.
+int main(int argc, char** argv) {
+    const size_t total = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000000;
+    const size_t batch = 1 << 16;
+
+    trading::loadgen::GeneratorConfig config;
+    trading::loadgen::MarketGenerator generator(config);
+    std::vector<trading::loadgen::MarketUpdate> buffer(batch);
+
+    uint64_t type_counts[3] = {0, 0, 0};
+    uint64_t top_symbol = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t done = 0; done < total; done += batch) {
+        generator.generate(buffer.data(), batch);
+        // Touch the output so the work cannot be elided
+        const trading::loadgen::MarketUpdate& last = buffer[batch - 1];
+        ++type_counts[static_cast<int>(last.type)];
+        top_symbol += last.symbol_id == 0;
+    }
+    double ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+    size_t generated = (total + batch - 1) / batch * batch;
+
+    std::cout << "Generated " << generated << " updates: "
+              << generated / ns * 1000.0 << " M msgs/s, " << ns / generated
+              << " ns/msg" << std::endl;
+    std::cout << "Last update of each batch: add " << type_counts[0] << ", cancel "
+              << type_counts[1] << ", execute " << type_counts[2] << ", most active symbol "
+              << top_symbol << std::endl;
+
+    // Shape of one batch
+    uint64_t per_type[3] = {0, 0, 0};
+    uint64_t rank0 = 0;
+    for (const trading::loadgen::MarketUpdate& update : buffer) {
+        ++per_type[static_cast<int>(update.type)];
+        rank0 += update.symbol_id == 0;
+    }
+    double span_ns = static_cast<double>(buffer.back().timestamp_ns - buffer.front().timestamp_ns);
+    std::cout << "Last batch: add " << per_type[0] << ", cancel " << per_type[1]
+              << ", execute " << per_type[2] << ", most active symbol share "
+              << static_cast<double>(rank0) / batch << ", rate "
+              << batch / span_ns * 1e9 << " msgs/s" << std::endl;
+    return 0;
+}
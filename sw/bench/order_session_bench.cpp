@@ -0,0 +1,406 @@
+#include "exchange_server.hpp"
+#include "fix_message.hpp"
+#include "fix_session.hpp"
+#include "load_driver.hpp"
+#include "ouch_session.hpp"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const uint64_t STOCK = trading::ouch::pack_stock("AAPL");
+const uint16_t OUCH_PORT = 19100;
+const uint16_t FIX_PORT = 19101;
+const size_t BATCH = 64;
+
+double ns_per(Clock::time_point start, size_t count) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+}
+
+uint32_t price_for(size_t i) {
+    return 1000000 + static_cast<uint32_t>(i % 50) * 100;
+}
+
+// Full FIX render per message, as a snprintf-based engine would
+size_t render_fix(char* out, uint64_t seq, const char* time, uint32_t id, bool is_buy,
+                  uint32_t shares, uint32_t price) {
+    char body[256];
+    int body_length = std::snprintf(body, sizeof(body),
+        "35=D\x01" "49=HOST\x01" "56=EXCH\x01" "34=%llu\x01" "52=%s\x01" "11=HOST00%08X\x01"
+        "21=1\x01" "55=AAPL\x01" "54=%c\x01" "38=%u\x01" "40=2\x01" "44=%u.%04u\x01"
+        "59=0\x01" "60=%s\x01",
+        static_cast<unsigned long long>(seq), time, id, is_buy ? '1' : '2', shares,
+        price / 10000, price % 10000, time);
+    int length = std::snprintf(out, 320, "8=FIX.4.2\x01" "9=%d\x01%s", body_length, body);
+    uint32_t sum = trading::fix::byte_sum(reinterpret_cast<uint8_t*>(out), length);
+    length += std::snprintf(out + length, 8, "10=%03u\x01", sum & 0xFF);
+    return static_cast<size_t>(length);
+}
+
+// Both paths write batches to /dev/null, so the difference is the
+// message building and the copies
+void bench_encode(size_t messages) {
+    int null_fd = open("/dev/null", O_WRONLY);
+    std::cout << "Build and write, " << BATCH << " messages per writev to /dev/null:" << std::endl;
+
+    {
+        trading::OuchEncoder encoder("HOST00");
+        std::vector<uint8_t> buffer(BATCH * trading::ouch::MAX_FRAME_LEN);
+        auto start = Clock::now();
+        for (size_t i = 0; i < messages;) {
+            size_t length = 0;
+            for (size_t j = 0; j < BATCH; ++j, ++i) {
+                trading::OrderCommand order{false, (i & 1) == 0, STOCK, price_for(i), 100, 0};
+                length += encoder.encode(order, buffer.data() + length);
+            }
+            if (write(null_fd, buffer.data(), length) < 0) {
+                break;
+            }
+        }
+        std::cout << "  OUCH full encode:     " << ns_per(start, messages) << " ns/msg" << std::endl;
+
+        trading::session::OuchSessionConfig config;
+        config.batch = BATCH;
+        trading::session::OuchSession session(config);
+        session.attach(dup(null_fd));
+        session.set_batching(true);
+        start = Clock::now();
+        uint32_t id;
+        for (size_t i = 0; i < messages; ++i) {
+            session.enter_order(STOCK, price_for(i), 100, (i & 1) == 0, id);
+        }
+        session.flush();
+        std::cout << "  OUCH template patch:  " << ns_per(start, messages) << " ns/msg"
+                  << (session.send_memory_locked() ? "" : " (send memory not locked)") << std::endl;
+    }
+
+    {
+        std::vector<char> buffer(BATCH * 320);
+        uint8_t time[trading::fix::TIME_WIDTH + 1] = {};
+        trading::fix::format_sending_time(time);
+        auto start = Clock::now();
+        for (size_t i = 0; i < messages;) {
+            size_t length = 0;
+            for (size_t j = 0; j < BATCH; ++j, ++i) {
+                length += render_fix(buffer.data() + length, i + 1, reinterpret_cast<char*>(time),
+                                     static_cast<uint32_t>(i + 1), (i & 1) == 0, 100, price_for(i));
+            }
+            if (write(null_fd, buffer.data(), length) < 0) {
+                break;
+            }
+        }
+        std::cout << "  FIX snprintf render:  " << ns_per(start, messages) << " ns/msg" << std::endl;
+
+        trading::session::FixSessionConfig config;
+        config.batch = BATCH;
+        trading::session::FixSession session(config);
+        int symbol = session.add_symbol("AAPL");
+        session.attach(dup(null_fd));
+        session.set_batching(true);
+        start = Clock::now();
+        uint32_t id;
+        for (size_t i = 0; i < messages; ++i) {
+            session.new_order(symbol, price_for(i), 100, (i & 1) == 0, id);
+        }
+        session.flush();
+        std::cout << "  FIX template patch:   " << ns_per(start, messages) << " ns/msg" << std::endl;
+    }
+    close(null_fd);
+}
+
+std::atomic<bool> server_stop(false);
+
+void on_term(int) {
+    server_stop.store(true);
+}
+
+pid_t start_exchange() {
+    pid_t pid = fork();
+    if (pid == 0) {
+        std::signal(SIGTERM, on_term);
+        trading::exchange::ExchangeConfig config;
+        config.tcp_port = OUCH_PORT;
+        trading::exchange::ExchangeServer server(config);
+        if (!server.open()) {
+            _exit(1);
+        }
+        server.run(server_stop);
+        _exit(0);
+    }
+    return pid;
+}
+
+// Answers Logon with Logon and every order or cancel with an
+// ExecutionReport, replies for one read going out in one write
+void run_fix_acceptor(int listen_fd) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+        return;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    std::vector<uint8_t> in(1 << 18);
+    size_t in_length = 0;
+    std::string out;
+    uint64_t seq = 1;
+    uint64_t exec_id = 1;
+    uint8_t time[trading::fix::TIME_WIDTH];
+    trading::fix::format_sending_time(time);
+    const std::string sending_time(time, time + sizeof(time));
+
+    auto reply = [&](const char* type, const std::vector<std::pair<int, std::string>>& fields) {
+        trading::fix::FixTemplate message(type);
+        message.add(49, "EXCH");
+        message.add(56, "HOST");
+        message.add(34, std::to_string(seq++));
+        message.add(52, sending_time);
+        for (const auto& field : fields) {
+            message.add(field.first, field.second);
+        }
+        message.finish();
+        out.append(message.bytes().begin(), message.bytes().end());
+    };
+
+    while (!server_stop.load()) {
+        ssize_t n = recv(fd, in.data() + in_length, in.size() - in_length, 0);
+        if (n <= 0) {
+            break;
+        }
+        in_length += static_cast<size_t>(n);
+        size_t pos = 0;
+        bool logout = false;
+        while (true) {
+            size_t length = trading::fix::message_length(in.data() + pos, in_length - pos);
+            if (length == 0 || length == trading::fix::MALFORMED) {
+                break;
+            }
+            std::string type, cl_ord_id, orig_cl_ord_id, side, symbol, qty;
+            trading::fix::for_each_field(in.data() + pos, length,
+                [&](int tag, const char* value, size_t value_length) {
+                    std::string v(value, value_length);
+                    switch (tag) {
+                    case 35: type = v; break;
+                    case 11: cl_ord_id = v; break;
+                    case 41: orig_cl_ord_id = v; break;
+                    case 54: side = v; break;
+                    case 55: symbol = v; break;
+                    case 38: qty = v; break;
+                    default: break;
+                    }
+                });
+            pos += length;
+
+            if (type == "A") {
+                reply("A", {{98, "0"}, {108, "30"}});
+            } else if (type == "D") {
+                reply("8", {{37, std::to_string(exec_id)}, {17, std::to_string(exec_id)},
+                            {11, cl_ord_id}, {150, "0"}, {39, "0"}, {55, symbol}, {54, side},
+                            {151, qty}, {14, "0"}, {6, "0"}});
+                ++exec_id;
+            } else if (type == "F") {
+                reply("8", {{37, std::to_string(exec_id)}, {17, std::to_string(exec_id)},
+                            {11, cl_ord_id}, {41, orig_cl_ord_id}, {150, "4"}, {39, "4"},
+                            {55, symbol}, {54, side}, {151, "0"}, {14, "0"}, {6, "0"}});
+                ++exec_id;
+            } else if (type == "5") {
+                reply("5", {});
+                logout = true;
+            }
+        }
+        std::memmove(in.data(), in.data() + pos, in_length - pos);
+        in_length -= pos;
+        if (!out.empty()) {
+            if (send(fd, out.data(), out.size(), MSG_NOSIGNAL) < 0) {
+                break;
+            }
+            out.clear();
+        }
+        if (logout) {
+            break;
+        }
+    }
+    close(fd);
+}
+
+pid_t start_fix_acceptor() {
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(FIX_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listen_fd, 1) != 0) {
+        close(listen_fd);
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        std::signal(SIGTERM, on_term);
+        run_fix_acceptor(listen_fd);
+        _exit(0);
+    }
+    close(listen_fd);
+    return pid;
+}
+
+void stop(pid_t pid) {
+    if (pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+void wait_readable(int fd) {
+    pollfd pfd{fd, POLLIN, 0};
+    ::poll(&pfd, 1, 1);
+}
+
+struct OuchAcks : trading::exchange::ExchangeHandler {
+    uint64_t accepted = 0;
+    void on_accepted(const trading::ouch::OrderAccepted&) override { ++accepted; }
+};
+
+struct FixAcks : trading::session::FixHandler {
+    uint64_t reports = 0;
+    void on_execution_report(const trading::session::ExecutionReport&) override { ++reports; }
+};
+
+void print_latency(const char* name, const trading::loadgen::LatencyRecorder& latency) {
+    std::cout << "  " << name << " round trip: p50 " << latency.percentile_ns(0.5) / 1000.0
+              << " us, p99 " << latency.percentile_ns(0.99) / 1000.0 << " us, max "
+              << latency.max_ns() / 1000.0 << " us" << std::endl;
+}
+
+// Each session drives its own acceptor: one order at a time for the
+// round trip, then batches of orders while acknowledgements are drained
+template <typename Session, typename Acks, typename Send>
+void bench_session(const char* name, Session& session, Acks& acks, uint64_t Acks::*counter,
+                   Send send, size_t round_trips, size_t streamed) {
+    trading::loadgen::LatencyRecorder latency;
+    for (size_t i = 0; i < round_trips; ++i) {
+        uint64_t expected = acks.*counter + 1;
+        auto start = Clock::now();
+        send(i);
+        while (acks.*counter < expected) {
+            if (session.poll(acks) == 0) {
+                wait_readable(session.fd());
+            }
+        }
+        latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - start).count()));
+        if ((i & 1023) == 0) {
+            session.service();
+        }
+    }
+    print_latency(name, latency);
+
+    session.set_batching(true);
+    uint64_t expected = acks.*counter + streamed;
+    uint64_t writes = session.writes();
+    auto start = Clock::now();
+    for (size_t i = 0; i < streamed; ++i) {
+        send(i);
+        if ((i & (BATCH - 1)) == BATCH - 1) {
+            session.poll(acks);
+        }
+    }
+    session.flush();
+    while (acks.*counter < expected) {
+        if (session.poll(acks) == 0) {
+            wait_readable(session.fd());
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << "  " << name << " streamed: " << streamed / seconds / 1e6 << " M orders/s acked, "
+              << static_cast<double>(streamed) / (session.writes() - writes) << " orders per write"
+              << std::endl;
+    session.set_batching(false);
+}
+
+} // namespace
+
+// Order building cost of the pre-rendered templates against a full encode,
+// then round trips and streamed throughput of OuchSession against an
+// exchange process and of FixSession against a minimal FIX acceptor, both
+// over loopback TCP. The acceptors share the core on small machines, so
+// the loopback figures include their work.
+int main(int argc, char** argv) {
+    const size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+    const size_t round_trips = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000;
+    const size_t streamed = messages / 25;
+
+    bench_encode(messages);
+
+    std::cout << "Loopback sessions:" << std::endl;
+    pid_t exchange = start_exchange();
+    trading::session::OuchSessionConfig ouch_config;
+    ouch_config.port = OUCH_PORT;
+    ouch_config.batch = BATCH;
+    trading::session::OuchSession ouch(ouch_config);
+    bool connected = false;
+    for (int attempt = 0; attempt < 200 && !connected; ++attempt) {
+        connected = ouch.connect();
+        if (!connected) {
+            usleep(10000);
+        }
+    }
+    if (connected) {
+        OuchAcks acks;
+        // Orders rest on alternating sides a tick apart, so none cross
+        bench_session("OUCH", ouch, acks, &OuchAcks::accepted,
+            [&](size_t i) {
+                uint32_t id;
+                bool is_buy = (i & 1) == 0;
+                ouch.enter_order(STOCK, is_buy ? 990000 : 1010000, 100, is_buy, id);
+            },
+            round_trips, streamed);
+        ouch.close();
+    } else {
+        std::cout << "  OUCH: exchange did not start" << std::endl;
+    }
+    stop(exchange);
+
+    pid_t acceptor = start_fix_acceptor();
+    trading::session::FixSessionConfig fix_config;
+    fix_config.port = FIX_PORT;
+    fix_config.batch = BATCH;
+    trading::session::FixSession fix(fix_config);
+    int symbol = fix.add_symbol("AAPL");
+    if (acceptor > 0 && fix.connect()) {
+        FixAcks acks;
+        bench_session("FIX", fix, acks, &FixAcks::reports,
+            [&](size_t i) {
+                uint32_t id;
+                fix.new_order(symbol, price_for(i), 100, (i & 1) == 0, id);
+            },
+            round_trips, streamed);
+        std::cout << "  FIX inbound sequence gaps: " << fix.sequence_gaps() << std::endl;
+        fix.close();
+    } else {
+        std::cout << "  FIX: acceptor did not start" << std::endl;
+    }
+    stop(acceptor);
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "ouch_encoder.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <x86intrin.h>
+
+// Measures the C++ reference encoder in host cycles per message. The RTL
+// encoder needs one accept cycle plus one cycle per 8-byte beat, so it is
+// listed alongside for comparison.
+int main(int argc, char** argv) {
+    const size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    trading::OuchEncoder encoder;
+    std::vector<trading::OrderCommand> commands(1024);
+    for (size_t i = 0; i < commands.size(); ++i) {
+        trading::OrderCommand& cmd = commands[i];
+        cmd.cancel = (i % 4) == 3;
+        cmd.is_buy = (i % 2) == 0;
+        cmd.symbol = trading::ouch::pack_stock(i % 3 ? "AAPL" : "MSFT");
+        cmd.price = trading::ouch::to_price(150.25 + 0.01 * (i % 100));
+        cmd.quantity = 100 + static_cast<uint32_t>(i);
+        cmd.order_id = static_cast<uint32_t>(i);
+    }
+
+    uint8_t frame[trading::ouch::MAX_FRAME_LEN];
+    uint64_t bytes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t tsc_start = __rdtsc();
+    for (size_t i = 0; i < iterations; ++i) {
+        bytes += encoder.encode(commands[i & (commands.size() - 1)], frame);
+    }
+    uint64_t tsc_end = __rdtsc();
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::cout << "Messages encoded: " << encoder.messages_sent() << std::endl;
+    std::cout << "Bytes: " << bytes << std::endl;
+    std::cout << "Software: " << ns / iterations << " ns/msg, "
+              << static_cast<double>(tsc_end - tsc_start) / iterations
+              << " TSC cycles/msg" << std::endl;
+    std::cout << "RTL: enter order " << 1 + 7 << " cycles, cancel order "
+              << 1 + 3 << " cycles (64-bit datapath)" << std::endl;
+
+    return 0;
+}
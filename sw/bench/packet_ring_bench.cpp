@@ -0,0 +1,254 @@
+#include "feed_publisher.hpp"
+#include "itch_decoder.hpp"
+#include "ouch_encoder.hpp"
+#include "packet_ring.hpp"
+#include "trading_interface.hpp"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const uint16_t PORT = 19200;
+const size_t MESSAGES_PER_PACKET = 4;
+const size_t SEND_BATCH = 64;
+const int IDLE_MS = 300;
+
+double cpu_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// MoldUDP64 packets of ITCH add orders, sent with sendmmsg from a child
+pid_t start_sender(const std::string& dest, size_t packets) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    usleep(100000);  // let the receiver open its ring
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORT);
+    inet_pton(AF_INET, dest.c_str(), &addr.sin_addr);
+
+    const uint8_t session[trading::feed::moldudp64::SESSION_LEN] = {'B', 'E', 'N', 'C', 'H',
+                                                                    ' ', ' ', ' ', ' ', ' '};
+    std::vector<std::vector<uint8_t>> buffers(SEND_BATCH, std::vector<uint8_t>(512));
+    std::vector<iovec> iov(SEND_BATCH);
+    std::vector<mmsghdr> msgs(SEND_BATCH);
+    trading::feed::itch::AddOrder order{1, 0, 0, true, 100,
+                                        trading::ouch::pack_stock("AAPL"), 1500000};
+    uint8_t message[trading::feed::itch::ADD_ORDER_LEN];
+    uint64_t sequence = 1;
+
+    for (size_t sent = 0; sent < packets;) {
+        size_t batch = packets - sent < SEND_BATCH ? packets - sent : SEND_BATCH;
+        for (size_t i = 0; i < batch; ++i) {
+            trading::feed::moldudp64::PacketBuilder builder(buffers[i].data(), buffers[i].size());
+            builder.begin(session, sequence);
+            for (size_t m = 0; m < MESSAGES_PER_PACKET; ++m) {
+                order.order_ref = sequence++;
+                order.is_buy = (order.order_ref & 1) != 0;
+                order.price = 1500000 + static_cast<uint32_t>(order.order_ref % 16) * 100;
+                size_t length = trading::feed::itch::encode_add_order(order, message);
+                builder.append(message, length);
+            }
+            iov[i] = iovec{buffers[i].data(), builder.length()};
+            std::memset(&msgs[i], 0, sizeof(mmsghdr));
+            msgs[i].msg_hdr.msg_name = &addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(addr);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = sendmmsg(fd, msgs.data(), static_cast<unsigned>(batch), 0);
+        if (n <= 0) {
+            usleep(100);
+            continue;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    close(fd);
+    _exit(0);
+}
+
+struct Result {
+    uint64_t packets = 0;
+    uint64_t messages = 0;
+    double wall = 0;
+    double cpu = 0;
+};
+
+void report(const char* name, const Result& result, size_t sent, uint64_t kernel_drops) {
+    std::cout << "  " << name << ": " << result.packets / result.wall / 1e3 << " k packets/s, "
+              << result.cpu / result.packets * 1e9 << " ns CPU/packet, " << result.messages
+              << " messages, " << (sent - result.packets) << " lost";
+    if (kernel_drops != 0) {
+        std::cout << " (" << kernel_drops << " ring drops)";
+    }
+    std::cout << std::endl;
+}
+
+// Times from the first packet to the last, with the receiver's CPU time
+template <typename Receive>
+Result drain(size_t packets, Receive receive) {
+    Result result;
+    Clock::time_point start, last;
+    double cpu_start = 0;
+    auto idle_since = Clock::now();
+    while (result.packets < packets) {
+        size_t got = receive(result);
+        auto now = Clock::now();
+        if (got == 0) {
+            if (result.packets != 0 &&
+                now - idle_since > std::chrono::milliseconds(IDLE_MS)) {
+                break;
+            }
+            continue;
+        }
+        if (result.packets == got) {
+            start = now;
+            cpu_start = cpu_seconds();
+        }
+        last = now;
+        idle_since = now;
+    }
+    result.wall = std::chrono::duration<double>(last - start).count();
+    result.cpu = cpu_seconds() - cpu_start;
+    if (result.wall <= 0) {
+        result.wall = 1e-9;
+    }
+    return result;
+}
+
+size_t count_messages(const trading::feed::UdpDatagram& datagram) {
+    return trading::feed::moldudp64::for_each_message(datagram.payload, datagram.length,
+        [](uint64_t, const uint8_t* msg, size_t length) {
+            trading::feed::itch::AddOrder order;
+            trading::feed::itch::parse_add_order(msg, length, order);
+        });
+}
+
+// One recv() per packet, the path the packet ring replaces
+void bench_socket(const std::string& dest, size_t packets) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    int buffer = 64 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    timeval timeout{0, 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cout << "  recv() socket: port in use, skipped" << std::endl;
+        close(fd);
+        return;
+    }
+
+    pid_t sender = start_sender(dest, packets);
+    std::vector<uint8_t> packet(65536);
+    Result result = drain(packets, [&](Result& r) -> size_t {
+        ssize_t n = recv(fd, packet.data(), packet.size(), 0);
+        if (n <= 0) {
+            return 0;
+        }
+        trading::feed::UdpDatagram datagram{0, 0, 0, 0, PORT, packet.data(),
+                                            static_cast<size_t>(n)};
+        r.messages += count_messages(datagram);
+        ++r.packets;
+        return 1;
+    });
+    waitpid(sender, nullptr, 0);
+    close(fd);
+    report("recv() socket", result, packets, 0);
+}
+
+void bench_ring(const char* name, trading::ingest::RingMode mode, const std::string& interface,
+                const std::string& dest, size_t packets, trading::TradingAccelerator* accelerator) {
+    // Something must own the port or every packet draws an ICMP reply
+    int sink = socket(AF_INET, SOCK_DGRAM, 0);
+    int small = 4096;
+    setsockopt(sink, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    bind(sink, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+
+    trading::ingest::PacketRingConfig config;
+    config.interface = interface;
+    config.udp_port = PORT;
+    config.mode = mode;
+    trading::ingest::PacketRing ring;
+    if (!ring.open(config)) {
+        std::cout << "  " << name << ": could not open the ring, skipped" << std::endl;
+        close(sink);
+        return;
+    }
+
+    std::unique_ptr<trading::ingest::FeedPublisher> publisher;
+    if (accelerator) {
+        publisher.reset(new trading::ingest::FeedPublisher(*accelerator));
+    }
+    pid_t sender = start_sender(dest, packets);
+    Result result = drain(packets, [&](Result& r) -> size_t {
+        return ring.poll([&](const trading::feed::UdpDatagram& datagram) {
+            r.messages += publisher ? publisher->publish(datagram) : count_messages(datagram);
+            ++r.packets;
+        }, 1);
+    });
+    waitpid(sender, nullptr, 0);
+    trading::ingest::PacketRingStats stats = ring.stats();
+    report(name, result, packets, stats.kernel_drops);
+    std::cout << "    " << static_cast<double>(stats.packets) / (stats.batches ? stats.batches : 1)
+              << " packets per wake-up" << std::endl;
+    ring.close();
+    close(sink);
+}
+
+} // namespace
+
+// Receives MoldUDP64/ITCH packets sent over an interface (lo by default;
+// give a veth end and the peer's address to use a veth pair) with one
+// recv() per packet, from a TPACKET_V3 ring and from an AF_XDP socket.
+// Reports packets per second and receiver CPU time per packet, first
+// decoding only and then publishing every add order to the simulated
+// device through send_market_data.
+int main(int argc, char** argv) {
+    const size_t packets = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const std::string interface = argc > 2 ? argv[2] : "lo";
+    const std::string dest = argc > 3 ? argv[3] : "127.0.0.1";
+    using trading::ingest::RingMode;
+
+    std::cout << "Decode only, " << MESSAGES_PER_PACKET << " add orders per packet:" << std::endl;
+    bench_socket(dest, packets);
+    bench_ring("TPACKET_V3", RingMode::TPACKET_V3, interface, dest, packets, nullptr);
+    bench_ring("AF_XDP", RingMode::XDP_SOCKET, interface, dest, packets, nullptr);
+
+    trading::TradingAccelerator accelerator;
+    if (!accelerator.initialize("bitstream.bit")) {
+        return 1;
+    }
+    std::cout << "Decode and send_market_data:" << std::endl;
+    bench_ring("TPACKET_V3", RingMode::TPACKET_V3, interface, dest, packets, &accelerator);
+    bench_ring("AF_XDP", RingMode::XDP_SOCKET, interface, dest, packets, &accelerator);
+    return 0;
+}
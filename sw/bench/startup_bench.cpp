@@ -0,0 +1,101 @@
+#include "book_snapshot.hpp"
+#include "order_book_engine.hpp"
+#include "trading_interface.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Time to the first valid book after a restart: restoring a snapshot at
+// initialize() against replaying the same levels as market data updates.
+int main(int argc, char** argv) {
+    const size_t symbols = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100;
+    const size_t levels = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 500;  // per side
+    const std::string path = argc > 3 ? argv[3] : "/tmp/startup_bench.snap";
+
+    // Synthetic depth around 100.00 with a 0.01 tick
+    trading::OrderBookEngine engine;
+    for (size_t s = 0; s < symbols; ++s) {
+        std::string symbol = "S" + std::to_string(s);
+        for (size_t i = 0; i < levels; ++i) {
+            engine.apply(symbol, 100000000 - 10000 * (i + 1), static_cast<uint32_t>(100 + i), true);
+            engine.apply(symbol, 100000000 + 10000 * (i + 1), static_cast<uint32_t>(100 + i), false);
+        }
+    }
+
+    trading::BookSnapshot snapshot;
+    engine.save(snapshot);
+    if (!trading::save_book_snapshot(path, snapshot)) {
+        return 1;
+    }
+    std::cout << "Snapshot: " << snapshot.symbols.size() << " symbols, "
+              << snapshot.level_count() << " levels" << std::endl;
+
+    // Restore from the snapshot
+    trading::OrderBookEngine restored;
+    trading::StartupOptions options;
+    options.snapshot_path = path;
+    options.device_symbol = "S0";
+    options.software_book = &restored;
+
+    trading::TradingAccelerator accelerator;
+    trading::StartupReport report;
+    if (!accelerator.initialize("bitstream.bit", options) ||
+        !accelerator.get_startup_report(report)) {
+        std::cerr << "Snapshot restore failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Snapshot restore:" << std::endl;
+    std::cout << "  File load: " << report.snapshot_load_ns / 1000.0 << " us" << std::endl;
+    std::cout << "  Software levels: " << report.software_levels << std::endl;
+    std::cout << "  Device levels: " << report.device_levels << std::endl;
+    std::cout << "  Time to first valid book: " << report.time_to_first_book_ns / 1000.0
+              << " us wall";
+    if (report.device_cycles > 0) {
+        std::cout << ", " << report.device_cycles << " device cycles";
+    }
+    std::cout << std::endl;
+
+    trading::OrderBook device_book;
+    trading::OrderBook software_book;
+    accelerator.get_order_book("S0", device_book);
+    restored.top_of_book("S0", software_book);
+    std::cout << "  S0 device " << device_book.best_bid_price << " x " << device_book.best_ask_price
+              << ", software " << software_book.best_bid_price << " x "
+              << software_book.best_ask_price << std::endl;
+
+    // Replaying the device symbol's levels one update at a time
+    trading::TradingAccelerator replay;
+    if (!replay.initialize("bitstream.bit")) {
+        return 1;
+    }
+    const trading::SymbolDepth* depth = &snapshot.symbols.front();
+    for (const trading::SymbolDepth& candidate : snapshot.symbols) {
+        if (candidate.symbol == "S0") {
+            depth = &candidate;
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (const trading::BookLevel& level : depth->bids) {
+        replay.send_market_data({"S0", level.price / 1000000.0, level.quantity, true, {}});
+    }
+    for (const trading::BookLevel& level : depth->asks) {
+        replay.send_market_data({"S0", level.price / 1000000.0, level.quantity, false, {}});
+    }
+    trading::OrderBook book;
+    replay.get_order_book("S0", book);
+    double replay_ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Update replay (device symbol only):" << std::endl;
+    std::cout << "  Time to first valid book: " << replay_ns / 1000.0 << " us wall";
+    trading::SimCycleReport cycles;
+    if (replay.get_sim_cycle_report(cycles)) {
+        std::cout << ", " << cycles.send_market_data.cycles + cycles.get_order_book.cycles
+                  << " device cycles";
+    }
+    std::cout << std::endl;
+
+    return 0;
+}
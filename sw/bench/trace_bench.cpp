@@ -0,0 +1,109 @@
+#include "itch_decoder.hpp"
+#include "trace.hpp"
+#include "trading_interface.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Cost of one trace event, then a traced tick-to-trade run: a feed thread
+// decodes ITCH adds and sends them to the device while a strategy thread
+// reads the book and places orders. The dump converts with trace_to_chrome.
+// Build with -DENABLE_TRACING=ON for the library's own trace points.
+int main(int argc, char** argv) {
+    const size_t ticks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+    const std::string path = argc > 2 ? argv[2] : "trace.bin";
+
+    const size_t iterations = 10000000;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        trading::trace::record(trading::trace::USER, trading::trace::INSTANT,
+                               static_cast<uint32_t>(i));
+    }
+    double ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "Trace event: " << ns / iterations << " ns" << std::endl;
+
+    // The floor: RDTSC alone, which is slow where a hypervisor traps it
+    volatile uint64_t tsc = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        tsc = __rdtsc();
+    }
+    (void)tsc;
+    ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "RDTSC alone: " << ns / iterations << " ns" << std::endl;
+
+    trading::TradingAccelerator accelerator;
+    if (!accelerator.initialize("bitstream.bit")) {
+        std::cerr << "Failed to initialize FPGA" << std::endl;
+        return 1;
+    }
+    std::mutex device_mutex;
+
+    std::vector<std::vector<uint8_t>> messages(ticks);
+    for (size_t i = 0; i < ticks; ++i) {
+        trading::feed::itch::AddOrder order{};
+        order.order_ref = i + 1;
+        order.is_buy = i % 2 == 0;
+        order.shares = 100;
+        order.stock = 0x20202020204c5041ull;  // "APL" space padded
+        order.price = static_cast<uint32_t>(1500000 + (i % 50) * 100);
+        messages[i].resize(trading::feed::itch::ADD_ORDER_LEN);
+        trading::feed::itch::encode_add_order(order, messages[i].data());
+    }
+
+    std::atomic<uint64_t> published(0);
+    std::atomic<bool> done(false);
+    std::thread strategy([&]() {
+        uint64_t seen = 0;
+        while (!done.load(std::memory_order_acquire) || seen != published.load()) {
+            uint64_t latest = published.load(std::memory_order_acquire);
+            if (latest == seen) {
+                std::this_thread::yield();
+                continue;
+            }
+            seen = latest;
+            TRACE_SCOPE(trading::trace::STRATEGY, static_cast<uint32_t>(seen));
+            std::lock_guard<std::mutex> lock(device_mutex);
+            trading::OrderBook book;
+            accelerator.get_order_book("APL", book);
+            if (seen % 8 == 0) {
+                accelerator.place_order("APL", book.best_bid_price, 10, true);
+            }
+        }
+    });
+
+    for (size_t i = 0; i < ticks; ++i) {
+        trading::MarketData data;
+        {
+            TRACE_SCOPE(trading::trace::FEED_DECODE, static_cast<uint32_t>(i));
+            trading::feed::itch::AddOrder order{};
+            trading::feed::itch::parse_add_order(messages[i].data(), messages[i].size(), order);
+            data = trading::MarketData{"APL", order.price / 10000.0, order.shares, order.is_buy,
+                                       std::chrono::nanoseconds(order.timestamp_ns)};
+        }
+        {
+            std::lock_guard<std::mutex> lock(device_mutex);
+            accelerator.send_market_data(data);
+        }
+        published.store(i + 1, std::memory_order_release);
+        std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+    strategy.join();
+
+    if (!trading::trace::dump(path)) {
+        return 1;
+    }
+    std::cout << "Traced " << ticks << " ticks to " << path
+              << "; convert with: trace_to_chrome " << path << " trace.json" << std::endl;
+    #ifndef TRADING_TRACE
+    std::cout << "(trace points are compiled out; configure with -DENABLE_TRACING=ON)" << std::endl;
+    #endif
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include "itch_decoder.hpp"
+#include "load_driver.hpp"
+#include "ouch_encoder.hpp"
+#include "trading_interface.hpp"
+#include "udp_feed.hpp"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const uint16_t PORT = 19300;
+const size_t MESSAGES_PER_PACKET = 4;
+const size_t SEND_BATCH = 64;
+const int IDLE_MS = 300;
+const uint64_t NS_PER_DAY = 86400ull * 1000000000ull;
+
+uint64_t realtime_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+double cpu_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// MoldUDP64 packets of ITCH add orders stamped with the send time (ns
+// since midnight, CLOCK_REALTIME), sendmmsg'd by a child. rate 0 sends as
+// fast as it can, otherwise packets per second in batches of burst.
+pid_t start_sender(const std::string& group, const std::string& interface_address,
+                   size_t packets, uint64_t rate, size_t burst) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    usleep(100000);  // let the receiver join
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    in_addr local;
+    inet_pton(AF_INET, interface_address.c_str(), &local);
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &local, sizeof(local));
+    unsigned char loop = 1;
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORT);
+    inet_pton(AF_INET, group.c_str(), &addr.sin_addr);
+
+    const uint8_t session[trading::feed::moldudp64::SESSION_LEN] = {'B', 'E', 'N', 'C', 'H',
+                                                                    ' ', ' ', ' ', ' ', ' '};
+    std::vector<std::vector<uint8_t>> buffers(SEND_BATCH, std::vector<uint8_t>(512));
+    std::vector<iovec> iov(SEND_BATCH);
+    std::vector<mmsghdr> msgs(SEND_BATCH);
+    trading::feed::itch::AddOrder order{1, 0, 0, true, 100,
+                                        trading::ouch::pack_stock("AAPL"), 1500000};
+    uint8_t message[trading::feed::itch::ADD_ORDER_LEN];
+    uint64_t sequence = 1;
+    const auto start = Clock::now();
+
+    for (size_t sent = 0; sent < packets;) {
+        if (rate != 0) {
+            // Sleep rather than spin: the receiver may share the core
+            auto due = start + std::chrono::nanoseconds(sent * 1000000000ull / rate);
+            auto wait = due - Clock::now();
+            if (wait.count() > 0) {
+                usleep(static_cast<useconds_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(wait).count()));
+            }
+        }
+        size_t batch = packets - sent < burst ? packets - sent : burst;
+        uint64_t now = realtime_ns() % NS_PER_DAY;
+        for (size_t i = 0; i < batch; ++i) {
+            trading::feed::moldudp64::PacketBuilder builder(buffers[i].data(), buffers[i].size());
+            builder.begin(session, sequence);
+            for (size_t m = 0; m < MESSAGES_PER_PACKET; ++m) {
+                order.timestamp_ns = now;
+                order.order_ref = sequence++;
+                order.is_buy = (order.order_ref & 1) != 0;
+                order.price = 1500000 + static_cast<uint32_t>(order.order_ref % 16) * 100;
+                size_t length = trading::feed::itch::encode_add_order(order, message);
+                builder.append(message, length);
+            }
+            iov[i] = iovec{buffers[i].data(), builder.length()};
+            std::memset(&msgs[i], 0, sizeof(mmsghdr));
+            msgs[i].msg_hdr.msg_name = &addr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(addr);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = sendmmsg(fd, msgs.data(), static_cast<unsigned>(batch), 0);
+        if (n <= 0) {
+            usleep(100);
+            continue;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    close(fd);
+    _exit(0);
+}
+
+void print_latency(const char* name, const trading::loadgen::LatencyRecorder& recorder) {
+    std::cout << "    " << name << ": p50 " << recorder.percentile_ns(0.5) / 1e3
+              << " us, p99 " << recorder.percentile_ns(0.99) / 1e3 << " us, p99.9 "
+              << recorder.percentile_ns(0.999) / 1e3 << " us, max "
+              << recorder.max_ns() / 1e3 << " us" << std::endl;
+}
+
+// Receives until every packet is in or the feed goes idle. Send to receive
+// is the kernel receive stamp less the ITCH timestamp; receive to send is
+// the time send_market_data returned less the receive stamp.
+void run(const char* name, trading::TradingAccelerator& accelerator,
+         const trading::ingest::UdpFeedConfig& config, size_t packets, uint64_t rate,
+         size_t burst) {
+    trading::ingest::UdpFeedHandler handler(accelerator);
+    if (!handler.open(config)) {
+        std::cout << "  " << name << ": could not open the feed, skipped" << std::endl;
+        return;
+    }
+
+    trading::loadgen::LatencyRecorder wire;
+    trading::loadgen::LatencyRecorder pipeline;
+    pid_t sender = start_sender(config.group, config.interface_address, packets, rate, burst);
+    Clock::time_point start, last;
+    double cpu_start = 0;
+    auto idle_since = Clock::now();
+    while (handler.stats().datagrams < packets) {
+        size_t got = handler.poll(1);
+        auto now = Clock::now();
+        if (got == 0) {
+            if (handler.stats().datagrams != 0 &&
+                now - idle_since > std::chrono::milliseconds(IDLE_MS)) {
+                break;
+            }
+            continue;
+        }
+        if (handler.stats().datagrams == got) {
+            start = now;
+            cpu_start = cpu_seconds();
+        }
+        last = now;
+        idle_since = now;
+
+        uint64_t delivered_ns = realtime_ns();
+        const trading::BookUpdate* updates = handler.updates();
+        const uint64_t* received = handler.receive_times();
+        for (size_t i = 0; i < handler.update_count(); ++i) {
+            uint64_t received_of_day = received[i] % NS_PER_DAY;
+            if (received_of_day >= updates[i].timestamp_ns) {
+                wire.record(received_of_day - updates[i].timestamp_ns);
+            }
+            pipeline.record(delivered_ns - received[i]);
+        }
+    }
+    double cpu = cpu_seconds() - cpu_start;
+    waitpid(sender, nullptr, 0);
+
+    const trading::ingest::UdpFeedStats& stats = handler.stats();
+    double wall = std::chrono::duration<double>(last - start).count();
+    if (wall <= 0) {
+        wall = 1e-9;
+    }
+    std::cout << "  " << name << ": " << stats.delivered / wall / 1e6 << " M msgs/s, "
+              << cpu / (stats.delivered ? stats.delivered : 1) * 1e9 << " ns CPU/msg, "
+              << static_cast<double>(stats.datagrams) / (stats.batches ? stats.batches : 1)
+              << " datagrams per recvmmsg, " << (packets - stats.datagrams) << " lost";
+    if (stats.kernel_drops != 0) {
+        std::cout << " (" << stats.kernel_drops << " socket drops)";
+    }
+    std::cout << std::endl;
+    print_latency("send to receive", wire);
+    print_latency("receive to send_market_data", pipeline);
+    handler.close();
+}
+
+} // namespace
+
+// Sends MoldUDP64/ITCH add orders to a multicast group over loopback
+// delivery and receives them with UdpFeedHandler into the simulated
+// device. The first runs go flat out, with one datagram per recvmmsg and
+// then a batch of 64; the last paces the sender to show latency when the
+// receiver keeps up. Receive timestamps are kernel software stamps.
+int main(int argc, char** argv) {
+    const size_t packets = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    const std::string group = argc > 2 ? argv[2] : "239.1.1.1";
+    const std::string interface_address = argc > 3 ? argv[3] : "127.0.0.1";
+    const uint64_t rate = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 20000;
+
+    trading::TradingAccelerator accelerator;
+    if (!accelerator.initialize("bitstream.bit")) {
+        return 1;
+    }
+
+    trading::ingest::UdpFeedConfig config;
+    config.group = group;
+    config.port = PORT;
+    config.interface_address = interface_address;
+
+    std::cout << MESSAGES_PER_PACKET << " add orders per datagram, " << packets
+              << " datagrams:" << std::endl;
+    config.batch = 1;
+    run("flat out, batch 1", accelerator, config, packets, 0, SEND_BATCH);
+    config.batch = 64;
+    run("flat out, batch 64", accelerator, config, packets, 0, SEND_BATCH);
+    run("paced", accelerator, config, packets, rate, 1);
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "trading_interface.hpp"
+#include "warm_state.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Reattach time of the warm-restart state and its commit cost. A child
+// process places orders and is killed mid-way through uncommitted
+// changes; the parent then restarts against the same file.
+int main(int argc, char** argv) {
+    const size_t orders = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+    const std::string path = argc > 2 ? argv[2] : "/tmp/warm_restart_bench.state";
+    unlink(path.c_str());
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        trading::TradingAccelerator accelerator;
+        trading::StartupOptions options;
+        options.warm_state_path = path;
+        if (!accelerator.initialize("bitstream.bit", options)) {
+            _exit(1);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < orders; ++i) {
+            std::string symbol = "S" + std::to_string(i % 50);
+            accelerator.place_order(symbol, 100.0 + 0.01 * (i % 100), 100, i % 2 == 0);
+        }
+        double ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << "Placed " << orders << " orders, " << ns / orders
+                  << " ns/order including the warm state commit" << std::endl;
+
+        // Fill half of the first order and crash before committing
+        trading::WarmState* state = accelerator.warm_state();
+        state->apply_fill(state->orders()[0].order_id, 50, 100000000);
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cerr << "Order placing process failed" << std::endl;
+        return 1;
+    }
+
+    trading::TradingAccelerator accelerator;
+    trading::StartupOptions options;
+    options.warm_state_path = path;
+    trading::StartupReport report;
+    if (!accelerator.initialize("bitstream.bit", options) ||
+        !accelerator.get_startup_report(report)) {
+        return 1;
+    }
+
+    trading::WarmState* state = accelerator.warm_state();
+    std::cout << "Restart: reattached " << (report.warm_reattached ? "yes" : "no")
+              << " in " << report.warm_attach_ns / 1000.0 << " us, generation "
+              << state->generation() << std::endl;
+    std::cout << "  Symbols: " << state->symbol_count() << ", open orders: "
+              << state->order_count() << ", uncommitted fill discarded: "
+              << (state->orders()[0].filled == 0 ? "yes" : "no") << std::endl;
+
+    uint64_t order_id;
+    accelerator.place_order("S0", 100.0, 100, true, order_id);
+    std::cout << "  Next order id after restart: " << order_id << " (expected "
+              << orders + 1 << ")" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "basic_trading_accelerator.hpp"
+#include "executor.hpp"
+#include "ouch_encoder.hpp"
+
+#include <coroutine>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace trading {
+namespace coro {
+
+// Awaitable order entry and book reads over a BasicTradingAccelerator.
+// Instead of spinning on ORDER_STATUS, an awaiting coroutine suspends
+// and the executor resumes it once poll() sees the encoder accept its
+// command, so one core can keep many order lifecycles in flight:
+//
+//     uint64_t id;
+//     if (co_await device.place_order(stock, price, 100, true, id) && !wanted()) {
+//         co_await device.cancel_order(id);
+//     }
+//
+// The command port takes one command at a time, so commands queue in
+// the order they were awaited. Waiters are nodes inside the awaiting
+// coroutine's frame; queueing them allocates nothing.
+template <typename Backend>
+class AsyncAccelerator : public Poller {
+public:
+    class CommandAwaiter {
+    public:
+        // A rejected command has no owner and completes inline as false
+        bool await_ready() const noexcept { return owner_ == nullptr; }
+        void await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            owner_->enqueue(this);
+        }
+        bool await_resume() const noexcept { return accepted_; }
+
+    private:
+        friend class AsyncAccelerator;
+
+        CommandAwaiter(AsyncAccelerator* owner, uint64_t stock, uint32_t price, uint32_t quantity,
+                       bool is_buy, uint64_t* order_id)
+            : owner_(owner), stock_(stock), price_(price), quantity_(quantity), is_buy_(is_buy),
+              is_cancel_(false), order_id_(order_id), cancel_id_(0), accepted_(false),
+              next_(nullptr) {}
+        CommandAwaiter(AsyncAccelerator* owner, uint64_t cancel_id)
+            : owner_(owner), stock_(0), price_(0), quantity_(0), is_buy_(false), is_cancel_(true),
+              order_id_(nullptr), cancel_id_(cancel_id), accepted_(false), next_(nullptr) {}
+
+        AsyncAccelerator* owner_;
+        uint64_t stock_;
+        uint32_t price_;
+        uint32_t quantity_;
+        bool is_buy_;
+        bool is_cancel_;
+        uint64_t* order_id_;
+        uint64_t cancel_id_;
+        bool accepted_;
+        CommandAwaiter* next_;
+        std::coroutine_handle<> handle_;
+    };
+
+    class BookAwaiter {
+    public:
+        // The first attempt is made inline; only a torn read suspends
+        bool await_ready() {
+            attempts_ = 1;
+            accepted_ = owner_->device_.try_read_order_book(*book_);
+            return accepted_;
+        }
+        void await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            next_ = owner_->book_waiters_;
+            owner_->book_waiters_ = this;
+        }
+        bool await_resume() const noexcept { return accepted_; }
+
+    private:
+        friend class AsyncAccelerator;
+
+        BookAwaiter(AsyncAccelerator* owner, OrderBook* book)
+            : owner_(owner), book_(book), attempts_(0), accepted_(false), next_(nullptr) {}
+
+        AsyncAccelerator* owner_;
+        OrderBook* book_;
+        int attempts_;
+        bool accepted_;
+        BookAwaiter* next_;
+        std::coroutine_handle<> handle_;
+    };
+
+    AsyncAccelerator(BasicTradingAccelerator<Backend>& device, Executor& executor)
+        : device_(device), executor_(executor), in_flight_(nullptr), queue_head_(nullptr),
+          queue_tail_(nullptr), book_waiters_(nullptr) {
+        executor_.add_poller(this);
+    }
+
+    AsyncAccelerator(const AsyncAccelerator&) = delete;
+    AsyncAccelerator& operator=(const AsyncAccelerator&) = delete;
+
+    // co_await yields true once the encoder accepted the order; order_id
+    // must outlive the await
+    // co_await yields false at once for a price OUCH cannot encode
+    CommandAwaiter place_order(const std::string& symbol, double price, uint32_t quantity,
+                               bool is_buy, uint64_t& order_id) {
+        uint32_t encoded;
+        if (!ouch::to_price(price, encoded)) {
+            std::cerr << "Price " << price << " of " << symbol << " does not fit an OUCH order"
+                      << std::endl;
+            return CommandAwaiter(nullptr, 0, 0, 0, is_buy, &order_id);
+        }
+        return place_order(ouch::pack_stock(symbol), encoded, quantity, is_buy, order_id);
+    }
+
+    // stock from ouch::pack_stock(), price from ouch::to_price()
+    CommandAwaiter place_order(uint64_t stock, uint32_t price, uint32_t quantity, bool is_buy,
+                               uint64_t& order_id) {
+        return CommandAwaiter(this, stock, price, quantity, is_buy, &order_id);
+    }
+
+    CommandAwaiter cancel_order(uint64_t order_id) {
+        return CommandAwaiter(this, order_id);
+    }
+
+    // co_await yields false after MAX_BOOK_READ_ATTEMPTS torn reads
+    BookAwaiter get_order_book(OrderBook& book) {
+        return BookAwaiter(this, &book);
+    }
+
+    // No command or book read outstanding
+    bool idle() const { return in_flight_ == nullptr && book_waiters_ == nullptr; }
+
+    bool poll() override {
+        bool completed = false;
+        if (in_flight_ && device_.order_accepted()) {
+            CommandAwaiter* done = in_flight_;
+            if (!done->is_cancel_) {
+                *done->order_id_ = device_.accepted_order_id();
+                TRACE_INSTANT(trace::DEVICE_ACK, static_cast<uint32_t>(*done->order_id_));
+            }
+            done->accepted_ = true;
+            executor_.schedule(done->handle_);
+            completed = true;
+
+            in_flight_ = queue_head_;
+            if (queue_head_) {
+                queue_head_ = queue_head_->next_;
+                if (!queue_head_) {
+                    queue_tail_ = nullptr;
+                }
+                submit(in_flight_);
+            }
+        }
+
+        BookAwaiter** link = &book_waiters_;
+        while (*link) {
+            BookAwaiter* waiter = *link;
+            ++waiter->attempts_;
+            waiter->accepted_ = device_.try_read_order_book(*waiter->book_);
+            if (!waiter->accepted_ &&
+                waiter->attempts_ < BasicTradingAccelerator<Backend>::MAX_BOOK_READ_ATTEMPTS) {
+                link = &waiter->next_;
+                continue;
+            }
+            if (!waiter->accepted_) {
+                std::cerr << "Order book snapshot torn "
+                          << BasicTradingAccelerator<Backend>::MAX_BOOK_READ_ATTEMPTS
+                          << " times in a row" << std::endl;
+            }
+            *link = waiter->next_;
+            executor_.schedule(waiter->handle_);
+            completed = true;
+        }
+        return completed;
+    }
+
+private:
+    void enqueue(CommandAwaiter* command) {
+        if (!in_flight_) {
+            in_flight_ = command;
+            submit(command);
+            return;
+        }
+        if (queue_tail_) {
+            queue_tail_->next_ = command;
+        } else {
+            queue_head_ = command;
+        }
+        queue_tail_ = command;
+    }
+
+    void submit(CommandAwaiter* command) {
+        if (command->is_cancel_) {
+            device_.submit_cancel(command->cancel_id_);
+        } else {
+            device_.submit_order(command->stock_, command->price_, command->quantity_,
+                                 command->is_buy_);
+        }
+    }
+
+    BasicTradingAccelerator<Backend>& device_;
+    Executor& executor_;
+    CommandAwaiter* in_flight_;
+    CommandAwaiter* queue_head_;
+    CommandAwaiter* queue_tail_;
+    BookAwaiter* book_waiters_;
+};
+
+} // namespace coro
+} // namespace trading
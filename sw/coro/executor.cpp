@@ -0,0 +1,64 @@
+#include "executor.hpp"
+
+namespace trading {
+namespace coro {
+
+Executor::Executor(size_t capacity) {
+    ready_.reserve(capacity);
+    running_.reserve(capacity);
+    tasks_.reserve(capacity);
+}
+
+Executor::~Executor() {
+    // Tasks still suspended are abandoned with their awaiters
+    for (std::coroutine_handle<> task : tasks_) {
+        task.destroy();
+    }
+}
+
+void Executor::schedule(std::coroutine_handle<> handle) {
+    ready_.push_back(handle);
+}
+
+void Executor::spawn(Task<void> task) {
+    std::coroutine_handle<> handle = task.release();
+    tasks_.push_back(handle);
+    schedule(handle);
+}
+
+void Executor::add_poller(Poller* poller) {
+    pollers_.push_back(poller);
+}
+
+bool Executor::poll() {
+    // Coroutines scheduled while these run wait for the next step
+    running_.swap(ready_);
+    for (std::coroutine_handle<> handle : running_) {
+        handle.resume();
+    }
+    running_.clear();
+
+    for (Poller* poller : pollers_) {
+        poller->poll();
+    }
+
+    // Top-level tasks stop at their final suspend point; free those
+    for (size_t i = 0; i < tasks_.size();) {
+        if (tasks_[i].done()) {
+            tasks_[i].destroy();
+            tasks_[i] = tasks_.back();
+            tasks_.pop_back();
+        } else {
+            ++i;
+        }
+    }
+    return !tasks_.empty();
+}
+
+void Executor::run() {
+    while (poll()) {
+    }
+}
+
+} // namespace coro
+} // namespace trading
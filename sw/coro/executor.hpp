@@ -0,0 +1,58 @@
+#pragma once
+
+#include "task.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <vector>
+
+namespace trading {
+namespace coro {
+
+// Something the executor polls for completions, such as a device's
+// status registers. poll() resumes finished waiters through
+// Executor::schedule() and returns true if it completed any.
+class Poller {
+public:
+    virtual ~Poller() = default;
+    virtual bool poll() = 0;
+};
+
+// Single-threaded run loop for the strategy's own core. Each step
+// resumes every ready coroutine and then polls each poller once, so
+// nothing sleeps and there are no locks: all coroutines on an executor
+// must be resumed from the thread that runs it.
+class Executor {
+public:
+    explicit Executor(size_t capacity = 256);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // Resumes handle on the next step
+    void schedule(std::coroutine_handle<> handle);
+
+    // Takes ownership of a top-level task, starts it on the next step and
+    // frees its frame once it finishes
+    void spawn(Task<void> task);
+
+    void add_poller(Poller* poller);
+
+    // One step; returns false once no spawned task is left
+    bool poll();
+
+    // Steps until every spawned task has finished
+    void run();
+
+    size_t active() const { return tasks_.size(); }
+
+private:
+    std::vector<std::coroutine_handle<>> ready_;
+    std::vector<std::coroutine_handle<>> running_;
+    std::vector<std::coroutine_handle<>> tasks_;
+    std::vector<Poller*> pollers_;
+};
+
+} // namespace coro
+} // namespace trading
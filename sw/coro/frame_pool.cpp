@@ -0,0 +1,85 @@
+#include "frame_pool.hpp"
+
+#include <new>
+
+namespace trading {
+namespace coro {
+
+namespace {
+
+constexpr size_t NUM_CLASSES = 6;  // 64 bytes to FramePool::MAX_FRAME
+constexpr size_t MIN_FRAME_LOG2 = 6;
+constexpr size_t CHUNK_FRAMES = 64;
+
+struct FreeFrame {
+    FreeFrame* next;
+};
+
+struct ThreadPool {
+    FreeFrame* free[NUM_CLASSES] = {};
+    FramePoolStats stats = {};
+};
+
+thread_local ThreadPool pool;
+
+size_t size_class(size_t size) {
+    size_t index = 0;
+    while ((size_t(1) << (index + MIN_FRAME_LOG2)) < size) {
+        ++index;
+    }
+    return index;
+}
+
+void refill(size_t index, size_t count) {
+    // Chunks are deliberately never freed: frames may migrate to other
+    // threads' lists and the pool is sized by peak concurrency anyway
+    size_t frame_size = size_t(1) << (index + MIN_FRAME_LOG2);
+    char* chunk = static_cast<char*>(::operator new(frame_size * count));
+    for (size_t i = 0; i < count; ++i) {
+        FreeFrame* frame = reinterpret_cast<FreeFrame*>(chunk + i * frame_size);
+        frame->next = pool.free[index];
+        pool.free[index] = frame;
+    }
+    ++pool.stats.chunk_allocations;
+}
+
+} // namespace
+
+void* FramePool::allocate(size_t size) {
+    ++pool.stats.allocations;
+    if (size > MAX_FRAME) {
+        ++pool.stats.oversized;
+        return ::operator new(size);
+    }
+    size_t index = size_class(size);
+    if (!pool.free[index]) {
+        refill(index, CHUNK_FRAMES);
+    }
+    FreeFrame* frame = pool.free[index];
+    pool.free[index] = frame->next;
+    return frame;
+}
+
+void FramePool::deallocate(void* frame, size_t size) {
+    if (size > MAX_FRAME) {
+        ::operator delete(frame);
+        return;
+    }
+    size_t index = size_class(size);
+    FreeFrame* free_frame = static_cast<FreeFrame*>(frame);
+    free_frame->next = pool.free[index];
+    pool.free[index] = free_frame;
+}
+
+void FramePool::reserve(size_t size, size_t count) {
+    if (size <= MAX_FRAME && count != 0) {
+        refill(size_class(size), count);
+    }
+}
+
+FramePoolStats FramePool::stats() {
+    return pool.stats;
+}
+
+} // namespace coro
+} // namespace trading
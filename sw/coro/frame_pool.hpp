@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace trading {
+namespace coro {
+
+struct FramePoolStats {
+    uint64_t allocations;
+    uint64_t chunk_allocations;  // heap refills of a size class
+    uint64_t oversized;          // frames too large for any class, from the heap
+};
+
+// Per-thread free lists of coroutine frames in a few size classes.
+// Frames are carved from chunks that are never returned, so once a
+// thread has run its peak number of coroutines, starting another one
+// only pops a free list. reserve() moves the chunk allocations to
+// startup.
+class FramePool {
+public:
+    static constexpr size_t MAX_FRAME = 2048;
+
+    static void* allocate(size_t size);
+    static void deallocate(void* frame, size_t size);
+
+    // Preallocates count frames of the class holding size on this thread
+    static void reserve(size_t size, size_t count);
+    static FramePoolStats stats();
+};
+
+// Base for promise types whose frames come from the FramePool
+struct PooledFrame {
+    static void* operator new(size_t size) { return FramePool::allocate(size); }
+    static void operator delete(void* frame, size_t size) { FramePool::deallocate(frame, size); }
+};
+
+} // namespace coro
+} // namespace trading
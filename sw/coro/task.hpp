@@ -0,0 +1,115 @@
+#pragma once
+
+#include "frame_pool.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace trading {
+namespace coro {
+
+// Lazily started coroutine returning T. Awaiting a Task starts it and
+// resumes the awaiter by symmetric transfer when it finishes, so chains
+// of tasks neither recurse nor allocate beyond their pooled frames.
+// Exceptions are not carried across: an escaping one terminates, as the
+// rest of the API reports failure through return values.
+template <typename T>
+class Task;
+
+namespace detail {
+
+struct PromiseBase : PooledFrame {
+    std::coroutine_handle<> continuation;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> next = handle.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept { std::terminate(); }
+};
+
+} // namespace detail
+
+template <typename T>
+class Task {
+public:
+    struct promise_type : detail::PromiseBase {
+        T value{};
+
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        void return_value(T result) { value = std::move(result); }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+    T await_resume() { return std::move(handle_.promise().value); }
+
+    // Hands the frame to an owner that destroys it once done()
+    std::coroutine_handle<> release() { return std::exchange(handle_, nullptr); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <>
+class Task<void> {
+public:
+    struct promise_type : detail::PromiseBase {
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        void return_void() {}
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+    void await_resume() {}
+
+    std::coroutine_handle<> release() { return std::exchange(handle_, nullptr); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+} // namespace coro
+} // namespace trading
@@ -0,0 +1,214 @@
+#include "exchange_client.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace trading {
+namespace exchange {
+
+namespace {
+
+constexpr size_t IN_BUFFER = 1 << 18;
+constexpr size_t MAX_PACKET = 65536;
+constexpr int MD_RECEIVE_BUFFER = 8 << 20;
+
+sockaddr_in loopback(uint16_t port) {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+} // namespace
+
+ExchangeClient::ExchangeClient()
+    : fd_(-1), md_fd_(-1), in_(IN_BUFFER), in_length_(0), packet_(MAX_PACKET) {}
+
+ExchangeClient::~ExchangeClient() {
+    close();
+}
+
+bool ExchangeClient::connect_tcp(uint16_t port, uint16_t md_port) {
+    close();
+    if (md_port != 0) {
+        // Bound before the orders connection, so no level update is missed
+        md_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        setsockopt(md_fd_, SOL_SOCKET, SO_RCVBUF, &MD_RECEIVE_BUFFER, sizeof(MD_RECEIVE_BUFFER));
+        sockaddr_in addr = loopback(md_port);
+        if (md_fd_ < 0 || bind(md_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "Failed to bind market data port " << md_port << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = loopback(port);
+    if (fd_ < 0 || connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Failed to connect to exchange on port " << port << std::endl;
+        close();
+        return false;
+    }
+    int one = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return true;
+}
+
+bool ExchangeClient::connect_shm(const std::string& name) {
+    close();
+    return link_.open(name);
+}
+
+void ExchangeClient::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    if (md_fd_ >= 0) {
+        ::close(md_fd_);
+        md_fd_ = -1;
+    }
+    link_.close();
+    in_length_ = 0;
+}
+
+bool ExchangeClient::send(const uint8_t* frames, size_t length) {
+    while (length != 0) {
+        size_t sent;
+        if (link_.is_open()) {
+            sent = link_.orders().write(frames, length);
+            if (sent == 0) {
+                sched_yield();  // the exchange is behind
+            }
+        } else {
+            ssize_t n = ::send(fd_, frames, length, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "Exchange connection lost" << std::endl;
+                return false;
+            }
+            sent = static_cast<size_t>(n);
+        }
+        frames += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+bool ExchangeClient::dispatch(const uint8_t* msg, size_t length, ExchangeHandler& handler) {
+    switch (msg[0]) {
+    case ouch::ACCEPTED: {
+        ouch::OrderAccepted accepted;
+        if (!ouch::parse_accepted(msg, length, accepted)) {
+            return false;
+        }
+        handler.on_accepted(accepted);
+        return true;
+    }
+    case ouch::EXECUTED: {
+        ouch::OrderExecuted executed;
+        if (!ouch::parse_executed(msg, length, executed)) {
+            return false;
+        }
+        handler.on_executed(executed);
+        return true;
+    }
+    case ouch::CANCELED: {
+        ouch::OrderCanceled canceled;
+        if (!ouch::parse_canceled(msg, length, canceled)) {
+            return false;
+        }
+        handler.on_canceled(canceled);
+        return true;
+    }
+    case ouch::REJECTED: {
+        ouch::OrderRejected rejected;
+        if (!ouch::parse_rejected(msg, length, rejected)) {
+            return false;
+        }
+        handler.on_rejected(rejected);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+size_t ExchangeClient::poll(ExchangeHandler& handler) {
+    size_t handled = 0;
+
+    size_t received = 0;
+    size_t room = in_.size() - in_length_;
+    if (link_.is_open()) {
+        received = link_.responses().read(in_.data() + in_length_, room);
+    } else if (fd_ >= 0) {
+        ssize_t n = recv(fd_, in_.data() + in_length_, room, MSG_DONTWAIT);
+        received = n < 0 ? 0 : static_cast<size_t>(n);
+    }
+    if (received != 0) {
+        in_length_ += received;
+        size_t consumed = ouch::for_each_frame(in_.data(), in_length_,
+            [&](uint8_t type, const uint8_t* msg, size_t length) {
+                if (type == ouch::soup::SEQUENCED && length != 0 &&
+                    dispatch(msg, length, handler)) {
+                    ++handled;
+                }
+            });
+        std::memmove(in_.data(), in_.data() + consumed, in_length_ - consumed);
+        in_length_ -= consumed;
+    }
+
+    auto on_packet = [&](size_t length) {
+        feed::moldudp64::for_each_message(packet_.data(), length,
+            [&](uint64_t sequence, const uint8_t* msg, size_t msg_length) {
+                feed::itch::AddOrder order;
+                if (feed::itch::parse_add_order(msg, msg_length, order)) {
+                    handler.on_market_data(sequence, order);
+                    ++handled;
+                }
+            });
+    };
+    if (link_.is_open()) {
+        size_t length;
+        while ((length = link_.market_data().read_record(packet_.data(), packet_.size())) != 0) {
+            on_packet(length);
+        }
+    } else if (md_fd_ >= 0) {
+        ssize_t n;
+        while ((n = recv(md_fd_, packet_.data(), packet_.size(), 0)) > 0) {
+            on_packet(static_cast<size_t>(n));
+        }
+    }
+    return handled;
+}
+
+void ExchangeClient::wait() {
+    if (link_.is_open()) {
+        sched_yield();
+        return;
+    }
+    pollfd fds[2];
+    nfds_t count = 0;
+    if (fd_ >= 0) {
+        fds[count++] = pollfd{fd_, POLLIN, 0};
+    }
+    if (md_fd_ >= 0) {
+        fds[count++] = pollfd{md_fd_, POLLIN, 0};
+    }
+    ::poll(fds, count, 1);
+}
+
+} // namespace exchange
+} // namespace trading
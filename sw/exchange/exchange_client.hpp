@@ -0,0 +1,65 @@
+#pragma once
+
+#include "itch_decoder.hpp"
+#include "ouch_messages.hpp"
+#include "shm_link.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trading {
+namespace exchange {
+
+// What an ExchangeClient receives; override the messages of interest
+class ExchangeHandler {
+public:
+    virtual ~ExchangeHandler() = default;
+    virtual void on_accepted(const ouch::OrderAccepted&) {}
+    virtual void on_executed(const ouch::OrderExecuted&) {}
+    virtual void on_canceled(const ouch::OrderCanceled&) {}
+    virtual void on_rejected(const ouch::OrderRejected&) {}
+    // MoldUDP64 sequence and a level's new total shares, 0 when it empties
+    virtual void on_market_data(uint64_t, const feed::itch::AddOrder&) {}
+};
+
+// Order entry and market data connection to an ExchangeServer in
+// another process. send() takes SoupBinTCP-framed OUCH, exactly what
+// OuchEncoder and the device's order egress produce.
+class ExchangeClient {
+public:
+    ExchangeClient();
+    ~ExchangeClient();
+
+    ExchangeClient(const ExchangeClient&) = delete;
+    ExchangeClient& operator=(const ExchangeClient&) = delete;
+
+    // md_port 0 skips market data
+    bool connect_tcp(uint16_t port, uint16_t md_port = 0);
+    bool connect_shm(const std::string& name);
+    void close();
+
+    bool send(const uint8_t* frames, size_t length);
+
+    // Dispatches everything received so far; returns the messages handled
+    size_t poll(ExchangeHandler& handler);
+
+    // Blocks briefly until more may have arrived: on a socket until it is
+    // readable, on shared memory for one yield of the core
+    void wait();
+
+    // Hands one sequenced OUCH message to handler; false if not understood
+    static bool dispatch(const uint8_t* msg, size_t length, ExchangeHandler& handler);
+
+private:
+    int fd_;
+    int md_fd_;
+    ShmLink link_;
+    std::vector<uint8_t> in_;
+    size_t in_length_;
+    std::vector<uint8_t> packet_;
+};
+
+} // namespace exchange
+} // namespace trading
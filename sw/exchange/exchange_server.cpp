@@ -0,0 +1,416 @@
+#include "exchange_server.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace trading {
+namespace exchange {
+
+namespace {
+
+const uint8_t MD_SESSION[feed::moldudp64::SESSION_LEN] = {'E', 'X', 'C', 'H', 'S', 'I', 'M',
+                                                          ' ', ' ', ' '};
+
+// Empty polls before an idle server gives up the core
+constexpr uint32_t IDLE_SPINS = 64;
+
+constexpr uint64_t HEARTBEAT_NS = 1000000000;
+
+uint64_t ns_since_midnight() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    return static_cast<uint64_t>(ns) % (86400ull * 1000000000ull);
+}
+
+sockaddr_in loopback(uint16_t port) {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+} // namespace
+
+ExchangeServer::ExchangeServer(const ExchangeConfig& config)
+    : config_(config), engine_(*this, config.initial_orders), listen_fd_(-1), md_fd_(-1),
+      now_ns_(0), md_packet_(md_buffer_, sizeof(md_buffer_)), md_sequence_(1), accepted_(0),
+      messages_in_(0), messages_out_(0), md_packets_(0), md_dropped_(0),
+      slow_dropped_(0) {
+    md_packet_.begin(MD_SESSION, md_sequence_);
+}
+
+ExchangeServer::~ExchangeServer() {
+    close();
+}
+
+bool ExchangeServer::open() {
+    if (config_.tcp_port != 0) {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        int one = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr = loopback(config_.tcp_port);
+        if (listen_fd_ < 0 ||
+            bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(listen_fd_, 16) != 0) {
+            std::cerr << "Failed to listen on port " << config_.tcp_port << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    if (!config_.shm_name.empty()) {
+        if (!link_.create(config_.shm_name, config_.shm_capacity)) {
+            close();
+            return false;
+        }
+        add_session(-1, true);
+    }
+
+    if (config_.md_port != 0) {
+        md_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr = loopback(config_.md_port);
+        if (md_fd_ < 0 || connect(md_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "Failed to open market data socket" << std::endl;
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void ExchangeServer::close() {
+    for (Session& session : sessions_) {
+        if (session.fd >= 0) {
+            ::close(session.fd);
+        }
+    }
+    sessions_.clear();
+    slots_.clear();
+    link_.close();
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+    if (md_fd_ >= 0) {
+        ::close(md_fd_);
+        md_fd_ = -1;
+    }
+}
+
+void ExchangeServer::add_session(int fd, bool shm) {
+    uint32_t id = static_cast<uint32_t>(slots_.size());
+    slots_.push_back(static_cast<uint32_t>(sessions_.size()));
+    sessions_.push_back(Session{id, fd, shm, false, std::vector<uint8_t>(IN_BUFFER), 0,
+                                std::vector<uint8_t>(config_.max_backlog), 0, 0, now_ns_});
+    ++accepted_;
+}
+
+void ExchangeServer::restart(Session& session) {
+    // A fresh id keeps fills for the last client's resting orders away
+    // from the new one
+    uint32_t index = slots_[session.id];
+    slots_[session.id] = NO_SLOT;
+    session.id = static_cast<uint32_t>(slots_.size());
+    slots_.push_back(index);
+    session.closed = false;
+    session.out_length = 0;
+    session.sequence = 0;
+    session.last_sent_ns = now_ns_;
+    ++accepted_;
+}
+
+void ExchangeServer::remove_closed() {
+    for (size_t i = 0; i < sessions_.size();) {
+        Session& session = sessions_[i];
+        if (!session.closed || session.shm) {
+            ++i;
+            continue;
+        }
+        // Orders of a closed session stay on the book; their replies
+        // find no session and are dropped
+        slots_[session.id] = NO_SLOT;
+        if (i + 1 != sessions_.size()) {
+            session = std::move(sessions_.back());
+            slots_[session.id] = static_cast<uint32_t>(i);
+        }
+        sessions_.pop_back();
+    }
+}
+
+bool ExchangeServer::accept_sessions() {
+    if (listen_fd_ < 0) {
+        return false;
+    }
+    bool accepted = false;
+    int fd;
+    while ((fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK)) >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        add_session(fd, false);
+        accepted = true;
+    }
+    return accepted;
+}
+
+bool ExchangeServer::receive(Session& session) {
+    size_t room = session.in.size() - session.in_length;
+    size_t received;
+    if (session.shm) {
+        received = link_.orders().read(session.in.data() + session.in_length, room);
+    } else {
+        ssize_t n = recv(session.fd, session.in.data() + session.in_length, room, MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            ::close(session.fd);
+            session.fd = -1;
+            session.closed = true;
+            return false;
+        }
+        received = n < 0 ? 0 : static_cast<size_t>(n);
+    }
+    if (received == 0) {
+        return false;
+    }
+    session.in_length += received;
+
+    size_t consumed = ouch::for_each_frame(session.in.data(), session.in_length,
+        [&](uint8_t type, const uint8_t* msg, size_t length) {
+            if (type == ouch::soup::LOGIN_REQUEST) {
+                if (session.closed) {
+                    restart(session);
+                }
+                login(session);
+                return;
+            }
+            // A closed shared-memory session waits for the next login
+            if (session.closed) {
+                return;
+            }
+            if (type == ouch::soup::LOGOUT_REQUEST) {
+                session.closed = true;
+                return;
+            }
+            // Client heartbeats need no answer
+            if (type != ouch::soup::UNSEQUENCED || length == 0) {
+                return;
+            }
+            ++messages_in_;
+            if (msg[0] == ouch::ENTER_ORDER) {
+                ouch::EnterOrder order;
+                if (ouch::parse_enter_order(msg, length, order)) {
+                    engine_.enter(session.id, order, now_ns_);
+                }
+            } else if (msg[0] == ouch::CANCEL_ORDER) {
+                ouch::CancelOrder cancel;
+                if (ouch::parse_cancel_order(msg, length, cancel)) {
+                    engine_.cancel(session.id, cancel, now_ns_);
+                }
+            }
+        });
+    std::memmove(session.in.data(), session.in.data() + consumed, session.in_length - consumed);
+    session.in_length -= consumed;
+    if (session.closed && session.fd >= 0) {
+        ::close(session.fd);
+        session.fd = -1;
+    }
+    return true;
+}
+
+void ExchangeServer::login(Session& session) {
+    uint8_t* out =
+        reserve_reply(session, ouch::soup::LOGIN_ACCEPTED_LEN, ouch::soup::LOGIN_ACCEPTED);
+    if (!out) {
+        return;
+    }
+    std::memcpy(out, MD_SESSION, ouch::soup::SESSION_LEN);
+    // Next sequence number, right-justified and space padded
+    char sequence[ouch::soup::SEQUENCE_LEN + 1];
+    std::snprintf(sequence, sizeof(sequence), "%20llu",
+                  static_cast<unsigned long long>(session.sequence + 1));
+    std::memcpy(out + ouch::soup::SESSION_LEN, sequence, ouch::soup::SEQUENCE_LEN);
+}
+
+uint8_t* ExchangeServer::reserve_reply(Session& session, size_t length, uint8_t type) {
+    if (session.closed) {
+        return nullptr;
+    }
+    size_t needed = ouch::FRAME_HEADER_LEN + length;
+    if (session.out_length + needed > session.out.size()) {
+        if (!flush(session)) {
+            return nullptr;
+        }
+        if (session.out_length + needed > session.out.size()) {
+            // The client has stopped reading; waiting for it would stall
+            // every other session, so drop it instead
+            std::cerr << "Session " << session.id << " fell " << session.out_length
+                      << " reply bytes behind, disconnecting" << std::endl;
+            if (session.fd >= 0) {
+                ::close(session.fd);
+                session.fd = -1;
+            }
+            session.closed = true;
+            session.out_length = 0;
+            ++slow_dropped_;
+            return nullptr;
+        }
+    }
+    uint8_t* frame = session.out.data() + session.out_length;
+    ouch::put_frame_header(frame, type, length);
+    session.out_length += needed;
+    if (type == ouch::soup::SEQUENCED) {
+        ++session.sequence;
+        ++messages_out_;
+    }
+    return frame + ouch::FRAME_HEADER_LEN;
+}
+
+bool ExchangeServer::flush(Session& session) {
+    if (session.out_length == 0 || session.closed) {
+        return !session.closed;
+    }
+    size_t sent;
+    if (session.shm) {
+        sent = link_.responses().write(session.out.data(), session.out_length);
+    } else {
+        ssize_t n = send(session.fd, session.out.data(), session.out_length,
+                         MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            ::close(session.fd);
+            session.fd = -1;
+            session.closed = true;
+            return false;
+        }
+        sent = n < 0 ? 0 : static_cast<size_t>(n);
+    }
+    std::memmove(session.out.data(), session.out.data() + sent, session.out_length - sent);
+    session.out_length -= sent;
+    if (sent != 0) {
+        session.last_sent_ns = now_ns_;
+    }
+    return true;
+}
+
+void ExchangeServer::on_accepted(uint32_t session, const ouch::OrderAccepted& msg) {
+    reply(session, ouch::ACCEPTED_LEN, [&](uint8_t* out) { ouch::encode_accepted(msg, out); });
+}
+
+void ExchangeServer::on_executed(uint32_t session, const ouch::OrderExecuted& msg) {
+    reply(session, ouch::EXECUTED_LEN, [&](uint8_t* out) { ouch::encode_executed(msg, out); });
+}
+
+void ExchangeServer::on_canceled(uint32_t session, const ouch::OrderCanceled& msg) {
+    reply(session, ouch::CANCELED_LEN, [&](uint8_t* out) { ouch::encode_canceled(msg, out); });
+}
+
+void ExchangeServer::on_rejected(uint32_t session, const ouch::OrderRejected& msg) {
+    reply(session, ouch::REJECTED_LEN, [&](uint8_t* out) { ouch::encode_rejected(msg, out); });
+}
+
+void ExchangeServer::on_level(uint64_t stock, uint32_t price, uint32_t shares, bool is_buy,
+                              uint64_t timestamp_ns) {
+    if (md_fd_ < 0 && !link_.is_open()) {
+        return;
+    }
+    uint8_t message[feed::itch::ADD_ORDER_LEN];
+    feed::itch::AddOrder order{0, timestamp_ns, 0, is_buy, shares, stock, price};
+    size_t length = feed::itch::encode_add_order(order, message);
+    if (!md_packet_.append(message, length)) {
+        flush_market_data();
+        md_packet_.append(message, length);
+    }
+}
+
+void ExchangeServer::flush_market_data() {
+    if (md_packet_.count() == 0) {
+        return;
+    }
+    if (md_fd_ >= 0) {
+        send(md_fd_, md_packet_.data(), md_packet_.length(), MSG_DONTWAIT);
+    }
+    if (link_.is_open() &&
+        !link_.market_data().write_record(md_packet_.data(), md_packet_.length())) {
+        ++md_dropped_;
+    }
+    ++md_packets_;
+    md_sequence_ += md_packet_.count();
+    md_packet_.begin(MD_SESSION, md_sequence_);
+}
+
+bool ExchangeServer::poll() {
+    now_ns_ = ns_since_midnight();
+    bool busy = accept_sessions();
+    for (Session& session : sessions_) {
+        if ((!session.closed || session.shm) && receive(session)) {
+            busy = true;
+        }
+    }
+    for (Session& session : sessions_) {
+        if (!session.closed && session.out_length == 0 &&
+            now_ns_ - session.last_sent_ns > HEARTBEAT_NS) {
+            reserve_reply(session, 0, ouch::soup::SERVER_HEARTBEAT);
+        }
+        flush(session);
+    }
+    remove_closed();
+    flush_market_data();
+    return busy;
+}
+
+void ExchangeServer::wait_for_work() {
+    if (config_.busy_poll) {
+        return;
+    }
+    // Shared memory cannot be waited on, so yield and come back
+    if (link_.is_open()) {
+        sched_yield();
+        return;
+    }
+    std::vector<pollfd> fds;
+    if (listen_fd_ >= 0) {
+        fds.push_back(pollfd{listen_fd_, POLLIN, 0});
+    }
+    for (const Session& session : sessions_) {
+        if (session.fd >= 0) {
+            short events = session.out_length != 0 ? POLLIN | POLLOUT : POLLIN;
+            fds.push_back(pollfd{session.fd, events, 0});
+        }
+    }
+    ::poll(fds.data(), fds.size(), 1);
+}
+
+void ExchangeServer::run(const std::atomic<bool>& stop) {
+    uint32_t idle = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        if (poll()) {
+            idle = 0;
+        } else if (++idle >= IDLE_SPINS) {
+            wait_for_work();
+        }
+    }
+}
+
+ExchangeStats ExchangeServer::stats() const {
+    ExchangeStats stats;
+    stats.sessions = accepted_;
+    stats.messages_in = messages_in_;
+    stats.messages_out = messages_out_;
+    stats.md_packets = md_packets_;
+    stats.md_dropped = md_dropped_;
+    stats.slow_dropped = slow_dropped_;
+    stats.matching = engine_.stats();
+    return stats;
+}
+
+} // namespace exchange
+} // namespace trading
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "itch_decoder.hpp"
+#include "matching_engine.hpp"
+#include "ouch_messages.hpp"
+#include "shm_link.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trading {
+namespace exchange {
+
+struct ExchangeConfig {
+    uint16_t tcp_port = 0;            // loopback TCP listener for OUCH sessions, 0 for none
+    std::string shm_name;             // shared-memory link, empty for none
+    size_t shm_capacity = 1 << 22;    // bytes per ring
+    uint16_t md_port = 0;             // MoldUDP64 market data to 127.0.0.1, 0 for none
+    bool busy_poll = false;           // spin when idle instead of giving up the core
+    size_t initial_orders = 1 << 16;  // resting orders preallocated
+    size_t max_backlog = 1 << 18;     // unsent reply bytes before a session is dropped
+};
+
+struct ExchangeStats {
+    uint64_t sessions;      // connections accepted, the shared-memory link included
+    uint64_t messages_in;
+    uint64_t messages_out;
+    uint64_t md_packets;
+    uint64_t md_dropped;    // shared-memory packets the client was too slow for
+    uint64_t slow_dropped;  // sessions disconnected for falling max_backlog behind
+    MatchingStats matching;
+};
+
+// Stand-in venue for order round-trip tests. OUCH orders arrive in
+// SoupBinTCP packets over loopback TCP or a ShmLink and go through a
+// MatchingEngine. Accepted, executed, canceled and rejected messages go
+// back to the session that owns the order, and every level change is
+// published as a MoldUDP64 packet of ITCH add-order messages carrying
+// the level's new total, the feed format sw/feed decodes. Replies and
+// market data are flushed once per poll(), so a batch of orders costs
+// one write per connection. Logins are accepted without checking
+// credentials, and idle sessions get a server heartbeat every second.
+// A session whose unsent replies would exceed max_backlog is
+// disconnected rather than stalling the loop for everyone else. Closed
+// TCP sessions are removed after each pass; the shared-memory session
+// starts over on its next login.
+class ExchangeServer : private MatchListener {
+public:
+    explicit ExchangeServer(const ExchangeConfig& config = ExchangeConfig());
+    ~ExchangeServer();
+
+    ExchangeServer(const ExchangeServer&) = delete;
+    ExchangeServer& operator=(const ExchangeServer&) = delete;
+
+    bool open();
+    void close();
+
+    // One pass over every connection; false if there was nothing to do
+    bool poll();
+    // Polls until stop is set
+    void run(const std::atomic<bool>& stop);
+
+    ExchangeStats stats() const;
+    const MatchingEngine& engine() const { return engine_; }
+
+private:
+    static constexpr size_t IN_BUFFER = 1 << 16;
+    static constexpr size_t MD_PACKET = 1400;
+    static constexpr uint32_t NO_SLOT = ~0u;
+
+    struct Session {
+        uint32_t id;            // owner of its orders in the engine, never reused
+        int fd;                 // -1 for the shared-memory link or once closed
+        bool shm;
+        bool closed;
+        std::vector<uint8_t> in;
+        size_t in_length;
+        std::vector<uint8_t> out;
+        size_t out_length;
+        uint64_t sequence;      // sequenced messages sent
+        uint64_t last_sent_ns;
+    };
+
+    void on_accepted(uint32_t session, const ouch::OrderAccepted& msg) override;
+    void on_executed(uint32_t session, const ouch::OrderExecuted& msg) override;
+    void on_canceled(uint32_t session, const ouch::OrderCanceled& msg) override;
+    void on_rejected(uint32_t session, const ouch::OrderRejected& msg) override;
+    void on_level(uint64_t stock, uint32_t price, uint32_t shares, bool is_buy,
+                  uint64_t timestamp_ns) override;
+
+    void add_session(int fd, bool shm);
+    // Gives the shared-memory session a new id and empty buffers
+    void restart(Session& session);
+    Session* find(uint32_t id) {
+        return id < slots_.size() && slots_[id] != NO_SLOT ? &sessions_[slots_[id]] : nullptr;
+    }
+    bool accept_sessions();
+    bool receive(Session& session);
+    void login(Session& session);
+    // Room for one more reply, flushing first if needed; drops the
+    // session and returns nullptr if it is still max_backlog behind
+    uint8_t* reserve_reply(Session& session, size_t length,
+                           uint8_t type = ouch::soup::SEQUENCED);
+    template <typename Encode>
+    void reply(uint32_t id, size_t length, Encode&& encode) {
+        Session* session = find(id);
+        if (uint8_t* out = session ? reserve_reply(*session, length) : nullptr) {
+            encode(out);
+        }
+    }
+    bool flush(Session& session);
+    void remove_closed();
+    void flush_market_data();
+    void wait_for_work();
+
+    ExchangeConfig config_;
+    MatchingEngine engine_;
+    int listen_fd_;
+    int md_fd_;
+    ShmLink link_;
+    std::vector<Session> sessions_;
+    std::vector<uint32_t> slots_;  // index in sessions_ by session id
+    uint64_t now_ns_;
+
+    uint8_t md_buffer_[MD_PACKET];
+    feed::moldudp64::PacketBuilder md_packet_;
+    uint64_t md_sequence_;
+
+    uint64_t accepted_;
+    uint64_t messages_in_;
+    uint64_t messages_out_;
+    uint64_t md_packets_;
+    uint64_t md_dropped_;
+    uint64_t slow_dropped_;
+};
+
+} // namespace exchange
+} // namespace trading
@@ -0,0 +1,226 @@
+#include "matching_engine.hpp"
+
+#include <algorithm>
+
+namespace trading {
+namespace exchange {
+
+size_t MatchingEngine::OrderKeyHash::operator()(const OrderKey& key) const {
+    // The token's two overlapping halves and the session, mixed
+    uint64_t low;
+    uint64_t high;
+    std::memcpy(&low, key.token.bytes, sizeof(low));
+    std::memcpy(&high, key.token.bytes + ouch::TOKEN_LEN - sizeof(high), sizeof(high));
+    uint64_t h = (low ^ (high * 0x9E3779B97F4A7C15ull) ^ key.session) * 0xBF58476D1CE4E5B9ull;
+    return static_cast<size_t>(h ^ (h >> 31));
+}
+
+MatchingEngine::MatchingEngine(MatchListener& listener, size_t initial_orders)
+    : listener_(listener), free_head_(NIL), next_order_ref_(1), next_match_(1), stats_() {
+    orders_.reserve(initial_orders);
+    live_.reserve(initial_orders);
+}
+
+uint32_t MatchingEngine::book_for(uint64_t stock) {
+    auto it = book_index_.find(stock);
+    if (it != book_index_.end()) {
+        return it->second;
+    }
+    uint32_t index = static_cast<uint32_t>(books_.size());
+    books_.push_back(Book{stock, {}, {}});
+    book_index_.emplace(stock, index);
+    return index;
+}
+
+uint32_t MatchingEngine::allocate_order() {
+    if (free_head_ != NIL) {
+        uint32_t index = free_head_;
+        free_head_ = orders_[index].next;
+        return index;
+    }
+    orders_.emplace_back();
+    return static_cast<uint32_t>(orders_.size() - 1);
+}
+
+void MatchingEngine::release_order(uint32_t index) {
+    live_.erase(OrderKey{orders_[index].session, orders_[index].token});
+    orders_[index].next = free_head_;
+    free_head_ = index;
+}
+
+std::vector<MatchingEngine::Level>::iterator MatchingEngine::find_level(
+    std::vector<Level>& side, uint32_t price, bool is_buy) {
+    if (is_buy) {
+        return std::lower_bound(side.begin(), side.end(), price,
+                                [](const Level& level, uint32_t p) { return level.price < p; });
+    }
+    return std::lower_bound(side.begin(), side.end(), price,
+                            [](const Level& level, uint32_t p) { return level.price > p; });
+}
+
+void MatchingEngine::unlink(Level& level, uint32_t index) {
+    Order& order = orders_[index];
+    if (order.prev != NIL) {
+        orders_[order.prev].next = order.next;
+    } else {
+        level.head = order.next;
+    }
+    if (order.next != NIL) {
+        orders_[order.next].prev = order.prev;
+    } else {
+        level.tail = order.prev;
+    }
+}
+
+void MatchingEngine::enter(uint32_t session, const ouch::EnterOrder& order, uint64_t timestamp_ns) {
+    if (order.shares == 0) {
+        ++stats_.rejects;
+        listener_.on_rejected(session, ouch::OrderRejected{timestamp_ns, order.token,
+                                                           ouch::REJECT_SHARES});
+        return;
+    }
+    if (order.price == 0) {
+        ++stats_.rejects;
+        listener_.on_rejected(session, ouch::OrderRejected{timestamp_ns, order.token,
+                                                           ouch::REJECT_PRICE});
+        return;
+    }
+    if (live_.count(OrderKey{session, order.token}) != 0) {
+        ++stats_.rejects;
+        listener_.on_rejected(session, ouch::OrderRejected{timestamp_ns, order.token,
+                                                           ouch::REJECT_DUPLICATE_TOKEN});
+        return;
+    }
+
+    ++stats_.orders;
+    listener_.on_accepted(session, ouch::OrderAccepted{timestamp_ns, order.token, order.is_buy,
+                                                       order.shares, order.stock, order.price,
+                                                       order.time_in_force, next_order_ref_++});
+
+    const uint32_t book_index = book_for(order.stock);
+    Book& book = books_[book_index];
+    std::vector<Level>& opposite = order.is_buy ? book.asks : book.bids;
+    uint32_t remaining = order.shares;
+
+    while (remaining != 0 && !opposite.empty()) {
+        Level& level = opposite.back();
+        if (order.is_buy ? level.price > order.price : level.price < order.price) {
+            break;
+        }
+        while (remaining != 0 && level.head != NIL) {
+            uint32_t resting_index = level.head;
+            Order& resting = orders_[resting_index];
+            uint32_t shares = std::min(remaining, resting.remaining);
+            uint64_t match = next_match_++;
+            listener_.on_executed(resting.session,
+                                  ouch::OrderExecuted{timestamp_ns, resting.token, shares,
+                                                      level.price, ouch::LIQUIDITY_ADDED, match});
+            listener_.on_executed(session,
+                                  ouch::OrderExecuted{timestamp_ns, order.token, shares,
+                                                      level.price, ouch::LIQUIDITY_REMOVED, match});
+            ++stats_.executions;
+            stats_.executed_shares += shares;
+            resting.remaining -= shares;
+            level.shares -= shares;
+            remaining -= shares;
+            if (resting.remaining == 0) {
+                unlink(level, resting_index);
+                release_order(resting_index);
+            }
+        }
+        listener_.on_level(book.stock, level.price, level.shares, !order.is_buy, timestamp_ns);
+        if (level.head == NIL) {
+            opposite.pop_back();
+        }
+    }
+
+    if (remaining == 0) {
+        return;
+    }
+    if (order.time_in_force == ouch::IMMEDIATE_OR_CANCEL) {
+        listener_.on_canceled(session, ouch::OrderCanceled{timestamp_ns, order.token, remaining,
+                                                           ouch::CANCEL_IMMEDIATE});
+        return;
+    }
+
+    // Rest the remainder at the back of its level's queue
+    uint32_t index = allocate_order();
+    Order& resting = orders_[index];
+    resting.token = order.token;
+    resting.session = session;
+    resting.remaining = remaining;
+    resting.price = order.price;
+    resting.book = book_index;
+    resting.next = NIL;
+    resting.is_buy = order.is_buy;
+    live_.emplace(OrderKey{session, order.token}, index);
+
+    std::vector<Level>& side = order.is_buy ? book.bids : book.asks;
+    auto it = find_level(side, order.price, order.is_buy);
+    if (it == side.end() || it->price != order.price) {
+        it = side.insert(it, Level{order.price, 0, NIL, NIL});
+    }
+    resting.prev = it->tail;
+    if (it->tail != NIL) {
+        orders_[it->tail].next = index;
+    } else {
+        it->head = index;
+    }
+    it->tail = index;
+    it->shares += remaining;
+    listener_.on_level(book.stock, it->price, it->shares, order.is_buy, timestamp_ns);
+}
+
+void MatchingEngine::cancel(uint32_t session, const ouch::CancelOrder& cancel,
+                            uint64_t timestamp_ns) {
+    // Unknown or already finished orders are ignored, as OUCH does
+    auto found = live_.find(OrderKey{session, cancel.token});
+    if (found == live_.end()) {
+        return;
+    }
+    const uint32_t index = found->second;
+    Order& order = orders_[index];
+    if (cancel.shares >= order.remaining) {
+        return;
+    }
+
+    Book& book = books_[order.book];
+    std::vector<Level>& side = order.is_buy ? book.bids : book.asks;
+    auto level = find_level(side, order.price, order.is_buy);
+    const uint32_t decrement = order.remaining - cancel.shares;
+    order.remaining = cancel.shares;
+    level->shares -= decrement;
+    ++stats_.cancels;
+    listener_.on_canceled(session, ouch::OrderCanceled{timestamp_ns, cancel.token, decrement,
+                                                       ouch::CANCEL_USER});
+    listener_.on_level(book.stock, level->price, level->shares, order.is_buy, timestamp_ns);
+
+    if (order.remaining == 0) {
+        unlink(*level, index);
+        release_order(index);
+        if (level->head == NIL) {
+            side.erase(level);
+        }
+    }
+}
+
+bool MatchingEngine::top_of_book(uint64_t stock, OrderBook& book) const {
+    auto it = book_index_.find(stock);
+    if (it == book_index_.end()) {
+        return false;
+    }
+    const Book& entry = books_[it->second];
+    book = OrderBook();
+    if (!entry.bids.empty()) {
+        book.best_bid_price = entry.bids.back().price / 10000.0;
+        book.best_bid_qty = entry.bids.back().shares;
+    }
+    if (!entry.asks.empty()) {
+        book.best_ask_price = entry.asks.back().price / 10000.0;
+        book.best_ask_qty = entry.asks.back().shares;
+    }
+    return true;
+}
+
+} // namespace exchange
+} // namespace trading
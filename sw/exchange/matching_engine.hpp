@@ -0,0 +1,119 @@
+#pragma once
+
+#include "ouch_messages.hpp"
+#include "trading_interface.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace trading {
+namespace exchange {
+
+// Receives what the engine does to each order. session is the caller's
+// id for the connection that owns the order.
+class MatchListener {
+public:
+    virtual ~MatchListener() = default;
+    virtual void on_accepted(uint32_t session, const ouch::OrderAccepted& msg) = 0;
+    virtual void on_executed(uint32_t session, const ouch::OrderExecuted& msg) = 0;
+    virtual void on_canceled(uint32_t session, const ouch::OrderCanceled& msg) = 0;
+    virtual void on_rejected(uint32_t session, const ouch::OrderRejected& msg) = 0;
+    // A level's new total shares, with the OrderBookEngine rule: the
+    // latest quantity replaces the level and zero removes it
+    virtual void on_level(uint64_t stock, uint32_t price, uint32_t shares, bool is_buy,
+                          uint64_t timestamp_ns) = 0;
+};
+
+struct MatchingStats {
+    uint64_t orders;
+    uint64_t cancels;
+    uint64_t rejects;
+    uint64_t executions;
+    uint64_t executed_shares;
+};
+
+// Price-time priority matching for any number of stocks. An incoming
+// order trades against the opposite side from the best price outward,
+// oldest order first at each price, at the resting order's price; what
+// is left rests unless it is immediate-or-cancel. Levels keep their
+// orders in a FIFO linked through a preallocated pool, and sides are
+// sorted vectors with the best price at the back, so the common case
+// of trading at or joining the touch touches the end of one vector.
+class MatchingEngine {
+public:
+    explicit MatchingEngine(MatchListener& listener, size_t initial_orders = 1 << 16);
+
+    void enter(uint32_t session, const ouch::EnterOrder& order, uint64_t timestamp_ns);
+    void cancel(uint32_t session, const ouch::CancelOrder& cancel, uint64_t timestamp_ns);
+
+    // Aggregated best levels; false for a stock never traded
+    bool top_of_book(uint64_t stock, OrderBook& book) const;
+
+    size_t resting_orders() const { return live_.size(); }
+    const MatchingStats& stats() const { return stats_; }
+
+private:
+    static constexpr uint32_t NIL = ~0u;
+
+    struct Order {
+        ouch::Token token;
+        uint32_t session;
+        uint32_t remaining;
+        uint32_t price;
+        uint32_t book;
+        uint32_t next;
+        uint32_t prev;
+        bool is_buy;
+    };
+
+    struct Level {
+        uint32_t price;
+        uint32_t shares;
+        uint32_t head;
+        uint32_t tail;
+    };
+
+    // Bids ascending and asks descending, so back() is the best price
+    struct Book {
+        uint64_t stock;
+        std::vector<Level> bids;
+        std::vector<Level> asks;
+    };
+
+    struct OrderKey {
+        uint32_t session;
+        ouch::Token token;
+
+        bool operator==(const OrderKey& other) const {
+            return session == other.session && token == other.token;
+        }
+    };
+
+    struct OrderKeyHash {
+        size_t operator()(const OrderKey& key) const;
+    };
+
+    uint32_t book_for(uint64_t stock);
+    uint32_t allocate_order();
+    void release_order(uint32_t index);
+
+    // Iterator to the level at price, or where it belongs
+    static std::vector<Level>::iterator find_level(std::vector<Level>& side, uint32_t price,
+                                                   bool is_buy);
+    void unlink(Level& level, uint32_t index);
+
+    MatchListener& listener_;
+    std::vector<Order> orders_;
+    uint32_t free_head_;
+    std::unordered_map<OrderKey, uint32_t, OrderKeyHash> live_;
+    std::vector<Book> books_;
+    std::unordered_map<uint64_t, uint32_t> book_index_;
+    uint64_t next_order_ref_;
+    uint64_t next_match_;
+    MatchingStats stats_;
+};
+
+} // namespace exchange
+} // namespace trading
@@ -0,0 +1,147 @@
+#include "ouch_messages.hpp"
+
+namespace trading {
+namespace ouch {
+
+namespace {
+
+using feed::detail::load_be32;
+using feed::detail::load_be64;
+using feed::detail::store_be32;
+using feed::detail::store_be64;
+
+// Must match the defaults order_entry_encoder.sv sends
+constexpr uint8_t FIRM[4] = {'F', 'P', 'G', 'A'};
+
+void put_token(uint8_t* out, const Token& token) {
+    std::memcpy(out, token.bytes, TOKEN_LEN);
+}
+
+void get_token(const uint8_t* in, Token& token) {
+    std::memcpy(token.bytes, in, TOKEN_LEN);
+}
+
+} // namespace
+
+bool parse_enter_order(const uint8_t* msg, size_t length, EnterOrder& out) {
+    if (length < ENTER_ORDER_LEN || msg[0] != ENTER_ORDER) {
+        return false;
+    }
+    get_token(msg + 1, out.token);
+    out.is_buy = msg[15] == 'B';
+    out.shares = load_be32(msg + 16);
+    std::memcpy(&out.stock, msg + 20, sizeof(out.stock));
+    out.price = load_be32(msg + 28);
+    out.time_in_force = load_be32(msg + 32);
+    return true;
+}
+
+bool parse_cancel_order(const uint8_t* msg, size_t length, CancelOrder& out) {
+    if (length < CANCEL_ORDER_LEN || msg[0] != CANCEL_ORDER) {
+        return false;
+    }
+    get_token(msg + 1, out.token);
+    out.shares = load_be32(msg + 15);
+    return true;
+}
+
+size_t encode_accepted(const OrderAccepted& msg, uint8_t* out) {
+    out[0] = ACCEPTED;
+    store_be64(out + 1, msg.timestamp_ns);
+    put_token(out + 9, msg.token);
+    out[23] = msg.is_buy ? 'B' : 'S';
+    store_be32(out + 24, msg.shares);
+    std::memcpy(out + 28, &msg.stock, sizeof(msg.stock));
+    store_be32(out + 36, msg.price);
+    store_be32(out + 40, msg.time_in_force);
+    std::memcpy(out + 44, FIRM, sizeof(FIRM));
+    out[48] = 'Y';  // display
+    store_be64(out + 49, msg.order_ref);
+    out[57] = 'P';  // capacity
+    out[58] = 'N';  // intermarket sweep
+    store_be32(out + 59, 0);  // minimum quantity
+    out[63] = 'N';  // cross type
+    out[64] = 'L';  // order state: live
+    out[65] = ' ';  // BBO weight indicator
+    return ACCEPTED_LEN;
+}
+
+size_t encode_executed(const OrderExecuted& msg, uint8_t* out) {
+    out[0] = EXECUTED;
+    store_be64(out + 1, msg.timestamp_ns);
+    put_token(out + 9, msg.token);
+    store_be32(out + 23, msg.shares);
+    store_be32(out + 27, msg.price);
+    out[31] = msg.liquidity;
+    store_be64(out + 32, msg.match_number);
+    return EXECUTED_LEN;
+}
+
+size_t encode_canceled(const OrderCanceled& msg, uint8_t* out) {
+    out[0] = CANCELED;
+    store_be64(out + 1, msg.timestamp_ns);
+    put_token(out + 9, msg.token);
+    store_be32(out + 23, msg.shares);
+    out[27] = msg.reason;
+    return CANCELED_LEN;
+}
+
+size_t encode_rejected(const OrderRejected& msg, uint8_t* out) {
+    out[0] = REJECTED;
+    store_be64(out + 1, msg.timestamp_ns);
+    put_token(out + 9, msg.token);
+    out[23] = msg.reason;
+    return REJECTED_LEN;
+}
+
+bool parse_accepted(const uint8_t* msg, size_t length, OrderAccepted& out) {
+    if (length < ACCEPTED_LEN || msg[0] != ACCEPTED) {
+        return false;
+    }
+    out.timestamp_ns = load_be64(msg + 1);
+    get_token(msg + 9, out.token);
+    out.is_buy = msg[23] == 'B';
+    out.shares = load_be32(msg + 24);
+    std::memcpy(&out.stock, msg + 28, sizeof(out.stock));
+    out.price = load_be32(msg + 36);
+    out.time_in_force = load_be32(msg + 40);
+    out.order_ref = load_be64(msg + 49);
+    return true;
+}
+
+bool parse_executed(const uint8_t* msg, size_t length, OrderExecuted& out) {
+    if (length < EXECUTED_LEN || msg[0] != EXECUTED) {
+        return false;
+    }
+    out.timestamp_ns = load_be64(msg + 1);
+    get_token(msg + 9, out.token);
+    out.shares = load_be32(msg + 23);
+    out.price = load_be32(msg + 27);
+    out.liquidity = msg[31];
+    out.match_number = load_be64(msg + 32);
+    return true;
+}
+
+bool parse_canceled(const uint8_t* msg, size_t length, OrderCanceled& out) {
+    if (length < CANCELED_LEN || msg[0] != CANCELED) {
+        return false;
+    }
+    out.timestamp_ns = load_be64(msg + 1);
+    get_token(msg + 9, out.token);
+    out.shares = load_be32(msg + 23);
+    out.reason = msg[27];
+    return true;
+}
+
+bool parse_rejected(const uint8_t* msg, size_t length, OrderRejected& out) {
+    if (length < REJECTED_LEN || msg[0] != REJECTED) {
+        return false;
+    }
+    out.timestamp_ns = load_be64(msg + 1);
+    get_token(msg + 9, out.token);
+    out.reason = msg[23];
+    return true;
+}
+
+} // namespace ouch
+} // namespace trading
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "itch_decoder.hpp"
+#include "ouch_encoder.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace trading {
+namespace ouch {
+
+// OUCH 4.2 message types
+constexpr uint8_t ENTER_ORDER = 'O';
+constexpr uint8_t CANCEL_ORDER = 'X';
+constexpr uint8_t ACCEPTED = 'A';
+constexpr uint8_t EXECUTED = 'E';
+constexpr uint8_t CANCELED = 'C';
+constexpr uint8_t REJECTED = 'J';
+
+constexpr size_t ACCEPTED_LEN = 66;
+constexpr size_t EXECUTED_LEN = 40;
+constexpr size_t CANCELED_LEN = 28;
+constexpr size_t REJECTED_LEN = 24;
+constexpr size_t MAX_MESSAGE_LEN = ACCEPTED_LEN;
+
+// Time in force 0 executes what it can and cancels the rest
+constexpr uint32_t IMMEDIATE_OR_CANCEL = 0;
+
+// Canceled reasons
+constexpr uint8_t CANCEL_USER = 'U';
+constexpr uint8_t CANCEL_IMMEDIATE = 'I';
+
+// Rejected reasons
+constexpr uint8_t REJECT_SHARES = 'Z';
+constexpr uint8_t REJECT_PRICE = 'X';
+constexpr uint8_t REJECT_DUPLICATE_TOKEN = 'D';
+
+// Liquidity flags
+constexpr uint8_t LIQUIDITY_ADDED = 'A';
+constexpr uint8_t LIQUIDITY_REMOVED = 'R';
+
+// SoupBinTCP packet types
+namespace soup {
+constexpr uint8_t UNSEQUENCED = 'U';       // client to server data
+constexpr uint8_t SEQUENCED = 'S';         // server to client data
+constexpr uint8_t CLIENT_HEARTBEAT = 'R';
+constexpr uint8_t SERVER_HEARTBEAT = 'H';
+constexpr uint8_t LOGIN_REQUEST = 'L';
+constexpr uint8_t LOGIN_ACCEPTED = 'A';
+constexpr uint8_t LOGOUT_REQUEST = 'O';
+
+// Payload lengths: username (6), password (10), session (10) and
+// sequence number (20, ASCII right-justified) for a login request;
+// session and next sequence number for login accepted
+constexpr size_t LOGIN_REQUEST_LEN = 46;
+constexpr size_t LOGIN_ACCEPTED_LEN = 30;
+constexpr size_t SESSION_LEN = 10;
+constexpr size_t SEQUENCE_LEN = 20;
+} // namespace soup
+
+struct Token {
+    uint8_t bytes[TOKEN_LEN];
+
+    bool operator==(const Token& other) const {
+        return std::memcmp(bytes, other.bytes, TOKEN_LEN) == 0;
+    }
+};
+
+struct EnterOrder {
+    Token token;
+    bool is_buy;
+    uint32_t shares;
+    uint64_t stock;          // see pack_stock
+    uint32_t price;          // see to_price
+    uint32_t time_in_force;
+};
+
+struct CancelOrder {
+    Token token;
+    uint32_t shares;         // shares left open afterwards; 0 cancels the order
+};
+
+struct OrderAccepted {
+    uint64_t timestamp_ns;
+    Token token;
+    bool is_buy;
+    uint32_t shares;
+    uint64_t stock;
+    uint32_t price;
+    uint32_t time_in_force;
+    uint64_t order_ref;      // exchange reference, as in the ITCH feed
+};
+
+struct OrderExecuted {
+    uint64_t timestamp_ns;
+    Token token;
+    uint32_t shares;
+    uint32_t price;
+    uint8_t liquidity;
+    uint64_t match_number;
+};
+
+struct OrderCanceled {
+    uint64_t timestamp_ns;
+    Token token;
+    uint32_t shares;         // shares taken off the book
+    uint8_t reason;
+};
+
+struct OrderRejected {
+    uint64_t timestamp_ns;
+    Token token;
+    uint8_t reason;
+};
+
+// Inbound messages, without SoupBinTCP framing
+bool parse_enter_order(const uint8_t* msg, size_t length, EnterOrder& out);
+bool parse_cancel_order(const uint8_t* msg, size_t length, CancelOrder& out);
+
+// Outbound messages; each writes the message into out and returns its length
+size_t encode_accepted(const OrderAccepted& msg, uint8_t* out);
+size_t encode_executed(const OrderExecuted& msg, uint8_t* out);
+size_t encode_canceled(const OrderCanceled& msg, uint8_t* out);
+size_t encode_rejected(const OrderRejected& msg, uint8_t* out);
+
+bool parse_accepted(const uint8_t* msg, size_t length, OrderAccepted& out);
+bool parse_executed(const uint8_t* msg, size_t length, OrderExecuted& out);
+bool parse_canceled(const uint8_t* msg, size_t length, OrderCanceled& out);
+bool parse_rejected(const uint8_t* msg, size_t length, OrderRejected& out);
+
+// Writes the SoupBinTCP header for a payload of length bytes
+inline void put_frame_header(uint8_t* out, uint8_t type, size_t length) {
+    feed::detail::store_be16(out, static_cast<uint16_t>(length + 1));
+    out[2] = type;
+}
+
+// Invoke fn(type, payload, payload_length) for each complete SoupBinTCP
+// packet in a byte stream. Returns the bytes consumed; a partial packet
+// at the end is left for the next call.
+template <typename Fn>
+size_t for_each_frame(const uint8_t* data, size_t length, Fn&& fn) {
+    size_t pos = 0;
+    while (pos + FRAME_HEADER_LEN <= length) {
+        size_t frame_len = feed::detail::load_be16(data + pos);
+        if (frame_len == 0 || pos + 2 + frame_len > length) {
+            break;
+        }
+        fn(data[pos + 2], data + pos + FRAME_HEADER_LEN, frame_len - 1);
+        pos += 2 + frame_len;
+    }
+    return pos;
+}
+
+} // namespace ouch
+} // namespace trading
@@ -0,0 +1,238 @@
+#include "shm_link.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace trading {
+namespace exchange {
+
+namespace {
+
+constexpr uint64_t LINK_MAGIC = 0x4B4E494C4D485358ull;  // "XSHMLINK"
+constexpr size_t RECORD_HEADER_LEN = 2;
+
+struct LinkHeader {
+    std::atomic<uint64_t> magic;  // set last, once the rings are ready
+    uint64_t capacity;
+    int64_t owner_pid;            // exchange process that created the link
+    ShmRing::Indices rings[3];
+};
+
+size_t data_offset() {
+    return (sizeof(LinkHeader) + 63) & ~size_t(63);
+}
+
+// True if name is an exchange link whose creator has exited. Anything
+// else under the name, a live exchange's link or a segment that is not
+// a link at all, is left alone.
+bool stale_link(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    LinkHeader header;
+    bool read_whole =
+        pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+    ::close(fd);
+    if (!read_whole || header.magic.load(std::memory_order_relaxed) != LINK_MAGIC ||
+        header.owner_pid <= 0) {
+        return false;
+    }
+    return kill(static_cast<pid_t>(header.owner_pid), 0) != 0 && errno == ESRCH;
+}
+
+} // namespace
+
+void ShmRing::copy_in(uint64_t position, const uint8_t* data, size_t length) {
+    size_t offset = position & mask_;
+    size_t first = std::min(length, mask_ + 1 - offset);
+    std::memcpy(data_ + offset, data, first);
+    std::memcpy(data_, data + first, length - first);
+}
+
+void ShmRing::copy_out(uint64_t position, uint8_t* out, size_t length) const {
+    size_t offset = position & mask_;
+    size_t first = std::min(length, mask_ + 1 - offset);
+    std::memcpy(out, data_ + offset, first);
+    std::memcpy(out + first, data_, length - first);
+}
+
+size_t ShmRing::write(const uint8_t* data, size_t length) {
+    uint64_t head = indices_->head.load(std::memory_order_relaxed);
+    uint64_t tail = indices_->tail.load(std::memory_order_acquire);
+    size_t count = std::min(length, static_cast<size_t>(mask_ + 1 - (head - tail)));
+    if (count == 0) {
+        return 0;
+    }
+    copy_in(head, data, count);
+    indices_->head.store(head + count, std::memory_order_release);
+    return count;
+}
+
+size_t ShmRing::read(uint8_t* out, size_t max) {
+    uint64_t tail = indices_->tail.load(std::memory_order_relaxed);
+    uint64_t head = indices_->head.load(std::memory_order_acquire);
+    size_t count = std::min(max, static_cast<size_t>(head - tail));
+    if (count == 0) {
+        return 0;
+    }
+    copy_out(tail, out, count);
+    indices_->tail.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+bool ShmRing::write_record(const uint8_t* data, size_t length) {
+    uint64_t head = indices_->head.load(std::memory_order_relaxed);
+    uint64_t tail = indices_->tail.load(std::memory_order_acquire);
+    if (length > 0xFFFF || RECORD_HEADER_LEN + length > mask_ + 1 - (head - tail)) {
+        return false;
+    }
+    uint8_t header[RECORD_HEADER_LEN] = {static_cast<uint8_t>(length >> 8),
+                                         static_cast<uint8_t>(length)};
+    copy_in(head, header, RECORD_HEADER_LEN);
+    copy_in(head + RECORD_HEADER_LEN, data, length);
+    indices_->head.store(head + RECORD_HEADER_LEN + length, std::memory_order_release);
+    return true;
+}
+
+size_t ShmRing::read_record(uint8_t* out, size_t max) {
+    uint64_t tail = indices_->tail.load(std::memory_order_relaxed);
+    uint64_t head = indices_->head.load(std::memory_order_acquire);
+    if (head == tail) {
+        return 0;
+    }
+    uint8_t header[RECORD_HEADER_LEN];
+    copy_out(tail, header, RECORD_HEADER_LEN);
+    size_t length = (static_cast<size_t>(header[0]) << 8) | header[1];
+    // A record too large for out is skipped rather than wedging the ring
+    if (length <= max) {
+        copy_out(tail + RECORD_HEADER_LEN, out, length);
+    }
+    indices_->tail.store(tail + RECORD_HEADER_LEN + length, std::memory_order_release);
+    return length <= max ? length : 0;
+}
+
+bool ShmRing::empty() const {
+    return indices_->head.load(std::memory_order_acquire) ==
+           indices_->tail.load(std::memory_order_relaxed);
+}
+
+ShmLink::ShmLink() : owner_(false), base_(nullptr), size_(0) {}
+
+ShmLink::~ShmLink() {
+    close();
+}
+
+bool ShmLink::map(int fd, size_t size) {
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory " << name_ << std::endl;
+        return false;
+    }
+    base_ = base;
+    size_ = size;
+    return true;
+}
+
+void ShmLink::attach_rings() {
+    LinkHeader* header = static_cast<LinkHeader*>(base_);
+    uint8_t* data = static_cast<uint8_t*>(base_) + data_offset();
+    size_t capacity = header->capacity;
+    orders_ = ShmRing(&header->rings[0], data, capacity);
+    responses_ = ShmRing(&header->rings[1], data + capacity, capacity);
+    market_data_ = ShmRing(&header->rings[2], data + 2 * capacity, capacity);
+}
+
+bool ShmLink::create(const std::string& name, size_t capacity) {
+    close();
+    size_t rounded = 4096;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+
+    name_ = name;
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    bool exists = fd < 0 && errno == EEXIST;
+    if (exists && stale_link(name)) {
+        // Left by an exchange that crashed; nobody else can be using it
+        std::cerr << "Replacing stale shared memory " << name << std::endl;
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        exists = fd < 0 && errno == EEXIST;
+    }
+    if (fd < 0) {
+        std::cerr << "Failed to create shared memory " << name
+                  << (exists ? ": the name is in use" : "") << std::endl;
+        return false;
+    }
+    size_t size = data_offset() + 3 * rounded;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::cerr << "Failed to size shared memory " << name << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    if (!map(fd, size)) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+    owner_ = true;
+
+    // A fresh segment is zeroed, so the indices start at 0
+    LinkHeader* header = new (base_) LinkHeader();
+    header->capacity = rounded;
+    header->owner_pid = getpid();
+    attach_rings();
+    header->magic.store(LINK_MAGIC, std::memory_order_release);
+    return true;
+}
+
+bool ShmLink::open(const std::string& name) {
+    close();
+    name_ = name;
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to open shared memory " << name << std::endl;
+        return false;
+    }
+    off_t size = lseek(fd, 0, SEEK_END);
+    if (size < static_cast<off_t>(data_offset())) {
+        std::cerr << "Shared memory " << name << " is not an exchange link" << std::endl;
+        ::close(fd);
+        return false;
+    }
+    if (!map(fd, static_cast<size_t>(size))) {
+        return false;
+    }
+    LinkHeader* header = static_cast<LinkHeader*>(base_);
+    if (header->magic.load(std::memory_order_acquire) != LINK_MAGIC ||
+        data_offset() + 3 * header->capacity > size_) {
+        std::cerr << "Shared memory " << name << " is not an exchange link" << std::endl;
+        close();
+        return false;
+    }
+    attach_rings();
+    return true;
+}
+
+void ShmLink::close() {
+    if (base_) {
+        munmap(base_, size_);
+        base_ = nullptr;
+    }
+    if (owner_) {
+        shm_unlink(name_.c_str());
+        owner_ = false;
+    }
+}
+
+} // namespace exchange
+} // namespace trading
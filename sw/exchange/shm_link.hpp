@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trading {
+namespace exchange {
+
+// Single-producer single-consumer byte ring whose indices and data live
+// in shared memory. Used as a stream, like a TCP connection, or as
+// length-prefixed records, like datagrams.
+class ShmRing {
+public:
+    struct alignas(64) Indices {
+        alignas(64) std::atomic<uint64_t> head;  // bytes written
+        alignas(64) std::atomic<uint64_t> tail;  // bytes read
+    };
+
+    ShmRing() : indices_(nullptr), data_(nullptr), mask_(0) {}
+    ShmRing(Indices* indices, uint8_t* data, size_t capacity)
+        : indices_(indices), data_(data), mask_(capacity - 1) {}
+
+    // Stream use; both return the bytes moved, possibly fewer than asked
+    size_t write(const uint8_t* data, size_t length);
+    size_t read(uint8_t* out, size_t max);
+
+    // Record use: false when the record does not fit whole
+    bool write_record(const uint8_t* data, size_t length);
+    // Length of the record copied into out, 0 if none is waiting
+    size_t read_record(uint8_t* out, size_t max);
+
+    bool empty() const;
+
+private:
+    void copy_in(uint64_t position, const uint8_t* data, size_t length);
+    void copy_out(uint64_t position, uint8_t* out, size_t length) const;
+
+    Indices* indices_;
+    uint8_t* data_;
+    size_t mask_;
+};
+
+// A named POSIX shared-memory segment holding the rings between one
+// exchange and one client: orders in, responses out and market data out.
+// The exchange creates it and removes the name again on close. create()
+// fails if the name is taken, unless it is a link whose creator has exited.
+class ShmLink {
+public:
+    ShmLink();
+    ~ShmLink();
+
+    ShmLink(const ShmLink&) = delete;
+    ShmLink& operator=(const ShmLink&) = delete;
+
+    // capacity per ring, rounded up to a power of two
+    bool create(const std::string& name, size_t capacity);
+    bool open(const std::string& name);
+    void close();
+
+    bool is_open() const { return base_ != nullptr; }
+    ShmRing& orders() { return orders_; }
+    ShmRing& responses() { return responses_; }
+    ShmRing& market_data() { return market_data_; }
+
+private:
+    bool map(int fd, size_t size);
+    void attach_rings();
+
+    std::string name_;
+    bool owner_;
+    void* base_;
+    size_t size_;
+    ShmRing orders_;
+    ShmRing responses_;
+    ShmRing market_data_;
+};
+
+} // namespace exchange
+} // namespace trading
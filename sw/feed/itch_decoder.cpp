@@ -0,0 +1,23 @@
+#include "itch_decoder.hpp"
+
+namespace trading {
+namespace feed {
+namespace itch {
+
+size_t encode_add_order(const AddOrder& order, uint8_t* out) {
+    out[0] = ADD_ORDER;
+    detail::store_be16(out + 1, order.stock_locate);
+    detail::store_be16(out + 3, 0);  // tracking number
+    detail::store_be16(out + 5, static_cast<uint16_t>(order.timestamp_ns >> 32));
+    detail::store_be32(out + 7, static_cast<uint32_t>(order.timestamp_ns));
+    detail::store_be64(out + 11, order.order_ref);
+    out[19] = order.is_buy ? 'B' : 'S';
+    detail::store_be32(out + 20, order.shares);
+    std::memcpy(out + 24, &order.stock, sizeof(order.stock));
+    detail::store_be32(out + 32, order.price);
+    return ADD_ORDER_LEN;
+}
+
+} // namespace itch
+} // namespace feed
+} // namespace trading
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace trading {
+namespace feed {
+
+namespace detail {
+
+inline uint16_t load_be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint32_t load_be32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return __builtin_bswap32(v);
+}
+
+inline uint64_t load_be48(const uint8_t* p) {
+    return (static_cast<uint64_t>(load_be16(p)) << 32) | load_be32(p + 2);
+}
+
+inline uint64_t load_be64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return __builtin_bswap64(v);
+}
+
+inline void store_be16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+inline void store_be32(uint8_t* p, uint32_t v) {
+    v = __builtin_bswap32(v);
+    std::memcpy(p, &v, sizeof(v));
+}
+
+inline void store_be64(uint8_t* p, uint64_t v) {
+    v = __builtin_bswap64(v);
+    std::memcpy(p, &v, sizeof(v));
+}
+
+} // namespace detail
+
+// MoldUDP64 downstream packet framing
+namespace moldudp64 {
+
+constexpr size_t SESSION_LEN = 10;
+constexpr size_t HEADER_LEN = 20;
+
+struct Header {
+    uint8_t session[SESSION_LEN];
+    uint64_t sequence;      // sequence number of the first message
+    uint16_t count;         // 0xFFFF marks end of session
+};
+
+inline bool parse_header(const uint8_t* packet, size_t length, Header& header) {
+    if (length < HEADER_LEN) {
+        return false;
+    }
+    std::memcpy(header.session, packet, SESSION_LEN);
+    header.sequence = detail::load_be64(packet + 10);
+    header.count = detail::load_be16(packet + 18);
+    return true;
+}
+
+// A re-request has the header's layout: session, first sequence wanted and
+// message count. parse_header() reads it.
+constexpr size_t REQUEST_LEN = HEADER_LEN;
+
+inline void encode_request(const uint8_t* session, uint64_t sequence, uint16_t count,
+                           uint8_t* out) {
+    std::memcpy(out, session, SESSION_LEN);
+    detail::store_be64(out + 10, sequence);
+    detail::store_be16(out + 18, count);
+}
+
+// Invoke fn(sequence, message, message_length) for each message in a packet.
+// Returns the number of messages visited, stopping early on truncation.
+template <typename Fn>
+size_t for_each_message(const uint8_t* packet, size_t length, Fn&& fn) {
+    Header header;
+    if (!parse_header(packet, length, header) || header.count == 0xFFFF) {
+        return 0;
+    }
+
+    size_t pos = HEADER_LEN;
+    size_t visited = 0;
+    for (; visited < header.count; ++visited) {
+        if (pos + 2 > length) {
+            break;
+        }
+        size_t msg_len = detail::load_be16(packet + pos);
+        pos += 2;
+        if (pos + msg_len > length) {
+            break;
+        }
+        fn(header.sequence + visited, packet + pos, msg_len);
+        pos += msg_len;
+    }
+    return visited;
+}
+
+// Builds a downstream packet in a caller-provided buffer
+class PacketBuilder {
+public:
+    PacketBuilder(uint8_t* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+
+    void begin(const uint8_t* session, uint64_t sequence) {
+        std::memcpy(buffer_, session, SESSION_LEN);
+        detail::store_be64(buffer_ + 10, sequence);
+        detail::store_be16(buffer_ + 18, 0);
+        length_ = HEADER_LEN;
+        count_ = 0;
+    }
+
+    bool append(const uint8_t* message, size_t message_length) {
+        if (length_ + 2 + message_length > capacity_) {
+            return false;
+        }
+        detail::store_be16(buffer_ + length_, static_cast<uint16_t>(message_length));
+        std::memcpy(buffer_ + length_ + 2, message, message_length);
+        length_ += 2 + message_length;
+        detail::store_be16(buffer_ + 18, ++count_);
+        return true;
+    }
+
+    size_t length() const { return length_; }
+    uint16_t count() const { return count_; }
+    const uint8_t* data() const { return buffer_; }
+
+private:
+    uint8_t* buffer_;
+    size_t capacity_;
+    size_t length_ = 0;
+    uint16_t count_ = 0;
+};
+
+} // namespace moldudp64
+
+// Nasdaq TotalView-ITCH 5.0 messages
+namespace itch {
+
+constexpr uint8_t ADD_ORDER = 'A';
+constexpr size_t ADD_ORDER_LEN = 36;
+
+struct AddOrder {
+    uint16_t stock_locate;
+    uint64_t timestamp_ns;  // nanoseconds since midnight
+    uint64_t order_ref;
+    bool is_buy;
+    uint32_t shares;
+    uint64_t stock;         // 8 ASCII chars, char 0 in the low byte
+    uint32_t price;         // 4 implied decimals
+};
+
+inline bool parse_add_order(const uint8_t* msg, size_t length, AddOrder& out) {
+    if (length < ADD_ORDER_LEN || msg[0] != ADD_ORDER) {
+        return false;
+    }
+    out.stock_locate = detail::load_be16(msg + 1);
+    out.timestamp_ns = detail::load_be48(msg + 5);
+    out.order_ref = detail::load_be64(msg + 11);
+    out.is_buy = msg[19] == 'B';
+    out.shares = detail::load_be32(msg + 20);
+    std::memcpy(&out.stock, msg + 24, sizeof(out.stock));
+    out.price = detail::load_be32(msg + 32);
+    return true;
+}
+
+size_t encode_add_order(const AddOrder& order, uint8_t* out);
+
+} // namespace itch
+
+} // namespace feed
+} // namespace trading
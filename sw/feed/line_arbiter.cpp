@@ -0,0 +1,209 @@
+#include "line_arbiter.hpp"
+#include "pow2.hpp"
+
+#include <algorithm>
+
+namespace trading {
+namespace feed {
+
+LineArbiter::LineArbiter(const LineArbiterConfig& config)
+    : config_(config), last_(0), lines_(), stats_() {
+    config_.window = static_cast<uint32_t>(round_up_pow2(config_.window, 64));
+    mask_ = config_.window - 1;
+    channels_.reserve(config_.max_channels);
+}
+
+double LineArbiter::win_rate(size_t line) const {
+    return stats_.emitted ? static_cast<double>(lines_[line].wins) / stats_.emitted : 0.0;
+}
+
+int32_t LineArbiter::lookup_channel(const uint8_t* session, uint64_t sequence) {
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        if (std::memcmp(channels_[i].session, session, moldudp64::SESSION_LEN) == 0) {
+            last_ = i;
+            return static_cast<int32_t>(i);
+        }
+    }
+    if (channels_.size() >= config_.max_channels || sequence == 0) {
+        return -1;
+    }
+
+    Channel channel;
+    std::memcpy(channel.session, session, moldudp64::SESSION_LEN);
+    channel.base = sequence;
+    channel.highest = sequence - 1;
+    channel.gap_since_ns = 0;
+    channel.frontier_ns = 0;
+    std::fill(channel.line_next, channel.line_next + NUM_LINES, 0);
+    channel.seen.assign(config_.window / 64, 0);
+    channel.stops.assign(config_.window / 64, 0);
+    channel.slots.assign(config_.window, Slot{0, NO_LINE, 0});
+    channels_.push_back(std::move(channel));
+    last_ = channels_.size() - 1;
+    return static_cast<int32_t>(last_);
+}
+
+bool LineArbiter::accept(Channel& channel, uint32_t index, size_t line, uint64_t sequence,
+                         uint64_t timestamp_ns) {
+    Slot& slot = channel.slots[sequence & mask_];
+    if (sequence >= channel.base && sequence - channel.base >= config_.window) {
+        slide(channel, index, sequence - config_.window + 1);
+    } else if (sequence < channel.base || test(channel, sequence)) {
+        // The slot still describes this sequence unless a later one reused it
+        if (sequence + config_.window > channel.highest && slot.line != NO_LINE &&
+            slot.line != line && timestamp_ns >= slot.arrival_ns) {
+            lines_[slot.line].lead_ns += timestamp_ns - slot.arrival_ns;
+            ++lines_[slot.line].lead_samples;
+        }
+        ++lines_[line].duplicates;
+        return false;
+    }
+
+    uint64_t bit = sequence & mask_;
+    channel.seen[bit >> 6] |= 1ull << (bit & 63);
+    slot.arrival_ns = timestamp_ns;
+    slot.line = static_cast<uint32_t>(line);
+    ++lines_[line].wins;
+    ++stats_.emitted;
+
+    if (sequence > channel.highest) {
+        note_frontier(channel, sequence - 1, timestamp_ns);
+        channel.highest = sequence;
+    } else {
+        ++stats_.filled;
+    }
+    if (sequence == channel.base) {
+        advance(channel);
+    }
+    return true;
+}
+
+void LineArbiter::note_frontier(Channel& channel, uint64_t highest, uint64_t timestamp_ns) {
+    if (highest <= channel.highest) {
+        return;
+    }
+    if (highest >= channel.base) {
+        // Sequences after the old frontier are missing; mark where this
+        // extension ends, or the end of the window, so each hole is dated
+        // by when it was found rather than by an older hole
+        ++stats_.gaps;
+        if (channel.base > channel.highest) {
+            channel.gap_since_ns = timestamp_ns;
+        }
+        uint64_t stop = std::min(highest, channel.base + config_.window - 1);
+        if (stop > channel.highest) {
+            uint64_t bit = stop & mask_;
+            channel.stops[bit >> 6] |= 1ull << (bit & 63);
+            channel.slots[bit].found_ns = timestamp_ns;
+        }
+    }
+    channel.highest = highest;
+    channel.frontier_ns = timestamp_ns;
+}
+
+uint64_t LineArbiter::first_set(const std::vector<uint64_t>& bits, uint64_t from,
+                                uint64_t limit) const {
+    for (uint64_t sequence = from; sequence < limit;) {
+        uint64_t bit = sequence & mask_;
+        uint64_t word = bits[bit >> 6] >> (bit & 63);
+        if (word != 0) {
+            sequence += static_cast<uint64_t>(__builtin_ctzll(word));
+            return std::min(sequence, limit);
+        }
+        sequence += 64 - (bit & 63);
+    }
+    return limit;
+}
+
+void LineArbiter::advance(Channel& channel) {
+    for (;;) {
+        uint64_t bit = channel.base & mask_;
+        uint64_t shift = bit & 63;
+        uint64_t run = ~(channel.seen[bit >> 6] >> shift);
+        uint64_t ones = run == 0 ? 64 - shift : static_cast<uint64_t>(__builtin_ctzll(run));
+        if (ones == 0) {
+            break;
+        }
+        uint64_t bits = ones == 64 ? ~0ull : ((1ull << ones) - 1) << shift;
+        channel.seen[bit >> 6] &= ~bits;
+        channel.stops[bit >> 6] &= ~bits;
+        channel.base += ones;
+    }
+
+    if (channel.base <= channel.highest) {
+        // Date the new hole by the frontier extension that found it; one
+        // past the window was found no later than the last extension
+        uint64_t limit = std::min(channel.highest + 1, channel.base + config_.window);
+        uint64_t stop = first_set(channel.stops, channel.base, limit);
+        channel.gap_since_ns =
+            stop < limit ? channel.slots[stop & mask_].found_ns : channel.frontier_ns;
+    }
+}
+
+void LineArbiter::slide(Channel& channel, uint32_t index, uint64_t new_base) {
+    uint64_t end = std::min(new_base, channel.base + config_.window);
+    uint64_t run_start = 0;
+    bool in_run = false;
+    for (uint64_t sequence = channel.base; sequence < end; ++sequence) {
+        uint64_t bit = sequence & mask_;
+        clear(channel.stops, sequence);
+        if (test(channel, sequence)) {
+            clear(channel.seen, sequence);
+            if (in_run) {
+                give_up(index, run_start, sequence - run_start);
+                in_run = false;
+            }
+        } else {
+            channel.slots[bit].line = NO_LINE;
+            if (!in_run) {
+                run_start = sequence;
+                in_run = true;
+            }
+        }
+    }
+    if (!in_run && new_base > end) {
+        run_start = end;
+        in_run = true;
+    }
+    if (in_run) {
+        give_up(index, run_start, new_base - run_start);
+    }
+    channel.base = new_base;
+    advance(channel);
+}
+
+void LineArbiter::expire(Channel& channel, uint32_t index, uint64_t now_ns) {
+    while (channel.base <= channel.highest &&
+           now_ns >= channel.gap_since_ns + config_.gap_timeout_ns) {
+        uint64_t limit = std::min(channel.highest + 1, channel.base + config_.window);
+        uint64_t end = first_set(channel.seen, channel.base, limit);
+        if (end == limit) {
+            // Nothing past the window can have arrived
+            end = channel.highest + 1;
+        }
+        for (uint64_t sequence = channel.base; sequence < std::min(end, limit); ++sequence) {
+            channel.slots[sequence & mask_].line = NO_LINE;
+            clear(channel.stops, sequence);
+        }
+        give_up(index, channel.base, end - channel.base);
+        channel.base = end;
+        advance(channel);
+    }
+}
+
+void LineArbiter::expire(uint64_t now_ns) {
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        expire(channels_[i], static_cast<uint32_t>(i), now_ns);
+    }
+}
+
+void LineArbiter::give_up(uint32_t index, uint64_t first, uint64_t count) {
+    stats_.lost += count;
+    ++stats_.lost_ranges;
+    if (gap_handler_) {
+        gap_handler_(index, first, count);
+    }
+}
+
+} // namespace feed
+} // namespace trading
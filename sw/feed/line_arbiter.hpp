@@ -0,0 +1,185 @@
+#pragma once
+
+#include "itch_decoder.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace trading {
+namespace feed {
+
+constexpr size_t NUM_LINES = 2;  // A and B
+
+struct LineArbiterConfig {
+    uint32_t window = 4096;              // sequences tracked past the oldest hole, power of 2
+    uint64_t gap_timeout_ns = 1000000;   // a hole neither line fills in this long is lost
+    size_t max_channels = 16;            // MoldUDP64 sessions
+};
+
+struct LineStats {
+    uint64_t packets;
+    uint64_t messages;
+    uint64_t wins;          // messages this line delivered first
+    uint64_t duplicates;    // messages already delivered by either line
+    uint64_t gaps;          // jumps in this line's own sequence
+    uint64_t gap_messages;  // messages those jumps skipped
+    uint64_t lead_ns;       // how far ahead its wins were, where the other copy came
+    uint64_t lead_samples;
+};
+
+struct ArbiterStats {
+    uint64_t emitted;
+    uint64_t gaps;          // times the merged stream jumped ahead of itself
+    uint64_t filled;        // messages emitted after a later sequence was
+    uint64_t lost;          // messages neither line delivered in time
+    uint64_t lost_ranges;   // gap handler calls
+    uint64_t foreign;       // packets dropped for want of a channel slot
+};
+
+// Called with each run of sequences given up on, for recovery
+using GapHandler = std::function<void(uint32_t channel, uint64_t first, uint64_t count)>;
+
+// Merges redundant A/B copies of a MoldUDP64 feed ahead of the decoders.
+// Each channel (MoldUDP64 session) keeps the oldest sequence not yet
+// emitted and a bitmap of the window after it, so the first copy of each
+// message is emitted as soon as it arrives and later copies are dropped.
+// Messages are not held back for an earlier hole: a message one line
+// missed comes out when the other line's copy arrives. A hole neither line
+// fills within gap_timeout_ns, or that falls out of the window, is handed
+// to the gap handler.
+class LineArbiter {
+public:
+    explicit LineArbiter(const LineArbiterConfig& config = LineArbiterConfig());
+
+    void set_gap_handler(GapHandler handler) { gap_handler_ = std::move(handler); }
+
+    // Calls fn(channel, sequence, message, length) for each message in a
+    // packet received on line that no line delivered before; timestamp_ns
+    // is the receive time and drives gap expiry. Returns the messages emitted.
+    template <typename Fn>
+    size_t process(size_t line, const uint8_t* packet, size_t length, uint64_t timestamp_ns,
+                   Fn&& fn) {
+        moldudp64::Header header;
+        if (line >= NUM_LINES || !moldudp64::parse_header(packet, length, header) ||
+            header.count == 0xFFFF) {
+            return 0;
+        }
+        int32_t index = find_channel(header.session, header.sequence);
+        if (index < 0) {
+            ++stats_.foreign;
+            return 0;
+        }
+        Channel& channel = channels_[index];
+        LineStats& stats = lines_[line];
+        ++stats.packets;
+
+        uint64_t& next = channel.line_next[line];
+        if (next != 0 && header.sequence > next) {
+            ++stats.gaps;
+            stats.gap_messages += header.sequence - next;
+        }
+        if (header.sequence + header.count > next) {
+            next = header.sequence + header.count;
+        }
+        if (header.count == 0 && header.sequence > 0) {
+            // A heartbeat carries the next sequence, so it reveals a hole too
+            note_frontier(channel, header.sequence - 1, timestamp_ns);
+        }
+
+        size_t emitted = 0;
+        moldudp64::for_each_message(packet, length,
+            [&](uint64_t sequence, const uint8_t* msg, size_t msg_length) {
+                ++stats.messages;
+                if (accept(channel, static_cast<uint32_t>(index), line, sequence,
+                           timestamp_ns)) {
+                    ++emitted;
+                    fn(static_cast<uint32_t>(index), sequence, msg, msg_length);
+                }
+            });
+        if (channel.base <= channel.highest &&
+            timestamp_ns >= channel.gap_since_ns + config_.gap_timeout_ns) {
+            expire(channel, static_cast<uint32_t>(index), timestamp_ns);
+        }
+        return emitted;
+    }
+
+    // Gives up on holes older than gap_timeout_ns; call when the lines are idle
+    void expire(uint64_t now_ns);
+
+    size_t channel_count() const { return channels_.size(); }
+    const uint8_t* session(uint32_t channel) const { return channels_[channel].session; }
+    // Oldest sequence not yet emitted or given up on
+    uint64_t next_sequence(uint32_t channel) const { return channels_[channel].base; }
+
+    const LineStats& line_stats(size_t line) const { return lines_[line]; }
+    const ArbiterStats& stats() const { return stats_; }
+    // Share of emitted messages line delivered first
+    double win_rate(size_t line) const;
+
+private:
+    struct Slot {
+        uint64_t arrival_ns;
+        uint32_t line;
+        uint64_t found_ns;      // when the frontier stopped here, if marked in stops
+    };
+
+    struct Channel {
+        uint8_t session[moldudp64::SESSION_LEN];
+        uint64_t base;          // oldest sequence not emitted or lost
+        uint64_t highest;       // highest sequence known to exist
+        uint64_t gap_since_ns;  // when the hole at base opened, if base <= highest
+        uint64_t frontier_ns;   // when highest last moved
+        uint64_t line_next[NUM_LINES];
+        std::vector<uint64_t> seen;  // bit per sequence in [base, base + window)
+        // Bit per sequence where a frontier extension ended with a hole
+        // before it; the hole up to the next stop was found at its found_ns
+        std::vector<uint64_t> stops;
+        std::vector<Slot> slots;
+    };
+
+    static constexpr uint32_t NO_LINE = ~0u;
+
+    int32_t find_channel(const uint8_t* session, uint64_t sequence) {
+        if (last_ < channels_.size() &&
+            std::memcmp(channels_[last_].session, session, moldudp64::SESSION_LEN) == 0) {
+            return static_cast<int32_t>(last_);
+        }
+        return lookup_channel(session, sequence);
+    }
+
+    bool test(const Channel& channel, uint64_t sequence) const {
+        uint64_t bit = sequence & mask_;
+        return (channel.seen[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    // Finds or adds a channel; a new one starts at sequence
+    int32_t lookup_channel(const uint8_t* session, uint64_t sequence);
+    bool accept(Channel& channel, uint32_t index, size_t line, uint64_t sequence,
+                uint64_t timestamp_ns);
+    void note_frontier(Channel& channel, uint64_t highest, uint64_t timestamp_ns);
+    // First sequence in [from, limit) set in bits, limit if none
+    uint64_t first_set(const std::vector<uint64_t>& bits, uint64_t from, uint64_t limit) const;
+    void clear(std::vector<uint64_t>& bits, uint64_t sequence) const {
+        uint64_t bit = sequence & mask_;
+        bits[bit >> 6] &= ~(1ull << (bit & 63));
+    }
+    void advance(Channel& channel);
+    void slide(Channel& channel, uint32_t index, uint64_t new_base);
+    void expire(Channel& channel, uint32_t index, uint64_t now_ns);
+    void give_up(uint32_t index, uint64_t first, uint64_t count);
+
+    LineArbiterConfig config_;
+    uint64_t mask_;
+    std::vector<Channel> channels_;
+    size_t last_;
+    GapHandler gap_handler_;
+    LineStats lines_[NUM_LINES];
+    ArbiterStats stats_;
+};
+
+} // namespace feed
+} // namespace trading
@@ -0,0 +1,272 @@
+#include "pcap_reader.hpp"
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace trading {
+namespace feed {
+
+namespace {
+
+constexpr uint32_t PCAP_MAGIC_US = 0xa1b2c3d4;
+constexpr uint32_t PCAP_MAGIC_NS = 0xa1b23c4d;
+constexpr uint32_t LINKTYPE_ETHERNET = 1;
+constexpr uint32_t LINKTYPE_RAW = 101;
+constexpr size_t GLOBAL_HEADER_LEN = 24;
+constexpr size_t RECORD_HEADER_LEN = 16;
+constexpr size_t ETH_HEADER_LEN = 14;
+constexpr size_t IPV4_HEADER_LEN = 20;
+constexpr size_t UDP_HEADER_LEN = 8;
+
+uint32_t load_u32(const uint8_t* p, bool swapped) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return swapped ? __builtin_bswap32(v) : v;
+}
+
+uint16_t load_be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t load_be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+void store_be16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void store_be32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+} // namespace
+
+bool parse_udp_frame(const uint8_t* pkt, size_t caplen, bool ethernet, UdpDatagram& datagram) {
+    size_t pos = 0;
+    if (ethernet) {
+        if (caplen < ETH_HEADER_LEN) {
+            return false;
+        }
+        uint16_t ether_type = load_be16(pkt + 12);
+        pos = ETH_HEADER_LEN;
+        if (ether_type == 0x8100 && caplen >= ETH_HEADER_LEN + 4) {
+            ether_type = load_be16(pkt + 16);
+            pos += 4;
+        }
+        if (ether_type != 0x0800) {
+            return false;
+        }
+    }
+
+    if (caplen < pos + IPV4_HEADER_LEN || (pkt[pos] >> 4) != 4) {
+        return false;
+    }
+    size_t ihl = static_cast<size_t>(pkt[pos] & 0x0F) * 4;
+    if (pkt[pos + 9] != 17 || caplen < pos + ihl + UDP_HEADER_LEN) {
+        return false;
+    }
+
+    const uint8_t* udp = pkt + pos + ihl;
+    size_t udp_len = load_be16(udp + 4);
+    size_t available = caplen - pos - ihl;
+    if (udp_len < UDP_HEADER_LEN || udp_len > available) {
+        return false;
+    }
+
+    datagram.timestamp_ns = 0;
+    datagram.src_ip = load_be32(pkt + pos + 12);
+    datagram.dst_ip = load_be32(pkt + pos + 16);
+    datagram.src_port = load_be16(udp);
+    datagram.dst_port = load_be16(udp + 2);
+    datagram.payload = udp + UDP_HEADER_LEN;
+    datagram.length = udp_len - UDP_HEADER_LEN;
+    return true;
+}
+
+PcapReader::~PcapReader() {
+    close();
+}
+
+bool PcapReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open pcap file " << path << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < GLOBAL_HEADER_LEN) {
+        std::cerr << "Invalid pcap file " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "Failed to map pcap file " << path << std::endl;
+        return false;
+    }
+
+    data_ = static_cast<const uint8_t*>(addr);
+    size_ = st.st_size;
+
+    uint32_t magic;
+    std::memcpy(&magic, data_, sizeof(magic));
+    if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS) {
+        swapped_ = false;
+    } else if (__builtin_bswap32(magic) == PCAP_MAGIC_US ||
+               __builtin_bswap32(magic) == PCAP_MAGIC_NS) {
+        swapped_ = true;
+        magic = __builtin_bswap32(magic);
+    } else {
+        std::cerr << "Unsupported pcap format in " << path << std::endl;
+        close();
+        return false;
+    }
+
+    nanosecond_ = magic == PCAP_MAGIC_NS;
+    link_type_ = load_u32(data_ + 20, swapped_);
+    if (link_type_ != LINKTYPE_ETHERNET && link_type_ != LINKTYPE_RAW) {
+        std::cerr << "Unsupported pcap link type " << link_type_ << std::endl;
+        close();
+        return false;
+    }
+
+    offset_ = GLOBAL_HEADER_LEN;
+    return true;
+}
+
+void PcapReader::close() {
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+    }
+    size_ = 0;
+    offset_ = 0;
+}
+
+void PcapReader::rewind() {
+    offset_ = GLOBAL_HEADER_LEN;
+}
+
+bool PcapReader::next(UdpDatagram& datagram) {
+    while (data_ && offset_ + RECORD_HEADER_LEN <= size_) {
+        const uint8_t* record = data_ + offset_;
+        uint32_t ts_sec = load_u32(record, swapped_);
+        uint32_t ts_frac = load_u32(record + 4, swapped_);
+        uint32_t caplen = load_u32(record + 8, swapped_);
+
+        const uint8_t* pkt = record + RECORD_HEADER_LEN;
+        offset_ += RECORD_HEADER_LEN + caplen;
+        if (offset_ > size_) {
+            return false;
+        }
+
+        if (!parse_udp_frame(pkt, caplen, link_type_ == LINKTYPE_ETHERNET, datagram)) {
+            continue;
+        }
+        datagram.timestamp_ns = static_cast<uint64_t>(ts_sec) * 1000000000ull +
+                                (nanosecond_ ? ts_frac : static_cast<uint64_t>(ts_frac) * 1000);
+        return true;
+    }
+    return false;
+}
+
+PcapWriter::~PcapWriter() {
+    close();
+}
+
+bool PcapWriter::open(const std::string& path) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Failed to create pcap file " << path << std::endl;
+        return false;
+    }
+
+    uint8_t header[GLOBAL_HEADER_LEN] = {};
+    uint32_t magic = PCAP_MAGIC_NS;
+    uint16_t version_major = 2;
+    uint16_t version_minor = 4;
+    uint32_t snaplen = 65535;
+    uint32_t link_type = LINKTYPE_ETHERNET;
+    std::memcpy(header, &magic, 4);
+    std::memcpy(header + 4, &version_major, 2);
+    std::memcpy(header + 6, &version_minor, 2);
+    std::memcpy(header + 16, &snaplen, 4);
+    std::memcpy(header + 20, &link_type, 4);
+    return std::fwrite(header, sizeof(header), 1, file_) == 1;
+}
+
+void PcapWriter::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool PcapWriter::write_udp(uint64_t timestamp_ns, uint32_t dst_ip, uint16_t dst_port,
+                           const uint8_t* payload, size_t length) {
+    if (!file_ || length > 65535 - IPV4_HEADER_LEN - UDP_HEADER_LEN) {
+        return false;
+    }
+
+    uint8_t headers[ETH_HEADER_LEN + IPV4_HEADER_LEN + UDP_HEADER_LEN] = {};
+    uint8_t* eth = headers;
+    uint8_t* ip = headers + ETH_HEADER_LEN;
+    uint8_t* udp = ip + IPV4_HEADER_LEN;
+
+    // Multicast destination MAC derived from the group address
+    eth[0] = 0x01;
+    eth[1] = 0x00;
+    eth[2] = 0x5e;
+    eth[3] = static_cast<uint8_t>((dst_ip >> 16) & 0x7f);
+    eth[4] = static_cast<uint8_t>(dst_ip >> 8);
+    eth[5] = static_cast<uint8_t>(dst_ip);
+    store_be16(eth + 12, 0x0800);
+
+    uint16_t ip_len = static_cast<uint16_t>(IPV4_HEADER_LEN + UDP_HEADER_LEN + length);
+    ip[0] = 0x45;
+    store_be16(ip + 2, ip_len);
+    ip[8] = 1;      // TTL
+    ip[9] = 17;     // UDP
+    store_be32(ip + 12, 0x7f000001);
+    store_be32(ip + 16, dst_ip);
+    uint32_t sum = 0;
+    for (size_t i = 0; i < IPV4_HEADER_LEN; i += 2) {
+        sum += load_be16(ip + i);
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    store_be16(ip + 10, static_cast<uint16_t>(~sum));
+
+    store_be16(udp, dst_port);
+    store_be16(udp + 2, dst_port);
+    store_be16(udp + 4, static_cast<uint16_t>(UDP_HEADER_LEN + length));
+
+    uint32_t record[4];
+    record[0] = static_cast<uint32_t>(timestamp_ns / 1000000000ull);
+    record[1] = static_cast<uint32_t>(timestamp_ns % 1000000000ull);
+    record[2] = static_cast<uint32_t>(sizeof(headers) + length);
+    record[3] = record[2];
+
+    return std::fwrite(record, sizeof(record), 1, file_) == 1 &&
+           std::fwrite(headers, sizeof(headers), 1, file_) == 1 &&
+           std::fwrite(payload, length, 1, file_) == 1;
+}
+
+} // namespace feed
+} // namespace trading
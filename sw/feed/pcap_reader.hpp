@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace trading {
+namespace feed {
+
+struct UdpDatagram {
+    uint64_t timestamp_ns;
+    uint32_t src_ip;
+    uint32_t dst_ip;
+    uint16_t src_port;
+    uint16_t dst_port;
+    const uint8_t* payload;
+    size_t length;
+};
+
+// Fills datagram, timestamp aside, from one captured frame (Ethernet,
+// optionally VLAN-tagged, or raw IPv4). False for anything but UDP/IPv4.
+bool parse_udp_frame(const uint8_t* frame, size_t length, bool ethernet, UdpDatagram& datagram);
+
+// Reads UDP/IPv4 datagrams from a classic (libpcap) capture file.
+// The file is memory-mapped and payloads point into the mapping.
+class PcapReader {
+public:
+    PcapReader() = default;
+    ~PcapReader();
+
+    PcapReader(const PcapReader&) = delete;
+    PcapReader& operator=(const PcapReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // Advance to the next UDP datagram; false at end of file
+    bool next(UdpDatagram& datagram);
+
+    // Restart from the first packet
+    void rewind();
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    size_t offset_ = 0;
+    bool swapped_ = false;
+    bool nanosecond_ = false;
+    uint32_t link_type_ = 0;
+};
+
+// Writes UDP/IPv4 datagrams into a classic capture file (nanosecond timestamps)
+class PcapWriter {
+public:
+    PcapWriter() = default;
+    ~PcapWriter();
+
+    PcapWriter(const PcapWriter&) = delete;
+    PcapWriter& operator=(const PcapWriter&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool write_udp(uint64_t timestamp_ns, uint32_t dst_ip, uint16_t dst_port,
+                   const uint8_t* payload, size_t length);
+
+private:
+    FILE* file_ = nullptr;
+};
+
+} // namespace feed
+} // namespace trading
@@ -0,0 +1,48 @@
+#include "feed_publisher.hpp"
+
+#include "itch_decoder.hpp"
+#include "ouch_encoder.hpp"
+
+namespace trading {
+namespace ingest {
+
+FeedPublisher::FeedPublisher(TradingAccelerator& accelerator)
+    : accelerator_(accelerator), data_{std::string(), 0.0, 0, false, std::chrono::nanoseconds(0)},
+      stats_{0, 0, 0, 0, 0} {}
+
+const std::string& FeedPublisher::symbol(uint64_t stock) {
+    auto it = symbols_.find(stock);
+    if (it == symbols_.end()) {
+        it = symbols_.emplace(stock, ouch::unpack_stock(stock)).first;
+    }
+    return it->second;
+}
+
+size_t FeedPublisher::publish(const uint8_t* packet, size_t length) {
+    ++stats_.packets;
+    size_t published = 0;
+    feed::moldudp64::for_each_message(packet, length,
+        [&](uint64_t, const uint8_t* msg, size_t msg_length) {
+            ++stats_.messages;
+            feed::itch::AddOrder order;
+            if (!feed::itch::parse_add_order(msg, msg_length, order)) {
+                ++stats_.skipped;
+                return;
+            }
+            data_.symbol = symbol(order.stock);
+            data_.price = order.price / 10000.0;  // 4 implied decimals
+            data_.quantity = order.shares;
+            data_.is_bid = order.is_buy;
+            data_.timestamp = std::chrono::nanoseconds(order.timestamp_ns);
+            if (accelerator_.send_market_data(data_)) {
+                ++stats_.published;
+                ++published;
+            } else {
+                ++stats_.rejected;
+            }
+        });
+    return published;
+}
+
+} // namespace ingest
+} // namespace trading
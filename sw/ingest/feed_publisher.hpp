@@ -0,0 +1,47 @@
+#pragma once
+
+#include "pcap_reader.hpp"
+#include "trading_interface.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace trading {
+namespace ingest {
+
+struct PublisherStats {
+    uint64_t packets;
+    uint64_t messages;      // MoldUDP64 messages seen
+    uint64_t published;     // add orders accepted by send_market_data
+    uint64_t rejected;      // add orders send_market_data refused
+    uint64_t skipped;       // messages other than add orders
+};
+
+// Decodes MoldUDP64-framed ITCH add orders straight out of a datagram's
+// payload and hands each to TradingAccelerator::send_market_data. Symbol
+// strings are built once per stock and reused.
+class FeedPublisher {
+public:
+    explicit FeedPublisher(TradingAccelerator& accelerator);
+
+    // Returns the add orders published from one datagram
+    size_t publish(const feed::UdpDatagram& datagram) {
+        return publish(datagram.payload, datagram.length);
+    }
+    size_t publish(const uint8_t* packet, size_t length);
+
+    const PublisherStats& stats() const { return stats_; }
+
+private:
+    const std::string& symbol(uint64_t stock);
+
+    TradingAccelerator& accelerator_;
+    std::unordered_map<uint64_t, std::string> symbols_;
+    MarketData data_;
+    PublisherStats stats_;
+};
+
+} // namespace ingest
+} // namespace trading
@@ -0,0 +1,356 @@
+#include "gap_recovery.hpp"
+
+#include "book_snapshot.hpp"
+#include "ouch_encoder.hpp"
+#include "pow2.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace trading {
+namespace ingest {
+
+namespace {
+
+constexpr int SNAPSHOT_TIMEOUT_S = 1;
+
+using Clock = std::chrono::steady_clock;
+
+// Fails once deadline passes, however the bytes are spread out
+bool read_all(int fd, uint8_t* data, size_t length, Clock::time_point deadline) {
+    while (length > 0) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+        if (left.count() <= 0) {
+            std::cerr << "Snapshot read timed out" << std::endl;
+            return false;
+        }
+        pollfd ready{fd, POLLIN, 0};
+        if (::poll(&ready, 1, static_cast<int>(left.count())) <= 0) {
+            continue;
+        }
+        ssize_t n = recv(fd, data, length, MSG_DONTWAIT);
+        if (n <= 0) {
+            if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+GapRecovery::GapRecovery(OrderBookEngine& book, const GapRecoveryConfig& config)
+    : book_(book), config_(config), fd_(-1), session_(), have_session_(false), next_(0),
+      frontier_(0), held_count_(0), in_hole_(false), hole_first_(0), hole_count_(0),
+      hole_since_ns_(0), requesting_(false), requested_at_ns_(0), attempts_(0),
+      used_snapshot_(false), stats_{0, 0, 0, 0, 0, 0, 0, 0, 0} {
+    uint64_t window = round_up_pow2(config_.buffer_window);
+    mask_ = window - 1;
+    held_.assign(window, Held{0, 0});
+    held_bytes_.assign(window * config_.max_message, 0);
+    packet_.resize(65536);
+}
+
+GapRecovery::~GapRecovery() {
+    close();
+}
+
+bool GapRecovery::open() {
+    close();
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.retransmit_port);
+    if (inet_pton(AF_INET, config_.server_address.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Bad recovery server address " << config_.server_address << std::endl;
+        return false;
+    }
+    fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd_ < 0 || connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Re-request socket failed: " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void GapRecovery::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+const std::string& GapRecovery::symbol(uint64_t stock) {
+    auto it = symbols_.find(stock);
+    if (it == symbols_.end()) {
+        it = symbols_.emplace(stock, ouch::unpack_stock(stock)).first;
+    }
+    return it->second;
+}
+
+void GapRecovery::process(const uint8_t* packet, size_t length, uint64_t now_ns) {
+    feed::moldudp64::Header header;
+    if (!feed::moldudp64::parse_header(packet, length, header) || header.count == 0xFFFF) {
+        return;
+    }
+    if (!have_session_) {
+        std::memcpy(session_, header.session, sizeof(session_));
+        have_session_ = true;
+    }
+    if (header.count == 0) {
+        // A heartbeat carries the next sequence to be sent
+        if (next_ != 0) {
+            note_frontier(header.sequence, header.sequence, now_ns);
+        }
+        return;
+    }
+    feed::moldudp64::for_each_message(packet, length,
+        [&](uint64_t sequence, const uint8_t* msg, size_t msg_length) {
+            on_message(sequence, msg, msg_length, now_ns);
+        });
+}
+
+void GapRecovery::on_message(uint64_t sequence, const uint8_t* msg, size_t length,
+                             uint64_t now_ns) {
+    if (next_ == 0) {
+        next_ = sequence;
+        frontier_ = sequence;
+    }
+    if (sequence < next_) {
+        ++stats_.duplicates;
+        return;
+    }
+    if (sequence == next_) {
+        release(msg, length);
+        ++next_;
+        drain(now_ns);
+        return;
+    }
+
+    Held& held = held_[sequence & mask_];
+    if (sequence - next_ > mask_ || length > config_.max_message) {
+        ++stats_.overflowed;
+    } else if (held.sequence == sequence) {
+        ++stats_.duplicates;
+    } else {
+        held.sequence = sequence;
+        held.length = static_cast<uint16_t>(length);
+        std::memcpy(&held_bytes_[(sequence & mask_) * config_.max_message], msg, length);
+        stats_.buffered_peak = std::max(stats_.buffered_peak, ++held_count_);
+    }
+    note_frontier(sequence, sequence + 1, now_ns);
+}
+
+void GapRecovery::recover(const uint8_t* session, uint64_t first, uint64_t count,
+                          uint64_t now_ns) {
+    if (!have_session_) {
+        std::memcpy(session_, session, sizeof(session_));
+        have_session_ = true;
+    }
+    if (next_ == 0 || first + count <= next_) {
+        return;
+    }
+    note_frontier(first + count, first + count, now_ns);
+    if (!requesting_) {
+        request(now_ns);
+    }
+}
+
+void GapRecovery::note_frontier(uint64_t missing_end, uint64_t frontier, uint64_t now_ns) {
+    if (frontier <= frontier_) {
+        return;
+    }
+    frontier_ = frontier;
+    if (!in_hole_ && next_ < frontier_) {
+        in_hole_ = true;
+        ++stats_.holes;
+        hole_first_ = next_;
+        hole_count_ = missing_end - next_;
+        hole_since_ns_ = now_ns;
+        attempts_ = 0;
+        used_snapshot_ = false;
+    }
+}
+
+void GapRecovery::release(const uint8_t* msg, size_t length) {
+    ++stats_.released;
+    feed::itch::AddOrder order;
+    if (feed::itch::parse_add_order(msg, length, order)) {
+        // ITCH prices have 4 implied decimals, the books 6
+        book_.apply(symbol(order.stock), static_cast<uint64_t>(order.price) * 100, order.shares,
+                    order.is_buy);
+        ++stats_.applied;
+    }
+}
+
+void GapRecovery::drain(uint64_t now_ns) {
+    for (;;) {
+        Held& held = held_[next_ & mask_];
+        if (held.sequence != next_) {
+            break;
+        }
+        release(&held_bytes_[(next_ & mask_) * config_.max_message], held.length);
+        held.sequence = 0;
+        --held_count_;
+        ++next_;
+    }
+    frontier_ = std::max(frontier_, next_);
+
+    if (in_hole_ && next_ >= frontier_) {
+        in_hole_ = false;
+        requesting_ = false;
+        if (recovered_) {
+            recovered_(hole_first_, hole_count_, now_ns - hole_since_ns_, used_snapshot_);
+        }
+    }
+}
+
+uint64_t GapRecovery::hole_end() const {
+    uint64_t limit = std::min(frontier_, next_ + mask_ + 1);
+    for (uint64_t sequence = next_ + 1; sequence < limit; ++sequence) {
+        if (held_[sequence & mask_].sequence == sequence) {
+            return sequence;
+        }
+    }
+    return frontier_;
+}
+
+void GapRecovery::poll(uint64_t now_ns) {
+    bool progress = false;
+    ssize_t n;
+    while (fd_ >= 0 && (n = recv(fd_, packet_.data(), packet_.size(), 0)) > 0) {
+        feed::moldudp64::Header header;
+        if (!feed::moldudp64::parse_header(packet_.data(), static_cast<size_t>(n), header) ||
+            std::memcmp(header.session, session_, sizeof(session_)) != 0) {
+            continue;
+        }
+        uint64_t before = next_;
+        feed::moldudp64::for_each_message(packet_.data(), static_cast<size_t>(n),
+            [&](uint64_t sequence, const uint8_t* msg, size_t msg_length) {
+                ++stats_.retransmitted;
+                on_message(sequence, msg, msg_length, now_ns);
+            });
+        progress = progress || next_ != before;
+    }
+
+    if (!recovering()) {
+        return;
+    }
+    if (!requesting_) {
+        if (now_ns - hole_since_ns_ >= config_.hole_timeout_ns) {
+            request(now_ns);
+        }
+    } else if (progress) {
+        // A reply holds one packet's worth; ask for the rest
+        attempts_ = 0;
+        request(now_ns);
+    } else if (now_ns - requested_at_ns_ >= config_.request_timeout_ns) {
+        if (attempts_ >= config_.max_attempts) {
+            load_snapshot(now_ns);
+        } else {
+            request(now_ns);
+        }
+    }
+}
+
+void GapRecovery::request(uint64_t now_ns) {
+    uint64_t count = hole_end() - next_;
+    if (count > config_.max_retransmit || !have_session_ || fd_ < 0) {
+        load_snapshot(now_ns);
+        return;
+    }
+    uint8_t request[feed::moldudp64::REQUEST_LEN];
+    feed::moldudp64::encode_request(session_, next_,
+                                    static_cast<uint16_t>(std::min<uint64_t>(count, 0xFFFF)),
+                                    request);
+    send(fd_, request, sizeof(request), 0);
+    ++stats_.requests;
+    ++attempts_;
+    requesting_ = true;
+    requested_at_ns_ = now_ns;
+}
+
+bool GapRecovery::load_snapshot(uint64_t now_ns) {
+    // Until this succeeds, try again a request timeout from now
+    requesting_ = true;
+    requested_at_ns_ = now_ns;
+    attempts_ = config_.max_attempts;
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.snapshot_port);
+    inet_pton(AF_INET, config_.server_address.c_str(), &addr.sin_addr);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "Snapshot socket failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // On Linux the send timeout also bounds connect(); the reads share
+    // one deadline after it
+    timeval timeout{SNAPSHOT_TIMEOUT_S, 0};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Snapshot connect failed: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    uint8_t prefix[4];
+    std::vector<uint8_t> body;
+    auto deadline = Clock::now() + std::chrono::seconds(SNAPSHOT_TIMEOUT_S);
+    bool ok = read_all(fd, prefix, sizeof(prefix), deadline);
+    if (ok) {
+        uint32_t size = static_cast<uint32_t>(prefix[0]) | static_cast<uint32_t>(prefix[1]) << 8 |
+                        static_cast<uint32_t>(prefix[2]) << 16 |
+                        static_cast<uint32_t>(prefix[3]) << 24;
+        if (size > config_.max_snapshot_bytes) {
+            std::cerr << "Snapshot of " << size << " bytes is over the "
+                      << config_.max_snapshot_bytes << " byte limit" << std::endl;
+            ok = false;
+        } else {
+            body.resize(size);
+            ok = read_all(fd, body.data(), body.size(), deadline);
+        }
+    }
+    ::close(fd);
+    BookSnapshot snapshot;
+    if (!ok || !decode_book_snapshot(body.data(), body.size(), snapshot, "recovery snapshot")) {
+        std::cerr << "Snapshot fetch failed" << std::endl;
+        return false;
+    }
+    if (snapshot.sequence + 1 < next_) {
+        std::cerr << "Snapshot at sequence " << snapshot.sequence << " is behind the book at "
+                  << next_ - 1 << std::endl;
+        return false;
+    }
+
+    book_.load(snapshot);
+    for (Held& held : held_) {
+        if (held.sequence != 0 && held.sequence <= snapshot.sequence) {
+            held.sequence = 0;
+            --held_count_;
+        }
+    }
+    ++stats_.snapshots;
+    used_snapshot_ = true;
+    requesting_ = false;
+    next_ = snapshot.sequence + 1;
+    drain(now_ns);
+    return true;
+}
+
+} // namespace ingest
+} // namespace trading
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "itch_decoder.hpp"
+#include "order_book_engine.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace trading {
+namespace ingest {
+
+struct GapRecoveryConfig {
+    std::string server_address = "127.0.0.1";
+    uint16_t retransmit_port = 19500;
+    uint16_t snapshot_port = 19501;
+    uint64_t hole_timeout_ns = 1000000;     // recover a hole this old without being asked
+    uint64_t request_timeout_ns = 5000000;  // re-request when nothing came back in this long
+    uint32_t max_attempts = 3;              // unanswered re-requests before a snapshot
+    uint64_t max_retransmit = 10000;        // larger holes go straight to a snapshot
+    uint32_t buffer_window = 65536;         // live messages held past a hole, power of 2
+    size_t max_message = 64;
+    uint32_t max_snapshot_bytes = 64 << 20;  // larger snapshot replies are refused
+};
+
+struct RecoveryStats {
+    uint64_t released;       // messages released to the book in sequence
+    uint64_t applied;        // add orders among them
+    uint64_t holes;
+    uint64_t requests;
+    uint64_t retransmitted;  // messages the server sent
+    uint64_t snapshots;
+    uint64_t buffered_peak;
+    uint64_t overflowed;     // live messages dropped for want of buffer room
+    uint64_t duplicates;
+};
+
+// Called as each hole closes: its first sequence and size when found, the
+// time from finding it to the book catching up, and whether that took a
+// snapshot
+using RecoveredHandler =
+    std::function<void(uint64_t first, uint64_t count, uint64_t recover_ns, bool snapshot)>;
+
+// Keeps an OrderBookEngine in step with a MoldUDP64/ITCH feed across
+// packet loss. Live messages are released to the book strictly in
+// sequence; those after a hole are held in a preallocated window until
+// it is filled. A hole is filled by MoldUDP64 re-requests to a
+// retransmission server, or, when it is too large or the requests go
+// unanswered, by loading a book snapshot and releasing whatever was held
+// past the snapshot's sequence. Fetching a snapshot blocks poll() while
+// live packets queue in the socket.
+class GapRecovery {
+public:
+    explicit GapRecovery(OrderBookEngine& book,
+                         const GapRecoveryConfig& config = GapRecoveryConfig());
+    ~GapRecovery();
+
+    GapRecovery(const GapRecovery&) = delete;
+    GapRecovery& operator=(const GapRecovery&) = delete;
+
+    // Opens the re-request socket
+    bool open();
+    void close();
+
+    void set_recovered_handler(RecoveredHandler handler) { recovered_ = std::move(handler); }
+
+    // A live downstream packet; also learns the session to re-request on
+    void process(const uint8_t* packet, size_t length, uint64_t now_ns);
+    // One live message, e.g. from LineArbiter
+    void on_message(uint64_t sequence, const uint8_t* msg, size_t length, uint64_t now_ns);
+    // Recovers [first, first + count) at once, e.g. from a LineArbiter gap handler
+    void recover(const uint8_t* session, uint64_t first, uint64_t count, uint64_t now_ns);
+
+    // Reads retransmissions, retries and falls back to a snapshot; call
+    // whenever the feed is idle and at least every request_timeout_ns
+    void poll(uint64_t now_ns);
+
+    bool recovering() const { return next_ < frontier_; }
+    int fd() const { return fd_; }
+    uint64_t next_sequence() const { return next_; }
+    const RecoveryStats& stats() const { return stats_; }
+
+private:
+    struct Held {
+        uint64_t sequence;  // 0 when empty
+        uint16_t length;
+    };
+
+    // Sequences before missing_end and from next_ on have not arrived;
+    // frontier is one past the highest known to exist
+    void note_frontier(uint64_t missing_end, uint64_t frontier, uint64_t now_ns);
+    void release(const uint8_t* msg, size_t length);
+    void drain(uint64_t now_ns);
+    uint64_t hole_end() const;
+    void request(uint64_t now_ns);
+    bool load_snapshot(uint64_t now_ns);
+    const std::string& symbol(uint64_t stock);
+
+    OrderBookEngine& book_;
+    GapRecoveryConfig config_;
+    int fd_;
+    RecoveredHandler recovered_;
+
+    uint8_t session_[feed::moldudp64::SESSION_LEN];
+    bool have_session_;
+    uint64_t next_;      // next sequence to release, 0 before the first
+    uint64_t frontier_;  // one past the highest sequence known to exist
+
+    // Held messages, a slot per sequence modulo the window
+    std::vector<Held> held_;
+    std::vector<uint8_t> held_bytes_;
+    uint64_t mask_;
+    uint64_t held_count_;
+
+    // The hole being recovered
+    bool in_hole_;
+    uint64_t hole_first_;
+    uint64_t hole_count_;
+    uint64_t hole_since_ns_;
+    bool requesting_;
+    uint64_t requested_at_ns_;
+    uint32_t attempts_;
+    bool used_snapshot_;
+
+    std::vector<uint8_t> packet_;
+    std::unordered_map<uint64_t, std::string> symbols_;
+    RecoveryStats stats_;
+};
+
+} // namespace ingest
+} // namespace trading
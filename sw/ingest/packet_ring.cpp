@@ -0,0 +1,518 @@
+#include "packet_ring.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <arpa/inet.h>
+#include <linux/bpf.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_link.h>
+#include <linux/if_packet.h>
+#include <linux/if_xdp.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+namespace trading {
+namespace ingest {
+
+namespace {
+
+constexpr uint32_t MAX_XDP_BATCH = 256;
+constexpr uint32_t XSK_MAP_ENTRIES = 64;
+
+uint64_t realtime_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+long bpf(int cmd, bpf_attr& attr) {
+    return syscall(__NR_bpf, cmd, &attr, sizeof(attr));
+}
+
+bpf_insn insn(uint8_t code, uint8_t dst, uint8_t src, int16_t off, int32_t imm) {
+    bpf_insn i;
+    i.code = code;
+    i.dst_reg = dst;
+    i.src_reg = src;
+    i.off = off;
+    i.imm = imm;
+    return i;
+}
+
+// Socket filter for TPACKET_V3: IPv4 UDP to port (any port if 0), minus
+// the outgoing copies a packet socket also sees on lo, and fragments
+std::vector<sock_filter> udp_filter(uint16_t port) {
+    std::vector<sock_filter> filter = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_PKTTYPE)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, PACKET_OUTGOING, 10, 0),
+        BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 12),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ETH_P_IP, 0, 8),
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 23),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP, 0, 6),
+        BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 20),
+        BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x1fff, 4, 0),
+        BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, 14),
+        BPF_STMT(BPF_LD | BPF_H | BPF_IND, 16),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, port, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, 0x40000),
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    if (port == 0) {
+        filter[10] = BPF_STMT(BPF_JMP | BPF_JA, 0);
+    }
+    return filter;
+}
+
+// XDP program: IPv4 UDP to port (any port if 0, IHL 5 only) goes to the
+// XSK bound to the receiving queue, everything else to the stack
+std::vector<bpf_insn> redirect_program(int map_fd, uint16_t port) {
+    std::vector<bpf_insn> program = {
+        insn(BPF_ALU64 | BPF_MOV | BPF_X, 6, 1, 0, 0),            // r6 = ctx
+        insn(BPF_LDX | BPF_W | BPF_MEM, 2, 6, 0, 0),              // r2 = data
+        insn(BPF_LDX | BPF_W | BPF_MEM, 3, 6, 4, 0),              // r3 = data_end
+        insn(BPF_ALU64 | BPF_MOV | BPF_X, 4, 2, 0, 0),
+        insn(BPF_ALU64 | BPF_ADD | BPF_K, 4, 0, 0, 42),           // eth + ip + udp
+        insn(BPF_JMP | BPF_JGT | BPF_X, 4, 3, 14, 0),
+        insn(BPF_LDX | BPF_H | BPF_MEM, 5, 2, 12, 0),             // ether type
+        insn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, 12, htons(ETH_P_IP)),
+        insn(BPF_LDX | BPF_B | BPF_MEM, 5, 2, 14, 0),             // version, IHL
+        insn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, 10, 0x45),
+        insn(BPF_LDX | BPF_B | BPF_MEM, 5, 2, 23, 0),             // protocol
+        insn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, 8, IPPROTO_UDP),
+        insn(BPF_LDX | BPF_H | BPF_MEM, 5, 2, 36, 0),             // destination port
+        insn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, 6, htons(port)),
+        insn(BPF_LDX | BPF_W | BPF_MEM, 2, 6, 16, 0),             // r2 = rx_queue_index
+        insn(BPF_LD | BPF_DW | BPF_IMM, 1, BPF_PSEUDO_MAP_FD, 0, map_fd),
+        insn(0, 0, 0, 0, 0),
+        insn(BPF_ALU64 | BPF_MOV | BPF_K, 3, 0, 0, XDP_PASS),     // if the queue has no XSK
+        insn(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map),
+        insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+        insn(BPF_ALU64 | BPF_MOV | BPF_K, 0, 0, 0, XDP_PASS),
+        insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+    };
+    if (port == 0) {
+        program[13] = insn(BPF_JMP | BPF_JA, 0, 0, 0, 0);
+    }
+    return program;
+}
+
+} // namespace
+
+PacketRing::PacketRing()
+    : fd_(-1), ring_(nullptr), ring_size_(0), block_(0), holding_block_(false),
+      umem_(nullptr), umem_size_(0), rx_map_(nullptr), rx_map_size_(0), fill_map_(nullptr),
+      fill_map_size_(0), completion_map_(nullptr), completion_map_size_(0),
+      rx_producer_(nullptr), rx_consumer_(nullptr), rx_descs_(nullptr), fill_producer_(nullptr),
+      fill_addrs_(nullptr), ring_entries_(0), held_(0),
+      xsk_map_fd_(-1), prog_fd_(-1), link_fd_(-1), packets_(0), batches_(0), not_udp_(0),
+      kernel_drops_(0) {}
+
+PacketRing::~PacketRing() {
+    close();
+}
+
+bool PacketRing::open(const PacketRingConfig& config) {
+    close();
+    config_ = config;
+    packets_ = batches_ = not_udp_ = kernel_drops_ = 0;
+    bool opened = config_.mode == RingMode::XDP_SOCKET ? open_xdp() : open_tpacket();
+    if (!opened) {
+        close();
+    }
+    return opened;
+}
+
+bool PacketRing::open_tpacket() {
+    const uint32_t page = static_cast<uint32_t>(sysconf(_SC_PAGESIZE));
+    if (config_.block_size % page != 0 || config_.block_size % config_.frame_size != 0) {
+        std::cerr << "Packet ring block size must be a multiple of the page and frame size"
+                  << std::endl;
+        return false;
+    }
+    int ifindex = static_cast<int>(if_nametoindex(config_.interface.c_str()));
+    if (ifindex == 0) {
+        std::cerr << "Unknown interface " << config_.interface << std::endl;
+        return false;
+    }
+
+    // No protocol until bound, so nothing arrives before the filter is on
+    fd_ = socket(AF_PACKET, SOCK_RAW, 0);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open packet socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    std::vector<sock_filter> filter = udp_filter(config_.udp_port);
+    sock_fprog program{static_cast<unsigned short>(filter.size()), filter.data()};
+    int version = TPACKET_V3;
+    tpacket_req3 req;
+    std::memset(&req, 0, sizeof(req));
+    req.tp_block_size = config_.block_size;
+    req.tp_block_nr = config_.block_count;
+    req.tp_frame_size = config_.frame_size;
+    req.tp_frame_nr = config_.block_size / config_.frame_size * config_.block_count;
+    req.tp_retire_blk_tov = config_.block_timeout_ms;
+    if (setsockopt(fd_, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) != 0 ||
+        setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0 ||
+        setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) != 0) {
+        std::cerr << "Failed to set up TPACKET_V3 ring: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    ring_size_ = static_cast<size_t>(config_.block_size) * config_.block_count;
+    void* ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, fd_, 0);
+    if (ring == MAP_FAILED) {
+        // Without CAP_IPC_LOCK the ring is still usable, just not pinned
+        ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    }
+    if (ring == MAP_FAILED) {
+        std::cerr << "Failed to map packet ring: " << std::strerror(errno) << std::endl;
+        ring_size_ = 0;
+        return false;
+    }
+    ring_ = static_cast<uint8_t*>(ring);
+
+    sockaddr_ll addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    addr.sll_ifindex = ifindex;
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Failed to bind packet socket to " << config_.interface << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Packets are at least a header and an Ethernet/IPv4/UDP frame apart
+    frames_.resize(config_.block_size / 64);
+    block_ = 0;
+    holding_block_ = false;
+    return true;
+}
+
+bool PacketRing::open_xdp() {
+    const uint32_t frames = config_.xdp_frames;
+    if (frames == 0 || (frames & (frames - 1)) != 0 ||
+        (config_.frame_size & (config_.frame_size - 1)) != 0) {
+        std::cerr << "AF_XDP frame count and size must be powers of two" << std::endl;
+        return false;
+    }
+    int ifindex = static_cast<int>(if_nametoindex(config_.interface.c_str()));
+    if (ifindex == 0) {
+        std::cerr << "Unknown interface " << config_.interface << std::endl;
+        return false;
+    }
+
+    fd_ = socket(AF_XDP, SOCK_RAW, 0);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open AF_XDP socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    umem_size_ = static_cast<size_t>(frames) * config_.frame_size;
+    void* umem = mmap(nullptr, umem_size_, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (umem == MAP_FAILED) {
+        std::cerr << "Failed to map UMEM" << std::endl;
+        umem_size_ = 0;
+        return false;
+    }
+    umem_ = static_cast<uint8_t*>(umem);
+
+    xdp_umem_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.addr = reinterpret_cast<uint64_t>(umem_);
+    reg.len = umem_size_;
+    reg.chunk_size = config_.frame_size;
+    uint32_t entries = frames;
+    if (setsockopt(fd_, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) != 0 ||
+        setsockopt(fd_, SOL_XDP, XDP_UMEM_FILL_RING, &entries, sizeof(entries)) != 0 ||
+        setsockopt(fd_, SOL_XDP, XDP_UMEM_COMPLETION_RING, &entries, sizeof(entries)) != 0 ||
+        setsockopt(fd_, SOL_XDP, XDP_RX_RING, &entries, sizeof(entries)) != 0) {
+        std::cerr << "Failed to set up AF_XDP rings: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    xdp_mmap_offsets offsets;
+    socklen_t length = sizeof(offsets);
+    if (getsockopt(fd_, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &length) != 0) {
+        std::cerr << "Failed to read AF_XDP ring offsets" << std::endl;
+        return false;
+    }
+    auto map = [&](uint64_t page_offset, size_t size, size_t& mapped) -> uint8_t* {
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                       static_cast<off_t>(page_offset));
+        if (p == MAP_FAILED) {
+            return nullptr;
+        }
+        mapped = size;
+        return static_cast<uint8_t*>(p);
+    };
+    rx_map_ = map(XDP_PGOFF_RX_RING, offsets.rx.desc + entries * sizeof(xdp_desc), rx_map_size_);
+    fill_map_ = map(XDP_UMEM_PGOFF_FILL_RING, offsets.fr.desc + entries * sizeof(uint64_t),
+                    fill_map_size_);
+    completion_map_ = map(XDP_UMEM_PGOFF_COMPLETION_RING,
+                          offsets.cr.desc + entries * sizeof(uint64_t), completion_map_size_);
+    if (!rx_map_ || !fill_map_ || !completion_map_) {
+        std::cerr << "Failed to map AF_XDP rings" << std::endl;
+        return false;
+    }
+    rx_producer_ = reinterpret_cast<uint32_t*>(rx_map_ + offsets.rx.producer);
+    rx_consumer_ = reinterpret_cast<uint32_t*>(rx_map_ + offsets.rx.consumer);
+    rx_descs_ = rx_map_ + offsets.rx.desc;
+    fill_producer_ = reinterpret_cast<uint32_t*>(fill_map_ + offsets.fr.producer);
+    fill_addrs_ = reinterpret_cast<uint64_t*>(fill_map_ + offsets.fr.desc);
+    ring_entries_ = entries;
+
+    // Every frame starts out with the kernel
+    for (uint32_t i = 0; i < frames; ++i) {
+        fill_addrs_[i] = static_cast<uint64_t>(i) * config_.frame_size;
+    }
+    __atomic_store_n(fill_producer_, frames, __ATOMIC_RELEASE);
+
+    sockaddr_xdp addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sxdp_family = AF_XDP;
+    addr.sxdp_ifindex = static_cast<uint32_t>(ifindex);
+    addr.sxdp_queue_id = config_.xdp_queue;
+    addr.sxdp_flags = XDP_COPY;
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Failed to bind AF_XDP socket to " << config_.interface << " queue "
+                  << config_.xdp_queue << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    frames_.resize(MAX_XDP_BATCH);
+    held_ = 0;
+    return attach_xdp_program(ifindex);
+}
+
+bool PacketRing::attach_xdp_program(int ifindex) {
+    bpf_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(uint32_t);
+    attr.max_entries = XSK_MAP_ENTRIES;
+    xsk_map_fd_ = static_cast<int>(bpf(BPF_MAP_CREATE, attr));
+    if (xsk_map_fd_ < 0) {
+        std::cerr << "Failed to create XSK map: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    uint32_t key = config_.xdp_queue;
+    uint32_t value = static_cast<uint32_t>(fd_);
+    std::memset(&attr, 0, sizeof(attr));
+    attr.map_fd = static_cast<uint32_t>(xsk_map_fd_);
+    attr.key = reinterpret_cast<uint64_t>(&key);
+    attr.value = reinterpret_cast<uint64_t>(&value);
+    if (bpf(BPF_MAP_UPDATE_ELEM, attr) != 0) {
+        std::cerr << "Failed to add the socket to the XSK map: " << std::strerror(errno)
+                  << std::endl;
+        return false;
+    }
+
+    std::vector<bpf_insn> program = redirect_program(xsk_map_fd_, config_.udp_port);
+    static const char license[] = "Dual BSD/GPL";
+    char log[4096] = {};
+    std::memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.expected_attach_type = BPF_XDP;
+    attr.insns = reinterpret_cast<uint64_t>(program.data());
+    attr.insn_cnt = static_cast<uint32_t>(program.size());
+    attr.license = reinterpret_cast<uint64_t>(license);
+    attr.log_buf = reinterpret_cast<uint64_t>(log);
+    attr.log_size = sizeof(log);
+    attr.log_level = 1;
+    prog_fd_ = static_cast<int>(bpf(BPF_PROG_LOAD, attr));
+    if (prog_fd_ < 0) {
+        std::cerr << "Failed to load XDP program: " << std::strerror(errno) << "\n" << log
+                  << std::endl;
+        return false;
+    }
+
+    // Generic mode works on any device, lo and veth included; the link
+    // detaches the program when it is closed
+    std::memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd = static_cast<uint32_t>(prog_fd_);
+    attr.link_create.target_ifindex = static_cast<uint32_t>(ifindex);
+    attr.link_create.attach_type = BPF_XDP;
+    attr.link_create.flags = XDP_FLAGS_SKB_MODE;
+    link_fd_ = static_cast<int>(bpf(BPF_LINK_CREATE, attr));
+    if (link_fd_ < 0) {
+        std::cerr << "Failed to attach XDP program to " << config_.interface << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PacketRing::close() {
+    if (holding_block_ || held_ != 0) {
+        release_batch();
+    }
+    if (link_fd_ >= 0) {
+        ::close(link_fd_);
+        link_fd_ = -1;
+    }
+    if (prog_fd_ >= 0) {
+        ::close(prog_fd_);
+        prog_fd_ = -1;
+    }
+    if (xsk_map_fd_ >= 0) {
+        ::close(xsk_map_fd_);
+        xsk_map_fd_ = -1;
+    }
+    if (ring_) {
+        munmap(ring_, ring_size_);
+        ring_ = nullptr;
+        ring_size_ = 0;
+    }
+    if (rx_map_) {
+        munmap(rx_map_, rx_map_size_);
+        rx_map_ = nullptr;
+    }
+    if (fill_map_) {
+        munmap(fill_map_, fill_map_size_);
+        fill_map_ = nullptr;
+    }
+    if (completion_map_) {
+        munmap(completion_map_, completion_map_size_);
+        completion_map_ = nullptr;
+    }
+    if (umem_) {
+        munmap(umem_, umem_size_);
+        umem_ = nullptr;
+        umem_size_ = 0;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+size_t PacketRing::next_batch(int timeout_ms) {
+    if (fd_ < 0) {
+        return 0;
+    }
+    size_t count = config_.mode == RingMode::XDP_SOCKET ? next_xdp_batch(timeout_ms)
+                                                   : next_tpacket_batch(timeout_ms);
+    if (count != 0) {
+        packets_ += count;
+        ++batches_;
+    }
+    return count;
+}
+
+size_t PacketRing::next_tpacket_batch(int timeout_ms) {
+    auto* block = reinterpret_cast<tpacket_block_desc*>(
+        ring_ + static_cast<size_t>(block_) * config_.block_size);
+    if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+        pollfd pfd{fd_, POLLIN | POLLERR, 0};
+        ::poll(&pfd, 1, timeout_ms);
+        if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+            return 0;
+        }
+    }
+    holding_block_ = true;
+
+    const uint32_t packets = block->hdr.bh1.num_pkts;
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(block);
+    auto* packet = reinterpret_cast<const tpacket3_hdr*>(base + block->hdr.bh1.offset_to_first_pkt);
+    size_t count = 0;
+    for (uint32_t i = 0; i < packets && count < frames_.size(); ++i) {
+        const uint8_t* frame = reinterpret_cast<const uint8_t*>(packet) + packet->tp_mac;
+        frames_[count++] = Frame{frame, packet->tp_snaplen,
+                                 static_cast<uint64_t>(packet->tp_sec) * 1000000000ull +
+                                     packet->tp_nsec};
+        packet = reinterpret_cast<const tpacket3_hdr*>(
+            reinterpret_cast<const uint8_t*>(packet) + packet->tp_next_offset);
+    }
+    return count;
+}
+
+size_t PacketRing::next_xdp_batch(int timeout_ms) {
+    uint32_t consumer = *rx_consumer_;
+    uint32_t available = __atomic_load_n(rx_producer_, __ATOMIC_ACQUIRE) - consumer;
+    if (available == 0) {
+        pollfd pfd{fd_, POLLIN, 0};
+        ::poll(&pfd, 1, timeout_ms);
+        available = __atomic_load_n(rx_producer_, __ATOMIC_ACQUIRE) - consumer;
+        if (available == 0) {
+            return 0;
+        }
+    }
+    if (available > frames_.size()) {
+        available = static_cast<uint32_t>(frames_.size());
+    }
+
+    const uint64_t now = realtime_ns();
+    const xdp_desc* descs = static_cast<const xdp_desc*>(rx_descs_);
+    const uint32_t mask = ring_entries_ - 1;
+    for (uint32_t i = 0; i < available; ++i) {
+        const xdp_desc& desc = descs[(consumer + i) & mask];
+        frames_[i] = Frame{umem_ + desc.addr, desc.len, now};
+    }
+    held_ = available;
+    return available;
+}
+
+void PacketRing::release_batch() {
+    if (holding_block_) {
+        auto* block = reinterpret_cast<tpacket_block_desc*>(
+            ring_ + static_cast<size_t>(block_) * config_.block_size);
+        __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        block_ = block_ + 1 == config_.block_count ? 0 : block_ + 1;
+        holding_block_ = false;
+        return;
+    }
+    if (held_ == 0) {
+        return;
+    }
+    // Frames go straight back to the fill ring, chunk-aligned
+    const uint32_t mask = ring_entries_ - 1;
+    const uint64_t chunk_mask = ~static_cast<uint64_t>(config_.frame_size - 1);
+    const xdp_desc* descs = static_cast<const xdp_desc*>(rx_descs_);
+    uint32_t consumer = *rx_consumer_;
+    uint32_t producer = *fill_producer_;
+    for (uint32_t i = 0; i < held_; ++i) {
+        fill_addrs_[(producer + i) & mask] = descs[(consumer + i) & mask].addr & chunk_mask;
+    }
+    __atomic_store_n(fill_producer_, producer + held_, __ATOMIC_RELEASE);
+    __atomic_store_n(rx_consumer_, consumer + held_, __ATOMIC_RELEASE);
+    held_ = 0;
+}
+
+PacketRingStats PacketRing::stats() {
+    if (fd_ >= 0 && config_.mode == RingMode::TPACKET_V3) {
+        // Cleared by every read
+        tpacket_stats_v3 st;
+        socklen_t length = sizeof(st);
+        if (getsockopt(fd_, SOL_PACKET, PACKET_STATISTICS, &st, &length) == 0) {
+            kernel_drops_ += st.tp_drops;
+        }
+    } else if (fd_ >= 0) {
+        xdp_statistics st;
+        socklen_t length = sizeof(st);
+        if (getsockopt(fd_, SOL_XDP, XDP_STATISTICS, &st, &length) == 0) {
+            kernel_drops_ = st.rx_dropped + st.rx_ring_full;
+        }
+    }
+    return PacketRingStats{packets_, batches_, not_udp_, kernel_drops_};
+}
+
+} // namespace ingest
+} // namespace trading
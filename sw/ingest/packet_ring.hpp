@@ -0,0 +1,135 @@
+#pragma once
+
+#include "pcap_reader.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trading {
+namespace ingest {
+
+enum class RingMode {
+    TPACKET_V3,  // AF_PACKET PACKET_RX_RING, block-based
+    XDP_SOCKET,  // AF_XDP socket on a UMEM, fed by a generic-mode XDP redirect
+};
+
+struct PacketRingConfig {
+    std::string interface = "lo";
+    uint16_t udp_port = 0;             // 0 takes every UDP datagram
+    RingMode mode = RingMode::TPACKET_V3;
+
+    // TPACKET_V3: the kernel fills whole blocks and hands each over when
+    // it is full or block_timeout_ms after its first packet
+    uint32_t block_size = 1 << 20;
+    uint32_t block_count = 16;
+    uint32_t frame_size = 2048;
+    uint32_t block_timeout_ms = 1;
+
+    // AF_XDP: UMEM frames (frame_size each) and the queue to bind
+    uint32_t xdp_frames = 4096;
+    uint32_t xdp_queue = 0;
+};
+
+struct PacketRingStats {
+    uint64_t packets;        // frames handed out
+    uint64_t batches;        // blocks (TPACKET_V3) or ring reads (AF_XDP)
+    uint64_t not_udp;        // frames that did not parse as UDP/IPv4
+    uint64_t kernel_drops;   // frames the kernel had no room for
+};
+
+// Receives frames from a memory-mapped ring shared with the kernel, a
+// batch per wake-up rather than a syscall per packet. poll() hands each
+// UDP datagram to the caller with its payload pointing into the ring;
+// the frames go back to the kernel when the callback returns, so
+// anything kept must be copied. Both modes need CAP_NET_RAW, AF_XDP also
+// CAP_NET_ADMIN and CAP_BPF; either works on lo or a veth pair.
+class PacketRing {
+public:
+    PacketRing();
+    ~PacketRing();
+
+    PacketRing(const PacketRing&) = delete;
+    PacketRing& operator=(const PacketRing&) = delete;
+
+    bool open(const PacketRingConfig& config);
+    void close();
+    bool is_open() const { return fd_ >= 0; }
+
+    // Waits up to timeout_ms for a batch and calls fn(const UdpDatagram&)
+    // for each datagram in it; returns the datagrams visited
+    template <typename Fn>
+    size_t poll(Fn&& fn, int timeout_ms) {
+        size_t count = next_batch(timeout_ms);
+        size_t visited = 0;
+        feed::UdpDatagram datagram;
+        for (size_t i = 0; i < count; ++i) {
+            const Frame& frame = frames_[i];
+            if (!feed::parse_udp_frame(frame.data, frame.length, true, datagram)) {
+                ++not_udp_;
+                continue;
+            }
+            datagram.timestamp_ns = frame.timestamp_ns;
+            fn(static_cast<const feed::UdpDatagram&>(datagram));
+            ++visited;
+        }
+        release_batch();
+        return visited;
+    }
+
+    PacketRingStats stats();
+
+private:
+    struct Frame {
+        const uint8_t* data;
+        uint32_t length;
+        uint64_t timestamp_ns;  // kernel receive time; batch time for AF_XDP
+    };
+
+    bool open_tpacket();
+    bool open_xdp();
+    bool attach_xdp_program(int ifindex);
+    size_t next_batch(int timeout_ms);
+    size_t next_tpacket_batch(int timeout_ms);
+    size_t next_xdp_batch(int timeout_ms);
+    void release_batch();
+
+    PacketRingConfig config_;
+    int fd_;
+    uint8_t* ring_;
+    size_t ring_size_;
+    std::vector<Frame> frames_;
+
+    // TPACKET_V3
+    uint32_t block_;
+    bool holding_block_;
+
+    // AF_XDP
+    uint8_t* umem_;
+    size_t umem_size_;
+    uint8_t* rx_map_;
+    size_t rx_map_size_;
+    uint8_t* fill_map_;
+    size_t fill_map_size_;
+    uint8_t* completion_map_;
+    size_t completion_map_size_;
+    uint32_t* rx_producer_;
+    uint32_t* rx_consumer_;
+    void* rx_descs_;
+    uint32_t* fill_producer_;
+    uint64_t* fill_addrs_;
+    uint32_t ring_entries_;
+    uint32_t held_;
+    int xsk_map_fd_;
+    int prog_fd_;
+    int link_fd_;
+
+    uint64_t packets_;
+    uint64_t batches_;
+    uint64_t not_udp_;
+    uint64_t kernel_drops_;
+};
+
+} // namespace ingest
+} // namespace trading
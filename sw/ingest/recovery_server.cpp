@@ -0,0 +1,238 @@
+#include "recovery_server.hpp"
+
+#include "book_snapshot.hpp"
+#include "ouch_encoder.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace trading {
+namespace ingest {
+
+namespace {
+
+bool write_all(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool make_address(const std::string& host, uint16_t port, sockaddr_in& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    return inet_pton(AF_INET, host.c_str(), &addr.sin_addr) == 1;
+}
+
+} // namespace
+
+RecoveryServer::RecoveryServer()
+    : udp_fd_(-1), tcp_fd_(-1), session_(), have_session_(false), first_sequence_(1),
+      stats_{0, 0, 0, 0} {}
+
+RecoveryServer::~RecoveryServer() {
+    stop();
+}
+
+bool RecoveryServer::start(const RecoveryServerConfig& config) {
+    stop();
+    config_ = config;
+    sockaddr_in addr;
+    if (!make_address(config_.address, config_.retransmit_port, addr)) {
+        std::cerr << "Bad recovery server address " << config_.address << std::endl;
+        return false;
+    }
+
+    udp_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (udp_fd_ < 0 || bind(udp_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Recovery server could not bind UDP port " << config_.retransmit_port
+                  << ": " << std::strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+
+    make_address(config_.address, config_.snapshot_port, addr);
+    tcp_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (tcp_fd_ < 0) {
+        std::cerr << "Recovery server could not open a TCP socket: " << std::strerror(errno)
+                  << std::endl;
+        stop();
+        return false;
+    }
+    int on = 1;
+    setsockopt(tcp_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind(tcp_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(tcp_fd_, 16) != 0) {
+        std::cerr << "Recovery server could not listen on TCP port " << config_.snapshot_port
+                  << ": " << std::strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void RecoveryServer::stop() {
+    if (udp_fd_ >= 0) {
+        close(udp_fd_);
+        udp_fd_ = -1;
+    }
+    if (tcp_fd_ >= 0) {
+        close(tcp_fd_);
+        tcp_fd_ = -1;
+    }
+}
+
+const std::string& RecoveryServer::symbol(uint64_t stock) {
+    auto it = symbols_.find(stock);
+    if (it == symbols_.end()) {
+        it = symbols_.emplace(stock, ouch::unpack_stock(stock)).first;
+    }
+    return it->second;
+}
+
+void RecoveryServer::record(const uint8_t* packet, size_t length) {
+    feed::moldudp64::Header header;
+    if (!feed::moldudp64::parse_header(packet, length, header) || header.count == 0 ||
+        header.count == 0xFFFF) {
+        return;
+    }
+    if (!have_session_) {
+        std::memcpy(session_, header.session, sizeof(session_));
+        have_session_ = true;
+        first_sequence_ = header.sequence;
+    }
+    if (header.sequence != last_sequence() + 1) {
+        return;  // only a contiguous history can be retransmitted
+    }
+
+    feed::moldudp64::for_each_message(packet, length,
+        [&](uint64_t, const uint8_t* msg, size_t msg_length) {
+            offsets_.push_back(static_cast<uint32_t>(messages_.size()));
+            messages_.push_back(static_cast<uint8_t>(msg_length >> 8));
+            messages_.push_back(static_cast<uint8_t>(msg_length));
+            messages_.insert(messages_.end(), msg, msg + msg_length);
+
+            feed::itch::AddOrder order;
+            if (feed::itch::parse_add_order(msg, msg_length, order)) {
+                // ITCH prices have 4 implied decimals, the books 6
+                book_.apply(symbol(order.stock), static_cast<uint64_t>(order.price) * 100,
+                            order.shares, order.is_buy);
+            }
+        });
+
+    if (offsets_.size() > config_.max_messages) {
+        // Forget the older half
+        size_t drop = offsets_.size() / 2;
+        uint32_t shift = offsets_[drop];
+        messages_.erase(messages_.begin(), messages_.begin() + shift);
+        offsets_.erase(offsets_.begin(), offsets_.begin() + static_cast<ptrdiff_t>(drop));
+        for (uint32_t& offset : offsets_) {
+            offset -= shift;
+        }
+        first_sequence_ += drop;
+    }
+}
+
+size_t RecoveryServer::poll(int timeout_ms) {
+    if (udp_fd_ < 0) {
+        return 0;
+    }
+    pollfd fds[2] = {{udp_fd_, POLLIN, 0}, {tcp_fd_, POLLIN, 0}};
+    if (::poll(fds, 2, timeout_ms) <= 0) {
+        return 0;
+    }
+
+    size_t served = 0;
+    uint8_t request[64];
+    sockaddr_in from;
+    socklen_t from_length = sizeof(from);
+    ssize_t n;
+    while ((n = recvfrom(udp_fd_, request, sizeof(request), 0,
+                         reinterpret_cast<sockaddr*>(&from), &from_length)) > 0) {
+        serve_request(request, static_cast<size_t>(n), &from, from_length);
+        from_length = sizeof(from);
+        ++served;
+    }
+    int fd;
+    while ((fd = accept(tcp_fd_, nullptr, nullptr)) >= 0) {
+        serve_snapshot(fd);
+        close(fd);
+        ++served;
+    }
+    return served;
+}
+
+void RecoveryServer::serve_request(const uint8_t* request, size_t length, const void* from,
+                                   uint32_t from_length) {
+    feed::moldudp64::Header header;
+    if (length < feed::moldudp64::REQUEST_LEN ||
+        !feed::moldudp64::parse_header(request, length, header) || !have_session_ ||
+        std::memcmp(header.session, session_, sizeof(session_)) != 0) {
+        return;
+    }
+    ++stats_.requests;
+    if (header.sequence < first_sequence_) {
+        ++stats_.unavailable;
+        return;
+    }
+
+    reply_.resize(config_.max_packet);
+    feed::moldudp64::PacketBuilder builder(reply_.data(), reply_.size());
+    builder.begin(session_, header.sequence);
+    uint64_t last = last_sequence();
+    for (uint64_t sequence = header.sequence;
+         sequence <= last && sequence < header.sequence + header.count; ++sequence) {
+        const uint8_t* msg = &messages_[offsets_[sequence - first_sequence_]];
+        size_t msg_length = (static_cast<size_t>(msg[0]) << 8) | msg[1];
+        if (!builder.append(msg + 2, msg_length)) {
+            break;
+        }
+        ++stats_.retransmitted;
+    }
+    // An empty reply tells the client where the feed is
+    sendto(udp_fd_, builder.data(), builder.length(), 0,
+           static_cast<const sockaddr*>(from), from_length);
+}
+
+void RecoveryServer::serve_snapshot(int fd) {
+    BookSnapshot snapshot;
+    book_.save(snapshot);
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    snapshot.timestamp_ns =
+        static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    snapshot.sequence = last_sequence();
+
+    std::vector<uint8_t> body;
+    encode_book_snapshot(snapshot, body);
+    uint8_t prefix[4];
+    uint32_t size = static_cast<uint32_t>(body.size());
+    for (size_t i = 0; i < sizeof(prefix); ++i) {
+        prefix[i] = static_cast<uint8_t>(size >> (8 * i));
+    }
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    if (write_all(fd, prefix, sizeof(prefix)) && write_all(fd, body.data(), body.size())) {
+        ++stats_.snapshots;
+    }
+}
+
+} // namespace ingest
+} // namespace trading
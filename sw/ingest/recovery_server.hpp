@@ -0,0 +1,79 @@
+#pragma once
+
+#include "itch_decoder.hpp"
+#include "order_book_engine.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trading {
+namespace ingest {
+
+struct RecoveryServerConfig {
+    std::string address = "127.0.0.1";
+    uint16_t retransmit_port = 19500;  // MoldUDP64 re-requests, UDP
+    uint16_t snapshot_port = 19501;    // book snapshots, TCP
+    size_t max_messages = 1 << 20;     // retained for retransmission
+    size_t max_packet = 1400;          // reply payload limit
+};
+
+struct RecoveryServerStats {
+    uint64_t requests;
+    uint64_t retransmitted;  // messages sent in replies
+    uint64_t unavailable;    // requests for messages no longer retained
+    uint64_t snapshots;
+};
+
+// Local stand-in for an exchange's recovery services. Every downstream
+// packet the feed publishes is passed to record(), which keeps its
+// messages for retransmission and applies its add orders to a book.
+// poll() answers MoldUDP64 re-requests with one downstream packet of as
+// many of the requested messages as fit, and snapshot connections with
+// the book as of the last recorded sequence: a u32 little-endian length,
+// then the snapshot in the book_snapshot.hpp layout.
+class RecoveryServer {
+public:
+    RecoveryServer();
+    ~RecoveryServer();
+
+    RecoveryServer(const RecoveryServer&) = delete;
+    RecoveryServer& operator=(const RecoveryServer&) = delete;
+
+    bool start(const RecoveryServerConfig& config = RecoveryServerConfig());
+    void stop();
+
+    void record(const uint8_t* packet, size_t length);
+
+    // Serves what is pending, waiting up to timeout_ms; returns requests served
+    size_t poll(int timeout_ms);
+
+    uint64_t last_sequence() const { return first_sequence_ + offsets_.size() - 1; }
+    const RecoveryServerStats& stats() const { return stats_; }
+
+private:
+    void serve_request(const uint8_t* request, size_t length, const void* from,
+                       uint32_t from_length);
+    void serve_snapshot(int fd);
+    const std::string& symbol(uint64_t stock);
+
+    RecoveryServerConfig config_;
+    int udp_fd_;
+    int tcp_fd_;
+
+    uint8_t session_[feed::moldudp64::SESSION_LEN];
+    bool have_session_;
+    uint64_t first_sequence_;        // sequence of offsets_[0]
+    std::vector<uint32_t> offsets_;  // where each message starts in messages_
+    std::vector<uint8_t> messages_;  // u16 length then the message, back to back
+
+    OrderBookEngine book_;
+    std::unordered_map<uint64_t, std::string> symbols_;
+    std::vector<uint8_t> reply_;
+    RecoveryServerStats stats_;
+};
+
+} // namespace ingest
+} // namespace trading
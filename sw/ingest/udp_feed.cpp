@@ -0,0 +1,273 @@
+#include "udp_feed.hpp"
+
+#include "itch_decoder.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace trading {
+namespace ingest {
+
+namespace {
+
+uint64_t realtime_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t to_ns(const timespec& ts) {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Asks the NIC to stamp every received packet; needs CAP_NET_ADMIN
+bool enable_hardware_stamping(int fd, const std::string& interface) {
+    hwtstamp_config config;
+    std::memset(&config, 0, sizeof(config));
+    config.tx_type = HWTSTAMP_TX_OFF;
+    config.rx_filter = HWTSTAMP_FILTER_ALL;
+    ifreq request;
+    std::memset(&request, 0, sizeof(request));
+    std::strncpy(request.ifr_name, interface.c_str(), IFNAMSIZ - 1);
+    request.ifr_data = reinterpret_cast<char*>(&config);
+    return ioctl(fd, SIOCSHWTSTAMP, &request) == 0;
+}
+
+// Worst case number of add orders in one datagram
+size_t max_add_orders(size_t datagram) {
+    const size_t framed = 2 + feed::itch::ADD_ORDER_LEN;
+    return datagram > feed::moldudp64::HEADER_LEN
+        ? (datagram - feed::moldudp64::HEADER_LEN) / framed : 0;
+}
+
+} // namespace
+
+UdpFeedHandler::UdpFeedHandler(TradingAccelerator& accelerator)
+    : accelerator_(accelerator), fd_(-1), timeout_ms_(-1), control_size_(0), update_count_(0),
+      stats_{0, 0, 0, 0, 0, 0, 0, 0, 0} {}
+
+UdpFeedHandler::~UdpFeedHandler() {
+    close();
+}
+
+bool UdpFeedHandler::open(const UdpFeedConfig& config) {
+    close();
+    config_ = config;
+    stats_ = UdpFeedStats{0, 0, 0, 0, 0, 0, 0, 0, 0};
+    if (config_.batch == 0 || config_.max_datagram <= feed::moldudp64::HEADER_LEN) {
+        std::cerr << "UDP feed needs a batch and room for a MoldUDP64 header" << std::endl;
+        return false;
+    }
+
+    in_addr group;
+    in_addr local;
+    if (inet_pton(AF_INET, config_.group.c_str(), &group) != 1 ||
+        inet_pton(AF_INET, config_.interface_address.c_str(), &local) != 1) {
+        std::cerr << "Bad UDP feed address " << config_.group << " / "
+                  << config_.interface_address << std::endl;
+        return false;
+    }
+
+    fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd_ < 0) {
+        std::cerr << "UDP feed socket failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // A and B lines, or a second handler, may listen on the same port
+    int on = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (setsockopt(fd_, SOL_SOCKET, SO_RCVBUFFORCE, &config_.receive_buffer,
+                   sizeof(config_.receive_buffer)) != 0) {
+        setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &config_.receive_buffer,
+                   sizeof(config_.receive_buffer));
+    }
+    setsockopt(fd_, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on));
+    if (config_.busy_poll_us > 0 &&
+        setsockopt(fd_, SOL_SOCKET, SO_BUSY_POLL, &config_.busy_poll_us,
+                   sizeof(config_.busy_poll_us)) != 0) {
+        std::cerr << "SO_BUSY_POLL not set: " << std::strerror(errno) << std::endl;
+    }
+
+    int stamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (!config_.hardware_interface.empty()) {
+        if (enable_hardware_stamping(fd_, config_.hardware_interface)) {
+            stamping |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+        } else {
+            std::cerr << "No hardware receive timestamps on " << config_.hardware_interface
+                      << ": " << std::strerror(errno) << std::endl;
+        }
+    }
+    if (setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPING, &stamping, sizeof(stamping)) != 0) {
+        std::cerr << "SO_TIMESTAMPING not set: " << std::strerror(errno) << std::endl;
+    }
+
+    // Bound to the group itself so only its traffic arrives
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.port);
+    addr.sin_addr = group;
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "UDP feed bind to " << config_.group << ":" << config_.port
+                  << " failed: " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    if (IN_MULTICAST(ntohl(group.s_addr))) {
+        ip_mreq membership;
+        membership.imr_multiaddr = group;
+        membership.imr_interface = local;
+        if (setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership,
+                       sizeof(membership)) != 0) {
+            std::cerr << "Joining " << config_.group << " failed: " << std::strerror(errno)
+                      << std::endl;
+            close();
+            return false;
+        }
+        int off = 0;
+        setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_ALL, &off, sizeof(off));
+    }
+
+    const size_t batch = config_.batch;
+    control_size_ = CMSG_SPACE(sizeof(scm_timestamping)) + CMSG_SPACE(sizeof(uint32_t));
+    buffers_.assign(batch * config_.max_datagram, 0);
+    controls_.assign(batch * control_size_, 0);
+    iovecs_.resize(batch);
+    headers_.resize(batch);
+    for (size_t i = 0; i < batch; ++i) {
+        iovecs_[i] = iovec{&buffers_[i * config_.max_datagram], config_.max_datagram};
+    }
+    updates_.assign(batch * max_add_orders(config_.max_datagram), BookUpdate());
+    receive_ns_.assign(updates_.size(), 0);
+    update_count_ = 0;
+    timeout_ms_ = -1;
+    return true;
+}
+
+void UdpFeedHandler::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool UdpFeedHandler::set_timeout(int timeout_ms) {
+    if (timeout_ms == timeout_ms_) {
+        return true;
+    }
+    timeval timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+    if (setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0) {
+        return false;
+    }
+    timeout_ms_ = timeout_ms;
+    return true;
+}
+
+uint64_t UdpFeedHandler::receive_time(msghdr& header, uint64_t fallback_ns) {
+    uint64_t received_ns = fallback_ns;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+        if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            scm_timestamping stamps;
+            std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+            if (stamps.ts[2].tv_sec != 0 || stamps.ts[2].tv_nsec != 0) {
+                ++stats_.hardware_stamped;
+                received_ns = to_ns(stamps.ts[2]);
+            } else if (stamps.ts[0].tv_sec != 0 || stamps.ts[0].tv_nsec != 0) {
+                received_ns = to_ns(stamps.ts[0]);
+            }
+        } else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+            uint32_t drops;
+            std::memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+            stats_.kernel_drops = drops;
+        }
+    }
+    return received_ns;
+}
+
+void UdpFeedHandler::decode(const uint8_t* packet, size_t length, uint64_t received_ns) {
+    feed::moldudp64::for_each_message(packet, length,
+        [&](uint64_t, const uint8_t* msg, size_t msg_length) {
+            ++stats_.messages;
+            feed::itch::AddOrder order;
+            if (!feed::itch::parse_add_order(msg, msg_length, order)) {
+                ++stats_.skipped;
+                return;
+            }
+            BookUpdate& update = updates_[update_count_];
+            update.timestamp_ns = order.timestamp_ns;
+            update.price = static_cast<uint64_t>(order.price) * 100;  // 4 to 6 decimals
+            update.quantity = order.shares;
+            update.is_bid = order.is_buy;
+            std::memcpy(update.symbol, &order.stock, sizeof(update.symbol));
+            for (size_t i = sizeof(update.symbol); i > 0 && update.symbol[i - 1] == ' '; --i) {
+                update.symbol[i - 1] = '\0';
+            }
+            receive_ns_[update_count_] = received_ns;
+            ++update_count_;
+        });
+}
+
+size_t UdpFeedHandler::poll(int timeout_ms) {
+    update_count_ = 0;
+    if (fd_ < 0) {
+        return 0;
+    }
+    int flags = MSG_WAITFORONE;
+    if (timeout_ms <= 0) {
+        flags |= MSG_DONTWAIT;
+    } else if (!set_timeout(timeout_ms)) {
+        return 0;
+    }
+
+    const size_t batch = config_.batch;
+    for (size_t i = 0; i < batch; ++i) {
+        msghdr& header = headers_[i].msg_hdr;
+        header.msg_name = nullptr;
+        header.msg_namelen = 0;
+        header.msg_iov = &iovecs_[i];
+        header.msg_iovlen = 1;
+        header.msg_control = &controls_[i * control_size_];
+        header.msg_controllen = control_size_;
+        header.msg_flags = 0;
+    }
+    int received = recvmmsg(fd_, headers_.data(), static_cast<unsigned>(batch), flags, nullptr);
+    if (received <= 0) {
+        return 0;
+    }
+    const uint64_t now_ns = realtime_ns();
+    ++stats_.batches;
+    stats_.datagrams += static_cast<uint64_t>(received);
+
+    for (int i = 0; i < received; ++i) {
+        mmsghdr& message = headers_[i];
+        if (message.msg_hdr.msg_flags & MSG_TRUNC) {
+            ++stats_.truncated;
+            continue;
+        }
+        uint64_t received_ns = receive_time(message.msg_hdr, now_ns);
+        decode(static_cast<const uint8_t*>(iovecs_[i].iov_base), message.msg_len, received_ns);
+    }
+
+    if (update_count_ > 0) {
+        size_t delivered = accelerator_.send_market_data(updates_.data(), update_count_);
+        stats_.delivered += delivered;
+        stats_.rejected += update_count_ - delivered;
+    }
+    return static_cast<size_t>(received);
+}
+
+} // namespace ingest
+} // namespace trading
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "broadcast_ring.hpp"
+#include "trading_interface.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+
+namespace trading {
+namespace ingest {
+
+struct UdpFeedConfig {
+    std::string group = "239.1.1.1";        // multicast group, or a unicast address to bind
+    uint16_t port = 0;
+    std::string interface_address = "0.0.0.0";  // local address to join the group on
+    std::string hardware_interface;         // NIC to enable receive stamping on, empty skips
+    size_t batch = 64;                      // datagrams per recvmmsg
+    size_t max_datagram = 2048;
+    int busy_poll_us = 50;                  // SO_BUSY_POLL for blocking receives, 0 off
+    int receive_buffer = 16 << 20;
+};
+
+struct UdpFeedStats {
+    uint64_t datagrams;
+    uint64_t batches;           // recvmmsg calls that returned data
+    uint64_t messages;          // MoldUDP64 messages seen
+    uint64_t delivered;         // add orders send_market_data accepted
+    uint64_t rejected;          // add orders it refused
+    uint64_t skipped;           // messages other than add orders
+    uint64_t truncated;         // datagrams longer than max_datagram
+    uint64_t hardware_stamped;  // datagrams with a NIC receive timestamp
+    uint64_t kernel_drops;      // datagrams the socket buffer had no room for
+};
+
+// Receives MoldUDP64-framed ITCH from a UDP socket, up to a batch of
+// datagrams per recvmmsg into buffers allocated at open(). Add orders are
+// decoded into BookUpdates and handed to the accelerator with one
+// send_market_data call per batch. Every datagram carries its kernel
+// receive timestamp (SO_TIMESTAMPING): the NIC's raw hardware stamp when
+// hardware_interface supports it, which is in the NIC clock's domain, else
+// the software stamp in CLOCK_REALTIME.
+class UdpFeedHandler {
+public:
+    explicit UdpFeedHandler(TradingAccelerator& accelerator);
+    ~UdpFeedHandler();
+
+    UdpFeedHandler(const UdpFeedHandler&) = delete;
+    UdpFeedHandler& operator=(const UdpFeedHandler&) = delete;
+
+    bool open(const UdpFeedConfig& config);
+    void close();
+    bool is_open() const { return fd_ >= 0; }
+    int fd() const { return fd_; }
+
+    // Receives one batch, waiting up to timeout_ms for its first datagram
+    // (0 does not wait), and delivers its add orders; returns the datagrams
+    // received
+    size_t poll(int timeout_ms);
+
+    // The updates from the last poll() and the receive timestamp of the
+    // datagram each came in, valid until the next poll()
+    const BookUpdate* updates() const { return updates_.data(); }
+    const uint64_t* receive_times() const { return receive_ns_.data(); }
+    size_t update_count() const { return update_count_; }
+
+    const UdpFeedStats& stats() const { return stats_; }
+
+private:
+    bool set_timeout(int timeout_ms);
+    uint64_t receive_time(msghdr& header, uint64_t fallback_ns);
+    void decode(const uint8_t* packet, size_t length, uint64_t received_ns);
+
+    TradingAccelerator& accelerator_;
+    UdpFeedConfig config_;
+    int fd_;
+    int timeout_ms_;
+
+    // Receive buffers, allocated once
+    std::vector<uint8_t> buffers_;
+    std::vector<uint8_t> controls_;
+    std::vector<iovec> iovecs_;
+    std::vector<mmsghdr> headers_;
+    size_t control_size_;
+
+    std::vector<BookUpdate> updates_;
+    std::vector<uint64_t> receive_ns_;
+    size_t update_count_;
+    UdpFeedStats stats_;
+};
+
+} // namespace ingest
+} // namespace trading
@@ -0,0 +1,242 @@
+#include "load_driver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace trading {
+namespace loadgen {
+
+namespace {
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Sleeping is too coarse for the schedule, and spinning starves the
+// backend when threads outnumber cores: sleep to just short of the
+// deadline, then yield until it passes
+void wait_until(uint64_t deadline_ns) {
+    const uint64_t spin_window_ns = 200000;
+    uint64_t now = now_ns();
+    if (deadline_ns > now + spin_window_ns) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(deadline_ns - now - spin_window_ns));
+    }
+    while (now_ns() < deadline_ns) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+LatencyRecorder::LatencyRecorder()
+    : counts_((MAX_EXPONENT - SUB_BITS + 2) << SUB_BITS, 0), count_(0), max_(0), sum_(0.0) {}
+
+size_t LatencyRecorder::bucket_index(uint64_t ns) {
+    const uint64_t sub_count = 1ull << SUB_BITS;
+    if (ns < sub_count) {
+        return static_cast<size_t>(ns);
+    }
+    ns = std::min<uint64_t>(ns, (2ull << MAX_EXPONENT) - 1);
+    uint32_t exponent = 63 - static_cast<uint32_t>(__builtin_clzll(ns));
+    uint32_t shift = exponent - SUB_BITS;
+    uint64_t sub = (ns >> shift) & (sub_count - 1);
+    return static_cast<size_t>(((shift + 1) << SUB_BITS) + sub);
+}
+
+uint64_t LatencyRecorder::bucket_upper_bound(size_t index) {
+    const uint64_t sub_count = 1ull << SUB_BITS;
+    if (index < sub_count) {
+        return index;
+    }
+    uint32_t shift = static_cast<uint32_t>(index >> SUB_BITS) - 1;
+    uint64_t sub = index & (sub_count - 1);
+    return ((sub_count + sub + 1) << shift) - 1;
+}
+
+void LatencyRecorder::record(uint64_t ns) {
+    ++counts_[bucket_index(ns)];
+    ++count_;
+    max_ = std::max(max_, ns);
+    sum_ += static_cast<double>(ns);
+}
+
+void LatencyRecorder::merge(const LatencyRecorder& other) {
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    max_ = std::max(max_, other.max_);
+    sum_ += other.sum_;
+}
+
+void LatencyRecorder::clear() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    count_ = 0;
+    max_ = 0;
+    sum_ = 0.0;
+}
+
+double LatencyRecorder::mean_ns() const {
+    return count_ ? sum_ / static_cast<double>(count_) : 0.0;
+}
+
+uint64_t LatencyRecorder::percentile_ns(double q) const {
+    if (count_ == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count_ - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            return std::min(bucket_upper_bound(i), max_);
+        }
+    }
+    return max_;
+}
+
+LoadDriver::LoadDriver(const LoadBackend& backend) : backend_(backend) {}
+
+void LoadDriver::run_thread(const LoadTestConfig& config, uint32_t thread_index,
+                            uint64_t start_ns, ThreadResult& result) {
+    const double thread_rate = config.offered_rate / config.threads;
+    const double interval_ns = 1e9 / thread_rate;
+    const size_t count = static_cast<size_t>(thread_rate * config.duration_s);
+    const uint64_t give_up_ns = start_ns +
+        static_cast<uint64_t>(config.duration_s * config.max_overrun * 1e9);
+
+    // Generate the whole schedule's payload up front so generation never
+    // delays a send
+    GeneratorConfig generator_config = config.generator;
+    generator_config.seed += thread_index;
+    MarketGenerator generator(generator_config);
+    std::vector<MarketUpdate> updates(count);
+    generator.generate(updates.data(), count);
+
+    // Threads are staggered so their combined schedule stays evenly spaced
+    const double offset_ns = interval_ns * thread_index / config.threads;
+    double order_credit = 0.0;
+    size_t k = 0;
+    for (; k < count; ++k) {
+        uint64_t intended = start_ns + static_cast<uint64_t>(offset_ns + k * interval_ns);
+        uint64_t send = now_ns();
+        if (send < intended) {
+            wait_until(intended);
+            send = now_ns();
+        } else if (send > give_up_ns) {
+            break;
+        } else if (send - intended > interval_ns) {
+            ++result.late_sends;
+        }
+
+        const MarketUpdate& update = updates[k];
+        bool ok;
+        order_credit += config.order_fraction;
+        if (order_credit >= 1.0) {
+            order_credit -= 1.0;
+            ok = backend_.place_order(generator.symbol(update.symbol_id),
+                                      update.price / 1000000.0, update.quantity,
+                                      update.is_bid != 0);
+        } else {
+            ok = backend_.send_market_data(generator.to_market_data(update));
+        }
+        uint64_t done = now_ns();
+
+        result.latency.record(done - intended);
+        result.service.record(done - send);
+        result.failures += ok ? 0 : 1;
+        result.last_completion_ns = done;
+    }
+    result.operations = k;
+
+    // Operations never sent have waited at least this long; recording them
+    // keeps an abandoned run from looking better than a finished one
+    uint64_t abandoned = now_ns();
+    for (; k < count; ++k) {
+        uint64_t intended = start_ns + static_cast<uint64_t>(offset_ns + k * interval_ns);
+        result.latency.record(abandoned > intended ? abandoned - intended : 0);
+        ++result.unsent;
+    }
+}
+
+LoadResult LoadDriver::run(const LoadTestConfig& config) {
+    const uint32_t threads = std::max<uint32_t>(config.threads, 1);
+    LoadTestConfig run_config = config;
+    run_config.threads = threads;
+
+    std::vector<ThreadResult> results(threads);
+    for (ThreadResult& result : results) {
+        result.operations = 0;
+        result.failures = 0;
+        result.late_sends = 0;
+        result.unsent = 0;
+        result.last_completion_ns = 0;
+    }
+
+    // Schedules start together, after every thread has generated its payload
+    const uint64_t start_ns = now_ns() + 20000000;
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; ++t) {
+        workers.emplace_back(&LoadDriver::run_thread, this, std::cref(run_config), t,
+                             start_ns, std::ref(results[t]));
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    LoadResult total;
+    total.offered_rate = config.offered_rate;
+    total.operations = 0;
+    total.failures = 0;
+    total.late_sends = 0;
+    total.unsent = 0;
+    uint64_t end_ns = start_ns;
+    for (const ThreadResult& result : results) {
+        total.operations += result.operations;
+        total.failures += result.failures;
+        total.late_sends += result.late_sends;
+        total.unsent += result.unsent;
+        total.latency.merge(result.latency);
+        total.service.merge(result.service);
+        end_ns = std::max(end_ns, result.last_completion_ns);
+    }
+    double elapsed_s = std::max(static_cast<double>(end_ns - start_ns) / 1e9, config.duration_s);
+    total.achieved_rate = total.operations / elapsed_s;
+    return total;
+}
+
+SweepResult LoadDriver::sweep(const LoadTestConfig& config, const SweepConfig& sweep) {
+    SweepResult result;
+    result.backend = backend_.name;
+    result.saturation_rate = 0.0;
+
+    LoadTestConfig step = config;
+    step.offered_rate = sweep.start_rate;
+    uint64_t baseline_p99 = 0;
+    uint32_t saturated_steps = 0;
+    for (uint32_t i = 0; i < sweep.max_steps && saturated_steps < 2; ++i) {
+        result.points.push_back(run(step));
+        const LoadResult& point = result.points.back();
+
+        // Light loads are noisy, so the baseline is the best p99 seen yet
+        uint64_t p99 = std::max<uint64_t>(point.latency.percentile_ns(0.99), 1);
+        baseline_p99 = i == 0 ? p99 : std::min(baseline_p99, p99);
+        bool saturated = point.unsent > 0 ||
+            point.achieved_rate < sweep.min_efficiency * point.offered_rate ||
+            static_cast<double>(p99) > sweep.knee_p99_factor * baseline_p99;
+        if (saturated) {
+            ++saturated_steps;
+        } else {
+            saturated_steps = 0;
+            result.saturation_rate = point.offered_rate;
+        }
+        step.offered_rate *= sweep.growth;
+    }
+    return result;
+}
+
+} // namespace loadgen
+} // namespace trading
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "market_generator.hpp"
+#include "trading_interface.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace trading {
+namespace loadgen {
+
+// Log-linear latency histogram in the style of HdrHistogram: every power
+// of two is split into 2^SUB_BITS linear buckets, so any recorded value is
+// reported to within 1/64 of itself. Values above 2^MAX_EXPONENT ns clamp.
+class LatencyRecorder {
+public:
+    LatencyRecorder();
+
+    void record(uint64_t ns);
+    void merge(const LatencyRecorder& other);
+    void clear();
+
+    uint64_t count() const { return count_; }
+    uint64_t max_ns() const { return max_; }
+    double mean_ns() const;
+    // Upper bound of the bucket holding quantile q (0..1)
+    uint64_t percentile_ns(double q) const;
+
+private:
+    static constexpr uint32_t SUB_BITS = 6;
+    static constexpr uint32_t MAX_EXPONENT = 40;
+
+    static size_t bucket_index(uint64_t ns);
+    static uint64_t bucket_upper_bound(size_t index);
+
+    std::vector<uint64_t> counts_;
+    uint64_t count_;
+    uint64_t max_;
+    double sum_;
+};
+
+// The system under load. The driver calls it from several threads at
+// once, so the functions must do their own locking.
+struct LoadBackend {
+    std::string name;
+    std::function<bool(const MarketData& data)> send_market_data;
+    std::function<bool(const std::string& symbol, double price,
+                       uint32_t quantity, bool is_buy)> place_order;
+};
+
+struct LoadTestConfig {
+    double offered_rate = 10000.0;  // operations per second over all threads
+    uint32_t threads = 2;
+    double duration_s = 0.5;
+    double order_fraction = 0.1;    // share of operations that are orders
+    double max_overrun = 4.0;       // give up after duration_s * max_overrun
+    GeneratorConfig generator;
+};
+
+// One offered load. Latency runs from the scheduled send time to
+// completion, so time spent queued behind a slow call is counted; service
+// time runs from the actual send and is what a closed-loop test reports.
+struct LoadResult {
+    double offered_rate;
+    double achieved_rate;   // completed operations per second of wall time
+    uint64_t operations;    // completed
+    uint64_t failures;      // calls that returned false
+    uint64_t late_sends;    // sent more than one interval after schedule
+    uint64_t unsent;        // still queued when the run was abandoned
+    LatencyRecorder latency;
+    LatencyRecorder service;
+};
+
+struct SweepConfig {
+    double start_rate = 1000.0;
+    double growth = 2.0;            // offered rate multiplier per step
+    uint32_t max_steps = 16;
+    double min_efficiency = 0.95;   // achieved / offered below this is saturated
+    double knee_p99_factor = 10.0;  // so is p99 above this multiple of the best p99 so far
+};
+
+struct SweepResult {
+    std::string backend;
+    std::vector<LoadResult> points;
+    double saturation_rate;  // highest offered rate that was not saturated
+};
+
+// Open-loop load: each thread issues operations on a fixed-rate schedule
+// regardless of how long earlier calls took, so queueing delay shows up in
+// the measured latency instead of silently lowering the offered load.
+class LoadDriver {
+public:
+    explicit LoadDriver(const LoadBackend& backend);
+
+    LoadResult run(const LoadTestConfig& config);
+    // Raises the offered load until two consecutive steps are saturated
+    SweepResult sweep(const LoadTestConfig& config, const SweepConfig& sweep);
+
+private:
+    struct ThreadResult {
+        uint64_t operations;
+        uint64_t failures;
+        uint64_t late_sends;
+        uint64_t unsent;
+        uint64_t last_completion_ns;
+        LatencyRecorder latency;
+        LatencyRecorder service;
+    };
+
+    void run_thread(const LoadTestConfig& config, uint32_t thread_index,
+                    uint64_t start_ns, ThreadResult& result);
+
+    LoadBackend backend_;
+};
+
+} // namespace loadgen
+} // namespace trading
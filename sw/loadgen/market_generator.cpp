@@ -0,0 +1,185 @@
+#include "market_generator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace trading {
+namespace loadgen {
+
+namespace {
+
+uint32_t to_threshold(double probability) {
+    return static_cast<uint32_t>(std::min(probability, 1.0) * 4294967295.0);
+}
+
+} // namespace
+
+MarketGenerator::MarketGenerator(const GeneratorConfig& config)
+    : config_(config),
+      rng_state_(config.seed),
+      live_(std::max<uint32_t>(config.max_live_orders, 1)),
+      live_count_(0),
+      next_order_id_(1),
+      neg_log_table_(1u << LOG_TABLE_BITS),
+      excess_intensity_(0.0),
+      time_ns_(0.0) {
+    config_.symbols = std::max<uint32_t>(config_.symbols, 1);
+
+    symbols_.reserve(config_.symbols);
+    for (uint32_t i = 0; i < config_.symbols; ++i) {
+        symbols_.push_back("S" + std::to_string(i));
+    }
+    build_alias_table();
+
+    tick_fixed_ = static_cast<uint32_t>(config_.tick * 1000000.0 + 0.5);
+    uint32_t base_ticks = static_cast<uint32_t>(config_.base_price / config_.tick + 0.5);
+    mid_ticks_.assign(config_.symbols, base_ticks);
+    walk_threshold_ = to_threshold(config_.walk_probability);
+    add_threshold_ = to_threshold(config_.add_fraction);
+    cancel_threshold_ = to_threshold(config_.add_fraction + config_.cancel_fraction);
+
+    for (size_t i = 0; i < neg_log_table_.size(); ++i) {
+        neg_log_table_[i] = -std::log((i + 0.5) / neg_log_table_.size());
+    }
+
+    // mean rate = base / (1 - n), and each event adds n / decay to the
+    // intensity so that its expected offspring is n
+    double branching = std::min(std::max(config_.branching_ratio, 0.0), 0.99);
+    double mean_per_ns = config_.mean_rate / 1e9;
+    base_intensity_ = mean_per_ns * (1.0 - branching);
+    excitation_ = branching / config_.decay_ns;
+    inv_decay_ns_ = 1.0 / config_.decay_ns;
+}
+
+void MarketGenerator::build_alias_table() {
+    const uint32_t n = config_.symbols;
+    std::vector<double> weights(n);
+    double total = 0.0;
+    for (uint32_t i = 0; i < n; ++i) {
+        weights[i] = 1.0 / std::pow(i + 1.0, config_.zipf_exponent);
+        total += weights[i];
+    }
+
+    // Vose: split each scaled weight between itself and one alias
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] * n / total;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    alias_threshold_.assign(n, 0xFFFFFFFFu);
+    alias_.resize(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        alias_[i] = i;
+    }
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back();
+        uint32_t l = large.back();
+        small.pop_back();
+        alias_threshold_[s] = to_threshold(scaled[s]);
+        alias_[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+}
+
+uint64_t MarketGenerator::next_random() {
+    // wyrand
+    rng_state_ += 0xa0761d6478bd642full;
+    __uint128_t product = static_cast<__uint128_t>(rng_state_) * (rng_state_ ^ 0xe7037ed1a0b428dbull);
+    return static_cast<uint64_t>(product >> 64) ^ static_cast<uint64_t>(product);
+}
+
+uint32_t MarketGenerator::sample_symbol() {
+    uint64_t r = next_random();
+    uint32_t index = static_cast<uint32_t>(((r >> 32) * config_.symbols) >> 32);
+    return static_cast<uint32_t>(r) < alias_threshold_[index] ? index : alias_[index];
+}
+
+void MarketGenerator::emit_add(MarketUpdate& update) {
+    uint32_t symbol_id = sample_symbol();
+    uint64_t r = next_random();
+    bool is_bid = (r >> 20) & 1;
+    uint32_t offset = 1 + static_cast<uint32_t>(((r & 0xFFFF) * config_.max_depth_ticks) >> 16);
+    uint32_t quantity = 100 * (1 + static_cast<uint32_t>((r >> 16) & 7));
+
+    // Random walk of the mid, one tick either way
+    uint32_t& mid = mid_ticks_[symbol_id];
+    if (static_cast<uint32_t>(r >> 32) < walk_threshold_) {
+        mid += ((r >> 31) & 1) || mid <= config_.max_depth_ticks + 1 ? 1 : -1;
+    }
+    // A mid configured within max_depth_ticks of zero keeps bids at 1 tick
+    uint32_t ticks = is_bid ? (mid > offset ? mid - offset : 1) : mid + offset;
+
+    update.order_id = next_order_id_++;
+    update.symbol_id = symbol_id;
+    update.price = ticks * tick_fixed_;
+    update.quantity = quantity;
+    update.type = UpdateType::ADD;
+    update.is_bid = is_bid;
+    live_[live_count_++] = LiveOrder{update.order_id, symbol_id, update.price, quantity, is_bid};
+}
+
+void MarketGenerator::emit_remove(MarketUpdate& update, UpdateType type, uint32_t random) {
+    // Swap-remove a random live order
+    uint32_t index = static_cast<uint32_t>((static_cast<uint64_t>(random) * live_count_) >> 32);
+    const LiveOrder order = live_[index];
+    live_[index] = live_[--live_count_];
+
+    update.order_id = order.order_id;
+    update.symbol_id = order.symbol_id;
+    update.price = order.price;
+    update.quantity = order.quantity;
+    update.type = type;
+    update.is_bid = order.is_bid;
+}
+
+size_t MarketGenerator::generate(MarketUpdate* out, size_t count) {
+    const uint32_t log_mask = (1u << LOG_TABLE_BITS) - 1;
+    const uint32_t capacity = static_cast<uint32_t>(live_.size());
+
+    for (size_t i = 0; i < count; ++i) {
+        MarketUpdate& update = out[i];
+
+        // Inter-arrival at the current intensity, then linear decay of the
+        // excitation, which is exact enough while gaps are << decay_ns
+        uint64_t r = next_random();
+        double intensity = base_intensity_ + excess_intensity_;
+        double gap = neg_log_table_[r & log_mask] / intensity;
+        time_ns_ += gap;
+        excess_intensity_ = excess_intensity_ * std::max(0.0, 1.0 - gap * inv_decay_ns_) + excitation_;
+        update.timestamp_ns = static_cast<uint64_t>(time_ns_);
+        update.reserved = 0;
+
+        // Bits 12-31 pick the live order to remove, 32-63 the event type
+        uint32_t mix = static_cast<uint32_t>(r >> 32);
+        if (live_count_ == 0 || (mix < add_threshold_ && live_count_ < capacity)) {
+            emit_add(update);
+        } else {
+            UpdateType type = mix < cancel_threshold_ || live_count_ == capacity
+                                  ? UpdateType::CANCEL : UpdateType::EXECUTE;
+            emit_remove(update, type, static_cast<uint32_t>(r) & ~log_mask);
+        }
+    }
+    return count;
+}
+
+MarketData MarketGenerator::to_market_data(const MarketUpdate& update) const {
+    // The device book keeps price levels: an add sets the level, removing
+    // the order clears it
+    return MarketData{
+        symbols_[update.symbol_id],
+        update.price / 1000000.0,
+        update.type == UpdateType::ADD ? update.quantity : 0,
+        update.is_bid != 0,
+        std::chrono::nanoseconds(update.timestamp_ns)
+    };
+}
+
+} // namespace loadgen
+} // namespace trading
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "trading_interface.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trading {
+namespace loadgen {
+
+enum class UpdateType : uint8_t {
+    ADD = 0,
+    CANCEL = 1,
+    EXECUTE = 2,
+};
+
+// One synthetic order-flow event, kept small so buffers of millions stay
+// cache friendly
+struct MarketUpdate {
+    uint64_t timestamp_ns;  // offset from the start of the stream
+    uint64_t order_id;
+    uint32_t symbol_id;
+    uint32_t price;         // 6 implied decimals, the device datapath width
+    uint32_t quantity;
+    UpdateType type;
+    uint8_t is_bid;
+    uint16_t reserved;
+};
+
+struct GeneratorConfig {
+    uint32_t symbols = 1000;
+    double zipf_exponent = 1.0;     // symbol activity ~ 1 / rank^s
+    double base_price = 100.0;
+    double tick = 0.01;
+    uint32_t max_depth_ticks = 8;   // adds land within this many ticks of the mid
+    double walk_probability = 0.1;  // chance an add moves its symbol's mid one tick
+    double add_fraction = 0.55;
+    double cancel_fraction = 0.35;  // executes take the rest
+    uint32_t max_live_orders = 1 << 14;
+
+    // Self-exciting arrivals: every event raises the intensity, which
+    // decays back with decay_ns. branching_ratio is the expected number of
+    // events each event triggers (0 gives a Poisson process).
+    double mean_rate = 1e6;         // messages per second
+    double branching_ratio = 0.5;
+    double decay_ns = 50000.0;
+
+    uint64_t seed = 1;
+};
+
+// High-rate synthetic order flow: Zipf symbol activity, per-symbol price
+// random walks, add/cancel/execute mixes and bursty (Hawkes-like)
+// arrivals. All state is allocated up front; generate() does no
+// allocation and draws every variate from table lookups.
+class MarketGenerator {
+public:
+    explicit MarketGenerator(const GeneratorConfig& config = GeneratorConfig());
+
+    // Fills out[0, count) and returns count
+    size_t generate(MarketUpdate* out, size_t count);
+
+    const std::string& symbol(uint32_t symbol_id) const { return symbols_[symbol_id]; }
+    MarketData to_market_data(const MarketUpdate& update) const;
+    const GeneratorConfig& config() const { return config_; }
+
+private:
+    static constexpr uint32_t LOG_TABLE_BITS = 12;
+
+    struct LiveOrder {
+        uint64_t order_id;
+        uint32_t symbol_id;
+        uint32_t price;
+        uint32_t quantity;
+        uint8_t is_bid;
+    };
+
+    uint64_t next_random();
+    uint32_t sample_symbol();
+    void build_alias_table();
+    void emit_add(MarketUpdate& update);
+    void emit_remove(MarketUpdate& update, UpdateType type, uint32_t random);
+
+    GeneratorConfig config_;
+    uint64_t rng_state_;
+    std::vector<std::string> symbols_;
+
+    // Vose alias table for the Zipf symbol distribution
+    std::vector<uint32_t> alias_threshold_;
+    std::vector<uint32_t> alias_;
+
+    // Per-symbol mid price in ticks
+    std::vector<uint32_t> mid_ticks_;
+    uint32_t tick_fixed_;
+    uint32_t walk_threshold_;
+    uint32_t add_threshold_;
+    uint32_t cancel_threshold_;
+
+    // Orders that can still be cancelled or executed
+    std::vector<LiveOrder> live_;
+    uint32_t live_count_;
+    uint64_t next_order_id_;
+
+    // Arrival process state
+    std::vector<double> neg_log_table_;  // -ln(u) at bucket midpoints
+    double base_intensity_;              // events per ns
+    double excitation_;                  // intensity jump per event
+    double inv_decay_ns_;
+    double excess_intensity_;
+    double time_ns_;
+};
+
+} // namespace loadgen
+} // namespace trading
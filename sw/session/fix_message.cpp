@@ -0,0 +1,168 @@
+#include "fix_message.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+namespace trading {
+namespace fix {
+
+uint32_t put_digits(uint8_t* out, uint64_t value, size_t width) {
+    uint32_t sum = 0;
+    for (size_t i = width; i-- > 0;) {
+        out[i] = static_cast<uint8_t>('0' + value % 10);
+        sum += out[i];
+        value /= 10;
+    }
+    return sum;
+}
+
+uint32_t put_price(uint8_t* out, uint32_t price) {
+    uint32_t sum = put_digits(out, price / 10000, PRICE_WIDTH - 5);
+    out[PRICE_WIDTH - 5] = '.';
+    return sum + '.' + put_digits(out + PRICE_WIDTH - 4, price % 10000, 4);
+}
+
+uint32_t put_hex(uint8_t* out, uint32_t value) {
+    static const char hex[] = "0123456789ABCDEF";
+    uint32_t sum = 0;
+    for (int i = ID_WIDTH - 1; i >= 0; --i) {
+        out[i] = static_cast<uint8_t>(hex[value & 0xF]);
+        sum += out[i];
+        value >>= 4;
+    }
+    return sum;
+}
+
+void put_checksum(uint8_t* out, uint32_t sum) {
+    put_digits(out, sum & 0xFF, 3);
+}
+
+void format_sending_time(uint8_t* out) {
+    auto now = std::chrono::system_clock::now();
+    std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    int millis = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()).count() % 1000);
+    std::tm utc;
+    gmtime_r(&seconds, &utc);
+    put_digits(out, static_cast<uint64_t>(utc.tm_year + 1900), 4);
+    put_digits(out + 4, static_cast<uint64_t>(utc.tm_mon + 1), 2);
+    put_digits(out + 6, static_cast<uint64_t>(utc.tm_mday), 2);
+    out[8] = '-';
+    put_digits(out + 9, static_cast<uint64_t>(utc.tm_hour), 2);
+    out[11] = ':';
+    put_digits(out + 12, static_cast<uint64_t>(utc.tm_min), 2);
+    out[14] = ':';
+    put_digits(out + 15, static_cast<uint64_t>(utc.tm_sec), 2);
+    out[17] = '.';
+    put_digits(out + 18, static_cast<uint64_t>(millis), 3);
+}
+
+uint32_t byte_sum(const uint8_t* data, size_t length) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < length; ++i) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+FixTemplate::FixTemplate(const std::string& msg_type, const std::string& begin_string)
+    : begin_string_(begin_string), base_sum_(0) {
+    add(35, msg_type);
+}
+
+void FixTemplate::add(int tag, const std::string& value) {
+    body_ += std::to_string(tag);
+    body_ += '=';
+    body_ += value;
+    body_ += static_cast<char>(SOH);
+}
+
+size_t FixTemplate::add_patch(int tag, size_t width, const std::string& prefix) {
+    body_ += std::to_string(tag);
+    body_ += '=';
+    body_ += prefix;
+    patches_.push_back(Patch{body_.size(), width});  // relative to the body until finish()
+    body_.append(width, '0');
+    body_ += static_cast<char>(SOH);
+    return patches_.size() - 1;
+}
+
+void FixTemplate::finish() {
+    std::string header = "8=" + begin_string_ + static_cast<char>(SOH) + "9=" +
+                         std::to_string(body_.size()) + static_cast<char>(SOH);
+    std::string message = header + body_ + "10=000" + static_cast<char>(SOH);
+    message_.assign(message.begin(), message.end());
+
+    base_sum_ = byte_sum(message_.data(), header.size() + body_.size());
+    for (Patch& patch : patches_) {
+        patch.offset += header.size();
+        base_sum_ -= byte_sum(message_.data() + patch.offset, patch.width);
+    }
+    if (patches_.empty()) {
+        put_checksum(message_.data() + checksum_offset(), base_sum_);
+    }
+}
+
+size_t message_length(const uint8_t* data, size_t length) {
+    // 8=<BeginString>|9=<BodyLength>|<body>10=NNN|
+    if (length < 2) {
+        return 0;
+    }
+    if (data[0] != '8' || data[1] != '=') {
+        return MALFORMED;
+    }
+    size_t pos = 2;
+    while (pos < length && data[pos] != SOH) {
+        ++pos;
+    }
+    if (pos + 3 > length) {
+        return 0;
+    }
+    if (data[pos + 1] != '9' || data[pos + 2] != '=') {
+        return MALFORMED;
+    }
+    pos += 3;
+    size_t body_length = 0;
+    while (pos < length && data[pos] != SOH) {
+        if (data[pos] < '0' || data[pos] > '9') {
+            return MALFORMED;
+        }
+        body_length = body_length * 10 + (data[pos++] - '0');
+    }
+    if (pos >= length) {
+        return 0;
+    }
+    size_t total = pos + 1 + body_length + 7;
+    return total <= length ? total : 0;
+}
+
+uint64_t parse_uint(const char* value, size_t length) {
+    uint64_t result = 0;
+    for (size_t i = 0; i < length && value[i] >= '0' && value[i] <= '9'; ++i) {
+        result = result * 10 + static_cast<uint64_t>(value[i] - '0');
+    }
+    return result;
+}
+
+uint32_t parse_price(const char* value, size_t length) {
+    uint32_t result = 0;
+    int decimals = -1;
+    for (size_t i = 0; i < length && decimals < 4; ++i) {
+        if (value[i] == '.') {
+            decimals = 0;
+            continue;
+        }
+        result = result * 10 + static_cast<uint32_t>(value[i] - '0');
+        if (decimals >= 0) {
+            ++decimals;
+        }
+    }
+    for (int i = decimals < 0 ? 0 : decimals; i < 4; ++i) {
+        result *= 10;
+    }
+    return result;
+}
+
+} // namespace fix
+} // namespace trading
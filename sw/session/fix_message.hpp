@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trading {
+namespace fix {
+
+constexpr uint8_t SOH = 0x01;
+
+// Widths of the fields patched per message. FIX allows leading zeros in
+// int and float values, so fixed widths keep BodyLength constant.
+constexpr size_t SEQ_WIDTH = 9;
+constexpr size_t QTY_WIDTH = 10;     // any uint32_t quantity
+constexpr size_t PRICE_WIDTH = 11;   // 6 integer digits, '.', 4 decimals
+constexpr size_t TIME_WIDTH = 21;    // YYYYMMDD-HH:MM:SS.sss
+constexpr size_t ID_WIDTH = 8;       // hex order id after the ClOrdID prefix
+
+// Returned by message_length for a stream that is not FIX
+constexpr size_t MALFORMED = static_cast<size_t>(-1);
+
+// Largest sequence number SEQ_WIDTH digits hold; a session stops sending
+// rather than wrap it
+constexpr uint64_t MAX_SEQ = 999999999;
+
+// Each writes a fixed-width value and returns the sum of its bytes, for
+// adding to a template's base checksum. put_digits keeps only the low
+// width digits, so callers check the range first.
+uint32_t put_digits(uint8_t* out, uint64_t value, size_t width);
+uint32_t put_price(uint8_t* out, uint32_t price);  // 4 implied decimals
+uint32_t put_hex(uint8_t* out, uint32_t value);
+void put_checksum(uint8_t* out, uint32_t sum);
+
+// UTC now as a SendingTime value (TIME_WIDTH bytes)
+void format_sending_time(uint8_t* out);
+uint32_t byte_sum(const uint8_t* data, size_t length);
+
+// A message rendered once with its header, BodyLength and checksum in
+// place. Fields added with add_patch() are left zero-filled and excluded
+// from base_sum(); whoever fills them adds their byte sums and writes the
+// checksum.
+class FixTemplate {
+public:
+    explicit FixTemplate(const std::string& msg_type,
+                         const std::string& begin_string = "FIX.4.2");
+
+    void add(int tag, const std::string& value);
+    // A value of prefix followed by width patched bytes; returns a handle for offset()
+    size_t add_patch(int tag, size_t width, const std::string& prefix = "");
+    void finish();
+
+    const std::vector<uint8_t>& bytes() const { return message_; }
+    size_t offset(size_t patch) const { return patches_[patch].offset; }
+    size_t checksum_offset() const { return message_.size() - 4; }
+    uint32_t base_sum() const { return base_sum_; }
+
+private:
+    struct Patch {
+        size_t offset;
+        size_t width;
+    };
+
+    std::string begin_string_;
+    std::string body_;
+    std::vector<Patch> patches_;
+    std::vector<uint8_t> message_;
+    uint32_t base_sum_;
+};
+
+// Length of the complete message at the start of data, 0 if more bytes
+// are needed, MALFORMED if data does not start a FIX message
+size_t message_length(const uint8_t* data, size_t length);
+
+uint64_t parse_uint(const char* value, size_t length);
+uint32_t parse_price(const char* value, size_t length);  // to 4 implied decimals
+
+// Invoke fn(tag, value, value_length) for each field of a complete message
+template <typename Fn>
+void for_each_field(const uint8_t* msg, size_t length, Fn&& fn) {
+    size_t pos = 0;
+    while (pos < length) {
+        int tag = 0;
+        while (pos < length && msg[pos] != '=') {
+            tag = tag * 10 + (msg[pos++] - '0');
+        }
+        size_t start = ++pos;
+        while (pos < length && msg[pos] != SOH) {
+            ++pos;
+        }
+        if (pos >= length) {
+            return;
+        }
+        fn(tag, reinterpret_cast<const char*>(msg + start), pos - start);
+        ++pos;
+    }
+}
+
+} // namespace fix
+} // namespace trading
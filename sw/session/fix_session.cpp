@@ -0,0 +1,415 @@
+#include "fix_session.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace trading {
+namespace session {
+
+namespace {
+
+constexpr size_t IN_BUFFER = 1 << 18;
+constexpr size_t MAX_TEMPLATE = 256;
+constexpr int LOGON_TIMEOUT_MS = 2000;
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+FixSession::FixSession(const FixSessionConfig& config)
+    : config_(config), fd_(-1), batch_(config.batch), batching_(false), next_order_id_(1),
+      next_seq_(1), messages_sent_(0), time_sum_(0), in_(IN_BUFFER), in_length_(0),
+      logged_in_(false), expected_seq_(1), sequence_gaps_(0), bytes_received_(0),
+      sent_at_service_(0), received_at_service_(0), last_send_ns_(0), last_receive_ns_(0),
+      test_request_pending_(false) {
+    symbols_.reserve(config_.max_symbols);
+    refresh_time();
+}
+
+FixSession::~FixSession() {
+    close();
+}
+
+int FixSession::add_symbol(const std::string& symbol) {
+    if (symbols_.size() == config_.max_symbols) {
+        std::cerr << "No room for FIX symbol " << symbol << std::endl;
+        return -1;
+    }
+    symbols_.push_back(SymbolTemplates());
+    symbols_.back().symbol = symbol;
+    if (fd_ >= 0 && !render(symbols_.back())) {
+        symbols_.pop_back();
+        return -1;
+    }
+    return static_cast<int>(symbols_.size() - 1);
+}
+
+bool FixSession::render(SymbolTemplates& symbol) {
+    const size_t slots = batch_.capacity();
+    const std::string& prefix = config_.cl_ord_id_prefix;
+
+    fix::FixTemplate order("D");
+    order.add(49, config_.sender_comp_id);
+    order.add(56, config_.target_comp_id);
+    size_t seq = order.add_patch(34, fix::SEQ_WIDTH);
+    size_t sending_time = order.add_patch(52, fix::TIME_WIDTH);
+    size_t id = order.add_patch(11, fix::ID_WIDTH, prefix);
+    order.add(21, "1");  // automated, no intervention
+    order.add(55, symbol.symbol);
+    size_t side = order.add_patch(54, 1);
+    size_t qty = order.add_patch(38, fix::QTY_WIDTH);
+    order.add(40, "2");  // limit
+    size_t price = order.add_patch(44, fix::PRICE_WIDTH);
+    order.add(59, "0");  // day
+    size_t transact_time = order.add_patch(60, fix::TIME_WIDTH);
+    order.finish();
+    symbol.new_order_at = Layout{order.offset(seq), order.offset(sending_time),
+                                 order.offset(transact_time), order.offset(id), 0,
+                                 order.offset(side), order.offset(qty), order.offset(price),
+                                 order.checksum_offset(), order.base_sum()};
+
+    fix::FixTemplate cancel("F");
+    cancel.add(49, config_.sender_comp_id);
+    cancel.add(56, config_.target_comp_id);
+    seq = cancel.add_patch(34, fix::SEQ_WIDTH);
+    sending_time = cancel.add_patch(52, fix::TIME_WIDTH);
+    size_t orig_id = cancel.add_patch(41, fix::ID_WIDTH, prefix);
+    id = cancel.add_patch(11, fix::ID_WIDTH, prefix);
+    cancel.add(55, symbol.symbol);
+    side = cancel.add_patch(54, 1);
+    qty = cancel.add_patch(38, fix::QTY_WIDTH);
+    transact_time = cancel.add_patch(60, fix::TIME_WIDTH);
+    cancel.finish();
+    symbol.cancel_at = Layout{cancel.offset(seq), cancel.offset(sending_time),
+                              cancel.offset(transact_time), cancel.offset(id),
+                              cancel.offset(orig_id), cancel.offset(side), cancel.offset(qty), 0,
+                              cancel.checksum_offset(), cancel.base_sum()};
+
+    if (order.bytes().size() > MAX_TEMPLATE || cancel.bytes().size() > MAX_TEMPLATE) {
+        std::cerr << "FIX template too long for " << symbol.symbol << std::endl;
+        return false;
+    }
+    return symbol.new_order.init(arena_, order.bytes().data(), order.bytes().size(), slots) &&
+           symbol.cancel.init(arena_, cancel.bytes().data(), cancel.bytes().size(), slots);
+}
+
+bool FixSession::prepare() {
+    if (!arena_.allocate(config_.max_symbols * 2 * batch_.capacity() * MAX_TEMPLATE)) {
+        return false;
+    }
+    for (SymbolTemplates& symbol : symbols_) {
+        if (!render(symbol)) {
+            return false;
+        }
+    }
+    refresh_time();
+    in_length_ = 0;
+    logged_in_ = false;
+    next_seq_ = 1;
+    expected_seq_ = 1;
+    test_request_pending_ = false;
+    sent_at_service_ = messages_sent_;
+    received_at_service_ = bytes_received_;
+    last_send_ns_ = last_receive_ns_ = now_ns();
+    return true;
+}
+
+bool FixSession::connect() {
+    close();
+    fd_ = connect_tcp(config_.host, config_.port);
+    if (fd_ < 0) {
+        std::cerr << "Failed to connect to " << config_.host << ":" << config_.port << std::endl;
+        return false;
+    }
+    if (!prepare() ||
+        !send_admin("A", {{98, "0"}, {108, std::to_string(config_.heartbeat_s)}})) {
+        close();
+        return false;
+    }
+
+    FixHandler handler;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(LOGON_TIMEOUT_MS);
+    while (!logged_in_ && fd_ >= 0 && std::chrono::steady_clock::now() < deadline) {
+        pollfd pfd{fd_, POLLIN, 0};
+        ::poll(&pfd, 1, 10);
+        poll(handler);
+    }
+    if (!logged_in_) {
+        std::cerr << "FIX logon was not accepted" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool FixSession::attach(int fd) {
+    close();
+    fd_ = fd;
+    if (!prepare()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void FixSession::close() {
+    if (fd_ < 0) {
+        return;
+    }
+    flush();
+    if (logged_in_) {
+        send_admin("5", {});
+    }
+    ::close(fd_);
+    fd_ = -1;
+    logged_in_ = false;
+}
+
+void FixSession::refresh_time() {
+    fix::format_sending_time(time_);
+    time_sum_ = fix::byte_sum(time_, sizeof(time_));
+}
+
+bool FixSession::sequence_available() const {
+    if (next_seq_ > fix::MAX_SEQ) {
+        std::cerr << "FIX sequence numbers exhausted at " << fix::MAX_SEQ
+                  << "; reset the session" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool FixSession::send_admin(const std::string& msg_type,
+                            const std::vector<std::pair<int, std::string>>& fields) {
+    // Keeps the stream ordered behind anything batched
+    if (!flush() || !sequence_available()) {
+        return false;
+    }
+    uint8_t seq[fix::SEQ_WIDTH];
+    fix::put_digits(seq, next_seq_++, sizeof(seq));
+    fix::FixTemplate message(msg_type);
+    message.add(49, config_.sender_comp_id);
+    message.add(56, config_.target_comp_id);
+    message.add(34, std::string(seq, seq + sizeof(seq)));
+    message.add(52, std::string(time_, time_ + sizeof(time_)));
+    for (const auto& field : fields) {
+        message.add(field.first, field.second);
+    }
+    message.finish();
+
+    const std::vector<uint8_t>& bytes = message.bytes();
+    if (::send(fd_, bytes.data(), bytes.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(bytes.size())) {
+        std::cerr << "FIX session write failed" << std::endl;
+        return false;
+    }
+    ++messages_sent_;
+    return true;
+}
+
+bool FixSession::new_order(int symbol, uint32_t price, uint32_t shares, bool is_buy,
+                           uint32_t& order_id) {
+    if (fd_ < 0 || symbol < 0 || static_cast<size_t>(symbol) >= symbols_.size() ||
+        !sequence_available()) {
+        return false;
+    }
+    SymbolTemplates& t = symbols_[symbol];
+    const Layout& at = t.new_order_at;
+    uint8_t* msg = t.new_order.next();
+    order_id = next_order_id_++;
+
+    uint32_t sum = at.base_sum + 2 * time_sum_;
+    sum += fix::put_digits(msg + at.seq, next_seq_++, fix::SEQ_WIDTH);
+    std::memcpy(msg + at.sending_time, time_, sizeof(time_));
+    std::memcpy(msg + at.transact_time, time_, sizeof(time_));
+    sum += fix::put_hex(msg + at.id, order_id);
+    msg[at.side] = is_buy ? '1' : '2';
+    sum += msg[at.side];
+    sum += fix::put_digits(msg + at.qty, shares, fix::QTY_WIDTH);
+    sum += fix::put_price(msg + at.price, price);
+    fix::put_checksum(msg + at.checksum, sum);
+    return queue(msg, t.new_order.length());
+}
+
+bool FixSession::cancel_order(int symbol, uint32_t order_id, uint32_t shares, bool is_buy) {
+    if (fd_ < 0 || symbol < 0 || static_cast<size_t>(symbol) >= symbols_.size() ||
+        !sequence_available()) {
+        return false;
+    }
+    SymbolTemplates& t = symbols_[symbol];
+    const Layout& at = t.cancel_at;
+    uint8_t* msg = t.cancel.next();
+
+    uint32_t sum = at.base_sum + 2 * time_sum_;
+    sum += fix::put_digits(msg + at.seq, next_seq_++, fix::SEQ_WIDTH);
+    std::memcpy(msg + at.sending_time, time_, sizeof(time_));
+    std::memcpy(msg + at.transact_time, time_, sizeof(time_));
+    sum += fix::put_hex(msg + at.orig_id, order_id);
+    sum += fix::put_hex(msg + at.id, next_order_id_++);
+    msg[at.side] = is_buy ? '1' : '2';
+    sum += msg[at.side];
+    sum += fix::put_digits(msg + at.qty, shares, fix::QTY_WIDTH);
+    fix::put_checksum(msg + at.checksum, sum);
+    return queue(msg, t.cancel.length());
+}
+
+bool FixSession::flush() {
+    if (batch_.size() == 0) {
+        return true;
+    }
+    return fd_ >= 0 && batch_.flush(fd_);
+}
+
+size_t FixSession::poll(FixHandler& handler) {
+    if (fd_ < 0) {
+        return 0;
+    }
+    ssize_t n = recv(fd_, in_.data() + in_length_, in_.size() - in_length_, MSG_DONTWAIT);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return 0;
+    }
+    if (n <= 0) {
+        std::cerr << "FIX session " << (n == 0 ? "closed by the acceptor" : "receive failed")
+                  << std::endl;
+        disconnect(handler);
+        return 0;
+    }
+    in_length_ += static_cast<size_t>(n);
+    bytes_received_ += static_cast<uint64_t>(n);
+
+    size_t handled = 0;
+    size_t pos = 0;
+    while (pos < in_length_) {
+        size_t length = fix::message_length(in_.data() + pos, in_length_ - pos);
+        if (length == 0) {
+            break;
+        }
+        if (length == fix::MALFORMED) {
+            std::cerr << "FIX session received a malformed message" << std::endl;
+            disconnect(handler);
+            return handled;
+        }
+        handle(in_.data() + pos, length, handler, handled);
+        pos += length;
+    }
+    std::memmove(in_.data(), in_.data() + pos, in_length_ - pos);
+    in_length_ -= pos;
+    return handled;
+}
+
+void FixSession::disconnect(FixHandler& handler) {
+    logged_in_ = false;
+    ::close(fd_);
+    fd_ = -1;
+    in_length_ = 0;
+    handler.on_disconnect();
+}
+
+void FixSession::handle(const uint8_t* msg, size_t length, FixHandler& handler, size_t& handled) {
+    char msg_type = 0;
+    uint64_t seq = 0;
+    uint64_t ref_seq = 0;
+    std::string test_request_id;
+    ExecutionReport report{0, 0, 0, 0, false, 0, 0, 0, 0};
+    const size_t prefix = config_.cl_ord_id_prefix.size();
+
+    fix::for_each_field(msg, length, [&](int tag, const char* value, size_t value_length) {
+        switch (tag) {
+        case 35: msg_type = value_length == 1 ? value[0] : '?'; break;
+        case 34: seq = fix::parse_uint(value, value_length); break;
+        case 45: ref_seq = fix::parse_uint(value, value_length); break;
+        case 112: test_request_id.assign(value, value_length); break;
+        case 11:
+        case 41:
+            if (value_length == prefix + fix::ID_WIDTH) {
+                uint32_t id = static_cast<uint32_t>(std::strtoul(
+                    std::string(value + prefix, fix::ID_WIDTH).c_str(), nullptr, 16));
+                (tag == 11 ? report.order_id : report.orig_order_id) = id;
+            }
+            break;
+        case 150: report.exec_type = value[0]; break;
+        case 39: report.ord_status = value[0]; break;
+        case 54: report.is_buy = value[0] == '1'; break;
+        case 32: report.last_shares = static_cast<uint32_t>(fix::parse_uint(value, value_length)); break;
+        case 31: report.last_price = fix::parse_price(value, value_length); break;
+        case 151: report.leaves_qty = static_cast<uint32_t>(fix::parse_uint(value, value_length)); break;
+        case 14: report.cum_qty = static_cast<uint32_t>(fix::parse_uint(value, value_length)); break;
+        default: break;
+        }
+    });
+
+    if (seq > expected_seq_) {
+        ++sequence_gaps_;
+    }
+    if (seq >= expected_seq_) {
+        expected_seq_ = seq + 1;
+    }
+
+    switch (msg_type) {
+    case 'A':
+        logged_in_ = true;
+        break;
+    case '1':
+        send_admin("0", {{112, test_request_id}});
+        break;
+    case '0':
+        test_request_pending_ = false;
+        break;
+    case '3':
+        handler.on_reject(ref_seq);
+        break;
+    case '5':
+        logged_in_ = false;
+        break;
+    case '8':
+        handler.on_execution_report(report);
+        ++handled;
+        break;
+    default:
+        break;
+    }
+}
+
+bool FixSession::service() {
+    if (fd_ < 0) {
+        return false;
+    }
+    refresh_time();
+    const uint64_t now = now_ns();
+    const uint64_t interval = static_cast<uint64_t>(config_.heartbeat_s) * 1000000000;
+
+    if (messages_sent_ != sent_at_service_) {
+        sent_at_service_ = messages_sent_;
+        last_send_ns_ = now;
+    } else if (now - last_send_ns_ >= interval) {
+        if (!send_admin("0", {})) {
+            return false;
+        }
+        sent_at_service_ = messages_sent_;
+        last_send_ns_ = now;
+    }
+
+    if (bytes_received_ != received_at_service_) {
+        received_at_service_ = bytes_received_;
+        last_receive_ns_ = now;
+        test_request_pending_ = false;
+    } else if (logged_in_ && now - last_receive_ns_ > 2 * interval) {
+        std::cerr << "FIX session timed out waiting for the acceptor" << std::endl;
+        return false;
+    } else if (logged_in_ && !test_request_pending_ && now - last_receive_ns_ > interval) {
+        test_request_pending_ = true;
+        return send_admin("1", {{112, "TEST"}});
+    }
+    return true;
+}
+
+} // namespace session
+} // namespace trading
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "fix_message.hpp"
+#include "session_io.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace trading {
+namespace session {
+
+struct FixSessionConfig {
+    std::string host = "127.0.0.1";
+    uint16_t port = 9878;
+    std::string sender_comp_id = "HOST";
+    std::string target_comp_id = "EXCH";
+    std::string cl_ord_id_prefix = "HOST00";  // ClOrdID is this plus 8 hex digits
+    uint32_t heartbeat_s = 30;                // HeartBtInt
+    size_t batch = 64;                        // messages per write when batching
+    size_t max_symbols = 16;
+};
+
+struct ExecutionReport {
+    uint32_t order_id;       // from ClOrdID
+    uint32_t orig_order_id;  // from OrigClOrdID on cancels, else 0
+    char exec_type;          // 150
+    char ord_status;         // 39
+    bool is_buy;
+    uint32_t last_shares;
+    uint32_t last_price;     // 4 implied decimals
+    uint32_t leaves_qty;
+    uint32_t cum_qty;
+};
+
+class FixHandler {
+public:
+    virtual ~FixHandler() = default;
+    virtual void on_execution_report(const ExecutionReport&) {}
+    virtual void on_reject(uint64_t /*ref_seq_num*/) {}
+    // The acceptor closed the connection or it failed; the session is closed
+    virtual void on_disconnect() {}
+};
+
+// Host-side FIX 4.2 order entry with the same send path as OuchSession.
+// Each symbol gets NewOrderSingle and OrderCancelRequest templates with
+// every variable field at a fixed width, so BodyLength never changes and
+// the checksum is the template's base sum plus the sums of the bytes
+// written. SendingTime and TransactTime come from a timestamp cached by
+// service(), so their resolution is however often that runs. Sequence gaps
+// on the inbound side are counted, not recovered.
+class FixSession {
+public:
+    explicit FixSession(const FixSessionConfig& config = FixSessionConfig());
+    ~FixSession();
+
+    FixSession(const FixSession&) = delete;
+    FixSession& operator=(const FixSession&) = delete;
+
+    // Symbols get templates when the session opens, or at once if it is open;
+    // returns the index to order with, -1 if there is no room
+    int add_symbol(const std::string& symbol);
+
+    // Connects and sends Logon, waiting for the acceptor's Logon
+    bool connect();
+    // Takes over an already connected descriptor without logging on
+    bool attach(int fd);
+    // Sends Logout when logged on, then closes the connection
+    void close();
+
+    bool new_order(int symbol, uint32_t price, uint32_t shares, bool is_buy, uint32_t& order_id);
+    // Cancels the whole order; side and quantity repeat the original's
+    bool cancel_order(int symbol, uint32_t order_id, uint32_t shares, bool is_buy);
+
+    void set_batching(bool enabled) { batching_ = enabled; }
+    bool flush();
+
+    // Dispatches what the acceptor sent; returns the execution reports handled.
+    // Closes the session on end of stream or a receive error.
+    size_t poll(FixHandler& handler);
+    // Refreshes the timestamp and handles heartbeats and test requests,
+    // off the hot path; false once the session is dead
+    bool service();
+
+    bool logged_in() const { return logged_in_; }
+    bool send_memory_locked() const { return arena_.locked(); }
+    int fd() const { return fd_; }
+    uint64_t next_seq_num() const { return next_seq_; }
+    uint64_t sequence_gaps() const { return sequence_gaps_; }
+    uint64_t messages_sent() const { return messages_sent_; }
+    uint64_t writes() const { return batch_.writes(); }
+
+private:
+    struct Layout {
+        size_t seq;
+        size_t sending_time;
+        size_t transact_time;
+        size_t id;
+        size_t orig_id;      // cancels only
+        size_t side;
+        size_t qty;
+        size_t price;        // new orders only
+        size_t checksum;
+        uint32_t base_sum;
+    };
+
+    struct SymbolTemplates {
+        std::string symbol;
+        TemplateRing new_order;
+        TemplateRing cancel;
+        Layout new_order_at;
+        Layout cancel_at;
+    };
+
+    bool prepare();
+    bool render(SymbolTemplates& symbol);
+    void refresh_time();
+    bool sequence_available() const;
+    bool send_admin(const std::string& msg_type,
+                    const std::vector<std::pair<int, std::string>>& fields);
+    void handle(const uint8_t* msg, size_t length, FixHandler& handler, size_t& handled);
+    void disconnect(FixHandler& handler);
+    bool queue(const uint8_t* msg, size_t length) {
+        ++messages_sent_;
+        if (batch_.add(msg, length) || !batching_) {
+            return batch_.flush(fd_);
+        }
+        return true;
+    }
+
+    FixSessionConfig config_;
+    int fd_;
+    SendArena arena_;
+    SendBatch batch_;
+    bool batching_;
+    std::vector<SymbolTemplates> symbols_;
+    uint32_t next_order_id_;
+    uint64_t next_seq_;
+    uint64_t messages_sent_;
+    uint8_t time_[fix::TIME_WIDTH];
+    uint32_t time_sum_;
+
+    std::vector<uint8_t> in_;
+    size_t in_length_;
+    bool logged_in_;
+    uint64_t expected_seq_;
+    uint64_t sequence_gaps_;
+    uint64_t bytes_received_;
+
+    // service() bookkeeping
+    uint64_t sent_at_service_;
+    uint64_t received_at_service_;
+    uint64_t last_send_ns_;
+    uint64_t last_receive_ns_;
+    bool test_request_pending_;
+};
+
+} // namespace session
+} // namespace trading
@@ -0,0 +1,275 @@
+#include "ouch_session.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace trading {
+namespace session {
+
+namespace {
+
+constexpr size_t IN_BUFFER = 1 << 18;
+constexpr int LOGIN_TIMEOUT_MS = 2000;
+
+// Field offsets within a framed enter or cancel message
+constexpr size_t TOKEN_ID = ouch::FRAME_HEADER_LEN + 7;  // 8 hex digits after the prefix
+constexpr size_t ENTER_SIDE = ouch::FRAME_HEADER_LEN + 15;
+constexpr size_t ENTER_SHARES = ouch::FRAME_HEADER_LEN + 16;
+constexpr size_t ENTER_STOCK = ouch::FRAME_HEADER_LEN + 20;
+constexpr size_t ENTER_PRICE = ouch::FRAME_HEADER_LEN + 28;
+constexpr size_t CANCEL_SHARES = ouch::FRAME_HEADER_LEN + 15;
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline void put_hex(uint8_t* out, uint32_t value) {
+    static const char hex[] = "0123456789ABCDEF";
+    for (int i = 7; i >= 0; --i) {
+        out[i] = static_cast<uint8_t>(hex[value & 0xF]);
+        value >>= 4;
+    }
+}
+
+void copy_padded(uint8_t* dst, const std::string& src, size_t length, char pad, bool right) {
+    size_t n = src.size() < length ? src.size() : length;
+    size_t start = right ? length - n : 0;
+    std::memset(dst, pad, length);
+    std::memcpy(dst + start, src.data(), n);
+}
+
+// Handles the SoupBinTCP login exchange and nothing else
+struct NullHandler : exchange::ExchangeHandler {};
+
+} // namespace
+
+OuchSession::OuchSession(const OuchSessionConfig& config)
+    : config_(config), fd_(-1),
+      batch_(config.batch), batching_(false), next_order_id_(1), messages_sent_(0),
+      in_(IN_BUFFER), in_length_(0), logged_in_(false), next_sequence_(1),
+      bytes_received_(0), sent_at_service_(0), received_at_service_(0),
+      last_send_ns_(0), last_receive_ns_(0) {}
+
+OuchSession::~OuchSession() {
+    close();
+}
+
+bool OuchSession::prepare() {
+    // Every slot of a ring may sit in one unflushed batch
+    const size_t slots = batch_.capacity();
+    if (!arena_.allocate(2 * slots * 64)) {
+        return false;
+    }
+
+    uint8_t frame[ouch::MAX_FRAME_LEN];
+    OuchEncoder renderer(config_.token_prefix, config_.firm);
+    OrderCommand order{false, true, 0, 0, 0, 0};
+    size_t length = renderer.encode(order, frame);
+    if (!enter_.init(arena_, frame, length, slots)) {
+        return false;
+    }
+    OrderCommand cancel{true, false, 0, 0, 0, 0};
+    length = renderer.encode(cancel, frame);
+    if (!cancel_.init(arena_, frame, length, slots)) {
+        return false;
+    }
+
+    in_length_ = 0;
+    logged_in_ = false;
+    next_sequence_ = 1;
+    sent_at_service_ = messages_sent_;
+    received_at_service_ = bytes_received_;
+    last_send_ns_ = last_receive_ns_ = now_ns();
+    return true;
+}
+
+bool OuchSession::connect() {
+    close();
+    fd_ = connect_tcp(config_.host, config_.port);
+    if (fd_ < 0) {
+        std::cerr << "Failed to connect to " << config_.host << ":" << config_.port << std::endl;
+        return false;
+    }
+    if (!prepare()) {
+        close();
+        return false;
+    }
+
+    uint8_t login[ouch::soup::LOGIN_REQUEST_LEN];
+    copy_padded(login, config_.username, 6, ' ', false);
+    copy_padded(login + 6, config_.password, 10, ' ', false);
+    copy_padded(login + 16, "", ouch::soup::SESSION_LEN, ' ', false);  // current session
+    copy_padded(login + 26, "0", ouch::soup::SEQUENCE_LEN, ' ', true);  // from the next message
+    if (!send_control(ouch::soup::LOGIN_REQUEST, login, sizeof(login))) {
+        close();
+        return false;
+    }
+
+    NullHandler handler;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(LOGIN_TIMEOUT_MS);
+    while (!logged_in_ && fd_ >= 0 && std::chrono::steady_clock::now() < deadline) {
+        pollfd pfd{fd_, POLLIN, 0};
+        ::poll(&pfd, 1, 10);
+        poll(handler);
+    }
+    if (!logged_in_) {
+        std::cerr << "OUCH login was not accepted" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool OuchSession::attach(int fd) {
+    close();
+    fd_ = fd;
+    if (!prepare()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void OuchSession::close() {
+    if (fd_ < 0) {
+        return;
+    }
+    flush();
+    if (logged_in_) {
+        send_control(ouch::soup::LOGOUT_REQUEST, nullptr, 0);
+    }
+    ::close(fd_);
+    fd_ = -1;
+    logged_in_ = false;
+}
+
+bool OuchSession::send_control(uint8_t type, const uint8_t* payload, size_t length) {
+    // Keeps the stream ordered behind anything batched
+    if (!flush()) {
+        return false;
+    }
+    uint8_t frame[ouch::FRAME_HEADER_LEN + ouch::soup::LOGIN_REQUEST_LEN];
+    ouch::put_frame_header(frame, type, length);
+    if (length != 0) {
+        std::memcpy(frame + ouch::FRAME_HEADER_LEN, payload, length);
+    }
+    size_t total = ouch::FRAME_HEADER_LEN + length;
+    if (::send(fd_, frame, total, MSG_NOSIGNAL) != static_cast<ssize_t>(total)) {
+        std::cerr << "OUCH session write failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool OuchSession::enter_order(uint64_t stock, uint32_t price, uint32_t shares, bool is_buy,
+                              uint32_t& order_id) {
+    if (fd_ < 0) {
+        return false;
+    }
+    uint8_t* frame = enter_.next();
+    order_id = next_order_id_++;
+    put_hex(frame + TOKEN_ID, order_id);
+    frame[ENTER_SIDE] = is_buy ? 'B' : 'S';
+    feed::detail::store_be32(frame + ENTER_SHARES, shares);
+    std::memcpy(frame + ENTER_STOCK, &stock, sizeof(stock));  // see ouch::pack_stock
+    feed::detail::store_be32(frame + ENTER_PRICE, price);
+    return queue(frame, enter_.length());
+}
+
+bool OuchSession::cancel_order(uint32_t order_id, uint32_t shares) {
+    if (fd_ < 0) {
+        return false;
+    }
+    uint8_t* frame = cancel_.next();
+    put_hex(frame + TOKEN_ID, order_id);
+    feed::detail::store_be32(frame + CANCEL_SHARES, shares);
+    return queue(frame, cancel_.length());
+}
+
+bool OuchSession::flush() {
+    if (batch_.size() == 0) {
+        return true;
+    }
+    return fd_ >= 0 && batch_.flush(fd_);
+}
+
+size_t OuchSession::poll(exchange::ExchangeHandler& handler) {
+    if (fd_ < 0) {
+        return 0;
+    }
+    ssize_t n = recv(fd_, in_.data() + in_length_, in_.size() - in_length_, MSG_DONTWAIT);
+    if (n <= 0) {
+        return 0;
+    }
+    in_length_ += static_cast<size_t>(n);
+    bytes_received_ += static_cast<uint64_t>(n);
+
+    size_t handled = 0;
+    size_t consumed = ouch::for_each_frame(in_.data(), in_length_,
+        [&](uint8_t type, const uint8_t* msg, size_t length) {
+            switch (type) {
+            case ouch::soup::SEQUENCED:
+                ++next_sequence_;
+                if (length != 0 && exchange::ExchangeClient::dispatch(msg, length, handler)) {
+                    ++handled;
+                }
+                break;
+            case ouch::soup::LOGIN_ACCEPTED:
+                if (length == ouch::soup::LOGIN_ACCEPTED_LEN) {
+                    char sequence[ouch::soup::SEQUENCE_LEN + 1];
+                    std::memcpy(sequence, msg + ouch::soup::SESSION_LEN, ouch::soup::SEQUENCE_LEN);
+                    sequence[ouch::soup::SEQUENCE_LEN] = '\0';
+                    next_sequence_ = std::strtoull(sequence, nullptr, 10);
+                    logged_in_ = true;
+                }
+                break;
+            case 'J':  // login rejected
+                std::cerr << "OUCH login rejected" << std::endl;
+                break;
+            case 'Z':  // end of session
+                logged_in_ = false;
+                break;
+            default:   // server heartbeats only count as traffic
+                break;
+            }
+        });
+    std::memmove(in_.data(), in_.data() + consumed, in_length_ - consumed);
+    in_length_ -= consumed;
+    return handled;
+}
+
+bool OuchSession::service() {
+    if (fd_ < 0) {
+        return false;
+    }
+    const uint64_t now = now_ns();
+    const uint64_t interval = static_cast<uint64_t>(config_.heartbeat_ms) * 1000000;
+
+    if (messages_sent_ != sent_at_service_) {
+        sent_at_service_ = messages_sent_;
+        last_send_ns_ = now;
+    } else if (now - last_send_ns_ >= interval) {
+        if (!send_control(ouch::soup::CLIENT_HEARTBEAT, nullptr, 0)) {
+            return false;
+        }
+        last_send_ns_ = now;
+    }
+
+    if (bytes_received_ != received_at_service_) {
+        received_at_service_ = bytes_received_;
+        last_receive_ns_ = now;
+    } else if (logged_in_ && now - last_receive_ns_ > 3 * interval) {
+        std::cerr << "OUCH session timed out waiting for the exchange" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace session
+} // namespace trading
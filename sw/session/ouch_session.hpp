@@ -0,0 +1,104 @@
+#pragma once
+
+#include "exchange_client.hpp"
+#include "ouch_messages.hpp"
+#include "session_io.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trading {
+namespace session {
+
+struct OuchSessionConfig {
+    std::string host = "127.0.0.1";
+    uint16_t port = 9000;
+    std::string username;               // up to 6 characters
+    std::string password;               // up to 10 characters
+    std::string token_prefix = "HOST00";
+    std::string firm = "FPGA";
+    size_t batch = 64;                  // messages per write when batching
+    uint32_t heartbeat_ms = 1000;       // client heartbeat when idle; 3x silence is fatal
+};
+
+// Host-side OUCH order entry over SoupBinTCP. Enter and cancel messages
+// are rendered once into locked send memory; an order writes only its
+// token, side, shares, stock and price into the next copy and goes to
+// the socket from there, with no encode pass and no allocation. With
+// batching on, messages are gathered and sent with one writev() per
+// batch or flush(). The hot path never reads the clock: service(), run
+// off the hot path, sends heartbeats when nothing went out since its last
+// call and notices a silent exchange.
+class OuchSession {
+public:
+    explicit OuchSession(const OuchSessionConfig& config = OuchSessionConfig());
+    ~OuchSession();
+
+    OuchSession(const OuchSession&) = delete;
+    OuchSession& operator=(const OuchSession&) = delete;
+
+    // Connects and logs in, waiting for the login to be accepted
+    bool connect();
+    // Takes over an already connected descriptor without logging in
+    bool attach(int fd);
+    // Logs out when logged in, then closes the connection
+    void close();
+
+    bool enter_order(uint64_t stock, uint32_t price, uint32_t shares, bool is_buy,
+                     uint32_t& order_id);
+    // shares is what stays open afterwards; 0 cancels the order
+    bool cancel_order(uint32_t order_id, uint32_t shares = 0);
+
+    void set_batching(bool enabled) { batching_ = enabled; }
+    bool flush();
+
+    // Dispatches what the exchange sent; returns the sequenced messages handled
+    size_t poll(exchange::ExchangeHandler& handler);
+    // Heartbeats and liveness, off the hot path; false once the session is dead
+    bool service();
+
+    bool logged_in() const { return logged_in_; }
+    bool send_memory_locked() const { return arena_.locked(); }
+    int fd() const { return fd_; }
+    uint64_t next_sequence() const { return next_sequence_; }
+    uint64_t messages_sent() const { return messages_sent_; }
+    uint64_t writes() const { return batch_.writes(); }
+
+private:
+    bool prepare();
+    bool send_control(uint8_t type, const uint8_t* payload, size_t length);
+    bool queue(const uint8_t* frame, size_t length) {
+        ++messages_sent_;
+        if (batch_.add(frame, length) || !batching_) {
+            return batch_.flush(fd_);
+        }
+        return true;
+    }
+
+    OuchSessionConfig config_;
+    int fd_;
+    SendArena arena_;
+    TemplateRing enter_;
+    TemplateRing cancel_;
+    SendBatch batch_;
+    bool batching_;
+    uint32_t next_order_id_;
+    uint64_t messages_sent_;
+
+    std::vector<uint8_t> in_;
+    size_t in_length_;
+    bool logged_in_;
+    uint64_t next_sequence_;
+    uint64_t bytes_received_;
+
+    // service() bookkeeping
+    uint64_t sent_at_service_;
+    uint64_t received_at_service_;
+    uint64_t last_send_ns_;
+    uint64_t last_receive_ns_;
+};
+
+} // namespace session
+} // namespace trading
@@ -0,0 +1,147 @@
+#include "session_io.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace trading {
+namespace session {
+
+namespace {
+
+constexpr size_t CACHE_LINE = 64;
+
+size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+SendArena::SendArena() : base_(nullptr), size_(0), used_(0), locked_(false) {}
+
+SendArena::~SendArena() {
+    release();
+}
+
+bool SendArena::allocate(size_t bytes) {
+    release();
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = align_up(bytes, page);
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Failed to map " << size << " bytes of send memory" << std::endl;
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(memory);
+    size_ = size;
+    used_ = 0;
+    locked_ = mlock(base_, size_) == 0;
+    return true;
+}
+
+void SendArena::release() {
+    if (base_) {
+        if (locked_) {
+            munlock(base_, size_);
+        }
+        munmap(base_, size_);
+    }
+    base_ = nullptr;
+    size_ = 0;
+    used_ = 0;
+    locked_ = false;
+}
+
+uint8_t* SendArena::carve(size_t bytes) {
+    size_t length = align_up(bytes, CACHE_LINE);
+    if (!base_ || used_ + length > size_) {
+        return nullptr;
+    }
+    uint8_t* block = base_ + used_;
+    used_ += length;
+    return block;
+}
+
+TemplateRing::TemplateRing()
+    : base_(nullptr), length_(0), stride_(0), slots_(0), index_(0) {}
+
+bool TemplateRing::init(SendArena& arena, const uint8_t* message, size_t length, size_t slots) {
+    stride_ = align_up(length, CACHE_LINE);
+    base_ = arena.carve(stride_ * slots);
+    if (!base_ || slots == 0) {
+        std::cerr << "Send arena too small for " << slots << " message slots" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < slots; ++i) {
+        std::memcpy(base_ + i * stride_, message, length);
+    }
+    length_ = length;
+    slots_ = slots;
+    index_ = 0;
+    return true;
+}
+
+SendBatch::SendBatch(size_t max_messages)
+    : iov_(max_messages == 0 ? 1 : max_messages), count_(0), bytes_(0), writes_(0) {}
+
+bool SendBatch::flush(int fd) {
+    iovec* iov = iov_.data();
+    size_t count = count_;
+    while (count != 0) {
+        ssize_t n = writev(fd, iov, static_cast<int>(count));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Session write failed: " << std::strerror(errno) << std::endl;
+            count_ = 0;
+            bytes_ = 0;
+            return false;
+        }
+        ++writes_;
+        size_t written = static_cast<size_t>(n);
+        while (count != 0 && written >= iov->iov_len) {
+            written -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count != 0) {
+            iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + written;
+            iov->iov_len -= written;
+        }
+    }
+    count_ = 0;
+    bytes_ = 0;
+    return true;
+}
+
+int connect_tcp(const std::string& host, uint16_t port) {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Invalid session address " << host << std::endl;
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+} // namespace session
+} // namespace trading
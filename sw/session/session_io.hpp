@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+
+namespace trading {
+namespace session {
+
+// Send memory for one session, mapped, touched and locked up front so
+// building a message never faults or allocates. Locking is best effort:
+// without CAP_IPC_LOCK or enough RLIMIT_MEMLOCK the pages are still
+// pre-faulted, just not pinned.
+class SendArena {
+public:
+    SendArena();
+    ~SendArena();
+
+    SendArena(const SendArena&) = delete;
+    SendArena& operator=(const SendArena&) = delete;
+
+    bool allocate(size_t bytes);
+    void release();
+
+    // Next bytes of the arena, cache-line aligned; nullptr once it is full
+    uint8_t* carve(size_t bytes);
+
+    bool locked() const { return locked_; }
+    size_t used() const { return used_; }
+
+private:
+    uint8_t* base_;
+    size_t size_;
+    size_t used_;
+    bool locked_;
+};
+
+// Copies of one pre-rendered message, handed out round robin. A slot is
+// patched in place and sent straight from the arena, so it must not come
+// round again before its batch is flushed: keep at least as many slots as
+// a SendBatch holds messages.
+class TemplateRing {
+public:
+    TemplateRing();
+
+    bool init(SendArena& arena, const uint8_t* message, size_t length, size_t slots);
+
+    uint8_t* next() {
+        uint8_t* slot = base_ + index_ * stride_;
+        index_ = index_ + 1 == slots_ ? 0 : index_ + 1;
+        return slot;
+    }
+    size_t length() const { return length_; }
+
+private:
+    uint8_t* base_;
+    size_t length_;
+    size_t stride_;
+    size_t slots_;
+    size_t index_;
+};
+
+// Messages gathered as iovecs and written with one writev()
+class SendBatch {
+public:
+    explicit SendBatch(size_t max_messages = 64);
+
+    // Queue a message; true once the batch is full and must be flushed
+    bool add(const uint8_t* data, size_t length) {
+        iov_[count_].iov_base = const_cast<uint8_t*>(data);
+        iov_[count_].iov_len = length;
+        bytes_ += length;
+        return ++count_ == iov_.size();
+    }
+
+    // Writes everything queued, resuming after partial writes
+    bool flush(int fd);
+
+    size_t size() const { return count_; }
+    size_t capacity() const { return iov_.size(); }
+    uint64_t writes() const { return writes_; }
+
+private:
+    std::vector<iovec> iov_;
+    size_t count_;
+    size_t bytes_;
+    uint64_t writes_;
+};
+
+// Blocking TCP connection with Nagle off; -1 on failure
+int connect_tcp(const std::string& host, uint16_t port);
+
+} // namespace session
+} // namespace trading
@@ -0,0 +1,96 @@
+#include "market_data_parser_model.hpp"
+
+namespace trading {
+namespace sim {
+
+void MarketDataParserModel::eval() {
+    next_state_ = current_state_;
+    data_ready = false;
+
+    switch (current_state_) {
+        case State::IDLE:
+            if (data_valid) {
+                next_state_ = State::HEADER_PARSE;
+            }
+            data_ready = true;
+            break;
+        case State::HEADER_PARSE:
+            if (data_valid) {
+                next_state_ = State::SYMBOL_PARSE;
+            }
+            data_ready = true;
+            break;
+        case State::SYMBOL_PARSE:
+            if (data_valid) {
+                next_state_ = State::PRICE_PARSE;
+            }
+            data_ready = true;
+            break;
+        case State::PRICE_PARSE:
+            if (data_valid) {
+                next_state_ = State::QUANTITY_PARSE;
+            }
+            data_ready = true;
+            break;
+        case State::QUANTITY_PARSE:
+            if (ready_next) {
+                next_state_ = data_valid ? State::HEADER_PARSE : State::IDLE;
+            }
+            data_ready = ready_next;
+            break;
+    }
+}
+
+void MarketDataParserModel::tick() {
+    if (!rst_n) {
+        current_state_ = State::IDLE;
+        data_buffer_ = 0;
+        symbol = 0;
+        price = 0;
+        quantity = 0;
+        parse_valid = false;
+        msg_type = 0;
+        is_bid = false;
+        header_type_ = 0;
+        eval();
+        return;
+    }
+
+    eval();
+
+    // Everything below samples pre-edge values
+    const uint64_t buffer = data_buffer_;
+    const State state = current_state_;
+
+    current_state_ = next_state_;
+    parse_valid = false;
+
+    if (data_valid && data_ready) {
+        data_buffer_ = data_in;
+    }
+
+    switch (state) {
+        case State::HEADER_PARSE:
+            header_type_ = static_cast<uint8_t>(buffer & 7);
+            msg_type = static_cast<uint8_t>(buffer & 3);
+            is_bid = (buffer >> 2) & 1;
+            break;
+        case State::SYMBOL_PARSE:
+            symbol = static_cast<uint32_t>(buffer);
+            break;
+        case State::PRICE_PARSE:
+            price = static_cast<uint32_t>(buffer);
+            break;
+        case State::QUANTITY_PARSE:
+            quantity = static_cast<uint32_t>(buffer);
+            parse_valid = ready_next;
+            break;
+        default:
+            break;
+    }
+
+    eval();
+}
+
+} // namespace sim
+} // namespace trading
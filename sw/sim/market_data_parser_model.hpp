@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+namespace trading {
+namespace sim {
+
+// Cycle-accurate C++ translation of hw/rtl/market_data_parser.sv.
+// Port names match the RTL (and the Verilator model) so testbench code
+// can drive either one: set inputs, eval(), sample outputs, tick().
+class MarketDataParserModel {
+public:
+    // Inputs
+    bool rst_n = false;
+    bool data_valid = false;
+    uint64_t data_in = 0;
+    bool ready_next = false;
+
+    // Outputs
+    bool data_ready = false;
+    uint32_t symbol = 0;
+    uint32_t price = 0;
+    uint32_t quantity = 0;
+    bool parse_valid = false;
+    uint8_t msg_type = 0;
+    bool is_bid = false;
+
+    // Settle combinational outputs for the current state and inputs
+    void eval();
+
+    // Rising clock edge
+    void tick();
+
+    // Header beat layout shared with the RTL
+    static uint64_t make_header(uint8_t msg_type, bool is_bid) {
+        return (msg_type & 3u) | (is_bid ? 4u : 0u);
+    }
+
+private:
+    enum class State : uint8_t {
+        IDLE,
+        HEADER_PARSE,
+        SYMBOL_PARSE,
+        PRICE_PARSE,
+        QUANTITY_PARSE
+    };
+
+    State current_state_ = State::IDLE;
+    State next_state_ = State::IDLE;
+    uint64_t data_buffer_ = 0;
+    uint8_t header_type_ = 0;
+};
+
+} // namespace sim
+} // namespace trading
@@ -0,0 +1,103 @@
+#include "order_book_manager_model.hpp"
+
+namespace trading {
+namespace sim {
+
+OrderBookManagerModel::OrderBookManagerModel(size_t max_orders)
+    : bid_book_(max_orders, OrderEntry{0, 0, false}),
+      ask_book_(max_orders, OrderEntry{0, 0, false}) {}
+
+void OrderBookManagerModel::apply(std::vector<OrderEntry>& book, uint32_t price,
+                                  uint32_t quantity, int& match_idx, int& free_idx) {
+    match_idx = -1;
+    free_idx = -1;
+    for (size_t i = 0; i < book.size(); ++i) {
+        if (book[i].valid && book[i].price == price) {
+            match_idx = static_cast<int>(i);
+        } else if (!book[i].valid && free_idx == -1) {
+            free_idx = static_cast<int>(i);
+        }
+    }
+
+    if (match_idx >= 0) {
+        if (quantity == 0) {
+            book[match_idx].valid = false;
+        } else {
+            book[match_idx].quantity = quantity;
+        }
+    } else if (quantity != 0 && free_idx >= 0) {
+        book[free_idx] = OrderEntry{price, quantity, true};
+    }
+}
+
+void OrderBookManagerModel::tick() {
+    if (!rst_n) {
+        order_count_ = 0;
+        book_valid = false;
+        book_updated = false;
+        book_full = false;
+        update_dropped = false;
+        updating_ = false;
+        best_bid_price = 0;
+        best_ask_price = 0;
+        best_bid_qty = 0;
+        best_ask_qty = 0;
+        for (size_t i = 0; i < bid_book_.size(); ++i) {
+            bid_book_[i].valid = false;
+            ask_book_[i].valid = false;
+        }
+        return;
+    }
+
+    // An update and a best-price scan never happen in the same cycle
+    // (they are gated on opposite values of 'updating'), so the books
+    // can be modified in place without breaking signal semantics.
+    const bool was_updating = updating_;
+    book_updated = false;
+    update_dropped = false;
+
+    if (update_valid && !was_updating) {
+        int match_idx;
+        int free_idx;
+        apply(is_bid ? bid_book_ : ask_book_, price_in, quantity_in, match_idx, free_idx);
+
+        // A new level with no free slot is dropped
+        book_full = match_idx == -1 && free_idx == -1 && quantity_in != 0;
+        update_dropped = book_full;
+
+        ++order_count_;
+        updating_ = true;
+    } else {
+        // Updates arriving while the best prices are recomputed are lost
+        update_dropped = update_valid;
+        updating_ = false;
+    }
+
+    if (was_updating) {
+        int best_idx = -1;
+        for (size_t i = 0; i < bid_book_.size(); ++i) {
+            if (bid_book_[i].valid &&
+                (best_idx == -1 || bid_book_[i].price > bid_book_[best_idx].price)) {
+                best_idx = static_cast<int>(i);
+            }
+        }
+        best_bid_price = best_idx >= 0 ? bid_book_[best_idx].price : 0;
+        best_bid_qty = best_idx >= 0 ? bid_book_[best_idx].quantity : 0;
+
+        best_idx = -1;
+        for (size_t i = 0; i < ask_book_.size(); ++i) {
+            if (ask_book_[i].valid &&
+                (best_idx == -1 || ask_book_[i].price < ask_book_[best_idx].price)) {
+                best_idx = static_cast<int>(i);
+            }
+        }
+        best_ask_price = best_idx >= 0 ? ask_book_[best_idx].price : 0;
+        best_ask_qty = best_idx >= 0 ? ask_book_[best_idx].quantity : 0;
+
+        book_valid = true;
+        book_updated = true;
+    }
+}
+
+} // namespace sim
+} // namespace trading
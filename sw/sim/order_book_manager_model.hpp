@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trading {
+namespace sim {
+
+// Cycle-accurate C++ translation of hw/rtl/order_book_manager.vhd, used
+// in place of a GHDL build. Port names follow the VHDL entity.
+class OrderBookManagerModel {
+public:
+    explicit OrderBookManagerModel(size_t max_orders = 1024);
+
+    // Inputs
+    bool rst_n = false;
+    uint32_t symbol_in = 0;
+    uint32_t price_in = 0;
+    uint32_t quantity_in = 0;
+    bool is_bid = false;
+    bool update_valid = false;
+
+    // Outputs
+    uint32_t best_bid_price = 0;
+    uint32_t best_ask_price = 0;
+    uint32_t best_bid_qty = 0;
+    uint32_t best_ask_qty = 0;
+    bool book_valid = false;
+    bool book_updated = false;
+    bool book_full = false;
+    bool update_dropped = false;
+
+    // The entity has no combinational outputs; kept for a uniform DUT interface
+    void eval() {}
+
+    // Rising clock edge
+    void tick();
+
+    // Internal state visible to testbenches
+    bool updating() const { return updating_; }
+
+private:
+    struct OrderEntry {
+        uint32_t price;
+        uint32_t quantity;
+        bool valid;
+    };
+
+    static void apply(std::vector<OrderEntry>& book, uint32_t price,
+                      uint32_t quantity, int& match_idx, int& free_idx);
+
+    std::vector<OrderEntry> bid_book_;
+    std::vector<OrderEntry> ask_book_;
+    uint32_t order_count_ = 0;
+    bool updating_ = false;
+};
+
+} // namespace sim
+} // namespace trading
@@ -0,0 +1,146 @@
+#include "order_entry_encoder_model.hpp"
+#include <cstring>
+
+namespace trading {
+namespace sim {
+
+namespace {
+
+// order_entry_encoder.sv parameter defaults
+constexpr char TOKEN_PREFIX[] = "FPGA00";
+constexpr char FIRM[] = "FPGA";
+constexpr uint32_t TIME_IN_FORCE = 99998;
+constexpr uint8_t DISPLAY = 'Y';
+constexpr uint8_t CAPACITY = 'P';
+constexpr uint8_t CROSS_TYPE = 'N';
+constexpr uint8_t CUSTOMER_TYPE = 'R';
+
+constexpr int ENTER_LEN = 49;
+constexpr int CANCEL_LEN = 19;
+
+uint8_t hex_ascii(uint32_t nibble) {
+    return static_cast<uint8_t>(nibble < 10 ? 0x30 + nibble : 0x37 + nibble);
+}
+
+} // namespace
+
+void OrderEntryEncoderModel::put_token(int pos, uint32_t id) {
+    for (int i = 0; i < 6; ++i) {
+        frame_[pos + i] = static_cast<uint8_t>(TOKEN_PREFIX[i]);
+    }
+    for (int i = 0; i < 8; ++i) {
+        frame_[pos + 6 + i] = hex_ascii((id >> (4 * (7 - i))) & 0xF);
+    }
+}
+
+void OrderEntryEncoderModel::put_u32(int pos, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        frame_[pos + i] = static_cast<uint8_t>(value >> (8 * (3 - i)));
+    }
+}
+
+void OrderEntryEncoderModel::eval() {
+    grant_eng_ = eng_cmd_valid && (!host_cmd_valid || !prefer_host_);
+    host_cmd_ready = state_ == State::IDLE && !grant_eng_;
+    eng_cmd_ready = state_ == State::IDLE && grant_eng_;
+
+    tx_valid = state_ == State::SEND;
+    tx_data = 0;
+    if (beat_ < MAX_BEATS) {
+        std::memcpy(&tx_data, frame_ + 8 * beat_, sizeof(tx_data));
+    }
+    tx_last = state_ == State::SEND && beat_ == last_beat_;
+    tx_keep = tx_last ? last_keep_ : 0xFF;
+}
+
+void OrderEntryEncoderModel::tick() {
+    if (!rst_n) {
+        state_ = State::IDLE;
+        std::memset(frame_, 0, sizeof(frame_));
+        beat_ = 0;
+        last_beat_ = 0;
+        last_keep_ = 0;
+        prefer_host_ = true;
+        next_order_id = 1;
+        last_order_id = 0;
+        last_order_host = false;
+        tx_msg_count = 0;
+        eval();
+        return;
+    }
+
+    eval();
+
+    // Non-blocking assignments: later writes win, reads see pre-edge values
+    const uint32_t current_order_id = next_order_id;
+    if (seq_load) {
+        next_order_id = seq_value;
+    }
+
+    switch (state_) {
+        case State::IDLE:
+            if (grant_eng_ || host_cmd_valid) {
+                const bool cancel = grant_eng_ ? eng_cmd_cancel : host_cmd_cancel;
+                const bool buy = grant_eng_ ? eng_cmd_buy : host_cmd_buy;
+                const uint64_t symbol = grant_eng_ ? eng_cmd_symbol : host_cmd_symbol;
+                const uint32_t price = grant_eng_ ? eng_cmd_price : host_cmd_price;
+                const uint32_t quantity = grant_eng_ ? eng_cmd_quantity : host_cmd_quantity;
+                const uint32_t order_id = grant_eng_ ? eng_cmd_order_id : host_cmd_order_id;
+                const uint32_t id = cancel ? order_id : current_order_id;
+
+                std::memset(frame_, 0, sizeof(frame_));
+                frame_[2] = 'U';
+                put_token(4, id);
+
+                if (cancel) {
+                    frame_[1] = CANCEL_LEN + 1;
+                    frame_[3] = 'X';
+                    put_u32(18, 0);
+                    last_beat_ = 2;
+                    last_keep_ = 0x3F;
+                } else {
+                    frame_[1] = ENTER_LEN + 1;
+                    frame_[3] = 'O';
+                    frame_[18] = buy ? 'B' : 'S';
+                    put_u32(19, quantity);
+                    for (int i = 0; i < 8; ++i) {
+                        frame_[23 + i] = static_cast<uint8_t>(symbol >> (8 * i));
+                    }
+                    put_u32(31, price);
+                    put_u32(35, TIME_IN_FORCE);
+                    std::memcpy(frame_ + 39, FIRM, 4);
+                    frame_[43] = DISPLAY;
+                    frame_[44] = CAPACITY;
+                    frame_[45] = 'N';
+                    put_u32(46, 0);
+                    frame_[50] = CROSS_TYPE;
+                    frame_[51] = CUSTOMER_TYPE;
+                    last_beat_ = 6;
+                    last_keep_ = 0x0F;
+                    next_order_id = current_order_id + 1;
+                }
+
+                beat_ = 0;
+                last_order_id = id;
+                last_order_host = !grant_eng_;
+                prefer_host_ = grant_eng_;
+                state_ = State::SEND;
+            }
+            break;
+
+        case State::SEND:
+            if (tx_ready) {
+                if (beat_ == last_beat_) {
+                    ++tx_msg_count;
+                    state_ = State::IDLE;
+                }
+                beat_ = static_cast<uint8_t>((beat_ + 1) & 7);
+            }
+            break;
+    }
+
+    eval();
+}
+
+} // namespace sim
+} // namespace trading
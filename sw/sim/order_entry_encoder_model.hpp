@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+namespace trading {
+namespace sim {
+
+// Cycle-accurate C++ translation of hw/rtl/order_entry_encoder.sv with
+// its default parameters. Port names match the RTL.
+class OrderEntryEncoderModel {
+public:
+    // Inputs
+    bool rst_n = false;
+
+    bool host_cmd_valid = false;
+    bool host_cmd_cancel = false;
+    bool host_cmd_buy = false;
+    uint64_t host_cmd_symbol = 0;
+    uint32_t host_cmd_price = 0;
+    uint32_t host_cmd_quantity = 0;
+    uint32_t host_cmd_order_id = 0;
+
+    bool eng_cmd_valid = false;
+    bool eng_cmd_cancel = false;
+    bool eng_cmd_buy = false;
+    uint64_t eng_cmd_symbol = 0;
+    uint32_t eng_cmd_price = 0;
+    uint32_t eng_cmd_quantity = 0;
+    uint32_t eng_cmd_order_id = 0;
+
+    bool seq_load = false;
+    uint32_t seq_value = 0;
+    bool tx_ready = false;
+
+    // Outputs
+    bool host_cmd_ready = false;
+    bool eng_cmd_ready = false;
+    uint32_t next_order_id = 1;
+    uint32_t last_order_id = 0;
+    bool last_order_host = false;
+    uint64_t tx_data = 0;
+    uint8_t tx_keep = 0;
+    bool tx_valid = false;
+    bool tx_last = false;
+    uint64_t tx_msg_count = 0;
+
+    void eval();
+    void tick();
+
+private:
+    static constexpr int MAX_BEATS = 7;
+
+    enum class State : uint8_t {
+        IDLE,
+        SEND
+    };
+
+    void put_token(int pos, uint32_t id);
+    void put_u32(int pos, uint32_t value);
+
+    State state_ = State::IDLE;
+    uint8_t frame_[8 * MAX_BEATS] = {};
+    uint8_t beat_ = 0;
+    uint8_t last_beat_ = 0;
+    uint8_t last_keep_ = 0;
+    bool grant_eng_ = false;
+    bool prefer_host_ = true;
+};
+
+} // namespace sim
+} // namespace trading
@@ -0,0 +1,61 @@
+#include "reference_models.hpp"
+#include "market_data_parser_model.hpp"
+
+namespace trading {
+namespace sim {
+
+ParserBeats make_parser_beats(const ParsedMessage& msg) {
+    return ParserBeats{{
+        MarketDataParserModel::make_header(msg.msg_type, msg.is_bid),
+        msg.symbol,
+        msg.price,
+        msg.quantity,
+    }};
+}
+
+namespace {
+
+template <typename Levels>
+void apply_level(Levels& levels, size_t max_levels, uint32_t price, uint32_t quantity) {
+    auto it = levels.find(price);
+    if (it != levels.end()) {
+        if (quantity == 0) {
+            levels.erase(it);
+        } else {
+            it->second = quantity;
+        }
+    } else if (quantity != 0 && levels.size() < max_levels) {
+        levels.emplace(price, quantity);
+    }
+}
+
+} // namespace
+
+void BookReference::apply(uint32_t price, uint32_t quantity, bool is_bid) {
+    if (is_bid) {
+        apply_level(bids_, max_levels_, price, quantity);
+    } else {
+        apply_level(asks_, max_levels_, price, quantity);
+    }
+}
+
+TopOfBook BookReference::top() const {
+    TopOfBook tob{0, 0, 0, 0};
+    if (!bids_.empty()) {
+        tob.best_bid_price = bids_.begin()->first;
+        tob.best_bid_qty = bids_.begin()->second;
+    }
+    if (!asks_.empty()) {
+        tob.best_ask_price = asks_.begin()->first;
+        tob.best_ask_qty = asks_.begin()->second;
+    }
+    return tob;
+}
+
+void BookReference::clear() {
+    bids_.clear();
+    asks_.clear();
+}
+
+} // namespace sim
+} // namespace trading
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+
+namespace trading {
+namespace sim {
+
+// Transaction-level reference behaviour the RTL is checked against
+
+struct ParsedMessage {
+    uint8_t msg_type;
+    bool is_bid;
+    uint32_t symbol;
+    uint32_t price;
+    uint32_t quantity;
+
+    bool operator==(const ParsedMessage& other) const {
+        return msg_type == other.msg_type && is_bid == other.is_bid &&
+               symbol == other.symbol && price == other.price &&
+               quantity == other.quantity;
+    }
+    bool operator!=(const ParsedMessage& other) const { return !(*this == other); }
+};
+
+// The four beats market_data_parser consumes for one message
+struct ParserBeats {
+    uint64_t beat[4];
+};
+
+ParserBeats make_parser_beats(const ParsedMessage& msg);
+
+struct TopOfBook {
+    uint32_t best_bid_price;
+    uint32_t best_bid_qty;
+    uint32_t best_ask_price;
+    uint32_t best_ask_qty;
+
+    bool operator==(const TopOfBook& other) const {
+        return best_bid_price == other.best_bid_price &&
+               best_bid_qty == other.best_bid_qty &&
+               best_ask_price == other.best_ask_price &&
+               best_ask_qty == other.best_ask_qty;
+    }
+    bool operator!=(const TopOfBook& other) const { return !(*this == other); }
+};
+
+// Price-level book with the same capacity limit as order_book_manager.
+// Like the RTL it keeps a single book and ignores the symbol.
+class BookReference {
+public:
+    explicit BookReference(size_t max_levels = 1024) : max_levels_(max_levels) {}
+
+    void apply(uint32_t price, uint32_t quantity, bool is_bid);
+    TopOfBook top() const;
+    void clear();
+
+private:
+    size_t max_levels_;
+    std::map<uint32_t, uint32_t, std::greater<uint32_t>> bids_;
+    std::map<uint32_t, uint32_t> asks_;
+};
+
+} // namespace sim
+} // namespace trading
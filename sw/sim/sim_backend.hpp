@@ -0,0 +1,40 @@
+#pragma once
+
+#include "sim_device.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace trading {
+namespace sim {
+
+// BasicTradingAccelerator backend that routes register accesses into a
+// SimDevice, the same way TradingAccelerator does under SIMULATION_MODE
+class SimBackend {
+public:
+    explicit SimBackend(const SimDeviceConfig& config = SimDeviceConfig()) : config_(config) {}
+
+    bool open() {
+        device_.reset(new SimDevice(config_));
+        return true;
+    }
+
+    uint32_t read(uint32_t reg) { return device_->read(reg); }
+    void write(uint32_t reg, uint32_t value) { device_->write(reg, value); }
+    void read_burst(uint32_t first, size_t count, uint32_t* out) {
+        device_->read_burst(first, count, out);
+    }
+
+    bool is_open() const { return device_ != nullptr; }
+    double cycle_ns() const { return config_.clock_period_ns; }
+    uint64_t cycles() const { return device_->cycles(); }
+    SimDevice& device() { return *device_; }
+
+private:
+    SimDeviceConfig config_;
+    std::unique_ptr<SimDevice> device_;
+};
+
+} // namespace sim
+} // namespace trading
@@ -0,0 +1,456 @@
+#include "sim_device.hpp"
+#include "register_map.hpp"
+
+#include <algorithm>
+
+namespace trading {
+namespace sim {
+
+namespace {
+
+constexpr uint64_t MSG_QUOTE = 2;
+
+} // namespace
+
+SimDevice::SimDevice(const SimDeviceConfig& config)
+    : config_(config), book_(config.max_orders) {
+    reset();
+}
+
+void SimDevice::reset() {
+    parser_.rst_n = false;
+    book_.rst_n = false;
+    encoder_.rst_n = false;
+    parser_.tick();
+    book_.tick();
+    encoder_.tick();
+    parser_.rst_n = true;
+    book_.rst_n = true;
+    encoder_.rst_n = true;
+
+    status_ = regs::STATUS_ACK;
+    order_accepted_ = true;
+    cycle_count_ = 0;
+
+    // The histograms sweep both banks to tag 0 and start at generation 1
+    for (HistogramBanks* banks : {&ingress_hist_, &order_hist_}) {
+        for (auto& bank : *banks) {
+            bank.fill(HistogramEntry{0, 0});
+        }
+    }
+    hist_active_ = 0;
+    hist_gen_ = {1, 1};
+    hist_clearing_ = 2 * HIST_BUCKETS;
+}
+
+uint32_t SimDevice::read(uint32_t reg) {
+    // The request reaches the bank half way through the round trip
+    uint32_t half = config_.read_cycles / 2;
+    run(half);
+    tick(BusAccess{false, true, reg, 0});
+    uint32_t value = reg_rdata_;
+    if (config_.read_cycles > half + 1) {
+        run(config_.read_cycles - half - 1);
+    }
+    return value;
+}
+
+void SimDevice::read_burst(uint32_t first, size_t count, uint32_t* out) {
+    // One request; the bank returns a word per cycle once it arrives and
+    // the completion adds a beat per two words on the way back
+    uint32_t half = config_.read_cycles / 2;
+    run(half);
+    for (size_t i = 0; i < count; ++i) {
+        tick(BusAccess{false, true, first + static_cast<uint32_t>(i), 0});
+        out[i] = reg_rdata_;
+    }
+    if (config_.read_cycles > half + 1) {
+        run(config_.read_cycles - half - 1 + count / 2);
+    }
+}
+
+void SimDevice::write(uint32_t reg, uint32_t value) {
+    if (config_.write_cycles > 1) {
+        run(config_.write_cycles - 1);
+    }
+    tick(BusAccess{true, false, reg, value});
+}
+
+void SimDevice::run(uint64_t cycles) {
+    const BusAccess idle{false, false, 0, 0};
+    while (cycles > 0) {
+        if (quiescent()) {
+            fast_forward(cycles);
+            return;
+        }
+        tick(idle);
+        --cycles;
+    }
+}
+
+bool SimDevice::quiescent() const {
+    return !md_active_ && !waiting_book_ && load_wr_ == load_rd_ && !book_request_ && !host_cmd_valid_ &&
+           !seq_load_ && !encoder_.tx_valid && !book_.updating() && !book_.book_updated;
+}
+
+uint32_t SimDevice::window_throughput() const {
+    // messages/s = messages per window * clock Hz / window cycles
+    uint64_t clock_hz = 1000000000ull / config_.clock_period_ns;
+    return static_cast<uint32_t>((static_cast<uint64_t>(window_messages_) * clock_hz) >>
+                                 THROUGHPUT_WINDOW_LOG2);
+}
+
+size_t SimDevice::histogram_bucket(uint32_t cycles) {
+    // Bit width of the latency, saturating at the last bucket
+    size_t width = 0;
+    while (cycles != 0) {
+        ++width;
+        cycles >>= 1;
+    }
+    return width < HIST_BUCKETS ? width : HIST_BUCKETS - 1;
+}
+
+void SimDevice::histogram_sample(HistogramBanks& banks, uint8_t bank, uint32_t cycles) {
+    HistogramEntry& entry = banks[bank][histogram_bucket(cycles)];
+    entry.count = entry.tag == hist_gen_[bank] ? entry.count + 1 : 1;
+    entry.tag = hist_gen_[bank];
+}
+
+uint32_t SimDevice::histogram_read(const HistogramBanks& banks, uint32_t bucket) const {
+    const uint8_t bank = hist_active_ ^ 1;
+    const HistogramEntry& entry = banks[bank][bucket];
+    return entry.tag == hist_gen_[bank] ? entry.count : 0;
+}
+
+void SimDevice::fast_forward(uint64_t cycles) {
+    // Nothing but the free-running counters changes while idle
+    const uint64_t mask = (1ull << THROUGHPUT_WINDOW_LOG2) - 1;
+    uint64_t to_boundary = mask - (cycle_count_ & mask) + 1;
+    if (cycles >= to_boundary) {
+        uint64_t boundaries = 1 + (cycles - to_boundary) / (mask + 1);
+        throughput_ = window_throughput();
+        window_messages_ = 0;
+        if (boundaries > 1) {
+            throughput_ = 0;
+        }
+    }
+    cycle_count_ += cycles;
+    perf_counters_[regs::PERF_CYCLES] += cycles;
+    hist_clearing_ -= static_cast<uint32_t>(std::min<uint64_t>(hist_clearing_, cycles));
+}
+
+void SimDevice::tick(const BusAccess& bus) {
+    // Combinational outputs of the bank feed the parser and encoder
+    uint64_t md_data;
+    switch (md_beat_) {
+        case 0: {
+            bool is_bid = md_from_load_ ? (cur_load_qty_ & regs::LOAD_QTY_BID) != 0 : is_bid_reg_;
+            md_data = (is_bid ? 4u : 0u) | MSG_QUOTE;
+            break;
+        }
+        case 1: md_data = symbol_reg_; break;
+        case 2: md_data = md_from_load_ ? cur_load_price_ : price_l_reg_; break;  // parser datapath is 32 bits
+        default: md_data = md_from_load_ ? cur_load_qty_ & ~regs::LOAD_QTY_BID : quantity_reg_; break;
+    }
+
+    parser_.data_valid = md_active_;
+    parser_.data_in = md_data;
+    parser_.ready_next = true;
+    parser_.eval();
+
+    book_.update_valid = parser_.parse_valid;
+    book_.symbol_in = parser_.symbol;
+    book_.price_in = parser_.price;
+    book_.quantity_in = parser_.quantity;
+    book_.is_bid = parser_.is_bid;
+    book_.eval();
+
+    encoder_.host_cmd_valid = host_cmd_valid_;
+    encoder_.host_cmd_cancel = host_cmd_cancel_;
+    encoder_.host_cmd_buy = host_cmd_buy_;
+    encoder_.host_cmd_symbol = host_cmd_symbol_;
+    encoder_.host_cmd_price = host_cmd_price_;
+    encoder_.host_cmd_quantity = host_cmd_quantity_;
+    encoder_.host_cmd_order_id = host_cmd_order_id_;
+    encoder_.eng_cmd_valid = false;
+    encoder_.seq_load = seq_load_;
+    encoder_.seq_value = seq_value_;
+    encoder_.tx_ready = true;
+    encoder_.eval();
+
+    // Exchange gateway side of the encoder stream
+    if (encoder_.tx_valid) {
+        for (int i = 0; i < 8; ++i) {
+            if ((encoder_.tx_keep >> i) & 1) {
+                tx_frame_.push_back(static_cast<uint8_t>(encoder_.tx_data >> (8 * i)));
+            }
+        }
+        if (encoder_.tx_last) {
+            if (egress_) {
+                egress_(tx_frame_.data(), tx_frame_.size());
+            }
+            tx_frame_.clear();
+        }
+    }
+
+    // host_register_bank: next state from pre-edge values
+    const bool md_ready = parser_.data_ready;
+    const bool book_updated = book_.book_updated;
+    const bool update_done = book_updated && waiting_book_;
+    const uint32_t best_book[4] = {book_.best_bid_price, book_.best_ask_price,
+                                   book_.best_bid_qty, book_.best_ask_qty};
+    const bool cmd_ready = encoder_.host_cmd_ready;
+    const uint32_t next_order_id = encoder_.next_order_id;
+    const uint32_t last_order_id = encoder_.last_order_id;
+    const uint64_t cycle = cycle_count_;
+
+    // perf_counters event strobes (trading_top.sv)
+    const bool events[NUM_PERF_COUNTERS] = {
+        md_active_ && md_ready && md_beat_ == 0,
+        parser_.parse_valid,
+        parser_.parse_valid,
+        book_.book_updated,
+        encoder_.host_cmd_valid && cmd_ready,
+        encoder_.tx_valid && encoder_.tx_last,
+        md_active_ && !md_ready,
+        encoder_.host_cmd_valid && !cmd_ready,
+        false,  // the modelled gateway never deasserts tx_ready
+        book_.update_dropped,
+        true,
+    };
+
+    // latency_monitor: stage timestamps and histogram samples
+    const uint32_t now = static_cast<uint32_t>(cycle);
+    const uint8_t hist_bank = hist_active_;
+    const bool hist_clearing = hist_clearing_ != 0;
+    if (hist_clearing) {
+        --hist_clearing_;  // samples are dropped during a clear sweep
+    } else {
+        if (book_.book_updated) {
+            histogram_sample(ingress_hist_, hist_bank, now - book_ts_);
+        }
+        if (events[regs::PERF_ENGINE_IN] && update_pending_) {
+            histogram_sample(order_hist_, hist_bank, now - update_ts_);
+        }
+    }
+
+    const bool book_busy = lat_book_busy_;
+    if (events[regs::PERF_PARSER_IN]) {
+        parser_ts_[ts_wr_] = now;
+        ts_wr_ = (ts_wr_ + 1) % TS_FIFO_DEPTH;
+    }
+    lat_book_busy_ = false;
+    if (parser_.parse_valid) {
+        if (!book_busy) {
+            book_ts_ = parser_ts_[ts_rd_];
+            lat_book_busy_ = true;
+        }
+        ts_rd_ = (ts_rd_ + 1) % TS_FIFO_DEPTH;
+    }
+    if (book_.book_updated) {
+        update_pending_ = true;
+        update_ts_ = now;
+    } else if (events[regs::PERF_ENGINE_IN]) {
+        update_pending_ = false;
+    }
+
+    parser_.tick();
+    book_.tick();
+    encoder_.tick();
+
+    cycle_count_ = cycle + 1;
+    seq_load_ = false;
+
+    const bool was_md_active = md_active_;
+    const bool was_waiting_book = waiting_book_;
+    const uint32_t load_level = load_wr_ - load_rd_;
+    if (md_active_ && md_ready) {
+        if (md_beat_ == 3) {
+            md_active_ = false;
+            waiting_book_ = true;
+        }
+        md_beat_ = static_cast<uint8_t>((md_beat_ + 1) & 3);
+    }
+
+    if (update_done) {
+        waiting_book_ = false;
+        if (md_from_load_) {
+            ++load_count_;
+        } else {
+            status_ |= regs::STATUS_ACK;
+            latency_ns_ = static_cast<uint32_t>((cycle - update_start_) * config_.clock_period_ns);
+        }
+    }
+
+    // Next loaded level once the previous message has been applied
+    if (!was_md_active && !was_waiting_book && load_level != 0) {
+        cur_load_price_ = load_price_fifo_[load_rd_ % LOAD_FIFO_DEPTH];
+        cur_load_qty_ = load_qty_fifo_[load_rd_ % LOAD_FIFO_DEPTH];
+        ++load_rd_;
+        md_from_load_ = true;
+        md_active_ = true;
+        md_beat_ = 0;
+    }
+
+    const uint64_t mask = (1ull << THROUGHPUT_WINDOW_LOG2) - 1;
+    if ((cycle & mask) == mask) {
+        throughput_ = window_throughput();
+        window_messages_ = update_done ? 1 : 0;
+    } else if (update_done) {
+        ++window_messages_;
+    }
+
+    if (book_updated) {
+        ++book_gen_;
+        std::copy(best_book, best_book + 4, live_book_);
+    }
+
+    if (book_request_) {
+        best_bid_reg_ = best_book[0];
+        best_ask_reg_ = best_book[1];
+        best_bid_qty_reg_ = best_book[2];
+        best_ask_qty_reg_ = best_book[3];
+        status_ |= regs::STATUS_BOOK_VALID;
+        book_request_ = false;
+    }
+
+    if (host_cmd_valid_ && cmd_ready) {
+        host_cmd_valid_ = false;
+        order_accepted_ = true;
+    }
+
+    if (bus.we && bus.addr == regs::PERF_CONTROL && (bus.wdata & regs::PERF_CTRL_SNAPSHOT)) {
+        perf_shadow_ = perf_counters_;
+    }
+    for (size_t i = 0; i < NUM_PERF_COUNTERS; ++i) {
+        perf_counters_[i] += events[i];
+    }
+
+    if (bus.we && bus.addr == regs::HIST_CONTROL && (bus.wdata & regs::HIST_CTRL_SNAPSHOT) &&
+        !hist_clearing) {
+        hist_active_ ^= 1;
+        if (hist_gen_[hist_active_] == HIST_GEN_MAX) {
+            // The generation wraps: sweep the bank back to tag 0 first
+            hist_gen_[hist_active_] = 1;
+            ingress_hist_[hist_active_].fill(HistogramEntry{0, 0});
+            order_hist_[hist_active_].fill(HistogramEntry{0, 0});
+            hist_clearing_ = HIST_BUCKETS;
+        } else {
+            ++hist_gen_[hist_active_];
+        }
+    }
+
+    if (bus.we) {
+        switch (bus.addr) {
+            case regs::SYMBOL: symbol_reg_ = bus.wdata; break;
+            case regs::PRICE_H: price_h_reg_ = bus.wdata; break;
+            case regs::PRICE_L: price_l_reg_ = bus.wdata; break;
+            case regs::QUANTITY: quantity_reg_ = bus.wdata; break;
+            case regs::CONTROL:
+                if (bus.wdata & regs::CTRL_VALID) {
+                    is_bid_reg_ = (bus.wdata & regs::CTRL_BID) != 0;
+                    md_from_load_ = false;
+                    md_active_ = true;
+                    md_beat_ = 0;
+                    status_ &= ~regs::STATUS_ACK;
+                    update_start_ = cycle;
+                }
+                if (bus.wdata & regs::CTRL_BOOK_REQUEST) {
+                    status_ &= ~regs::STATUS_BOOK_VALID;
+                    book_request_ = true;
+                }
+                break;
+            case regs::ORDER_SYMBOL_L:
+                host_cmd_symbol_ = (host_cmd_symbol_ & ~0xFFFFFFFFull) | bus.wdata;
+                break;
+            case regs::ORDER_SYMBOL_H:
+                host_cmd_symbol_ = (host_cmd_symbol_ & 0xFFFFFFFFull) |
+                                   (static_cast<uint64_t>(bus.wdata) << 32);
+                break;
+            case regs::ORDER_PRICE: host_cmd_price_ = bus.wdata; break;
+            case regs::ORDER_QTY: host_cmd_quantity_ = bus.wdata; break;
+            case regs::ORDER_ID: host_cmd_order_id_ = bus.wdata; break;
+            case regs::ORDER_CONTROL:
+                if (bus.wdata & regs::ORDER_CTRL_VALID) {
+                    host_cmd_valid_ = true;
+                    host_cmd_buy_ = (bus.wdata & regs::ORDER_CTRL_BUY) != 0;
+                    host_cmd_cancel_ = (bus.wdata & regs::ORDER_CTRL_CANCEL) != 0;
+                    order_accepted_ = false;
+                }
+                break;
+            case regs::ORDER_SEQ:
+                seq_load_ = true;
+                seq_value_ = bus.wdata;
+                break;
+            case regs::LOAD_PRICE: load_price_reg_ = bus.wdata; break;
+            case regs::LOAD_QTY:
+                // A push into a full FIFO is dropped
+                if (load_level < LOAD_FIFO_DEPTH) {
+                    load_price_fifo_[load_wr_ % LOAD_FIFO_DEPTH] = load_price_reg_;
+                    load_qty_fifo_[load_wr_ % LOAD_FIFO_DEPTH] = bus.wdata;
+                    ++load_wr_;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (bus.re) {
+        switch (bus.addr) {
+            case regs::SYMBOL: reg_rdata_ = symbol_reg_; break;
+            case regs::PRICE_H: reg_rdata_ = price_h_reg_; break;
+            case regs::PRICE_L: reg_rdata_ = price_l_reg_; break;
+            case regs::QUANTITY: reg_rdata_ = quantity_reg_; break;
+            case regs::STATUS: reg_rdata_ = status_; break;
+            case regs::BEST_BID_H: reg_rdata_ = 0; break;
+            case regs::BEST_BID_L: reg_rdata_ = best_bid_reg_; break;
+            case regs::BEST_ASK_H: reg_rdata_ = 0; break;
+            case regs::BEST_ASK_L: reg_rdata_ = best_ask_reg_; break;
+            case regs::BEST_BID_QTY: reg_rdata_ = best_bid_qty_reg_; break;
+            case regs::BEST_ASK_QTY: reg_rdata_ = best_ask_qty_reg_; break;
+            case regs::LATENCY: reg_rdata_ = latency_ns_; break;
+            case regs::THROUGHPUT: reg_rdata_ = throughput_; break;
+            case regs::ORDER_SYMBOL_L: reg_rdata_ = static_cast<uint32_t>(host_cmd_symbol_); break;
+            case regs::ORDER_SYMBOL_H: reg_rdata_ = static_cast<uint32_t>(host_cmd_symbol_ >> 32); break;
+            case regs::ORDER_PRICE: reg_rdata_ = host_cmd_price_; break;
+            case regs::ORDER_QTY: reg_rdata_ = host_cmd_quantity_; break;
+            case regs::ORDER_ID: reg_rdata_ = last_order_id; break;
+            case regs::ORDER_STATUS: reg_rdata_ = order_accepted_ ? regs::ORDER_STATUS_ACCEPTED : 0; break;
+            case regs::ORDER_SEQ: reg_rdata_ = next_order_id; break;
+            case regs::LOAD_COUNT: reg_rdata_ = load_count_; break;
+            case regs::BOOK_SEQ_BEGIN:
+                reg_rdata_ = book_gen_;
+                snap_gen_ = book_gen_;
+                std::copy(live_book_, live_book_ + 4, snap_book_);
+                break;
+            case regs::BOOK_BID_H: reg_rdata_ = 0; break;
+            case regs::BOOK_BID_L: reg_rdata_ = snap_book_[0]; break;
+            case regs::BOOK_ASK_H: reg_rdata_ = 0; break;
+            case regs::BOOK_ASK_L: reg_rdata_ = snap_book_[1]; break;
+            case regs::BOOK_BID_QTY: reg_rdata_ = snap_book_[2]; break;
+            case regs::BOOK_ASK_QTY: reg_rdata_ = snap_book_[3]; break;
+            case regs::BOOK_SEQ_END: reg_rdata_ = snap_gen_; break;
+            case regs::PERF_CONTROL: reg_rdata_ = regs::PERF_NUM_COUNTERS; break;
+            default: {
+                uint32_t offset = bus.addr - regs::PERF_BASE;
+                uint32_t ingress = bus.addr - regs::HIST_INGRESS_BASE;
+                uint32_t order = bus.addr - regs::HIST_ORDER_BASE;
+                if (bus.addr >= regs::PERF_BASE && offset < 2 * NUM_PERF_COUNTERS) {
+                    uint64_t counter = perf_shadow_[offset / 2];
+                    reg_rdata_ = static_cast<uint32_t>((offset & 1) ? counter >> 32 : counter);
+                } else if (bus.addr >= regs::HIST_INGRESS_BASE && ingress < HIST_BUCKETS) {
+                    reg_rdata_ = histogram_read(ingress_hist_, ingress);
+                } else if (bus.addr >= regs::HIST_ORDER_BASE && order < HIST_BUCKETS) {
+                    reg_rdata_ = histogram_read(order_hist_, order);
+                } else {
+                    reg_rdata_ = 0;
+                }
+                break;
+            }
+        }
+    }
+}
+
+} // namespace sim
+} // namespace trading
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "market_data_parser_model.hpp"
+#include "order_book_manager_model.hpp"
+#include "order_entry_encoder_model.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace trading {
+namespace sim {
+
+struct SimDeviceConfig {
+    // Device clock cycles for a host register access to complete. Reads
+    // are non-posted PCIe round trips; writes are posted.
+    uint32_t read_cycles = 200;
+    uint32_t write_cycles = 25;
+    uint32_t clock_period_ns = 4;
+    size_t max_orders = 1024;
+};
+
+// Cycle-accurate model of hw/rtl/trading_top.sv: host_register_bank.sv
+// feeding the parser, book manager and order entry encoder models.
+// Register accesses advance the device clock by the configured bus cost,
+// so host protocol overheads show up as simulated cycles.
+class SimDevice {
+public:
+    using EgressHandler = std::function<void(const uint8_t* frame, size_t length)>;
+
+    explicit SimDevice(const SimDeviceConfig& config = SimDeviceConfig());
+
+    uint32_t read(uint32_t reg);
+    void write(uint32_t reg, uint32_t value);
+
+    // Read count consecutive registers in one non-posted request; the
+    // completion carries two words per beat after the round trip
+    void read_burst(uint32_t first, size_t count, uint32_t* out);
+
+    // Advance the device clock
+    void run(uint64_t cycles);
+
+    uint64_t cycles() const { return cycle_count_; }
+    const SimDeviceConfig& config() const { return config_; }
+
+    // Receives each OUCH frame leaving the order entry encoder
+    void set_egress_handler(EgressHandler handler) { egress_ = std::move(handler); }
+
+private:
+    static constexpr uint32_t THROUGHPUT_WINDOW_LOG2 = 20;
+    static constexpr size_t NUM_PERF_COUNTERS = 11;
+    static constexpr size_t HIST_BUCKETS = 32;
+    static constexpr size_t TS_FIFO_DEPTH = 4;
+    static constexpr size_t LOAD_FIFO_DEPTH = 16;
+
+    static constexpr uint32_t HIST_GEN_MAX = 255;  // GEN_W = 8
+
+    // latency_histogram.sv ping-pong banks and their generation tags; the
+    // sweep is taken to last HIST_BUCKETS cycles, without the stall for
+    // samples still in flight
+    struct HistogramEntry {
+        uint8_t tag;
+        uint32_t count;
+    };
+    using HistogramBanks = std::array<std::array<HistogramEntry, HIST_BUCKETS>, 2>;
+
+    struct BusAccess {
+        bool we;
+        bool re;
+        uint32_t addr;
+        uint32_t wdata;
+    };
+
+    void reset();
+    void tick(const BusAccess& bus);
+    bool quiescent() const;
+    void fast_forward(uint64_t cycles);
+    uint32_t window_throughput() const;
+    static size_t histogram_bucket(uint32_t cycles);
+    void histogram_sample(HistogramBanks& banks, uint8_t bank, uint32_t cycles);
+    uint32_t histogram_read(const HistogramBanks& banks, uint32_t bucket) const;
+
+    SimDeviceConfig config_;
+    MarketDataParserModel parser_;
+    OrderBookManagerModel book_;
+    OrderEntryEncoderModel encoder_;
+    EgressHandler egress_;
+    std::vector<uint8_t> tx_frame_;
+
+    // host_register_bank state
+    uint32_t symbol_reg_ = 0;
+    uint32_t price_h_reg_ = 0;
+    uint32_t price_l_reg_ = 0;
+    uint32_t quantity_reg_ = 0;
+    bool is_bid_reg_ = false;
+    bool md_active_ = false;
+    uint8_t md_beat_ = 0;
+    bool waiting_book_ = false;
+    bool md_from_load_ = false;
+    std::array<uint32_t, LOAD_FIFO_DEPTH> load_price_fifo_{};
+    std::array<uint32_t, LOAD_FIFO_DEPTH> load_qty_fifo_{};
+    uint32_t load_wr_ = 0;
+    uint32_t load_rd_ = 0;
+    uint32_t load_price_reg_ = 0;
+    uint32_t cur_load_price_ = 0;
+    uint32_t cur_load_qty_ = 0;
+    uint32_t load_count_ = 0;
+    uint32_t status_ = 0;
+    bool book_request_ = false;
+    uint32_t best_bid_reg_ = 0;
+    uint32_t best_ask_reg_ = 0;
+    uint32_t best_bid_qty_reg_ = 0;
+    uint32_t best_ask_qty_reg_ = 0;
+    bool order_accepted_ = false;
+    bool host_cmd_valid_ = false;
+    bool host_cmd_cancel_ = false;
+    bool host_cmd_buy_ = false;
+    uint64_t host_cmd_symbol_ = 0;
+    uint32_t host_cmd_price_ = 0;
+    uint32_t host_cmd_quantity_ = 0;
+    uint32_t host_cmd_order_id_ = 0;
+    bool seq_load_ = false;
+    uint32_t seq_value_ = 0;
+    uint64_t cycle_count_ = 0;
+    uint64_t update_start_ = 0;
+    uint32_t latency_ns_ = 0;
+    uint32_t window_messages_ = 0;
+    uint32_t throughput_ = 0;
+    uint32_t reg_rdata_ = 0;
+    uint32_t book_gen_ = 0;
+    uint32_t live_book_[4] = {};  // bid, ask, bid qty, ask qty
+    uint32_t snap_gen_ = 0;
+    uint32_t snap_book_[4] = {};
+
+    // perf_counters state
+    std::array<uint64_t, NUM_PERF_COUNTERS> perf_counters_{};
+    std::array<uint64_t, NUM_PERF_COUNTERS> perf_shadow_{};
+
+    // latency_monitor state
+    std::array<uint32_t, TS_FIFO_DEPTH> parser_ts_{};
+    uint8_t ts_wr_ = 0;
+    uint8_t ts_rd_ = 0;
+    bool lat_book_busy_ = false;
+    uint32_t book_ts_ = 0;
+    bool update_pending_ = false;
+    uint32_t update_ts_ = 0;
+    HistogramBanks ingress_hist_{};
+    HistogramBanks order_hist_{};
+    uint8_t hist_active_ = 0;
+    std::array<uint8_t, 2> hist_gen_{};
+    uint32_t hist_clearing_ = 0;  // cycles left in a clear sweep
+};
+
+} // namespace sim
+} // namespace trading
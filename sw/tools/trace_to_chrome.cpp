@@ -0,0 +1,92 @@
+#include "trace.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Converts a trace::dump() file into Chrome trace event JSON, which
+// chrome://tracing and ui.perfetto.dev both open.
+//
+//   trace_to_chrome trace.bin trace.json
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <trace.bin> <trace.json>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    trading::trace::FileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != trading::trace::FILE_MAGIC ||
+        header.version != trading::trace::FILE_VERSION) {
+        std::cerr << "Not a trace dump: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::ofstream out(argv[2]);
+    if (!out) {
+        std::cerr << "Failed to open " << argv[2] << std::endl;
+        return 1;
+    }
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << std::fixed << std::setprecision(3);
+
+    bool first = true;
+    auto separator = [&]() -> std::ostream& {
+        if (!first) {
+            out << ",\n";
+        }
+        first = false;
+        return out;
+    };
+
+    uint64_t total = 0;
+    std::vector<trading::trace::Event> events;
+    for (uint16_t t = 0; t < header.thread_count; ++t) {
+        trading::trace::ThreadHeader thread;
+        if (!in.read(reinterpret_cast<char*>(&thread), sizeof(thread))) {
+            std::cerr << "Truncated trace dump" << std::endl;
+            return 1;
+        }
+        events.resize(thread.event_count);
+        if (!in.read(reinterpret_cast<char*>(events.data()),
+                     events.size() * sizeof(trading::trace::Event))) {
+            std::cerr << "Truncated trace dump" << std::endl;
+            return 1;
+        }
+
+        separator() << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":"
+                    << thread.thread_id << ",\"args\":{\"name\":\"thread "
+                    << thread.thread_id << "\"}}";
+        for (const trading::trace::Event& event : events) {
+            static const char PHASES[] = {'B', 'E', 'i'};
+            if (event.phase > trading::trace::INSTANT) {
+                continue;
+            }
+            // Timestamps in microseconds from the first traced thread
+            double ts = static_cast<double>(event.tsc - header.tsc_origin) / header.tsc_per_ns / 1000.0;
+            const char* name = trading::trace::event_name(event.id);
+            separator() << "{\"ph\":\"" << PHASES[event.phase] << "\",\"name\":\"";
+            if (name) {
+                out << name;
+            } else {
+                out << "user_" << event.id;
+            }
+            out << "\",\"pid\":1,\"tid\":" << thread.thread_id << ",\"ts\":" << ts;
+            if (event.phase == trading::trace::INSTANT) {
+                out << ",\"s\":\"t\"";
+            }
+            if (event.phase != trading::trace::END) {
+                out << ",\"args\":{\"arg\":" << event.arg << "}";
+            }
+            out << "}";
+            ++total;
+        }
+    }
+    out << "\n]}\n";
+
+    std::cout << "Converted " << total << " events from " << header.thread_count
+              << " threads" << std::endl;
+    return out ? 0 : 1;
+}
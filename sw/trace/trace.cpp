@@ -0,0 +1,142 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trading {
+namespace trace {
+
+namespace {
+
+// Rings outlive their threads so a dump after join still sees them;
+// free holds those whose thread has exited
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Ring*> free;
+    uint64_t start_tsc;
+    std::chrono::steady_clock::time_point start_time;
+
+    Registry() : start_tsc(__rdtsc()), start_time(std::chrono::steady_clock::now()) {}
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+Ring* acquire_ring() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    if (!reg.free.empty()) {
+        Ring* ring = reg.free.back();
+        reg.free.pop_back();
+        return ring;
+    }
+    reg.rings.emplace_back(new Ring(static_cast<uint32_t>(reg.rings.size())));
+    return reg.rings.back().get();
+}
+
+// Set once the thread's lease is gone; events recorded later in its exit
+// get a ring that is never returned
+thread_local bool lease_released = false;
+
+// Returns the thread's ring to the registry when the thread exits
+struct RingLease {
+    Ring* ring = nullptr;
+
+    ~RingLease() {
+        lease_released = true;
+        if (ring) {
+            current_ring = nullptr;
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.free.push_back(ring);
+        }
+    }
+};
+
+const char* const EVENT_NAMES[] = {
+    "feed_decode",
+    "send_market_data",
+    "device_ack",
+    "get_order_book",
+    "strategy",
+    "place_order",
+    "cancel_order",
+};
+
+} // namespace
+
+Ring& thread_ring() {
+    if (lease_released) {
+        current_ring = acquire_ring();
+        return *current_ring;
+    }
+    thread_local RingLease lease;
+    if (!lease.ring) {
+        lease.ring = acquire_ring();
+    }
+    current_ring = lease.ring;
+    return *current_ring;
+}
+
+const char* event_name(uint16_t id) {
+    if (id < sizeof(EVENT_NAMES) / sizeof(EVENT_NAMES[0])) {
+        return EVENT_NAMES[id];
+    }
+    return nullptr;
+}
+
+bool dump(const std::string& path) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    // The TSC rate over the whole run is accurate enough for a timeline
+    uint64_t tsc = __rdtsc();
+    double ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - reg.start_time).count();
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to open trace dump " << path << std::endl;
+        return false;
+    }
+
+    FileHeader header;
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.thread_count = static_cast<uint16_t>(reg.rings.size());
+    header.tsc_per_ns = ns > 0 ? static_cast<double>(tsc - reg.start_tsc) / ns : 1.0;
+    header.tsc_origin = reg.start_tsc;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    for (const std::unique_ptr<Ring>& ring : reg.rings) {
+        uint64_t head = ring->head();
+        uint64_t count = std::min<uint64_t>(head, Ring::RING_SIZE);
+        ThreadHeader thread;
+        thread.thread_id = ring->thread_id();
+        thread.event_count = static_cast<uint32_t>(count);
+        ok = ok && std::fwrite(&thread, sizeof(thread), 1, file) == 1;
+
+        // Oldest first: from the wrap point to the end, then the start
+        size_t first = static_cast<size_t>((head - count) & (Ring::RING_SIZE - 1));
+        size_t tail = std::min<size_t>(count, Ring::RING_SIZE - first);
+        ok = ok && std::fwrite(ring->events() + first, sizeof(Event), tail, file) == tail;
+        ok = ok && std::fwrite(ring->events(), sizeof(Event), count - tail, file) == count - tail;
+    }
+
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::cerr << "Failed to write trace dump " << path << std::endl;
+    }
+    return ok;
+}
+
+} // namespace trace
+} // namespace trading
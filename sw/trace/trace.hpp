@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <x86intrin.h>
+
+namespace trading {
+namespace trace {
+
+// Trace points along the tick-to-trade path. Ids at or above USER are free
+// for applications; they are exported as "user_<n>".
+enum EventId : uint16_t {
+    FEED_DECODE = 0,
+    SEND_MARKET_DATA,
+    DEVICE_ACK,
+    GET_ORDER_BOOK,
+    STRATEGY,
+    PLACE_ORDER,
+    CANCEL_ORDER,
+    USER = 256,
+};
+
+enum Phase : uint8_t {
+    BEGIN = 0,
+    END = 1,
+    INSTANT = 2,
+};
+
+// One fixed-size binary record
+struct Event {
+    uint64_t tsc;
+    uint32_t arg;
+    uint16_t id;
+    uint8_t phase;
+    uint8_t reserved;
+};
+
+// Single-writer ring owned by one thread. The newest RING_SIZE events are
+// kept; a dump while the owner is writing may see a few torn records at
+// the tail.
+class Ring {
+public:
+    static constexpr size_t RING_SIZE = 1 << 16;
+
+    explicit Ring(uint32_t thread_id) : thread_id_(thread_id), head_(0) {}
+
+    void record(uint16_t id, Phase phase, uint32_t arg) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        Event& event = events_[head & (RING_SIZE - 1)];
+        event.tsc = __rdtsc();
+        event.arg = arg;
+        event.id = id;
+        event.phase = phase;
+        event.reserved = 0;
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    uint32_t thread_id() const { return thread_id_; }
+    uint64_t head() const { return head_.load(std::memory_order_acquire); }
+    const Event* events() const { return events_; }
+
+private:
+    uint32_t thread_id_;
+    std::atomic<uint64_t> head_;
+    Event events_[RING_SIZE];
+};
+
+// The calling thread's ring, taken on first use. A thread's ring goes
+// back to the registry when it exits and is reused by the next new
+// thread, so the rings are bounded by the peak thread count and a dump's
+// thread ids name rings rather than threads.
+Ring& thread_ring();
+
+// Constant-initialized, so the hot path is one TLS load and a test
+inline thread_local Ring* current_ring = nullptr;
+
+inline void record(uint16_t id, Phase phase, uint32_t arg = 0) {
+    Ring* ring = current_ring;
+    if (__builtin_expect(ring == nullptr, 0)) {
+        ring = &thread_ring();
+    }
+    ring->record(id, phase, arg);
+}
+
+// Writes every thread's ring to a binary file for trace_to_chrome
+bool dump(const std::string& path);
+
+// Records a BEGIN now and the matching END when the scope exits
+class Scope {
+public:
+    Scope(uint16_t id, uint32_t arg) : id_(id) { record(id, BEGIN, arg); }
+    ~Scope() { record(id_, END); }
+
+private:
+    uint16_t id_;
+};
+
+// Binary dump layout: FileHeader, then per thread a ThreadHeader followed
+// by its events oldest first
+constexpr uint32_t FILE_MAGIC = 0x52545446;  // "FTTR"
+constexpr uint16_t FILE_VERSION = 1;
+
+struct FileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t thread_count;
+    double tsc_per_ns;
+    uint64_t tsc_origin;  // earliest TSC that was captured
+};
+
+struct ThreadHeader {
+    uint32_t thread_id;
+    uint32_t event_count;
+};
+
+const char* event_name(uint16_t id);
+
+} // namespace trace
+} // namespace trading
+
+// Trace points compile to nothing unless the build sets ENABLE_TRACING
+#ifdef TRADING_TRACE
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(id, arg) \
+    ::trading::trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)((id), (arg))
+#define TRACE_BEGIN(id, arg) ::trading::trace::record((id), ::trading::trace::BEGIN, (arg))
+#define TRACE_END(id) ::trading::trace::record((id), ::trading::trace::END)
+#define TRACE_INSTANT(id, arg) ::trading::trace::record((id), ::trading::trace::INSTANT, (arg))
+#else
+#define TRACE_SCOPE(id, arg) ((void)0)
+#define TRACE_BEGIN(id, arg) ((void)0)
+#define TRACE_END(id) ((void)0)
+#define TRACE_INSTANT(id, arg) ((void)0)
+#endif